@@ -29,6 +29,14 @@
  *
  * @param WIDTH Ancho en bits de los datos almacenados en la FIFO (por defecto: 16).
  * @param DEPTH Profundidad máxima de almacenamiento de la FIFO, debe ser potencia de dos (por defecto: 16).
+ * @param FWFT  First-word-fall-through: 1 = la palabra de cabeza está en `data_out` mientras `!empty`
+ *              y `rd_en` la extrae; 0 = `data_out` se registra en el ciclo siguiente a `rd_en` (por defecto: 0).
+ * @param STORAGE Tipo de almacenamiento (por defecto: "FLOPS"):
+ *              - "FLOPS": banco de registros, adecuado para FIFOs poco profundas.
+ *              - "BRAM": memoria de dos puertos con lectura síncrona inferible como bloque RAM en FPGA.
+ *              - "SRAM": instancia de `hsi_sram_2p`, envoltorio de la macro SRAM en ASIC.
+ *              Las dos últimas permiten profundidades de líneas completas de imagen (512-2048 píxeles)
+ *              sin crecer en registros ni multiplexores.
  *
  * @section signals Descripción de señales de entrada y salida
  * | Señal    | Dirección | Descripción                        |
@@ -41,6 +49,17 @@
  * | data_out | output    | Datos de salida de la FIFO.        |
  * | full     | output    | Indicador de FIFO completamente llena. |
  * | empty    | output    | Indicador de FIFO completamente vacía. |
+ * | level    | output    | Número de palabras almacenadas (0..DEPTH). |
+ * | af_level | input     | Umbral de almost_full (palabras).  |
+ * | ae_level | input     | Umbral de almost_empty (palabras). |
+ * | almost_full  | output | `level >= af_level`.              |
+ * | almost_empty | output | `level <= ae_level`.              |
+ *
+ * Los umbrales son entradas para poder programarlos en tiempo de ejecución (p. ej. desde un
+ * registro del wrapper). Un productor puede así escribir ráfagas del tamaño del hueco libre
+ * (`af_level = DEPTH - ráfaga + 1`) sin consultar `full` antes de cada palabra. Con
+ * `af_level > DEPTH` almost_full no se activa nunca y con `ae_level >= DEPTH` almost_empty está
+ * siempre activo.
  *
  * @section usage Ejemplo de instanciación
  *
@@ -53,13 +72,20 @@
  *     .data_in(data_in),
  *     .data_out(data_out),
  *     .full(full),
- *     .empty(empty)
+ *     .empty(empty),
+ *     .level(level),
+ *     .af_level(6'd24),
+ *     .ae_level(6'd4),
+ *     .almost_full(almost_full),
+ *     .almost_empty(almost_empty)
  * );
  * @endcode
  */
 module fifo_cache #(
     parameter int WIDTH = 16,
-    parameter int DEPTH = 16
+    parameter int DEPTH = 16,
+    parameter bit FWFT  = 0,
+    parameter string STORAGE = "FLOPS"
 ) (
     input  logic                  clk,       ///< Señal de reloj
     input  logic                  rst_n,     ///< Reset asíncrono activo en bajo
@@ -68,14 +94,22 @@ module fifo_cache #(
     input  logic [WIDTH-1:0]      data_in,   ///< Datos de entrada a escribir
     output logic [WIDTH-1:0]      data_out,  ///< Datos de salida leídos
     output logic                  full,      ///< Indicador de FIFO llena
-    output logic                  empty      ///< Indicador de FIFO vacía
+    output logic                  empty,     ///< Indicador de FIFO vacía
+    output logic [$clog2(DEPTH):0] level,    ///< Ocupación actual de la FIFO
+    input  logic [$clog2(DEPTH):0] af_level, ///< Umbral de almost_full
+    input  logic [$clog2(DEPTH):0] ae_level, ///< Umbral de almost_empty
+    output logic                  almost_full,  ///< Ocupación mayor o igual que af_level
+    output logic                  almost_empty  ///< Ocupación menor o igual que ae_level
 );
 
     /// Punteros internos con bit de fase para control eficiente de escritura y lectura
     logic [$clog2(DEPTH):0] wr_ptr, rd_ptr;
 
-    /// Almacenamiento interno de la FIFO
-    logic [WIDTH-1:0] fifo_mem [0:DEPTH-1];
+    /// Ancho de las direcciones de la matriz y escritura/lectura efectivas
+    localparam int AW = $clog2(DEPTH);
+    logic          push, pop;
+    assign push = wr_en && !full;
+    assign pop  = rd_en && !empty;
 
     /**
      * @brief Cálculo combinacional del estado de los indicadores full y empty.
@@ -88,27 +122,111 @@ module fifo_cache #(
 
     assign empty = (wr_ptr == rd_ptr);
 
+    /// La diferencia de punteros con bit de fase da directamente la ocupación (módulo 2*DEPTH)
+    assign level = wr_ptr - rd_ptr;
+
+    /// Indicadores programables a partir de la ocupación
+    assign almost_full  = (level >= af_level);
+    assign almost_empty = (level <= ae_level);
+
     /**
-     * @brief Proceso secuencial principal para operaciones de lectura/escritura.
+     * @brief Proceso secuencial de los punteros.
      *
      * - Inicialización al reset.
-     * - Manejo eficiente de lectura y escritura según señales y estados internos.
+     * - Avance de cada puntero con una escritura o lectura efectiva.
      */
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             wr_ptr   <= '0;
             rd_ptr   <= '0;
-            data_out <= '0;
         end else begin
-            if (wr_en && !full) begin
-                fifo_mem[wr_ptr[$clog2(DEPTH)-1:0]] <= data_in;
-                wr_ptr <= wr_ptr + 1;
+            if (push) wr_ptr <= wr_ptr + 1;
+            if (pop)  rd_ptr <= rd_ptr + 1;
+        end
+    end
+
+    /**
+     * @brief Almacenamiento y salida de datos.
+     *
+     * Con `STORAGE = "FLOPS"` la matriz es un banco de registros con lectura combinacional:
+     * - FWFT = 0: `data_out` se carga con la palabra extraída en el ciclo de `rd_en`.
+     * - FWFT = 1: `data_out` muestra de forma combinacional la palabra apuntada por `rd_ptr`, válida
+     *   mientras `!empty`; el consumidor la usa en el mismo ciclo en que activa `rd_en`.
+     *
+     * Con `STORAGE = "BRAM"` o `"SRAM"` la matriz es una memoria de dos puertos con lectura síncrona:
+     * - FWFT = 0: la lectura se lanza con `rd_en` y el registro de salida de la memoria es `data_out`.
+     * - FWFT = 1: la memoria lee cada ciclo la cabeza siguiente (`rd_ptr + 1` si se extrae una
+     *   palabra, `rd_ptr` en otro caso), de modo que su salida es la cabeza en el ciclo siguiente.
+     *   Si esa dirección se escribe en el mismo ciclo (FIFO vacía o con una palabra) el dato se toma
+     *   de un registro de bypass, ya que la memoria devuelve el contenido anterior.
+     * `full`, `empty` y `level` no cambian con el tipo de almacenamiento.
+     */
+    generate
+        if (STORAGE == "FLOPS") begin : g_flops
+            /// Almacenamiento interno de la FIFO
+            logic [WIDTH-1:0] fifo_mem [0:DEPTH-1];
+
+            always_ff @(posedge clk) begin
+                if (push) fifo_mem[wr_ptr[AW-1:0]] <= data_in;
             end
-            if (rd_en && !empty) begin
-                data_out <= fifo_mem[rd_ptr[$clog2(DEPTH)-1:0]];
-                rd_ptr   <= rd_ptr + 1;
+
+            if (FWFT) begin : g_fwft
+                assign data_out = fifo_mem[rd_ptr[AW-1:0]];
+            end else begin : g_registered
+                always_ff @(posedge clk or negedge rst_n) begin
+                    if (!rst_n) begin
+                        data_out <= '0;
+                    end else if (pop) begin
+                        data_out <= fifo_mem[rd_ptr[AW-1:0]];
+                    end
+                end
+            end
+        end else begin : g_ram
+            logic          mem_re;
+            logic [AW-1:0] mem_raddr;
+            logic [WIDTH-1:0] mem_rdata;
+
+            if (FWFT) begin : g_fwft
+                logic             byp_vld;
+                logic [WIDTH-1:0] byp_data;
+
+                assign mem_re    = 1'b1;
+                assign mem_raddr = pop ? rd_ptr[AW-1:0] + 1'b1 : rd_ptr[AW-1:0];
+
+                always_ff @(posedge clk or negedge rst_n) begin
+                    if (!rst_n) begin
+                        byp_vld  <= 1'b0;
+                        byp_data <= '0;
+                    end else begin
+                        byp_vld  <= push && (wr_ptr[AW-1:0] == mem_raddr);
+                        byp_data <= data_in;
+                    end
+                end
+
+                assign data_out = byp_vld ? byp_data : mem_rdata;
+            end else begin : g_registered
+                assign mem_re    = pop;
+                assign mem_raddr = rd_ptr[AW-1:0];
+                assign data_out  = mem_rdata;
+            end
+
+            if (STORAGE == "SRAM") begin : g_sram
+                // Envoltorio de la macro SRAM de la tecnología
+                hsi_sram_2p #(.WIDTH(WIDTH), .DEPTH(DEPTH)) i_sram (
+                    .clk(clk),
+                    .we(push), .waddr(wr_ptr[AW-1:0]), .wdata(data_in),
+                    .re(mem_re), .raddr(mem_raddr), .rdata(mem_rdata)
+                );
+            end else begin : g_bram
+                // Memoria inferible como bloque RAM: escritura y lectura síncronas sin reset
+                (* ram_style = "block" *) logic [WIDTH-1:0] ram [0:DEPTH-1];
+
+                always_ff @(posedge clk) begin
+                    if (push)   ram[wr_ptr[AW-1:0]] <= data_in;
+                    if (mem_re) mem_rdata <= ram[mem_raddr];
+                end
             end
         end
-    end
+    endgenerate
 
 endmodule
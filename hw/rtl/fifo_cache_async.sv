@@ -0,0 +1,168 @@
+/**
+ * @file fifo_cache_async.sv
+ * @brief Variante de doble reloj de `fifo_cache` con punteros en código Gray.
+ *
+ * @details
+ * FIFO asíncrona para comunicar dos dominios de reloj independientes, p. ej. el bus OBI del SoC y
+ * un núcleo de cálculo con un reloj más rápido. Cada dominio mantiene su puntero binario con bit de
+ * fase y una copia en código Gray, que es la única que cruza al otro dominio a través de
+ * `hsi_cdc_sync`. Como entre dos valores consecutivos de un puntero Gray solo cambia un bit, el
+ * valor sincronizado es siempre el actual o el anterior, y los indicadores resultan conservadores:
+ * `full` y `empty` pueden liberarse con un par de ciclos de retraso, pero nunca se activan tarde.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+/**
+ * @class fifo_cache_async
+ * @brief FIFO de doble reloj parametrizable.
+ *
+ * @details
+ * La interfaz de cada lado coincide con la de `fifo_cache` en su dominio: `full` y `wr_level` se
+ * calculan con el puntero de lectura sincronizado al reloj de escritura, y `empty` y `rd_level` con
+ * el puntero de escritura sincronizado al reloj de lectura. Los umbrales almost_full/almost_empty no
+ * se incluyen porque dependen del dominio en que se consulten; el usuario los compara con el nivel
+ * del lado que le interese. El almacenamiento es un banco de registros escrito con `wr_clk` y
+ * leído desde `rd_clk`.
+ *
+ * @param WIDTH       Ancho en bits de los datos (por defecto: 16).
+ * @param DEPTH       Profundidad, potencia de dos (por defecto: 16).
+ * @param FWFT        First-word-fall-through en el lado de lectura, igual que en `fifo_cache` (por defecto: 0).
+ * @param SYNC_STAGES Etapas de sincronización de los punteros Gray (por defecto: 2).
+ *
+ * @section signals Descripción de señales de entrada y salida
+ * | Señal    | Dirección | Descripción                                           |
+ * |----------|-----------|-------------------------------------------------------|
+ * | wr_clk   | input     | Reloj del dominio de escritura.                       |
+ * | wr_rst_n | input     | Reset activo en bajo del dominio de escritura.        |
+ * | wr_en    | input     | Habilitación de escritura.                            |
+ * | data_in  | input     | Datos de entrada.                                     |
+ * | full     | output    | FIFO llena vista desde el dominio de escritura.       |
+ * | wr_level | output    | Ocupación vista desde el dominio de escritura.        |
+ * | rd_clk   | input     | Reloj del dominio de lectura.                         |
+ * | rd_rst_n | input     | Reset activo en bajo del dominio de lectura.          |
+ * | rd_en    | input     | Habilitación de lectura.                              |
+ * | data_out | output    | Datos de salida.                                      |
+ * | empty    | output    | FIFO vacía vista desde el dominio de lectura.         |
+ * | rd_level | output    | Ocupación vista desde el dominio de lectura.          |
+ *
+ * Ambos resets deben activarse juntos (p. ej. el mismo reset asíncrono liberado de forma
+ * sincronizada en cada dominio).
+ */
+module fifo_cache_async #(
+    parameter int WIDTH       = 16,
+    parameter int DEPTH       = 16,
+    parameter bit FWFT        = 0,
+    parameter int SYNC_STAGES = 2
+) (
+    // Dominio de escritura
+    input  logic                   wr_clk,    ///< Reloj de escritura
+    input  logic                   wr_rst_n,  ///< Reset del dominio de escritura
+    input  logic                   wr_en,     ///< Habilitación de escritura
+    input  logic [WIDTH-1:0]       data_in,   ///< Datos de entrada a escribir
+    output logic                   full,      ///< Indicador de FIFO llena
+    output logic [$clog2(DEPTH):0] wr_level,  ///< Ocupación en el dominio de escritura
+
+    // Dominio de lectura
+    input  logic                   rd_clk,    ///< Reloj de lectura
+    input  logic                   rd_rst_n,  ///< Reset del dominio de lectura
+    input  logic                   rd_en,     ///< Habilitación de lectura
+    output logic [WIDTH-1:0]       data_out,  ///< Datos de salida leídos
+    output logic                   empty,     ///< Indicador de FIFO vacía
+    output logic [$clog2(DEPTH):0] rd_level   ///< Ocupación en el dominio de lectura
+);
+
+    localparam int AW = $clog2(DEPTH);
+
+    /// Punteros binarios con bit de fase y sus copias Gray registradas
+    logic [AW:0] wr_bin, wr_gray, rd_bin, rd_gray;
+    /// Punteros Gray sincronizados al dominio contrario y su conversión a binario
+    logic [AW:0] wr_gray_s, rd_gray_s, wr_bin_s, rd_bin_s;
+
+    logic push, pop;
+
+    function automatic logic [AW:0] bin2gray(input logic [AW:0] b);
+        return b ^ (b >> 1);
+    endfunction
+
+    function automatic logic [AW:0] gray2bin(input logic [AW:0] g);
+        logic [AW:0] b;
+        b[AW] = g[AW];
+        for (int i = AW - 1; i >= 0; i--) b[i] = b[i+1] ^ g[i];
+        return b;
+    endfunction
+
+    // ------------------------------------------------------------------------
+    // Dominio de escritura
+    // ------------------------------------------------------------------------
+    assign rd_bin_s = gray2bin(rd_gray_s);
+    assign wr_level = wr_bin - rd_bin_s;
+    assign full     = (wr_level == (AW+1)'(DEPTH));
+    assign push     = wr_en && !full;
+
+    always_ff @(posedge wr_clk or negedge wr_rst_n) begin
+        if (!wr_rst_n) begin
+            wr_bin  <= '0;
+            wr_gray <= '0;
+        end else if (push) begin
+            wr_bin  <= wr_bin + 1'b1;
+            wr_gray <= bin2gray(wr_bin + 1'b1);
+        end
+    end
+
+    hsi_cdc_sync #(.WIDTH(AW+1), .STAGES(SYNC_STAGES)) i_sync_rd_ptr (
+        .clk(wr_clk), .rst_n(wr_rst_n), .d(rd_gray), .q(rd_gray_s)
+    );
+
+    /// Almacenamiento interno: escrito en wr_clk, leído en rd_clk solo en posiciones ya publicadas
+    logic [WIDTH-1:0] fifo_mem [0:DEPTH-1];
+
+    always_ff @(posedge wr_clk) begin
+        if (push) fifo_mem[wr_bin[AW-1:0]] <= data_in;
+    end
+
+    // ------------------------------------------------------------------------
+    // Dominio de lectura
+    // ------------------------------------------------------------------------
+    assign wr_bin_s = gray2bin(wr_gray_s);
+    assign rd_level = wr_bin_s - rd_bin;
+    assign empty    = (wr_bin_s == rd_bin);
+    assign pop      = rd_en && !empty;
+
+    always_ff @(posedge rd_clk or negedge rd_rst_n) begin
+        if (!rd_rst_n) begin
+            rd_bin  <= '0;
+            rd_gray <= '0;
+        end else if (pop) begin
+            rd_bin  <= rd_bin + 1'b1;
+            rd_gray <= bin2gray(rd_bin + 1'b1);
+        end
+    end
+
+    hsi_cdc_sync #(.WIDTH(AW+1), .STAGES(SYNC_STAGES)) i_sync_wr_ptr (
+        .clk(rd_clk), .rst_n(rd_rst_n), .d(wr_gray), .q(wr_gray_s)
+    );
+
+    generate
+        if (FWFT) begin : g_fwft
+            assign data_out = fifo_mem[rd_bin[AW-1:0]];
+        end else begin : g_registered
+            always_ff @(posedge rd_clk or negedge rd_rst_n) begin
+                if (!rd_rst_n) begin
+                    data_out <= '0;
+                end else if (pop) begin
+                    data_out <= fifo_mem[rd_bin[AW-1:0]];
+                end
+            end
+        end
+    endgenerate
+
+endmodule
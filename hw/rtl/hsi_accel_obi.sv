@@ -7,7 +7,77 @@
  * Expone una interfaz OBI para facilitar su integración dentro de plataformas como X-HEEP.
  * 
  * El wrapper maneja la configuración del núcleo (op_code, num_bands, start) y proporciona acceso
- * al estado del procesamiento. Los vectores de entrada/salida deben conectarse externamente.
+ * al estado del procesamiento. Los vectores de entrada/salida deben conectarse externamente o, con
+ * `DMA_EN = 1`, los mueve el DMA `hsi_dma` a través del puerto maestro OBI `dma_*` (ver registros
+ * DMA_* del wrapper). Mientras el DMA está activo sus escrituras y lecturas de FIFO se suman a las
+ * de la interfaz externa, que no debe usarse durante la transferencia.
+ *
+ * La salida `irq_o` agrupa las fuentes de interrupción del wrapper (fin de trabajo, error y
+ * niveles de las FIFOs), configurables mediante IRQ_ENABLE / IRQ_STATUS / IRQ_LEVEL.
+ *
+ * Con `PERF_EN = 1` el wrapper incluye los contadores de rendimiento (PERF_*), alimentados con el
+ * estado de la FSM del núcleo y sus señales de bloqueo `stall_in` / `stall_out`.
+ *
+ * `FIFO_STORAGE` selecciona el almacenamiento de las FIFOs del núcleo ("FLOPS", "BRAM" o "SRAM").
+ * Para amortiguar ráfagas del DMA con una o varias líneas de imagen (FIFO_DEPTH de 512 a 2048)
+ * se recomienda "BRAM" en FPGA o "SRAM" en ASIC, sustituyendo el modelo de `hsi_sram_2p` por la macro.
+ *
+ * Con `DUAL_CLOCK = 1` el núcleo (FSM y datapath) funciona con `core_clk_i`, que puede ser más rápido
+ * que `clk_i`, mientras el wrapper, el DMA y la interfaz externa de las FIFOs siguen en `clk_i`. Las
+ * FIFOs del núcleo pasan a ser `fifo_cache_async` y el resto de señales cruzan de dominio así:
+ * - START y la configuración (OP_CODE, NUM_BANDS, CONFIG, THRESHOLD) viajan juntas por `hsi_cdc_bus`: el núcleo
+ *   recibe una copia registrada en su dominio en cada START, de modo que la configuración no debe
+ *   cambiarse mientras hay un trabajo en curso (BUSY). Un START que llega con la transferencia
+ *   anterior aún en vuelo se mantiene en el wrapper hasta que el bus lo acepta.
+ * - `more_input` (DMA pendiente o trabajo de PIXEL_COUNT píxeles) se sincroniza con `hsi_cdc_sync` y
+ *   llega al núcleo al menos un ciclo de `clk_i` antes que el START correspondiente.
+ * - Cada resultado incrementa un contador Gray en el dominio del núcleo; en el dominio del bus se
+ *   regenera un pulso de `pixel_valid` por cada incremento recibido.
+ * - `error_code`, `pixel_done`, el estado de la FSM y las señales de bloqueo se muestrean de forma
+ *   continua con `hsi_cdc_bus`, y `out_full` con `hsi_cdc_sync`. Los contadores PERF_* cuentan
+ *   entonces ciclos de `clk_i` según el último estado muestreado. El código de error y
+ *   `pixel_done` no llegan al wrapper hasta que la muestra recibida es posterior al último START.
+ * El reset del dominio del núcleo es `rst_ni` con liberación sincronizada a `core_clk_i`. Con
+ * `DUAL_CLOCK = 0` `core_clk_i` no se usa.
+ *
+ * `REF_NUM`/`REF_BEATS` dimensionan el banco de referencias del núcleo (OP_REF_LOAD y CONFIG.REF_MODE).
+ * Con el DMA, un trabajo OP_REF_LOAD lee solo de DMA_SRC2 (PIXEL_COUNT = número de referencias) y no
+ * escribe resultados, y un trabajo OP_DOT con REF_MODE lee solo de DMA_SRC1.
+ *
+ * CONFIG.PREC empaqueta 2 o 4 muestras por componente para OP_DOT (ver `hsi_vector_core`); el
+ * distribuidor y el DMA cuentan entonces `COMPONENTS_MAX*2^PREC` bandas por beat.
+ *
+ * BAND_WINDOW (0x84) limita el cálculo a una ventana contigua de bandas; en band-serial el DMA
+ * solo lee los beats que la solapan y el distribuidor cuenta los beats de cada píxel a partir del
+ * que contiene la primera banda de la ventana.
+ *
+ * CONFIG.OUT_SCALE (bits [15:8]) fija el desplazamiento, redondeo y saturación con que los
+ * acumuladores anchos de OP_DOT/OP_SAM se devuelven al ancho de la FIFO de salida.
+ *
+ * CONFIG.POST activa el postprocesado de OP_DOT del núcleo (ARGMAX o THRESHOLD con el registro
+ * THRESHOLD); el DMA escribe entonces solo las componentes 0 y 1 de cada resultado, es decir
+ * `ceil(2*COMPONENT_WIDTH/32)` palabras de 32 bits (una con COMPONENT_WIDTH <= 16).
+ *
+ * `DESC_DEPTH` dimensiona la cola de descriptores del wrapper (COMMAND.ENQUEUE y DESC_STATUS): los
+ * trabajos encolados se aplican al núcleo y al DMA al terminar el anterior, sin pasar por el firmware.
+ *
+ * Con `NUM_CORES` > 1 se replica el núcleo (cada copia con sus FIFOs) detrás del mismo wrapper:
+ * - Un distribuidor round-robin envía cada píxel completo (todos sus beats con BAND_SERIAL) de la
+ *   FIFO 1 y de la FIFO 2 al núcleo siguiente. En OP_REF_LOAD las escrituras de la FIFO 2 se copian
+ *   en todos los núcleos, que cargan así el mismo banco de referencias.
+ * - La salida se lee de los núcleos en el mismo orden circular, de modo que los resultados salen en
+ *   orden de píxel sin etiquetas: `out_empty_o` refleja la FIFO del núcleo que debe entregar el
+ *   siguiente resultado y `in*_full` la del núcleo que recibirá el siguiente píxel.
+ * - START se envía solo a los núcleos con datos, salvo con un productor pendiente (DMA o trabajo de
+ *   PIXEL_COUNT píxeles), que los arranca todos.
+ * - DONE se activa cuando todos los núcleos del último START han terminado (`pixel_done` o vuelta a
+ *   IDLE) y ERROR toma el código del primer núcleo con error. PERF_PIXELS y PROCESSED_COUNT cuentan
+ *   los resultados de todos, PERF_STALL_IN / PERF_STALL_OUT los ciclos con algún núcleo bloqueado, y
+ *   PERF_BUSY / PERF_STATE los ciclos con algún núcleo activo, según el estado del primero que lo
+ *   esté. PERF_CORE_PIXELS / PERF_CORE_BUSY dan el reparto por núcleo.
+ * Los punteros del distribuidor vuelven al núcleo 0 con cada START aceptado con todos los núcleos en
+ * IDLE y sus FIFOs vacías, lo que descarta el píxel a medias de un trabajo abortado. Si tras un
+ * error quedan píxeles a medio consumir en las FIFOs debe reiniciarse el acelerador con `rst_ni`.
  *
  * @author
  * Alejandro Fernández Rodríguez, UCLM
@@ -18,11 +88,22 @@
 module hsi_accel_obi #(
     parameter int COMPONENT_WIDTH = 16,
     parameter int FIFO_DEPTH      = 16,
-    parameter int COMPONENTS_MAX  = 3
+    parameter int COMPONENTS_MAX  = 3,
+    parameter bit DMA_EN          = 0,
+    parameter bit PERF_EN         = 1,
+    parameter string FIFO_STORAGE = "FLOPS",
+    parameter bit DUAL_CLOCK      = 0,
+    parameter int REF_NUM         = 3,
+    parameter int REF_BEATS       = 1,
+    parameter int NUM_CORES       = 1,
+    parameter int DESC_DEPTH      = 4
 )(
     // Señales de reloj y reset
     input  logic                          clk_i,
     input  logic                          rst_ni,
+    /* verilator lint_off UNUSEDSIGNAL */
+    input  logic                          core_clk_i,
+    /* verilator lint_on UNUSEDSIGNAL */
 
     // Interfaz OBI (slave)
     input  logic                          req_i,
@@ -35,6 +116,19 @@ module hsi_accel_obi #(
     output logic [31:0]                   rdata_o,
     output logic                          err_o,
 
+    // Interrupción
+    output logic                          irq_o,
+
+    // Interfaz OBI (master, DMA)
+    output logic                          dma_req_o,
+    output logic                          dma_we_o,
+    output logic [3:0]                    dma_be_o,
+    output logic [31:0]                   dma_addr_o,
+    output logic [31:0]                   dma_wdata_o,
+    input  logic                          dma_gnt_i,
+    input  logic                          dma_rvalid_i,
+    input  logic [31:0]                   dma_rdata_i,
+
     // Interfaz externa para datos (FIFO)
     input  logic                          in1_wr_en_i,
     input  logic                          in2_wr_en_i,
@@ -45,19 +139,81 @@ module hsi_accel_obi #(
     output logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] out_data_o
 );
 
+    localparam int DATA_W = COMPONENT_WIDTH*COMPONENTS_MAX;
+
     // Señales internas
     logic [3:0]  op_code;
     logic [31:0] num_bands;
-    logic        start;
+    logic        stream_mode;
+    logic        band_serial;
+    logic        ref_mode;
+    logic [1:0]  post_mode;
+    /* verilator lint_off UNUSEDSIGNAL */
+    logic [31:0] threshold;     // solo se usan los COMPONENT_WIDTH bits bajos
+    /* verilator lint_on UNUSEDSIGNAL */
+    logic [1:0]  prec;
+    logic [7:0]  out_scale;
+    logic [15:0] band_first, band_count;
+    logic        start, start_ready;
+    logic [31:0] pixel_count;
+    logic        job_active;
 
     logic        pixel_done;
+    logic        pixel_valid;
     logic [3:0]  error_code;
 
+    // Estado del núcleo para los contadores de rendimiento
+    logic [3:0]  core_state;
+    logic        stall_in, stall_out;
+
     logic        in1_full, in2_full;
     logic        out_full;
 
     logic        in1_empty, in2_empty;
-    
+
+    // Ocupación de las FIFOs y umbrales almost_full / almost_empty
+    localparam int LEVEL_W = $clog2(FIFO_DEPTH) + 1;
+    logic [LEVEL_W-1:0] in1_level, in2_level, out_level;
+    logic [15:0]        fifo_af_level, fifo_ae_level;
+    logic [LEVEL_W-1:0] af_level, ae_level;
+    logic [2:0]         almost_full, almost_empty;
+
+    // Puertos de cada núcleo vistos desde el dominio del bus
+    logic [NUM_CORES-1:0] c_in1_wr_en, c_in2_wr_en, c_out_rd_en;
+    logic [NUM_CORES-1:0] c_in1_full, c_in2_full, c_out_full, c_out_empty;
+    logic [DATA_W-1:0]    c_out_data     [NUM_CORES];
+    logic [LEVEL_W-1:0]   c_in1_level    [NUM_CORES];
+    logic [LEVEL_W-1:0]   c_in2_level    [NUM_CORES];
+    logic [LEVEL_W-1:0]   c_out_level    [NUM_CORES];
+    logic [2:0]           c_almost_full  [NUM_CORES];
+    logic [2:0]           c_almost_empty [NUM_CORES];
+    logic [NUM_CORES-1:0] c_pixel_done, c_pixel_valid, c_busy;
+    logic [NUM_CORES-1:0] c_stall_in, c_stall_out;
+    logic [3:0]           c_error_code   [NUM_CORES];
+    logic [3:0]           c_state        [NUM_CORES];
+    logic [NUM_CORES-1:0] c_err_fresh;      // el código de error ya refleja el último START
+
+    // Umbrales saturados al rango de la FIFO: por encima de FIFO_DEPTH, almost_full nunca se
+    // activa y almost_empty siempre
+    assign af_level = (fifo_af_level > 16'(FIFO_DEPTH)) ? LEVEL_W'(FIFO_DEPTH + 1) : LEVEL_W'(fifo_af_level);
+    assign ae_level = (fifo_ae_level > 16'(FIFO_DEPTH)) ? LEVEL_W'(FIFO_DEPTH)     : LEVEL_W'(fifo_ae_level);
+
+    // Configuración y estado del DMA
+    logic [31:0] dma_src1_addr, dma_src2_addr, dma_dst_addr;
+    logic [15:0] dma_src_stride, dma_dst_stride;
+    logic        dma_start, dma_done, dma_in_pending;
+
+    // Puertos de FIFO del núcleo (interfaz externa + DMA)
+    logic                                     dma_in1_wr_en, dma_in2_wr_en, dma_out_rd_en;
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] dma_in_data;
+    logic                                     core_in1_wr_en, core_in2_wr_en, core_out_rd_en;
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] core_in1_data, core_in2_data;
+
+    assign core_in1_wr_en = in1_wr_en_i | dma_in1_wr_en;
+    assign core_in2_wr_en = in2_wr_en_i | dma_in2_wr_en;
+    assign core_in1_data  = dma_in1_wr_en ? dma_in_data : in1_data_i;
+    assign core_in2_data  = dma_in2_wr_en ? dma_in_data : in2_data_i;
+    assign core_out_rd_en = out_rd_en_i | dma_out_rd_en;
 
     // ============================================================================
     // Instancia del wrapper
@@ -70,7 +226,11 @@ module hsi_accel_obi #(
         .NUM_BANDS_WIDTH(32),
         .ERR_WIDTH(4),
         .READ_CLEAR_DONE(0),
-        .EXPOSE_FIFO_STATUS(1)
+        .EXPOSE_FIFO_STATUS(1),
+        .EXPOSE_DMA(DMA_EN),
+        .EXPOSE_PERF(PERF_EN),
+        .NUM_CORES(NUM_CORES),
+        .DESC_DEPTH(DESC_DEPTH)
     ) i_wrapper (
         .clk_i(clk_i),
         .rst_ni(rst_ni),
@@ -89,10 +249,32 @@ module hsi_accel_obi #(
         // Señales de control hacia el core
         .op_code_o(op_code),
         .num_bands_o(num_bands),
+        .band_first_o(band_first),
+        .band_count_o(band_count),
+        .stream_mode_o(stream_mode),
+        .band_serial_o(band_serial),
+        .ref_mode_o(ref_mode),
+        .post_mode_o(post_mode),
+        .threshold_o(threshold),
+        .prec_o(prec),
+        .out_scale_o(out_scale),
         .start_o(start),
+        .start_ready_i(start_ready),
+        .job_active_o(job_active),
+
+        // Configuración del DMA
+        .dma_src1_addr_o(dma_src1_addr),
+        .dma_src2_addr_o(dma_src2_addr),
+        .dma_dst_addr_o(dma_dst_addr),
+        .pixel_count_o(pixel_count),
+        .dma_src_stride_o(dma_src_stride),
+        .dma_dst_stride_o(dma_dst_stride),
+        .dma_start_o(dma_start),
+        .dma_done_i(dma_done),
 
         // Desde core
         .pixel_done_i(pixel_done),
+        .pixel_valid_i(pixel_valid),
         .error_code_i(error_code),
 
         // Estado FIFO (desde core)
@@ -101,38 +283,504 @@ module hsi_accel_obi #(
         .out_full_i(out_full),
         .out_empty_i(out_empty_o),
         .in1_empty_i(in1_empty),
-        .in2_empty_i(in2_empty)
+        .in2_empty_i(in2_empty),
+
+        // Contadores de rendimiento (desde core)
+        .core_state_i(core_state),
+        .stall_in_i(stall_in),
+        .stall_out_i(stall_out),
+        .core_valid_i(c_pixel_valid),
+        .core_busy_i(c_busy),
+
+        // Ocupación de las FIFOs e interrupción
+        .in1_level_i(16'(in1_level)),
+        .in2_level_i(16'(in2_level)),
+        .out_level_i(16'(out_level)),
+        .almost_full_i(almost_full),
+        .almost_empty_i(almost_empty),
+        .fifo_af_level_o(fifo_af_level),
+        .fifo_ae_level_o(fifo_ae_level),
+        .irq_o(irq_o)
     );
 
     // ============================================================================
-    // Instancia del núcleo vectorial
+    // Instancia del DMA
     // ============================================================================
-    hsi_vector_core #(
-        .COMPONENT_WIDTH(COMPONENT_WIDTH),
-        .FIFO_DEPTH(FIFO_DEPTH),
-        .COMPONENTS_MAX(COMPONENTS_MAX)
-    ) i_hsi_core (
-        .clk(clk_i),
-        .rst_n(rst_ni),
-
-        .in1_wr_en(in1_wr_en_i),
-        .in1_data_in(in1_data_i),
-        .in1_full(in1_full),
-
-        .in2_wr_en(in2_wr_en_i),
-        .in2_data_in(in2_data_i),
-        .in2_full(in2_full),
-
-        .out_rd_en(out_rd_en_i),
-        .out_data_out(out_data_o),
-        .out_empty(out_empty_o),
-        .out_full(out_full),
-
-        .op_code(op_code),
-        .num_bands(num_bands),
-        .start(start),
-        .pixel_done(pixel_done),
-        .error_code(error_code)
-    );
+    if (DMA_EN) begin : g_dma
+        // Fuentes de cada beat: OP_REF_LOAD solo llena la FIFO 2 y REF_MODE solo usa la FIFO 1
+        logic ref_load;
+        assign ref_load = (op_code == 4'd4);
+
+        hsi_dma #(
+            .DATA_WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX),
+            .COMPONENTS_MAX(COMPONENTS_MAX),
+            .NARROW_WIDTH(2*COMPONENT_WIDTH)
+        ) i_dma (
+            .clk_i(clk_i),
+            .rst_ni(rst_ni),
+
+            .start_i(dma_start),
+            .src1_addr_i(dma_src1_addr),
+            .src2_addr_i(dma_src2_addr),
+            .dst_addr_i(dma_dst_addr),
+            .pixel_count_i(pixel_count),
+            .src_stride_i(dma_src_stride),
+            .dst_stride_i(dma_dst_stride),
+            .num_bands_i(num_bands),
+            .band_first_i(band_first),
+            .band_count_i(band_count),
+            .band_serial_i(band_serial),
+            .prec_i(prec),
+            .src1_en_i(!ref_load),
+            .src2_en_i(ref_load || !ref_mode),
+            // Con postprocesado el resultado útil son las componentes 0 y 1 (índice y puntuación de ARGMAX)
+            .narrow_res_i(post_mode != 2'd0),
+
+            /* verilator lint_off PINCONNECTEMPTY */
+            .busy_o(),
+            /* verilator lint_on PINCONNECTEMPTY */
+            .done_o(dma_done),
+            .in_pending_o(dma_in_pending),
+
+            .req_o(dma_req_o),
+            .we_o(dma_we_o),
+            .be_o(dma_be_o),
+            .addr_o(dma_addr_o),
+            .wdata_o(dma_wdata_o),
+            .gnt_i(dma_gnt_i),
+            .rvalid_i(dma_rvalid_i),
+            .rdata_i(dma_rdata_i),
+
+            .in1_wr_en_o(dma_in1_wr_en),
+            .in2_wr_en_o(dma_in2_wr_en),
+            .in_data_o(dma_in_data),
+            .in1_full_i(in1_full),
+            .in2_full_i(in2_full),
+            .out_rd_en_o(dma_out_rd_en),
+            .out_empty_i(out_empty_o),
+            .out_data_i(out_data_o)
+        );
+    end else begin : g_no_dma
+        assign dma_done       = 1'b0;
+        assign dma_in_pending = 1'b0;
+        assign dma_in1_wr_en  = 1'b0;
+        assign dma_in2_wr_en  = 1'b0;
+        assign dma_in_data    = '0;
+        assign dma_out_rd_en  = 1'b0;
+        assign dma_req_o      = 1'b0;
+        assign dma_we_o       = 1'b0;
+        assign dma_be_o       = 4'h0;
+        assign dma_addr_o     = 32'h0;
+        assign dma_wdata_o    = 32'h0;
+    end
+
+    // ============================================================================
+    // Dominio de reloj del núcleo
+    // ============================================================================
+    // Configuración compartida por los núcleos en su propio dominio
+    logic                 core_clk, core_rst_n;
+    logic [3:0]           core_op_code;
+    logic [31:0]          core_num_bands;
+    logic [15:0]          core_band_first, core_band_count;
+    logic                 core_stream_mode, core_band_serial, core_ref_mode;
+    logic [1:0]           core_post_mode, core_prec;
+    logic [7:0]           core_out_scale;
+    logic [COMPONENT_WIDTH-1:0] core_threshold;
+    logic                 core_start, core_more_input;
+    logic [NUM_CORES-1:0] start_mask, core_mask;
+    /* verilator lint_off UNUSEDSIGNAL */
+    logic                 start_tgl, core_start_tgl;   // START aceptados en cada dominio (DUAL_CLOCK)
+    /* verilator lint_on UNUSEDSIGNAL */
+
+    if (DUAL_CLOCK) begin : g_dual_clock
+        // Reset: activación asíncrona, liberación sincronizada con core_clk_i
+        logic [1:0] core_rst_q;
+
+        always_ff @(posedge core_clk_i or negedge rst_ni) begin
+            if (!rst_ni) core_rst_q <= '0;
+            else         core_rst_q <= {core_rst_q[0], 1'b1};
+        end
+
+        assign core_clk   = core_clk_i;
+        assign core_rst_n = core_rst_q[1];
+
+        // START se retrasa un ciclo respecto a more_input para que este llegue antes al núcleo
+        logic start_q, more_input_q;
+
+        always_ff @(posedge clk_i or negedge rst_ni) begin
+            if (!rst_ni) begin
+                start_q      <= 1'b0;
+                more_input_q <= 1'b0;
+            end else begin
+                start_q      <= start;
+                more_input_q <= dma_in_pending | job_active;
+            end
+        end
+
+        hsi_cdc_sync #(.WIDTH(1)) i_sync_more_input (
+            .clk(core_clk_i), .rst_n(core_rst_n), .d(more_input_q), .q(core_more_input)
+        );
+
+        // START + configuración + núcleos destinatarios hacia el dominio del núcleo. El wrapper
+        // mantiene START hasta que el bus lo acepta (un START anterior puede seguir en vuelo).
+        logic cfg_valid, cfg_ready;
+
+        assign start_ready = start_q && cfg_ready;
+
+        hsi_cdc_bus #(.WIDTH(4 + 32 + 3 + 2 + COMPONENT_WIDTH + 2 + 8 + 32 + NUM_CORES)) i_cdc_cfg (
+            .src_clk(clk_i), .src_rst_n(rst_ni),
+            .src_valid(start && start_q),
+            .src_data({op_code, num_bands, stream_mode, band_serial, ref_mode, post_mode,
+                       threshold[COMPONENT_WIDTH-1:0], prec, out_scale, band_first, band_count, start_mask}),
+            .src_ready(cfg_ready),
+            .dst_clk(core_clk_i), .dst_rst_n(core_rst_n),
+            .dst_valid(cfg_valid),
+            .dst_data({core_op_code, core_num_bands, core_stream_mode, core_band_serial, core_ref_mode, core_post_mode,
+                       core_threshold, core_prec, core_out_scale, core_band_first, core_band_count, core_mask})
+        );
+
+        // El núcleo ve START un ciclo después de cargar la configuración. Cada START cambia start_tgl
+        // al aceptarse y core_start_tgl al llegar al núcleo, en el mismo flanco en que este renueva
+        // error_code: el estado muestreado con ambos iguales ya corresponde al último START.
+        always_ff @(posedge clk_i or negedge rst_ni) begin
+            if (!rst_ni)                   start_tgl <= 1'b0;
+            else if (start && start_ready) start_tgl <= ~start_tgl;
+        end
+
+        always_ff @(posedge core_clk_i or negedge core_rst_n) begin
+            if (!core_rst_n) begin
+                core_start     <= 1'b0;
+                core_start_tgl <= 1'b0;
+            end else begin
+                core_start     <= cfg_valid;
+                core_start_tgl <= core_start_tgl ^ core_start;
+            end
+        end
+    end else begin : g_single_clock
+        assign core_clk         = clk_i;
+        assign core_rst_n       = rst_ni;
+        assign core_op_code     = op_code;
+        assign core_num_bands   = num_bands;
+        assign core_band_first  = band_first;
+        assign core_band_count  = band_count;
+        assign core_stream_mode = stream_mode;
+        assign core_band_serial = band_serial;
+        assign core_ref_mode    = ref_mode;
+        assign core_post_mode   = post_mode;
+        assign core_threshold   = threshold[COMPONENT_WIDTH-1:0];
+        assign core_prec        = prec;
+        assign core_out_scale   = out_scale;
+        assign core_mask        = start_mask;
+        assign core_start       = start;
+        assign start_ready      = 1'b1;
+        assign start_tgl        = 1'b0;
+        assign core_start_tgl   = 1'b0;
+        assign core_more_input  = dma_in_pending | job_active;
+    end
+
+    // ============================================================================
+    // Instancias de los núcleos vectoriales
+    // ============================================================================
+    for (genvar c = 0; c < NUM_CORES; c++) begin : g_core
+        // Estado del núcleo en su propio dominio
+        logic       core_pixel_done, core_pixel_valid;
+        logic [3:0] core_error_code, core_fsm_state;
+        logic       core_stall_in, core_stall_out, core_out_full;
+
+        hsi_vector_core #(
+            .COMPONENT_WIDTH(COMPONENT_WIDTH),
+            .FIFO_DEPTH(FIFO_DEPTH),
+            .COMPONENTS_MAX(COMPONENTS_MAX),
+            .FIFO_STORAGE(FIFO_STORAGE),
+            .DUAL_CLOCK(DUAL_CLOCK),
+            .REF_NUM(REF_NUM),
+            .REF_BEATS(REF_BEATS)
+        ) i_hsi_core (
+            .clk(core_clk),
+            .rst_n(core_rst_n),
+            .bus_clk(clk_i),
+            .bus_rst_n(rst_ni),
+
+            .in1_wr_en(c_in1_wr_en[c]),
+            .in1_data_in(core_in1_data),
+            .in1_full(c_in1_full[c]),
+
+            .in2_wr_en(c_in2_wr_en[c]),
+            .in2_data_in(core_in2_data),
+            .in2_full(c_in2_full[c]),
+
+            .out_rd_en(c_out_rd_en[c]),
+            .out_data_out(c_out_data[c]),
+            .out_empty(c_out_empty[c]),
+            .out_full(core_out_full),
+            .in1_level(c_in1_level[c]),
+            .in2_level(c_in2_level[c]),
+            .out_level(c_out_level[c]),
+            .af_level(af_level),
+            .ae_level(ae_level),
+            .almost_full(c_almost_full[c]),
+            .almost_empty(c_almost_empty[c]),
+
+            .op_code(core_op_code),
+            .num_bands(core_num_bands),
+            .band_first(core_band_first),
+            .band_count(core_band_count),
+            .stream_mode(core_stream_mode),
+            .band_serial(core_band_serial),
+            .ref_mode(core_ref_mode),
+            .post_mode(core_post_mode),
+            .threshold(core_threshold),
+            .prec(core_prec),
+            .out_scale(core_out_scale),
+            .more_input(core_more_input),
+            .start(core_start && core_mask[c]),
+            .pixel_done(core_pixel_done),
+            .pixel_valid(core_pixel_valid),
+            .fsm_state(core_fsm_state),
+            .stall_in(core_stall_in),
+            .stall_out(core_stall_out),
+            .error_code(core_error_code)
+        );
+
+        if (DUAL_CLOCK) begin : g_cdc
+            // Estado del núcleo hacia el wrapper (muestreo continuo)
+            logic c_start_tgl;
+
+            hsi_cdc_bus #(.WIDTH(4 + 1 + 4 + 2 + 1)) i_cdc_status (
+                .src_clk(core_clk), .src_rst_n(core_rst_n),
+                .src_valid(1'b1),
+                .src_data({core_error_code, core_pixel_done, core_fsm_state, core_stall_in, core_stall_out,
+                           core_start_tgl}),
+                /* verilator lint_off PINCONNECTEMPTY */
+                .src_ready(),
+                .dst_valid(),
+                /* verilator lint_on PINCONNECTEMPTY */
+                .dst_clk(clk_i), .dst_rst_n(rst_ni),
+                .dst_data({c_error_code[c], c_pixel_done[c], c_state[c], c_stall_in[c], c_stall_out[c],
+                           c_start_tgl})
+            );
+
+            assign c_err_fresh[c] = (c_start_tgl == start_tgl);
+
+            hsi_cdc_sync #(.WIDTH(1)) i_sync_out_full (
+                .clk(clk_i), .rst_n(rst_ni), .d(core_out_full), .q(c_out_full[c])
+            );
+
+            // Resultados: contador Gray en el dominio del núcleo y un pulso por incremento en el del bus.
+            // El retraso acumulado está acotado por la FIFO de salida, que se lee desde clk_i.
+            localparam int VCNT_W = $clog2(FIFO_DEPTH) + 3;
+            logic [VCNT_W-1:0] valid_cnt, valid_gray, valid_gray_s, valid_bin_s, valid_seen;
+
+            always_ff @(posedge core_clk or negedge core_rst_n) begin
+                if (!core_rst_n) begin
+                    valid_cnt  <= '0;
+                    valid_gray <= '0;
+                end else if (core_pixel_valid) begin
+                    valid_cnt  <= valid_cnt + 1'b1;
+                    valid_gray <= (valid_cnt + 1'b1) ^ ((valid_cnt + 1'b1) >> 1);
+                end
+            end
+
+            hsi_cdc_sync #(.WIDTH(VCNT_W)) i_sync_valid_cnt (
+                .clk(clk_i), .rst_n(rst_ni), .d(valid_gray), .q(valid_gray_s)
+            );
+
+            always_comb begin
+                valid_bin_s[VCNT_W-1] = valid_gray_s[VCNT_W-1];
+                for (int i = VCNT_W - 2; i >= 0; i--) valid_bin_s[i] = valid_bin_s[i+1] ^ valid_gray_s[i];
+            end
+
+            assign c_pixel_valid[c] = (valid_seen != valid_bin_s);
+
+            always_ff @(posedge clk_i or negedge rst_ni) begin
+                if (!rst_ni)               valid_seen <= '0;
+                else if (c_pixel_valid[c]) valid_seen <= valid_seen + 1'b1;
+            end
+        end else begin : g_direct
+            assign c_pixel_done[c]  = core_pixel_done;
+            assign c_pixel_valid[c] = core_pixel_valid;
+            assign c_error_code[c]  = core_error_code;
+            assign c_err_fresh[c]   = 1'b1;
+            assign c_state[c]       = core_fsm_state;
+            assign c_stall_in[c]    = core_stall_in;
+            assign c_stall_out[c]   = core_stall_out;
+            assign c_out_full[c]    = core_out_full;
+        end
+
+        assign c_busy[c] = (c_state[c] != 4'd0);
+    end
+
+    // ============================================================================
+    // Distribuidor de píxeles y reordenación de resultados
+    // ============================================================================
+    // Píxeles completos de cada FIFO de entrada al núcleo in*_sel en turno circular; la salida se
+    // lee en el mismo orden desde out_sel, por lo que los resultados salen en orden de píxel.
+    localparam int SEL_W = (NUM_CORES > 1) ? $clog2(NUM_CORES) : 1;
+
+    logic [SEL_W-1:0] in1_sel, in2_sel, out_sel, out_last;
+    logic [31:0]      in1_band, in2_band;
+    logic             in1_push, in2_push, out_pop;
+    logic             dist_restart;
+    logic             ref_bcast;
+    logic [31:0]      beat_max, win_lo, win_hi, pix_bands;
+
+    function automatic logic [SEL_W-1:0] next_core(input logic [SEL_W-1:0] c);
+        return (c == SEL_W'(NUM_CORES - 1)) ? '0 : c + 1'b1;
+    endfunction
+
+    // OP_REF_LOAD copia cada palabra de la FIFO 2 en todos los núcleos
+    assign ref_bcast = (op_code == 4'd4);
+
+    assign in1_push = core_in1_wr_en && !c_in1_full[in1_sel];
+    assign in2_push = core_in2_wr_en && (ref_bcast ? !(|c_in2_full) : !c_in2_full[in2_sel]);
+    assign out_pop  = core_out_rd_en && !c_out_empty[out_sel];
+
+    always_comb begin
+        for (int c = 0; c < NUM_CORES; c++) begin
+            c_in1_wr_en[c] = core_in1_wr_en && (in1_sel == SEL_W'(c));
+            c_in2_wr_en[c] = ref_bcast ? in2_push : core_in2_wr_en && (in2_sel == SEL_W'(c));
+            c_out_rd_en[c] = core_out_rd_en && (out_sel == SEL_W'(c));
+        end
+    end
+
+    // Cada píxel ocupa ceil(NUM_BANDS / (COMPONENTS_MAX*2^PREC)) beats en BAND_SERIAL y uno en otro caso;
+    // con BAND_WINDOW solo llegan los beats desde el que contiene la primera banda de la ventana
+    assign beat_max  = 32'(COMPONENTS_MAX) << prec;
+    assign win_lo    = (band_count == 16'd0) ? 32'd0 : 32'(band_first);
+    assign win_hi    = (band_count == 16'd0) ? num_bands : 32'(band_first) + 32'(band_count);
+    assign pix_bands = win_hi - ((((win_lo >> prec) / 32'(COMPONENTS_MAX)) * 32'(COMPONENTS_MAX)) << prec);
+
+    always_ff @(posedge clk_i or negedge rst_ni) begin
+        if (!rst_ni) begin
+            in1_sel  <= '0;
+            in2_sel  <= '0;
+            out_sel  <= '0;
+            out_last <= '0;
+            in1_band <= '0;
+            in2_band <= '0;
+        end else if (dist_restart) begin
+            in1_sel  <= '0;
+            in2_sel  <= '0;
+            out_sel  <= '0;
+            out_last <= '0;
+            in1_band <= '0;
+            in2_band <= '0;
+        end else begin
+            if (in1_push) begin
+                if (!band_serial || in1_band + beat_max >= pix_bands) begin
+                    in1_band <= '0;
+                    in1_sel  <= next_core(in1_sel);
+                end else begin
+                    in1_band <= in1_band + beat_max;
+                end
+            end
+            if (in2_push && !ref_bcast) begin
+                if (!band_serial || in2_band + beat_max >= pix_bands) begin
+                    in2_band <= '0;
+                    in2_sel  <= next_core(in2_sel);
+                end else begin
+                    in2_band <= in2_band + beat_max;
+                end
+            end
+            if (out_pop) begin
+                out_sel  <= next_core(out_sel);
+                out_last <= out_sel;
+            end
+        end
+    end
+
+    // START solo a los núcleos con datos, salvo que un productor vaya a seguir escribiendo
+    logic [NUM_CORES-1:0] has_data;
+
+    always_comb begin
+        for (int c = 0; c < NUM_CORES; c++) has_data[c] = (c_in1_level[c] != 0) || (c_in2_level[c] != 0);
+    end
+
+    assign start_mask = (dma_in_pending || job_active || has_data == '0) ? '1 : has_data;
+
+    // Sin núcleos activos ni píxeles en las FIFOs no hay nada en vuelo: el START reinicia el turno
+    assign dist_restart = start && start_ready && c_busy == '0 && has_data == '0 && &c_out_empty;
+
+    // Estado agregado hacia el wrapper y el DMA: FIFOs del núcleo en turno
+    assign in1_full     = c_in1_full[in1_sel];
+    assign in2_full     = ref_bcast ? |c_in2_full : c_in2_full[in2_sel];
+    assign out_full     = |c_out_full;
+    assign out_empty_o  = c_out_empty[out_sel];
+    assign out_data_o   = c_out_data[out_last];
+    assign in1_level    = c_in1_level[in1_sel];
+    assign in2_level    = c_in2_level[in2_sel];
+    assign out_level    = c_out_level[out_sel];
+    assign almost_full  = {c_almost_full[out_sel][2],  c_almost_full[in2_sel][1],  c_almost_full[in1_sel][0]};
+    assign almost_empty = {c_almost_empty[out_sel][2], c_almost_empty[in2_sel][1], c_almost_empty[in1_sel][0]};
+
+    // Núcleos del último START: los demás conservan el código de error de un trabajo anterior
+    logic [NUM_CORES-1:0] err_mask;
+
+    always_ff @(posedge clk_i or negedge rst_ni) begin
+        if (!rst_ni)                   err_mask <= '1;
+        else if (start && start_ready) err_mask <= start_mask;
+    end
+
+    // Un núcleo del START ha terminado al dar pixel_done o al volver a IDLE sin resultados ni error
+    // (p. ej. sin píxeles de un DMA con PIXEL_COUNT = 0). pixel_done cae al leer sus resultados, así
+    // que se recuerda hasta el siguiente START
+    logic [NUM_CORES-1:0] c_done, done_seen, done_now;
+
+    always_comb begin
+        for (int c = 0; c < NUM_CORES; c++) begin
+            c_done[c] = c_err_fresh[c] && (c_pixel_done[c] || (!c_busy[c] && c_error_code[c] == 0));
+        end
+    end
+
+    assign done_now = done_seen | c_done;
+
+    always_ff @(posedge clk_i or negedge rst_ni) begin
+        if (!rst_ni)                   done_seen <= '0;
+        else if (start && start_ready) done_seen <= '0;
+        else                           done_seen <= done_now;
+    end
+
+    // DONE con todos los núcleos del último START y el error del primero de ellos que lo tenga. Para
+    // PERF_*: bloqueos de cualquier núcleo y estado del primer núcleo fuera de IDLE
+    assign pixel_done = &(done_now | ~err_mask);
+    assign stall_in   = |c_stall_in;
+    assign stall_out  = |c_stall_out;
+
+    always_comb begin
+        core_state = '0;
+        for (int c = NUM_CORES - 1; c >= 0; c--) begin
+            if (c_busy[c]) core_state = c_state[c];
+        end
+    end
+
+    always_comb begin
+        error_code = '0;
+        for (int c = NUM_CORES - 1; c >= 0; c--) begin
+            if (err_mask[c] && c_err_fresh[c] && c_error_code[c] != 0) error_code = c_error_code[c];
+        end
+    end
+
+    if (NUM_CORES > 1) begin : g_valid_merge
+        // Varios núcleos pueden terminar en el mismo ciclo: los pulsos se acumulan y se entregan
+        // al wrapper de uno en uno. En OP_REF_LOAD todos cargan las mismas referencias y solo
+        // cuenta el núcleo 0.
+        localparam int PEND_W = $clog2(NUM_CORES * FIFO_DEPTH) + 2;
+        logic [PEND_W-1:0] valid_pend, valid_add;
+
+        always_comb begin
+            valid_add = '0;
+            if (ref_bcast) valid_add = PEND_W'(c_pixel_valid[0]);
+            else for (int c = 0; c < NUM_CORES; c++) valid_add = valid_add + PEND_W'(c_pixel_valid[c]);
+        end
+
+        assign pixel_valid = (valid_pend != 0);
+
+        always_ff @(posedge clk_i or negedge rst_ni) begin
+            if (!rst_ni) valid_pend <= '0;
+            else         valid_pend <= valid_pend + valid_add - PEND_W'(pixel_valid);
+        end
+    end else begin : g_valid_direct
+        assign pixel_valid = c_pixel_valid[0];
+    end
 
 endmodule
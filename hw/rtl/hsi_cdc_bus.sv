@@ -0,0 +1,110 @@
+/**
+ * @file hsi_cdc_bus.sv
+ * @brief Cruce de un bus multibit entre dominios de reloj mediante handshake de cambio de nivel.
+ *
+ * @details
+ * El dato se retiene en un registro del dominio de origen y solo se señaliza su disponibilidad con
+ * un bit de petición que cambia de nivel (toggle). El destino sincroniza la petición, copia el bus
+ * (estable desde varios ciclos antes) y devuelve el reconocimiento, también sincronizado. Así el
+ * bus llega coherente aunque sus bits no sean código Gray.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+/**
+ * @class hsi_cdc_bus
+ * @brief Transferencia de palabras de `WIDTH` bits de `src_clk` a `dst_clk`.
+ *
+ * @details
+ * Una palabra se acepta con `src_valid && src_ready` y aparece en `dst_data` junto con un pulso de
+ * `dst_valid`; `dst_data` conserva la última palabra recibida. Cada transferencia ocupa unos
+ * `2*STAGES + 2` ciclos del reloj más lento; con `src_ready = 0` el origen debe mantener `src_valid`
+ * y `src_data` hasta que se acepten, o la palabra no se transfiere.
+ * Con `src_valid = 1` permanente el módulo muestrea continuamente una señal de estado.
+ *
+ * @param WIDTH  Ancho del bus (por defecto: 32).
+ * @param STAGES Etapas de sincronización de la petición y del reconocimiento (por defecto: 2).
+ *
+ * @section signals Descripción de señales de entrada y salida
+ * | Señal      | Dirección | Descripción                                          |
+ * |------------|-----------|------------------------------------------------------|
+ * | src_clk    | input     | Reloj del dominio de origen.                         |
+ * | src_rst_n  | input     | Reset activo en bajo del dominio de origen.          |
+ * | src_valid  | input     | Palabra disponible en `src_data`.                    |
+ * | src_data   | input     | Palabra a transferir.                                |
+ * | src_ready  | output    | No hay transferencia en curso; se acepta una palabra.|
+ * | dst_clk    | input     | Reloj del dominio de destino.                        |
+ * | dst_rst_n  | input     | Reset activo en bajo del dominio de destino.         |
+ * | dst_valid  | output    | Pulso de un ciclo con cada palabra recibida.         |
+ * | dst_data   | output    | Última palabra recibida.                             |
+ */
+module hsi_cdc_bus #(
+    parameter int WIDTH  = 32,
+    parameter int STAGES = 2
+) (
+    input  logic             src_clk,    ///< Reloj de origen
+    input  logic             src_rst_n,  ///< Reset de origen
+    input  logic             src_valid,  ///< Palabra disponible
+    input  logic [WIDTH-1:0] src_data,   ///< Palabra a transferir
+    output logic             src_ready,  ///< Se acepta una palabra
+
+    input  logic             dst_clk,    ///< Reloj de destino
+    input  logic             dst_rst_n,  ///< Reset de destino
+    output logic             dst_valid,  ///< Pulso de palabra recibida
+    output logic [WIDTH-1:0] dst_data    ///< Última palabra recibida
+);
+
+    /// Registro de retención, petición y reconocimiento (toggle)
+    logic [WIDTH-1:0] hold_q;
+    logic             req_q, req_s;
+    logic             ack_q, ack_s;
+
+    // ------------------------------------------------------------------------
+    // Dominio de origen
+    // ------------------------------------------------------------------------
+    assign src_ready = (req_q == ack_s);
+
+    always_ff @(posedge src_clk or negedge src_rst_n) begin
+        if (!src_rst_n) begin
+            hold_q <= '0;
+            req_q  <= 1'b0;
+        end else if (src_valid && src_ready) begin
+            hold_q <= src_data;
+            req_q  <= ~req_q;
+        end
+    end
+
+    hsi_cdc_sync #(.WIDTH(1), .STAGES(STAGES)) i_sync_ack (
+        .clk(src_clk), .rst_n(src_rst_n), .d(ack_q), .q(ack_s)
+    );
+
+    // ------------------------------------------------------------------------
+    // Dominio de destino: hold_q es estable mientras req_s != ack_q
+    // ------------------------------------------------------------------------
+    hsi_cdc_sync #(.WIDTH(1), .STAGES(STAGES)) i_sync_req (
+        .clk(dst_clk), .rst_n(dst_rst_n), .d(req_q), .q(req_s)
+    );
+
+    always_ff @(posedge dst_clk or negedge dst_rst_n) begin
+        if (!dst_rst_n) begin
+            ack_q     <= 1'b0;
+            dst_valid <= 1'b0;
+            dst_data  <= '0;
+        end else begin
+            dst_valid <= (req_s != ack_q);
+            if (req_s != ack_q) begin
+                dst_data <= hold_q;
+                ack_q    <= req_s;
+            end
+        end
+    end
+
+endmodule
@@ -0,0 +1,61 @@
+/**
+ * @file hsi_cdc_sync.sv
+ * @brief Sincronizador de varias etapas para el cruce de dominios de reloj.
+ *
+ * @details
+ * Cadena de biestables en el dominio de destino que reduce la probabilidad de metaestabilidad de
+ * señales generadas en otro dominio de reloj. Cada bit se sincroniza de forma independiente, por lo
+ * que solo debe usarse con señales de un bit, con niveles quasi-estáticos o con buses en código Gray
+ * (un único bit cambia entre valores consecutivos), como los punteros de `fifo_cache_async`.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+/**
+ * @class hsi_cdc_sync
+ * @brief Sincronizador bit a bit de `STAGES` etapas.
+ *
+ * @param WIDTH  Número de bits sincronizados (por defecto: 1).
+ * @param STAGES Número de etapas de la cadena, al menos 2 (por defecto: 2).
+ *
+ * @section signals Descripción de señales de entrada y salida
+ * | Señal | Dirección | Descripción                                      |
+ * |-------|-----------|--------------------------------------------------|
+ * | clk   | input     | Reloj del dominio de destino.                    |
+ * | rst_n | input     | Reset activo en bajo del dominio de destino.     |
+ * | d     | input     | Señal procedente del dominio de origen.          |
+ * | q     | output    | Señal sincronizada, `STAGES` ciclos de retardo.  |
+ */
+module hsi_cdc_sync #(
+    parameter int WIDTH  = 1,
+    parameter int STAGES = 2
+) (
+    input  logic             clk,    ///< Reloj del dominio de destino
+    input  logic             rst_n,  ///< Reset asíncrono activo en bajo
+    input  logic [WIDTH-1:0] d,      ///< Señal del dominio de origen
+    output logic [WIDTH-1:0] q       ///< Señal sincronizada
+);
+
+    /// Cadena de sincronización (ASYNC_REG agrupa las etapas en FPGA)
+    (* ASYNC_REG = "TRUE" *) logic [WIDTH-1:0] sync_q [0:STAGES-1];
+
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            for (int s = 0; s < STAGES; s++) sync_q[s] <= '0;
+        end else begin
+            sync_q[0] <= d;
+            for (int s = 1; s < STAGES; s++) sync_q[s] <= sync_q[s-1];
+        end
+    end
+
+    assign q = sync_q[STAGES-1];
+
+endmodule
@@ -0,0 +1,439 @@
+/**
+ * @file hsi_dma.sv
+ * @brief Motor DMA con interfaz maestra OBI para alimentar el núcleo vectorial HSI.
+ *
+ * @details
+ * Este módulo lee los vectores de entrada desde memoria a través de un puerto maestro OBI de 32 bits,
+ * los deposita en las FIFOs de entrada del núcleo `hsi_vector_core` y escribe de vuelta en memoria los
+ * resultados que va extrayendo de la FIFO de salida, sin intervención de la CPU.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+/**
+ * @class hsi_dma
+ * @brief Motor DMA OBI para las FIFOs del núcleo vectorial HSI.
+ *
+ * @details
+ * Cada palabra de FIFO (beat) de `DATA_WIDTH` bits ocupa en memoria `ceil(DATA_WIDTH/32)` palabras
+ * de 32 bits consecutivas en little-endian (la palabra 0 contiene los bits [31:0]); la última
+ * palabra se rellena con ceros. Los beats consecutivos de una misma fuente están separados
+ * `src_stride_i` bytes (0 = empaquetados) y los resultados `dst_stride_i` bytes (0 = empaquetados).
+ *
+ * Por cada píxel se lee un beat de SRC1 y otro de SRC2 de forma alterna, de modo que el núcleo puede
+ * empezar a calcular en cuanto llega el primer par. En modo band-serial cada píxel ocupa
+ * `ceil(num_bands/(COMPONENTS_MAX*2^prec_i))` beats por fuente (`prec_i` es el empaquetado de
+ * muestras del núcleo). Con una ventana de bandas (`band_count_i > 0`) en band-serial solo se leen
+ * los beats que solapan `[band_first_i, band_first_i+band_count_i)`: los demás se saltan sin acceso al
+ * bus, avanzando en D_ARB los punteros de las dos fuentes a la vez. En el primer píxel se salta una
+ * posición de beat por ciclo y se miden los huecos anterior y posterior a la ventana; en los siguientes,
+ * el final de la ventana de un píxel y el principio de la del siguiente se unen con un único salto de
+ * un ciclo. Las peticiones de un beat se emiten de forma segmentada (una por ciclo mientras haya
+ * `gnt_i`) y las respuestas se recogen en orden.
+ *
+ * `src1_en_i`/`src2_en_i` permiten leer una sola fuente (al menos una debe estar activa): con
+ * `src2_en_i = 0` solo se alimenta la FIFO 1 (OP_DOT contra el banco de referencias del núcleo) y con
+ * `src1_en_i = 0` solo la FIFO 2 (carga del banco con OP_REF_LOAD). En este último caso el núcleo no
+ * produce resultados y el trabajo termina al entregar los `pixel_count_i` píxeles de SRC2.
+ *
+ * Con `narrow_res_i = 1` cada resultado se escribe solo con las `ceil(NARROW_WIDTH/32)` primeras
+ * palabras de 32 bits del beat (los bits [NARROW_WIDTH-1:0]), que es donde el núcleo deja el índice,
+ * la puntuación o la máscara de su postprocesado; el resto del beat es cero y no se transfiere. En
+ * ese caso `dst_stride_i = 0` empaqueta los resultados cada `4*ceil(NARROW_WIDTH/32)` bytes.
+ *
+ * La escritura de resultados tiene prioridad sobre la lectura para que la FIFO de salida nunca
+ * bloquee al núcleo. Antes de leer un beat se comprueba que la FIFO destino no está llena; como el
+ * DMA es el único productor mientras está activo, el hueco está garantizado al recibir los datos.
+ * El trabajo termina (pulso `done_o`) cuando se han escrito `pixel_count_i` resultados.
+ *
+ * No hay ráfagas de varios beats: D_ARB vuelve a arbitrar tras cada beat leído o escrito y cada salto,
+ * y solo las `ceil(DATA_WIDTH/32)` peticiones de un mismo beat se emiten segmentadas. Cada beat
+ * cuesta así `ceil(DATA_WIDTH/32) + 3` ciclos (D_ARB, D_RD y D_PUSH) con un esclavo que concede en
+ * el mismo ciclo y responde en el siguiente. A cambio, un resultado pendiente se atiende como muy
+ * tarde tras el beat en curso y el hueco en la FIFO se comprueba beat a beat.
+ *
+ * @param DATA_WIDTH Ancho en bits de una palabra de FIFO (por defecto: 48).
+ * @param COMPONENTS_MAX Bandas por beat en modo band-serial (por defecto: 3).
+ * @param NARROW_WIDTH Bits útiles de un resultado con `narrow_res_i = 1` (por defecto: 32).
+ *
+ * @section signals Descripción de señales de entrada y salida
+ * | Señal          | Dirección | Descripción                                                        |
+ * |----------------|-----------|--------------------------------------------------------------------|
+ * | clk_i          | input     | Reloj principal del sistema.                                       |
+ * | rst_ni         | input     | Reset asíncrono activo en bajo.                                    |
+ * | start_i        | input     | Pulso de inicio de la transferencia.                               |
+ * | src1_addr_i    | input     | Dirección en bytes del primer beat de la fuente 1.                 |
+ * | src2_addr_i    | input     | Dirección en bytes del primer beat de la fuente 2.                 |
+ * | dst_addr_i     | input     | Dirección en bytes del primer resultado.                           |
+ * | pixel_count_i  | input     | Número de píxeles a transferir.                                    |
+ * | src_stride_i   | input     | Separación en bytes entre beats de entrada (0 = empaquetados).     |
+ * | dst_stride_i   | input     | Separación en bytes entre resultados (0 = empaquetados).           |
+ * | num_bands_i    | input     | Número de bandas por píxel (para contar beats en band-serial).     |
+ * | band_serial_i  | input     | Modo band-serial activo.                                           |
+ * | prec_i         | input     | log2 de las muestras por componente (bandas por beat).             |
+ * | band_first_i   | input     | Primera banda de la ventana (band-serial).                         |
+ * | band_count_i   | input     | Bandas de la ventana (0 = todas).                                  |
+ * | src1_en_i      | input     | Se lee la fuente 1 (y se escriben resultados).                     |
+ * | src2_en_i      | input     | Se lee la fuente 2.                                                |
+ * | narrow_res_i   | input     | Cada resultado ocupa una palabra de 32 bits (postprocesado).       |
+ * | busy_o         | output    | Transferencia en curso.                                            |
+ * | done_o         | output    | Pulso de fin de transferencia.                                     |
+ * | in_pending_o   | output    | Quedan beats de entrada por entregar a las FIFOs.                  |
+ * | req_o ... rdata_i | -      | Puerto maestro OBI (req/we/be/addr/wdata, gnt/rvalid/rdata).       |
+ * | in1_wr_en_o    | output    | Escritura en la FIFO de entrada 1.                                 |
+ * | in2_wr_en_o    | output    | Escritura en la FIFO de entrada 2.                                 |
+ * | in_data_o      | output    | Beat a escribir en la FIFO de entrada seleccionada.                |
+ * | in1_full_i     | input     | FIFO de entrada 1 llena.                                           |
+ * | in2_full_i     | input     | FIFO de entrada 2 llena.                                           |
+ * | out_rd_en_o    | output    | Lectura de la FIFO de salida.                                      |
+ * | out_empty_i    | input     | FIFO de salida vacía.                                              |
+ * | out_data_i     | input     | Resultado leído de la FIFO de salida.                              |
+ *
+ * @section usage Ejemplo de instanciación
+ * @code{.sv}
+ * hsi_dma #(
+ *     .DATA_WIDTH(48),
+ *     .COMPONENTS_MAX(3)
+ * ) i_dma (
+ *     .clk_i(clk_i), .rst_ni(rst_ni),
+ *     .start_i(dma_start), .src1_addr_i(src1), .src2_addr_i(src2), .dst_addr_i(dst),
+ *     .pixel_count_i(count), .src_stride_i(16'd0), .dst_stride_i(16'd0),
+ *     .num_bands_i(num_bands), .band_serial_i(band_serial), .prec_i(2'd0),
+ *     .band_first_i(16'd0), .band_count_i(16'd0),
+ *     .src1_en_i(1'b1), .src2_en_i(1'b1), .narrow_res_i(1'b0),
+ *     .busy_o(dma_busy), .done_o(dma_done), .in_pending_o(dma_in_pending),
+ *     .req_o(m_req), .we_o(m_we), .be_o(m_be), .addr_o(m_addr), .wdata_o(m_wdata),
+ *     .gnt_i(m_gnt), .rvalid_i(m_rvalid), .rdata_i(m_rdata),
+ *     .in1_wr_en_o(in1_wr), .in2_wr_en_o(in2_wr), .in_data_o(in_data),
+ *     .in1_full_i(in1_full), .in2_full_i(in2_full),
+ *     .out_rd_en_o(out_rd), .out_empty_i(out_empty), .out_data_i(out_data)
+ * );
+ * @endcode
+ */
+module hsi_dma #(
+    parameter int DATA_WIDTH     = 48,
+    parameter int COMPONENTS_MAX = 3,
+    parameter int NARROW_WIDTH   = 32
+)(
+    input  logic                    clk_i,
+    input  logic                    rst_ni,
+
+    // Configuración (desde el wrapper)
+    input  logic                    start_i,
+    input  logic [31:0]             src1_addr_i,
+    input  logic [31:0]             src2_addr_i,
+    input  logic [31:0]             dst_addr_i,
+    input  logic [31:0]             pixel_count_i,
+    input  logic [15:0]             src_stride_i,
+    input  logic [15:0]             dst_stride_i,
+    input  logic [31:0]             num_bands_i,
+    input  logic                    band_serial_i,
+    input  logic [1:0]              prec_i,
+    input  logic [15:0]             band_first_i,
+    input  logic [15:0]             band_count_i,
+    input  logic                    src1_en_i,
+    input  logic                    src2_en_i,
+    input  logic                    narrow_res_i,
+
+    // Estado
+    output logic                    busy_o,
+    output logic                    done_o,
+    output logic                    in_pending_o,
+
+    // Puerto maestro OBI
+    output logic                    req_o,
+    output logic                    we_o,
+    output logic [3:0]              be_o,
+    output logic [31:0]             addr_o,
+    output logic [31:0]             wdata_o,
+    input  logic                    gnt_i,
+    input  logic                    rvalid_i,
+    input  logic [31:0]             rdata_i,
+
+    // FIFOs del núcleo
+    output logic                    in1_wr_en_o,
+    output logic                    in2_wr_en_o,
+    output logic [DATA_WIDTH-1:0]   in_data_o,
+    input  logic                    in1_full_i,
+    input  logic                    in2_full_i,
+    output logic                    out_rd_en_o,
+    input  logic                    out_empty_i,
+    input  logic [DATA_WIDTH-1:0]   out_data_i
+);
+
+    /// Palabras de 32 bits por beat
+    localparam int WPB = (DATA_WIDTH + 31) / 32;
+    /// Palabras de 32 bits por resultado con `narrow_res_i` (como mucho un beat)
+    localparam int NPW = ((NARROW_WIDTH < DATA_WIDTH ? NARROW_WIDTH : DATA_WIDTH) + 31) / 32;
+
+    /**
+     * @class dma_state_t
+     * @brief Estados de la FSM del DMA
+     *
+     * - D_IDLE: Sin transferencia en curso.
+     * - D_ARB: Decide entre escribir un resultado, leer un beat o terminar; salta los beats fuera de la
+     *   ventana de bandas sin leerlos.
+     * - D_RD: Emite las lecturas OBI del beat y recoge sus respuestas.
+     * - D_PUSH: Escribe el beat recibido en la FIFO de entrada correspondiente.
+     * - D_POP: Extrae un resultado de la FIFO de salida.
+     * - D_LATCH: Captura el resultado extraído.
+     * - D_WR: Emite las escrituras OBI del resultado y espera sus respuestas.
+     *
+     * @dot
+     * digraph DMA {
+     *   rankdir=LR;
+     *   node [shape=ellipse, style=filled, fillcolor=lightgray];
+     *   D_IDLE -> D_ARB    [label="start_i && pixel_count_i != 0"];
+     *   D_ARB -> D_POP     [label="wr_left != 0 && !out_empty_i"];
+     *   D_ARB -> D_ARB     [label="rd_left != 0 && rd_skip"];
+     *   D_ARB -> D_RD      [label="rd_left != 0 && !fifo_full"];
+     *   D_ARB -> D_IDLE    [label="rd_left == 0 && wr_left == 0"];
+     *   D_RD -> D_PUSH     [label="última respuesta"];
+     *   D_PUSH -> D_ARB;
+     *   D_POP -> D_LATCH;
+     *   D_LATCH -> D_WR;
+     *   D_WR -> D_ARB      [label="última respuesta"];
+     * }
+     * @enddot
+     */
+    typedef enum logic [2:0] {
+        D_IDLE  = 3'd0,
+        D_ARB   = 3'd1,
+        D_RD    = 3'd2,
+        D_PUSH  = 3'd3,
+        D_POP   = 3'd4,
+        D_LATCH = 3'd5,
+        D_WR    = 3'd6
+    } dma_state_t;
+
+    dma_state_t state_q;
+
+    /**
+     * @var src1_ptr, src2_ptr, dst_ptr, rd_left, wr_left, rd_band, rd_sel, req_cnt, rsp_cnt, rbuf, wbuf, narrow_q
+     * @brief Registros internos del DMA
+     *
+     * - `src1_ptr`, `src2_ptr`, `dst_ptr`: Dirección del siguiente beat / resultado.
+     * - `rd_left`, `wr_left`: Píxeles pendientes de leer y de escribir.
+     * - `rd_band`: Primera banda del beat que se está leyendo (band-serial).
+     * - `rd_sel`: Fuente del beat en curso (0 = SRC1, 1 = SRC2).
+     * - `req_cnt`, `rsp_cnt`: Peticiones concedidas y respuestas recibidas del beat en curso.
+     * - `rbuf`, `wbuf`: Beat en montaje (lectura) y resultado a escribir.
+     * - `narrow_q`: Copia de `narrow_res_i` tomada con `start_i`.
+     */
+    logic [31:0]         src1_ptr, src2_ptr, dst_ptr;
+    logic [31:0]         rd_left, wr_left;
+    logic [31:0]         rd_band;
+    logic                rd_sel;
+    logic [31:0]         req_cnt, rsp_cnt;
+    /* verilator lint_off UNUSEDSIGNAL */
+    logic [WPB*32-1:0]   rbuf;
+    /* verilator lint_on UNUSEDSIGNAL */
+    logic [WPB*32-1:0]   wbuf;
+    logic                narrow_q;
+
+    /// Palabras de 32 bits por resultado y por beat en curso
+    logic [31:0]         wr_words, xfer_words;
+    assign wr_words   = narrow_q ? NPW : WPB;
+    assign xfer_words = (state_q == D_WR) ? wr_words : WPB;
+
+    logic [31:0]         src_step, dst_step;
+    assign src_step = (src_stride_i == 16'd0) ? WPB*4 : {16'h0, src_stride_i};
+    assign dst_step = (dst_stride_i == 16'd0) ? wr_words << 2 : {16'h0, dst_stride_i};
+
+    /// Bandas de un beat completo
+    logic [31:0] beat_max;
+    assign beat_max = 32'(COMPONENTS_MAX) << prec_i;
+
+    logic rd_fifo_full;
+    assign rd_fifo_full = rd_sel ? in2_full_i : in1_full_i;
+
+    /// El beat `[rd_band, rd_band+beat_max)` no solapa la ventana de bandas y no se lee
+    logic        rd_skip;
+    logic [31:0] win_lo, win_hi;
+    assign win_lo  = 32'(band_first_i);
+    assign win_hi  = 32'(band_first_i) + 32'(band_count_i);
+    assign rd_skip = band_serial_i && (band_count_i != 16'd0) && (rd_band + beat_max <= win_lo || rd_band >= win_hi);
+
+    /**
+     * @var skip_known, lead_off, tail_off, lead_band
+     * @brief Huecos de la ventana de bandas, medidos en el primer píxel del trabajo
+     *
+     * - `skip_known`: El primer píxel ha terminado y los huecos ya se conocen.
+     * - `lead_off`, `tail_off`: Bytes que se saltan en cada fuente antes y después de la ventana.
+     * - `lead_band`: Primera banda del primer beat tras el hueco anterior a la ventana.
+     */
+    logic        skip_known;
+    logic [31:0] lead_off, tail_off, lead_band;
+
+    /// Salto en curso: bytes por fuente, banda siguiente y fin de píxel
+    logic [31:0] skip_off, skip_band;
+    logic        skip_end;
+
+    always_comb begin
+        if (!skip_known) begin
+            // Primer píxel: una posición de beat por ciclo
+            skip_off  = src_step;
+            skip_end  = rd_band + beat_max >= num_bands_i;
+            skip_band = skip_end ? '0 : rd_band + beat_max;
+        end else if (rd_band < win_lo) begin
+            // Hueco inicial de un píxel cuya ventana anterior llegaba al último beat
+            skip_off  = lead_off;
+            skip_end  = lead_band >= num_bands_i;
+            skip_band = skip_end ? '0 : lead_band;
+        end else begin
+            // Hueco final de este píxel e inicial del siguiente en un solo salto
+            skip_off  = tail_off + lead_off;
+            skip_end  = 1'b1;
+            skip_band = lead_band;
+        end
+    end
+
+    // Puerto maestro OBI
+    assign req_o   = ((state_q == D_RD) || (state_q == D_WR)) && (req_cnt < xfer_words);
+    assign we_o    = (state_q == D_WR);
+    assign be_o    = 4'hF;
+    assign addr_o  = ((state_q == D_WR) ? dst_ptr : (rd_sel ? src2_ptr : src1_ptr)) + (req_cnt << 2);
+    assign wdata_o = wbuf[req_cnt*32 +: 32];
+
+    // FIFOs del núcleo
+    assign in1_wr_en_o = (state_q == D_PUSH) && !rd_sel;
+    assign in2_wr_en_o = (state_q == D_PUSH) &&  rd_sel;
+    assign in_data_o   = rbuf[DATA_WIDTH-1:0];
+    assign out_rd_en_o = (state_q == D_POP);
+
+    // Estado
+    assign busy_o       = (state_q != D_IDLE);
+    // Activa ya en el ciclo de start_i para que un START simultáneo del núcleo no vea las FIFOs vacías
+    assign in_pending_o = (state_q == D_IDLE) ? (start_i && pixel_count_i != 0) : (rd_left != 0);
+
+    always_ff @(posedge clk_i or negedge rst_ni) begin
+        if (!rst_ni) begin
+            state_q  <= D_IDLE;
+            done_o   <= 1'b0;
+            src1_ptr <= '0;
+            src2_ptr <= '0;
+            dst_ptr  <= '0;
+            rd_left  <= '0;
+            wr_left  <= '0;
+            rd_band  <= '0;
+            rd_sel   <= 1'b0;
+            req_cnt  <= '0;
+            rsp_cnt  <= '0;
+            rbuf     <= '0;
+            wbuf     <= '0;
+            narrow_q <= 1'b0;
+            skip_known <= 1'b0;
+            lead_off   <= '0;
+            tail_off   <= '0;
+            lead_band  <= '0;
+        end else begin
+            done_o <= 1'b0;
+
+            case (state_q)
+                D_IDLE: begin
+                    if (start_i) begin
+                        src1_ptr <= src1_addr_i;
+                        src2_ptr <= src2_addr_i;
+                        dst_ptr  <= dst_addr_i;
+                        rd_left  <= pixel_count_i;
+                        wr_left  <= src1_en_i ? pixel_count_i : '0;
+                        rd_band  <= '0;
+                        rd_sel   <= !src1_en_i;
+                        narrow_q <= narrow_res_i;
+                        skip_known <= 1'b0;
+                        lead_off   <= '0;
+                        tail_off   <= '0;
+                        lead_band  <= '0;
+                        if (pixel_count_i == 0) done_o  <= 1'b1;
+                        else                    state_q <= D_ARB;
+                    end
+                end
+                D_ARB: begin
+                    req_cnt <= '0;
+                    rsp_cnt <= '0;
+                    if (wr_left != 0 && !out_empty_i) begin
+                        state_q <= D_POP;
+                    end else if (rd_left != 0 && rd_skip) begin
+                        // Salto sin acceso al bus; la fuente en curso es la primera del beat
+                        if (src1_en_i) src1_ptr <= src1_ptr + skip_off;
+                        if (src2_en_i) src2_ptr <= src2_ptr + skip_off;
+                        rd_band <= skip_band;
+                        if (!skip_known) begin
+                            if (rd_band < win_lo) begin
+                                lead_off  <= lead_off + src_step;
+                                lead_band <= rd_band + beat_max;
+                            end else begin
+                                tail_off  <= tail_off + src_step;
+                            end
+                        end
+                        if (skip_end) begin
+                            rd_left    <= rd_left - 1;
+                            skip_known <= 1'b1;
+                        end
+                    end else if (rd_left != 0 && !rd_fifo_full) begin
+                        state_q <= D_RD;
+                    end else if (rd_left == 0 && wr_left == 0) begin
+                        state_q <= D_IDLE;
+                        done_o  <= 1'b1;
+                    end
+                end
+                D_RD: begin
+                    if (req_o && gnt_i) req_cnt <= req_cnt + 1;
+                    if (rvalid_i) begin
+                        rbuf[rsp_cnt*32 +: 32] <= rdata_i;
+                        rsp_cnt <= rsp_cnt + 1;
+                        if (rsp_cnt == WPB-1) state_q <= D_PUSH;
+                    end
+                end
+                D_PUSH: begin
+                    // El beat se escribe en la FIFO en este ciclo; avanzar a la siguiente fuente
+                    if (!rd_sel) src1_ptr <= src1_ptr + src_step;
+                    else         src2_ptr <= src2_ptr + src_step;
+                    if (!rd_sel && src2_en_i) begin
+                        rd_sel   <= 1'b1;
+                    end else begin
+                        // Último beat de la banda actual (par SRC1/SRC2 o fuente única)
+                        rd_sel   <= !src1_en_i;
+                        if (!band_serial_i || rd_band + beat_max >= num_bands_i) begin
+                            rd_band    <= '0;
+                            rd_left    <= rd_left - 1;
+                            skip_known <= 1'b1;
+                        end else begin
+                            rd_band <= rd_band + beat_max;
+                        end
+                    end
+                    state_q <= D_ARB;
+                end
+                D_POP: begin
+                    state_q <= D_LATCH;
+                end
+                D_LATCH: begin
+                    wbuf <= '0;
+                    wbuf[DATA_WIDTH-1:0] <= out_data_i;
+                    state_q <= D_WR;
+                end
+                D_WR: begin
+                    if (req_o && gnt_i) req_cnt <= req_cnt + 1;
+                    if (rvalid_i) begin
+                        rsp_cnt <= rsp_cnt + 1;
+                        if (rsp_cnt == wr_words - 1) begin
+                            dst_ptr <= dst_ptr + dst_step;
+                            wr_left <= wr_left - 1;
+                            state_q <= D_ARB;
+                        end
+                    end
+                end
+                default: state_q <= D_IDLE;
+            endcase
+        end
+    end
+
+endmodule
@@ -0,0 +1,66 @@
+/**
+ * @file hsi_sram_2p.sv
+ * @brief Envoltorio de memoria SRAM de dos puertos (1 escritura, 1 lectura) para `fifo_cache`.
+ *
+ * @details
+ * Punto de enganche para la macro SRAM de la tecnología ASIC. Este fichero contiene un modelo
+ * de comportamiento con lectura síncrona (un ciclo de latencia) que sirve para simulación y FPGA;
+ * en un flujo ASIC se sustituye el cuerpo del módulo por la instancia de la macro generada por el
+ * compilador de memorias, manteniendo los puertos.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+/**
+ * @class hsi_sram_2p
+ * @brief SRAM síncrona de dos puertos con lectura registrada.
+ *
+ * @details
+ * Un puerto de escritura y uno de lectura independientes con el mismo reloj. La lectura de una
+ * dirección que se escribe en el mismo ciclo devuelve el dato anterior (read-first); `fifo_cache`
+ * resuelve ese caso con su propio bypass. `rdata` conserva su valor mientras `re` está inactivo.
+ *
+ * @param WIDTH Ancho de palabra en bits (por defecto: 48).
+ * @param DEPTH Número de palabras, potencia de dos (por defecto: 512).
+ *
+ * @section signals Descripción de señales de entrada y salida
+ * | Señal    | Dirección | Descripción                                   |
+ * |----------|-----------|-----------------------------------------------|
+ * | clk      | input     | Reloj de ambos puertos.                       |
+ * | we       | input     | Habilitación de escritura.                    |
+ * | waddr    | input     | Dirección de escritura.                       |
+ * | wdata    | input     | Dato a escribir.                              |
+ * | re       | input     | Habilitación de lectura.                      |
+ * | raddr    | input     | Dirección de lectura.                         |
+ * | rdata    | output    | Dato leído, disponible el ciclo siguiente a `re`. |
+ */
+module hsi_sram_2p #(
+    parameter int WIDTH = 48,
+    parameter int DEPTH = 512
+) (
+    input  logic                     clk,    ///< Reloj
+    input  logic                     we,     ///< Habilitación de escritura
+    input  logic [$clog2(DEPTH)-1:0] waddr,  ///< Dirección de escritura
+    input  logic [WIDTH-1:0]         wdata,  ///< Dato de escritura
+    input  logic                     re,     ///< Habilitación de lectura
+    input  logic [$clog2(DEPTH)-1:0] raddr,  ///< Dirección de lectura
+    output logic [WIDTH-1:0]         rdata   ///< Dato leído (registrado)
+);
+
+    /// Modelo de comportamiento de la matriz de la macro
+    logic [WIDTH-1:0] mem [0:DEPTH-1];
+
+    always_ff @(posedge clk) begin
+        if (we) mem[waddr] <= wdata;
+        if (re) rdata <= mem[raddr];
+    end
+
+endmodule
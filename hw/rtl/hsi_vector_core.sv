@@ -33,12 +33,167 @@
  * @param COMPONENT_WIDTH Ancho de cada componente H/S/I (por defecto: 16 bits).
  * @param FIFO_DEPTH Profundidad de las FIFOs internas (potencia de 2, por defecto: 16).
  * @param COMPONENTS_MAX Máximo número de bandas/componentes HSI (por defecto: 3).
+ * @param DOT_LANES Número de carriles MAC en paralelo para OP_DOT, potencia de 2 (por defecto: 4).
+ * @param FWFT Las FIFOs de entrada funcionan en modo first-word-fall-through (por defecto: 1).
+ * @param FIFO_STORAGE Almacenamiento de las tres FIFOs: "FLOPS", "BRAM" o "SRAM" (ver `fifo_cache`,
+ *        por defecto: "FLOPS"). Con FIFO_DEPTH de cientos o miles de píxeles conviene "BRAM"/"SRAM".
+ * @param SAM_EN Incluye los multiplicadores de cuadrados y los acumuladores de OP_SAM (por defecto: 1).
+ * @param DUAL_CLOCK Las interfaces de las FIFOs funcionan con `bus_clk` y el cálculo con `clk`
+ *        (por defecto: 0). Ver la sección de doble reloj.
+ * @param REF_NUM Número de vectores de referencia del banco persistente, como mucho COMPONENTS_MAX
+ *        (se comprueba al elaborar); 0 lo elimina (por defecto: 3). Ver la sección de referencias.
+ * @param REF_BEATS Beats almacenados por referencia; limita `num_bands` a `REF_BEATS*COMPONENTS_MAX`
+ *        (por `2^prec` con muestras empaquetadas; con ventana de bandas cuentan solo los beats
+ *        entregados) en los modos con referencias (por defecto: 1).
+ * @param SIMD_EN Incluye los multiplicadores de subpalabra de los modos `prec` empaquetados (por defecto: 1).
+ * @param ACC_GUARD Bits de guarda de los acumuladores sobre `2*COMPONENT_WIDTH`; admiten sin
+ *        desbordamiento `2^ACC_GUARD` productos de ancho completo (por defecto: 8). Ver la sección de escalado.
+ *
+ * @section mac Datapath MAC multicarril
+ * El producto escalar se evalúa en bloques de `DOT_LANES` bandas por ciclo. Los productos de cada
+ * bloque se registran y se reducen mediante un árbol de sumadores segmentado de `log2(DOT_LANES)`
+ * etapas, cuya salida se acumula en `result[0]`. Un píxel de N bandas necesita aproximadamente
+ * `N/DOT_LANES + log2(DOT_LANES)` ciclos en COMPUTE. Los multiplicadores del producto vectorial
+ * son los mismos que forman los carriles del producto escalar (se comparten cuando OP_CROSS no
+ * está activo), por lo que con `DOT_LANES <= 4` no se añaden multiplicadores. El árbol solo admite
+ * potencias de 2: cualquier otro valor de `DOT_LANES` detiene la elaboración.
+ *
+ * @section sam Spectral Angle Mapper (OP_SAM)
+ * OP_SAM recorre una sola vez las bandas del píxel y acumula a la vez `a·b`, `|a|²` y `|b|²`, los
+ * tres términos del ángulo espectral `cos θ = a·b / sqrt(|a|²·|b|²)`. Cada carril MAC dispone de
+ * dos multiplicadores adicionales (`a_k²` y `b_k²`) y el árbol de sumadores tiene tres canales,
+ * por lo que la latencia es la de OP_DOT. El resultado ocupa tres componentes de la palabra de
+ * salida: `|a|²` en la componente 2 (la más significativa con 3 componentes), `|b|²` en la 1 y
+ * `a·b` en la 0, igual que OP_DOT. Admite los modos streaming y band-serial, y requiere
+ * `COMPONENTS_MAX >= 3`. Con `SAM_EN = 0` no se instancian los multiplicadores adicionales y OP_SAM
+ * produce ERR_OP.
+ *
+ * @section stream Modo streaming
+ * Con `stream_mode = 1`, un `start` válido lleva la FSM al estado STREAM, en el que las FIFOs de
+ * entrada se leen cada ciclo mientras tengan datos y el resultado se escribe en la FIFO de salida
+ * con control valid/ready (intervalo de iniciación de 1 píxel/ciclo). La salida de datos de las
+ * FIFOs de entrada actúa como primera etapa y `out_data_in`/`out_wr_en` como segunda; si
+ * `out_full` está activo la segunda etapa retiene el resultado y se detienen las lecturas. En este
+ * modo OP_DOT reduce las `num_bands` bandas del píxel en un único ciclo. El trabajo termina, igual
+ * que en modo FSM, cuando las FIFOs de entrada se vacían y el pipeline queda libre.
+ *
+ * @section serial Modo band-serial
+ * Con `band_serial = 1` cada palabra de las FIFOs (beat) transporta hasta `COMPONENTS_MAX` bandas
+ * y un píxel de `num_bands` bandas ocupa `ceil(num_bands/COMPONENTS_MAX)` beats consecutivos, por
+ * lo que `num_bands` puede llegar a 2^32-1 sin ensanchar el datapath. El núcleo lleva la cuenta de
+ * bandas (`beat_base`) y genera internamente la marca de fin de píxel (`last_beat`): la acumulación
+ * de OP_DOT continúa entre beats y el resultado se escribe tras el último. Los beats completos
+ * siguen el formato habitual (banda 0 del beat en la componente más significativa) y el último beat
+ * parcial se alinea a la componente menos significativa, igual que un píxel con
+ * `num_bands < COMPONENTS_MAX`. Solo OP_DOT y OP_SAM admiten este modo; es compatible con `stream_mode`, en
+ * cuyo caso se procesa un beat por ciclo.
+ *
+ * @section window Ventana de bandas
+ * `band_count > 0` restringe el cálculo a las bandas `band_first .. band_first+band_count-1` del
+ * píxel de `num_bands` bandas (p. ej. para descartar las bandas de absorción del agua en los
+ * extremos); `band_count = 0` usa todas. Las bandas fuera de la ventana se anulan al desempaquetar
+ * el beat y la FSM emite hacia los carriles solo las componentes que contienen bandas de la ventana.
+ * En band-serial el productor entrega únicamente los beats que solapan la ventana, desde el que
+ * contiene `band_first` hasta el que contiene la última banda, de modo que `beat_base` empieza en
+ * `win_base` (el inicio de ese primer beat) y el píxel termina con el beat que alcanza el final de la
+ * ventana; el DMA ya no lee los demás. La ventana se aplica a OP_DOT, OP_SAM y a la carga del banco
+ * de referencias, que debe hacerse con la misma ventana con que se usa. Una ventana que exceda
+ * `num_bands` o se combine con OP_CROSS produce ERR_OP.
+ *
+ * @section ref Banco de referencias (filtrado adaptado)
+ * El núcleo guarda hasta `REF_NUM` vectores de referencia (firmas espectrales) en un banco de
+ * registros que se conserva entre trabajos. OP_REF_LOAD (`op_code = 4`) los carga desde la FIFO de
+ * entrada 2: con `num_bands` bandas por referencia extrae `REF_NUM` píxeles (en band-serial,
+ * `ceil(num_bands/COMPONENTS_MAX)` beats cada uno) sin escribir resultados; la FIFO 1 no se usa.
+ * Cada referencia almacenada genera un pulso de `pixel_valid`, y al completar el banco
+ * `pixel_done` permanece activo hasta el siguiente `start`. Si la FIFO 2 se vacía antes y
+ * `more_input = 0` la carga se abandona y el banco queda parcialmente actualizado.
+ *
+ * Con `ref_mode = 1`, OP_DOT toma el segundo operando del banco en lugar de la FIFO 2, que no se
+ * lee: cada píxel de la FIFO 1 produce `REF_NUM` productos escalares, el de la referencia k en la
+ * componente k de la palabra de salida (la referencia 0 en la menos significativa, igual que OP_DOT).
+ * Los carriles MAC recorren el beat una vez por referencia, por lo que el cálculo dura `REF_NUM`
+ * veces el de OP_DOT sin añadir multiplicadores. Este modo usa siempre la FSM por píxel (se ignora
+ * `stream_mode`), admite band-serial y solo se aplica a OP_DOT; con otra operación produce ERR_OP.
+ *
+ * @section simd Muestras empaquetadas (prec)
+ * Con `prec = 1` cada componente de `COMPONENT_WIDTH` bits transporta 2 muestras de
+ * `COMPONENT_WIDTH/2` bits, y con `prec = 2` 4 muestras de `COMPONENT_WIDTH/4` bits (p. ej. 2×8 o
+ * 4×4 bits con 16 bits por componente), todas con signo. Un beat lleva entonces hasta
+ * `COMPONENTS_MAX*2^prec` bandas con el mismo formato que a precisión completa, pero a nivel de
+ * subpalabra: la banda 0 en la subpalabra más significativa de las usadas y el último beat parcial
+ * alineado a la subpalabra menos significativa; `num_bands` cuenta muestras. Cada carril MAC recibe
+ * las `2^prec` bandas consecutivas de su componente y suma sus productos de subpalabra, que son exactos
+ * (`2*(COMPONENT_WIDTH/2^prec)` bits <= `COMPONENT_WIDTH`); la suma del píxel se acumula como en OP_DOT.
+ * A igual ancho de FIFO y de bus, un píxel ocupa `2^prec` veces menos beats y ciclos de COMPUTE.
+ * Solo OP_DOT (con o sin `ref_mode` y postprocesado) y OP_REF_LOAD, que solo cuenta las bandas, lo
+ * admiten; el banco de referencias debe cargarse con la misma `prec` con que se usa. `prec = 3`, otra
+ * operación, `SIMD_EN = 0` o un `COMPONENT_WIDTH` no divisible por `2^prec` producen ERR_OP.
+ *
+ * @section scale Acumulación ancha y escalado de salida
+ * Los productos de los carriles MAC se calculan con `2*COMPONENT_WIDTH` bits y el árbol, las sumas
+ * parciales de streaming y `result` acumulan con `ACC_W = 2*COMPONENT_WIDTH + ACC_GUARD` bits, de
+ * forma que un píxel de hasta `2^ACC_GUARD` bandas (p. ej. un beat de `COMPONENTS_MAX` bandas, o un
+ * píxel band-serial completo) no desborda. Al escribir, cada componente de OP_DOT/OP_SAM se devuelve
+ * al ancho de la FIFO con la entrada `out_scale = {sat, round, shift[5:0]}`:
+ * - `shift`: desplazamiento aritmético a la derecha de la suma ancha.
+ * - `round`: suma `2^(shift-1)` antes de desplazar (redondeo al más próximo, medios hacia +inf).
+ * - `sat`: satura el valor desplazado a `[-2^(COMPONENT_WIDTH-1), 2^(COMPONENT_WIDTH-1)-1]`; sin él
+ *   se toman los `COMPONENT_WIDTH` bits bajos, que con `out_scale = 0` coincide con la aritmética
+ *   modular de versiones anteriores.
+ * OP_CROSS conserva su resultado de `COMPONENT_WIDTH` bits y no se escala. El postprocesado trabaja
+ * sobre los valores ya escalados.
+ *
+ * @section post Postprocesado de OP_DOT
+ * La entrada `post_mode` añade una etapa tras COMPUTE que reduce los productos escalares del píxel
+ * (las K = `REF_NUM` puntuaciones con `ref_mode`, o K = 1 sin él) a una sola información antes de
+ * escribirla en la FIFO de salida:
+ * | post_mode | Nombre    | Palabra de salida                                                               |
+ * |-----------|-----------|---------------------------------------------------------------------------------|
+ * | 0         | NONE      | Las K puntuaciones, la k en la componente k (comportamiento original).          |
+ * | 1         | ARGMAX    | Índice de la mayor puntuación en la componente 0 y su valor en la componente 1. |
+ * | 2         | THRESHOLD | Bit k de la componente 0 = (puntuación k >= `threshold`), con signo.            |
+ * Con empates ARGMAX devuelve el menor índice. Las componentes no indicadas valen 0, de modo que la
+ * información útil cabe en los 32 bits menos significativos de la palabra (`hsi_dma` escribe una
+ * palabra de bus por píxel en lugar de `ceil(COMPONENT_WIDTH*COMPONENTS_MAX/32)`). Se aplica en la
+ * escritura de WRITE y, sin referencias, también en el modo streaming, sin añadir latencia. Solo
+ * OP_DOT lo admite; `post_mode = 3`, o un valor distinto de 0 con otra operación, produce ERR_OP.
+ *
+ * @section more_input Productor externo
+ * La entrada `more_input` indica que un productor (p. ej. el DMA `hsi_dma`) todavía tiene beats
+ * pendientes de escribir en las FIFOs de entrada. Mientras está activa, un `start` con las FIFOs
+ * vacías no produce ERR_INPUT_FIFO_EMPTY y el núcleo espera nuevos datos (en CAPTURE o en STREAM)
+ * en lugar de volver a IDLE cuando las FIFOs se vacían momentáneamente. Con `more_input = 0` el
+ * comportamiento es el original. El wrapper la activa también durante un trabajo de PIXEL_COUNT
+ * píxeles, que cuenta con la salida `pixel_valid` (un pulso por resultado aceptado en la FIFO de
+ * salida) y la libera al producirse el último.
+ *
+ * @section fwft FIFOs de entrada first-word-fall-through
+ * Con `FWFT = 1` las FIFOs de entrada presentan la palabra de cabeza en `data_out` mientras no están
+ * vacías. La FSM captura el beat en CAPTURE en el mismo ciclo en que lo extrae y pasa directamente a
+ * COMPUTE (el estado READ no se usa), lo que ahorra un ciclo por beat. En modo streaming la propia
+ * cabeza de las FIFOs actúa como etapa de entrada y se extrae al consumirse. Con `FWFT = 0` se
+ * mantiene la lectura registrada original (CAPTURE -> READ -> COMPUTE). La FIFO de salida conserva
+ * siempre la lectura registrada de la interfaz externa.
+ *
+ * @section dual_clock Doble reloj
+ * Con `DUAL_CLOCK = 1` las tres FIFOs son instancias de `fifo_cache_async` (punteros Gray, banco de
+ * registros; `FIFO_STORAGE` no se aplica). El lado de escritura de las FIFOs de entrada y el de
+ * lectura de la FIFO de salida usan `bus_clk`/`bus_rst_n`, y la FSM y el datapath usan `clk`, que
+ * puede ser más rápido. En ese caso están en el dominio de `bus_clk` las señales `in*_wr_en`,
+ * `in*_data_in`, `in*_full`, `out_rd_en`, `out_data_out`, `out_empty`, los niveles, los umbrales
+ * `af_level`/`ae_level` y los indicadores almost_*, que se calculan con la ocupación vista desde el
+ * bus. Todas las demás señales, incluida `out_full`, pertenecen al dominio de `clk` y el
+ * instanciador debe sincronizarlas (ver `hsi_accel_obi`). Con `DUAL_CLOCK = 0` `bus_clk` y
+ * `bus_rst_n` no se usan.
  *
  * @section signals Descripción de señales de entrada y salida
  * | Señal         | Dirección | Descripción                                                              |
  * |---------------|-----------|---------------------------------------------------------------------------|
  * | clk           | input     | Reloj principal del sistema.                                             |
  * | rst_n         | input     | Reset asíncrono activo en bajo.                                          |
+ * | bus_clk       | input     | Reloj de la interfaz de las FIFOs con `DUAL_CLOCK = 1`.                  |
+ * | bus_rst_n     | input     | Reset del dominio de `bus_clk`.                                          |
  * | in1_wr_en     | input     | Escritura en FIFO de entrada 1.                                          |
  * | in1_data_in   | input     | Datos de entrada (vector HSI) a FIFO 1.                                  |
  * | in1_full      | output    | FIFO de entrada 1 llena.                                                 |
@@ -49,21 +204,45 @@
  * | out_data_out  | output    | Resultado vectorial calculado.                                           |
  * | out_empty     | output    | FIFO de salida vacía.                                                    |
  * | out_full      | output    | FIFO de salida llena.                                                    |
+ * | in1_level     | output    | Ocupación de la FIFO de entrada 1 (0..FIFO_DEPTH).                       |
+ * | in2_level     | output    | Ocupación de la FIFO de entrada 2 (0..FIFO_DEPTH).                       |
+ * | out_level     | output    | Ocupación de la FIFO de salida (0..FIFO_DEPTH).                          |
+ * | af_level      | input     | Umbral de almost_full común a las tres FIFOs.                            |
+ * | ae_level      | input     | Umbral de almost_empty común a las tres FIFOs.                           |
+ * | almost_full   | output    | almost_full de {fifo_out, fifo_in2, fifo_in1}.                           |
+ * | almost_empty  | output    | almost_empty de {fifo_out, fifo_in2, fifo_in1}.                          |
  * | op_code       | input     | Código de operación (producto vectorial o escalar).                      |
- * | num_bands     | input     | Número de componentes del vector (1 a COMPONENTS_MAX).                   |
+ * | band_first    | input     | Primera banda de la ventana de bandas.                                   |
+ * | band_count    | input     | Bandas de la ventana (0 = todas).                                        |
+ * | num_bands     | input     | Bandas del píxel: 1 a COMPONENTS_MAX << prec; sin límite en band-serial. |
+ * | stream_mode   | input     | Selecciona el modo streaming (1 píxel/ciclo) en lugar de la FSM.         |
+ * | band_serial   | input     | Píxeles recibidos como secuencia de beats de COMPONENTS_MAX bandas.      |
+ * | ref_mode      | input     | OP_DOT contra el banco de referencias en lugar de la FIFO 2.             |
+ * | post_mode     | input     | Postprocesado de OP_DOT: 0 ninguno, 1 ARGMAX, 2 THRESHOLD.               |
+ * | prec          | input     | Muestras por componente: 0 una, 1 dos, 2 cuatro (OP_DOT).                |
+ * | out_scale     | input     | Escalado de la salida MAC: {sat, round, shift[5:0]}.                     |
+ * | threshold     | input     | Umbral con signo del postprocesado THRESHOLD.                            |
+ * | more_input    | input     | El productor externo tiene más beats pendientes para las FIFOs.          |
  * | start         | input     | Señal para iniciar la operación.                                         |
  * | pixel_done    | output    | Señal que indica que un resultado está disponible.                       |
- * | error_code    | output    | Código de error, si se produce durante el procesamiento.                 |
+ * | pixel_valid   | output    | Pulso por resultado escrito en la FIFO de salida o referencia cargada.   |
+ * | fsm_state     | output    | Estado actual de la FSM (codificación de `state_t`).                     |
+ * | stall_in      | output    | Ciclo detenido esperando datos en las FIFOs de entrada.                  |
+ * | stall_out     | output    | Ciclo detenido con un resultado retenido por `out_full`.                 |
+ * | error_code    | output    | Código de error del último START (ERR_NONE si fue válido).               |
  *
  * @section usage Ejemplo de instanciación
  * @code{.sv}
  * hsi_vector_core #(
  *     .COMPONENT_WIDTH(16),
  *     .FIFO_DEPTH(32),
- *     .COMPONENTS_MAX(3)
+ *     .COMPONENTS_MAX(3),
+ *     .DOT_LANES(4)
  * ) hsi_core_inst (
  *     .clk(clk),
  *     .rst_n(rst_n),
+ *     .bus_clk(clk),
+ *     .bus_rst_n(rst_n),
  *     .in1_wr_en(in1_wr_en),
  *     .in1_data_in(in1_data_in),
  *     .in1_full(in1_full),
@@ -74,10 +253,31 @@
  *     .out_data_out(out_data_out),
  *     .out_empty(out_empty),
  *     .out_full(out_full),
+ *     .in1_level(in1_level),
+ *     .in2_level(in2_level),
+ *     .out_level(out_level),
+ *     .af_level(af_level),
+ *     .ae_level(ae_level),
+ *     .almost_full(almost_full),
+ *     .almost_empty(almost_empty),
  *     .op_code(op_code),
  *     .num_bands(num_bands),
+ *     .band_first('0),
+ *     .band_count('0),
+ *     .stream_mode(stream_mode),
+ *     .band_serial(band_serial),
+ *     .ref_mode(1'b0),
+ *     .post_mode(2'd0),
+ *     .prec(2'd0),
+ *     .out_scale('0),
+ *     .threshold('0),
+ *     .more_input(1'b0),
  *     .start(start),
  *     .pixel_done(pixel_done),
+ *     .pixel_valid(pixel_valid),
+ *     .fsm_state(fsm_state),
+ *     .stall_in(stall_in),
+ *     .stall_out(stall_out),
  *     .error_code(error_code)
  * );
  * @endcode
@@ -85,7 +285,16 @@
 module hsi_vector_core #(
     parameter int COMPONENT_WIDTH = 16,
     parameter int FIFO_DEPTH      = 16,
-    parameter int COMPONENTS_MAX  = 3 
+    parameter int COMPONENTS_MAX  = 3,
+    parameter int DOT_LANES       = 4,
+    parameter bit FWFT            = 1,
+    parameter string FIFO_STORAGE = "FLOPS",
+    parameter bit SAM_EN          = 1,
+    parameter bit DUAL_CLOCK      = 0,
+    parameter int REF_NUM         = 3,
+    parameter int REF_BEATS       = 1,
+    parameter bit SIMD_EN         = 1,
+    parameter int ACC_GUARD       = 8
 )(
     /**
      * @var clk, rst_n
@@ -94,6 +303,15 @@ module hsi_vector_core #(
     input  logic                                            clk,
     input  logic                                            rst_n,
 
+    /**
+     * @var bus_clk, bus_rst_n
+     * @brief Reloj y reset de la interfaz de las FIFOs (solo con DUAL_CLOCK = 1)
+     */
+    /* verilator lint_off UNUSEDSIGNAL */
+    input  logic                                            bus_clk,
+    input  logic                                            bus_rst_n,
+    /* verilator lint_on UNUSEDSIGNAL */
+
     /**
      * @var in1_wr_en, in1_data_in, in1_full
      * @brief Interfaz FIFO de entrada 1
@@ -126,18 +344,51 @@ module hsi_vector_core #(
     output logic                                            out_full,
 
     /**
-     * @var op_code, num_bands, start
+     * @var in1_level, in2_level, out_level
+     * @brief Ocupación de las FIFOs (0..FIFO_DEPTH), usada para las interrupciones por nivel
+     */
+    output logic [$clog2(FIFO_DEPTH):0]                     in1_level,
+    output logic [$clog2(FIFO_DEPTH):0]                     in2_level,
+    output logic [$clog2(FIFO_DEPTH):0]                     out_level,
+
+    /**
+     * @var af_level, ae_level, almost_full, almost_empty
+     * @brief Umbrales programables comunes a las tres FIFOs y sus indicadores
+     *
+     * Bit 0: FIFO de entrada 1, bit 1: FIFO de entrada 2, bit 2: FIFO de salida.
+     */
+    input  logic [$clog2(FIFO_DEPTH):0]                     af_level,
+    input  logic [$clog2(FIFO_DEPTH):0]                     ae_level,
+    output logic [2:0]                                      almost_full,
+    output logic [2:0]                                      almost_empty,
+
+    /**
+     * @var op_code, num_bands, band_first, band_count, stream_mode, band_serial, ref_mode, post_mode, threshold, prec, out_scale, more_input, start
      * @brief Señales de control y configuración
      */
     input  logic [3:0]                                      op_code,        ///< Código de operación
-    input  logic [31:0]                                     num_bands,      ///< Número de bandas/componentes (1..32)
+    input  logic [31:0]                                     num_bands,      ///< Bandas del píxel (1..COMPONENTS_MAX << prec; 1..2^32-1 con band_serial)
+    input  logic [15:0]                                     band_first,     ///< Primera banda de la ventana
+    input  logic [15:0]                                     band_count,     ///< Bandas de la ventana (0 = todas)
+    input  logic                                            stream_mode,    ///< 1 = modo streaming, 0 = FSM por píxel
+    input  logic                                            band_serial,    ///< 1 = píxel en varios beats de COMPONENTS_MAX bandas
+    input  logic                                            ref_mode,       ///< 1 = OP_DOT contra el banco de referencias
+    input  logic [1:0]                                      post_mode,      ///< Postprocesado de OP_DOT (NONE/ARGMAX/THRESHOLD)
+    input  logic signed [COMPONENT_WIDTH-1:0]               threshold,      ///< Umbral de POST_THRESHOLD
+    input  logic [1:0]                                      prec,           ///< log2 de las muestras por componente
+    input  logic [7:0]                                      out_scale,      ///< {sat, round, shift} de la salida MAC
+    input  logic                                            more_input,     ///< 1 = el productor tiene más beats pendientes
     input  logic                                            start,          ///< Señal para iniciar operación
 
     /**
-     * @var pixel_done, error_code
+     * @var pixel_done, pixel_valid, fsm_state, stall_in, stall_out, error_code
      * @brief Señales de salida
      */
     output logic                                            pixel_done,     ///< Indica pixel procesado y escrito
+    output logic                                            pixel_valid,    ///< Pulso por resultado escrito o referencia cargada
+    output logic [3:0]                                      fsm_state,      ///< Estado actual de la FSM (contadores de rendimiento)
+    output logic                                            stall_in,       ///< Ciclo detenido esperando datos en las FIFOs de entrada
+    output logic                                            stall_out,      ///< Ciclo detenido por out_full
     output logic [3:0]                                      error_code      ///< 0 = OK, otros = error
 );
 
@@ -152,41 +403,109 @@ module hsi_vector_core #(
     logic                                           in1_empty, in2_empty;
 
     /**
-     * @class FIFO_entrada_1
-     * @brief FIFO de entrada 1
-     * Esta FIFO almacena los vectores HSI de entrada.
-     * Utilizan el módulo `fifo_cache` genérico para manejar la lógica de lectura/escritura.
+     * @var fsm_pop, stream_pop, ref_pop, ref_active
+     * @brief Orígenes de la lectura de las FIFOs de entrada (FSM por píxel, streaming o carga de
+     * referencias). Con `ref_active` la FSM solo extrae de la FIFO 1.
      */
-    fifo_cache #(.WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX), .DEPTH(FIFO_DEPTH)) fifo_in1 (
-        .clk(clk), .rst_n(rst_n),
-        .wr_en(in1_wr_en), .rd_en(in1_rd_en),
-        .data_in(in1_data_in), .data_out(in1_data_out),
-        .full(in1_full), .empty(in1_empty)
-    );
-    /**
-     * @class FIFO_entrada_2
-     * @brief FIFO de entrada 2
-     * Esta FIFO almacena los vectores HSI de entrada.
-     * Utilizan el módulo `fifo_cache` genérico para manejar la lógica de lectura/escritura.
-     */
-    fifo_cache #(.WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX), .DEPTH(FIFO_DEPTH)) fifo_in2 (
-        .clk(clk), .rst_n(rst_n),
-        .wr_en(in2_wr_en), .rd_en(in2_rd_en),
-        .data_in(in2_data_in), .data_out(in2_data_out),
-        .full(in2_full), .empty(in2_empty)
-    );
+    logic                                           fsm_pop, stream_pop, ref_pop;
+    logic                                           ref_active;
+    assign in1_rd_en = fsm_pop | stream_pop;
+    assign in2_rd_en = (fsm_pop && !ref_active) | stream_pop | ref_pop;
+
     /**
-     * @class FIFO_salida
-     * @brief FIFO de salisa
-     * Esta FIFO almacena los vectores HSI de salida.
-     * Utilizan el módulo `fifo_cache` genérico para manejar la lógica de lectura/escritura.
+     * @var out_pending
+     * @brief La FIFO de salida contiene resultados, visto desde el dominio de `clk` (pixel_done)
      */
-    fifo_cache #(.WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX), .DEPTH(FIFO_DEPTH)) fifo_out (
-        .clk(clk), .rst_n(rst_n),
-        .wr_en(out_wr_en), .rd_en(out_rd_en),
-        .data_in(out_data_in), .data_out(out_data_out),
-        .full(out_full), .empty(out_empty)
-    );
+    logic                                           out_pending;
+
+    generate
+        if (DUAL_CLOCK) begin : g_dual_clock
+            /**
+             * @brief FIFOs de doble reloj: escritura de las entradas y lectura de la salida en `bus_clk`.
+             *
+             * Los niveles expuestos son los del lado del bus; los del lado del núcleo solo se usan
+             * para `out_pending`.
+             */
+            logic [$clog2(FIFO_DEPTH):0] out_wr_level;
+            /* verilator lint_off UNUSEDSIGNAL */
+            logic [$clog2(FIFO_DEPTH):0] in1_rd_level, in2_rd_level;
+            /* verilator lint_on UNUSEDSIGNAL */
+
+            fifo_cache_async #(.WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX), .DEPTH(FIFO_DEPTH), .FWFT(FWFT)) fifo_in1 (
+                .wr_clk(bus_clk), .wr_rst_n(bus_rst_n),
+                .wr_en(in1_wr_en), .data_in(in1_data_in), .full(in1_full), .wr_level(in1_level),
+                .rd_clk(clk), .rd_rst_n(rst_n),
+                .rd_en(in1_rd_en), .data_out(in1_data_out), .empty(in1_empty), .rd_level(in1_rd_level)
+            );
+            fifo_cache_async #(.WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX), .DEPTH(FIFO_DEPTH), .FWFT(FWFT)) fifo_in2 (
+                .wr_clk(bus_clk), .wr_rst_n(bus_rst_n),
+                .wr_en(in2_wr_en), .data_in(in2_data_in), .full(in2_full), .wr_level(in2_level),
+                .rd_clk(clk), .rd_rst_n(rst_n),
+                .rd_en(in2_rd_en), .data_out(in2_data_out), .empty(in2_empty), .rd_level(in2_rd_level)
+            );
+            fifo_cache_async #(.WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX), .DEPTH(FIFO_DEPTH)) fifo_out (
+                .wr_clk(clk), .wr_rst_n(rst_n),
+                .wr_en(out_wr_en), .data_in(out_data_in), .full(out_full), .wr_level(out_wr_level),
+                .rd_clk(bus_clk), .rd_rst_n(bus_rst_n),
+                .rd_en(out_rd_en), .data_out(out_data_out), .empty(out_empty), .rd_level(out_level)
+            );
+
+            // Indicadores programables con la ocupación vista desde el bus (dominio de los umbrales)
+            assign almost_full  = {out_level >= af_level, in2_level >= af_level, in1_level >= af_level};
+            assign almost_empty = {out_level <= ae_level, in2_level <= ae_level, in1_level <= ae_level};
+            assign out_pending  = (out_wr_level != 0);
+        end else begin : g_single_clock
+            /**
+             * @class FIFO_entrada_1
+             * @brief FIFO de entrada 1
+             * Esta FIFO almacena los vectores HSI de entrada.
+             * Utilizan el módulo `fifo_cache` genérico para manejar la lógica de lectura/escritura.
+             */
+            fifo_cache #(.WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX), .DEPTH(FIFO_DEPTH), .FWFT(FWFT),
+                         .STORAGE(FIFO_STORAGE)) fifo_in1 (
+                .clk(clk), .rst_n(rst_n),
+                .wr_en(in1_wr_en), .rd_en(in1_rd_en),
+                .data_in(in1_data_in), .data_out(in1_data_out),
+                .full(in1_full), .empty(in1_empty),
+                .level(in1_level),
+                .af_level(af_level), .ae_level(ae_level),
+                .almost_full(almost_full[0]), .almost_empty(almost_empty[0])
+            );
+            /**
+             * @class FIFO_entrada_2
+             * @brief FIFO de entrada 2
+             * Esta FIFO almacena los vectores HSI de entrada.
+             * Utilizan el módulo `fifo_cache` genérico para manejar la lógica de lectura/escritura.
+             */
+            fifo_cache #(.WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX), .DEPTH(FIFO_DEPTH), .FWFT(FWFT),
+                         .STORAGE(FIFO_STORAGE)) fifo_in2 (
+                .clk(clk), .rst_n(rst_n),
+                .wr_en(in2_wr_en), .rd_en(in2_rd_en),
+                .data_in(in2_data_in), .data_out(in2_data_out),
+                .full(in2_full), .empty(in2_empty),
+                .level(in2_level),
+                .af_level(af_level), .ae_level(ae_level),
+                .almost_full(almost_full[1]), .almost_empty(almost_empty[1])
+            );
+            /**
+             * @class FIFO_salida
+             * @brief FIFO de salisa
+             * Esta FIFO almacena los vectores HSI de salida.
+             * Utilizan el módulo `fifo_cache` genérico para manejar la lógica de lectura/escritura.
+             */
+            fifo_cache #(.WIDTH(COMPONENT_WIDTH*COMPONENTS_MAX), .DEPTH(FIFO_DEPTH),
+                         .STORAGE(FIFO_STORAGE)) fifo_out (
+                .clk(clk), .rst_n(rst_n),
+                .wr_en(out_wr_en), .rd_en(out_rd_en),
+                .data_in(out_data_in), .data_out(out_data_out),
+                .full(out_full), .empty(out_empty),
+                .level(out_level),
+                .af_level(af_level), .ae_level(ae_level),
+                .almost_full(almost_full[2]), .almost_empty(almost_empty[2])
+            );
+            assign out_pending = !out_empty;
+        end
+    endgenerate
 
 
     /**
@@ -194,26 +513,38 @@ module hsi_vector_core #(
     * @brief Estados de la máquina de estados finita (FSM)
     * Esta enumeración define los estados de la FSM que controla el flujo de datos y operaciones.
     * - IDLE: Estado inicial. Espera a que se reciba `start` con parámetros válidos para comenzar el procesamiento.
-    * - CAPTURE: Espera a que las FIFOs de entrada tengan datos disponibles para iniciar la lectura.
-    * - READ: Lee los vectores desde las FIFOs de entrada.
+    * - CAPTURE: Espera a que las FIFOs de entrada tengan datos disponibles y extrae la palabra (beat) siguiente.
+    * - READ: Lee los vectores desde las FIFOs de entrada (solo con FWFT = 0).
     * - COMPUTE: Realiza el cálculo del producto vectorial (CROSS) o producto punto (DOT).
     * - WRITE: Prepara el resultado del cálculo para escribirlo en la FIFO de salida.
     * - WRITE_DONE: Finaliza la escritura y decide si se continúa procesando o se vuelve a IDLE.
     * - ERROR: Estado de fallo si la configuración de entrada no es válida.
+    * - STREAM: Modo streaming; lee, calcula y escribe un píxel por ciclo mientras haya datos.
+    * - REF_LOAD: Carga del banco de referencias desde la FIFO de entrada 2 (OP_REF_LOAD).
+    *
+    * En las transiciones, `in_avail` equivale a `!in1_empty && !in2_empty`, o a `!in1_empty` con
+    * `ref_active`.
     * \dot
     * digraph FSM {
     *   rankdir=LR;
     *   node [shape=ellipse, style=filled, fillcolor=lightgray];
     *
-    *   IDLE -> CAPTURE     [label="start && error_code == ERR_NONE && ((op_code == OP_CROSS && num_bands == 3) || (op_code == OP_DOT && num_bands > 0)) && !out_full"];
+    *   IDLE -> CAPTURE     [label="start && cfg_ok && !out_full && (!stream_mode || ref_active)"];
+    *   IDLE -> STREAM      [label="(mismas condiciones) && stream_mode && !ref_active"];
+    *   IDLE -> REF_LOAD    [label="(mismas condiciones) && op_code == OP_REF_LOAD"];
+    *   REF_LOAD -> IDLE    [label="última referencia almacenada || (in2_empty && !more_input)"];
+    *   STREAM -> IDLE      [label="(in1_empty || in2_empty) && !more_input && !stream_head && !out_wr_en && beat_base == win_base"];
     *   IDLE -> ERROR       [label="start && error_code != ERR_NONE"];
     *
-    *   CAPTURE -> READ     [label="!in1_empty && !in2_empty"];
+    *   CAPTURE -> READ     [label="in_avail && !FWFT"];
+    *   CAPTURE -> COMPUTE  [label="in_avail && FWFT"];
+    *   CAPTURE -> IDLE     [label="!in_avail && !more_input && beat_base == win_base"];
     *   READ -> COMPUTE;
-    *   COMPUTE -> WRITE    [label="(op_code == OP_CROSS) || (op_code == OP_DOT && i >= num_bands)"];
+    *   COMPUTE -> WRITE    [label="(op_code == OP_CROSS) || (op_code in {OP_DOT, OP_SAM} && beat_end && last_beat && !tree_pending)"];
+    *   COMPUTE -> CAPTURE  [label="op_code in {OP_DOT, OP_SAM} && beat_end && !last_beat"];
     *   WRITE -> WRITE_DONE [label="!out_full"];
     *
-    *   WRITE_DONE -> CAPTURE [label="!in1_empty && !in2_empty"];
+    *   WRITE_DONE -> CAPTURE [label="in_avail || more_input"];
     *   WRITE_DONE -> IDLE    [label="otherwise"];
     *
     *   ERROR -> IDLE         [label="!start"];
@@ -230,7 +561,9 @@ module hsi_vector_core #(
         COMPUTE = 4'd3,
         WRITE   = 4'd4,
         WRITE_DONE = 4'd5,
-        ERROR   = 4'd6
+        ERROR   = 4'd6,
+        STREAM  = 4'd7,
+        REF_LOAD = 4'd8
     } state_t;
 
     /**
@@ -239,27 +572,358 @@ module hsi_vector_core #(
      * 
      * - OP_CROSS: Producto vectorial (cross-product) para 3 bandas.
      * - OP_DOT: Producto punto (dot-product) para cualquier número de bandas.
+     * - OP_SAM: a·b, |a|² y |b|² en una sola pasada (Spectral Angle Mapper).
+     * - OP_REF_LOAD: Carga del banco de referencias desde la FIFO de entrada 2.
      */
     typedef enum logic [3:0] {
-        OP_CROSS = 4'd1, ///< Producto vectorial (cross-product)
-        OP_DOT   = 4'd2  ///< Producto punto (dot-product)
+        OP_CROSS    = 4'd1, ///< Producto vectorial (cross-product)
+        OP_DOT      = 4'd2, ///< Producto punto (dot-product)
+        OP_SAM      = 4'd3, ///< Términos del ángulo espectral
+        OP_REF_LOAD = 4'd4  ///< Carga de vectores de referencia
     } op_code_t;
 
+    /**
+     * @class post_mode_t
+     * @brief Modos de postprocesado de OP_DOT
+     *
+     * - POST_NONE: Se escriben las puntuaciones sin modificar.
+     * - POST_ARGMAX: Índice y valor de la mayor puntuación.
+     * - POST_THRESHOLD: Máscara de puntuaciones mayores o iguales que `threshold`.
+     */
+    typedef enum logic [1:0] {
+        POST_NONE      = 2'd0, ///< Sin postprocesado
+        POST_ARGMAX    = 2'd1, ///< Índice y valor máximos
+        POST_THRESHOLD = 2'd2  ///< Detección por umbral
+    } post_mode_t;
+
+    /**
+     * @class prec_t
+     * @brief Modos de empaquetado de muestras
+     *
+     * - PREC_FULL: Una muestra de `COMPONENT_WIDTH` bits por componente.
+     * - PREC_2: Dos muestras de `COMPONENT_WIDTH/2` bits por componente.
+     * - PREC_4: Cuatro muestras de `COMPONENT_WIDTH/4` bits por componente.
+     */
+    typedef enum logic [1:0] {
+        PREC_FULL = 2'd0, ///< Precisión completa
+        PREC_2    = 2'd1, ///< 2 subpalabras por componente
+        PREC_4    = 2'd2  ///< 4 subpalabras por componente
+    } prec_t;
+
+    localparam int SW2 = (COMPONENT_WIDTH >= 2) ? COMPONENT_WIDTH / 2 : 1;
+    localparam int SW4 = (COMPONENT_WIDTH >= 4) ? COMPONENT_WIDTH / 4 : 1;
+
+    /// Ancho de los productos y acumuladores MAC y límites de saturación (ver la sección de escalado)
+    localparam int ACC_W = 2*COMPONENT_WIDTH + ACC_GUARD;
+    localparam logic signed [ACC_W-1:0] OUT_MAX = ACC_W'({1'b0, {(COMPONENT_WIDTH-1){1'b1}}});
+    localparam logic signed [ACC_W-1:0] OUT_MIN = ~OUT_MAX;
+
+    /**
+     * @var is_mac
+     * @brief La operación usa los carriles MAC y el árbol de sumadores (OP_DOT u OP_SAM)
+     */
+    logic is_mac;
+    assign is_mac = (op_code == OP_DOT) || (op_code == OP_SAM);
+    assign ref_active = (REF_NUM > 0) && ref_mode && (op_code == OP_DOT);
+
     /**
      * @var state, next_state, vec1, vec2, result, i
      * @brief Variables internas de la FSM
      * 
      * - `state`: Estado actual de la FSM.
      * - `next_state`: Estado siguiente a transitar.
-     * - `vec1`, `vec2`, `result`: Vectores internos para almacenar los componentes de entrada y el resultado.
+     * - `vec1`, `vec2`, `result`: Vectores internos para almacenar los componentes de entrada y el
+     *   resultado, este último con `ACC_W` bits.
      * - `i`: Contador para iterar sobre las bandas.
      */
     state_t state, next_state;
     logic signed [COMPONENT_WIDTH-1:0] vec1 [0:COMPONENTS_MAX-1];
     logic signed [COMPONENT_WIDTH-1:0] vec2 [0:COMPONENTS_MAX-1];
-    logic signed [COMPONENT_WIDTH-1:0] result [0:COMPONENTS_MAX-1];
+    logic signed [ACC_W-1:0]           result [0:COMPONENTS_MAX-1];
     integer i;
 
+    /**
+     * @var beat_base, beat_max, beat_bands, beat_bands_q, beat_lanes, beat_lanes_q, last_beat, cfg_ok
+     * @brief Seguimiento de beats dentro del píxel y validación de la configuración
+     *
+     * - `beat_base`: Primera banda del píxel contenida en el beat actual (`win_base` en el primer beat).
+     * - `beat_max`: Bandas de un beat completo, `COMPONENTS_MAX*2^prec`.
+     * - `beat_bands`: Bandas del beat disponible en la salida de las FIFOs, `min(beat_max, num_bands - beat_base)`.
+     * - `beat_bands_q`: Copia de `beat_bands` capturada con el beat en cálculo (`capture_beat`).
+     * - `win_lo`, `win_hi`: Primera banda de la ventana y la siguiente a la última (`0`, `num_bands` sin ventana).
+     * - `win_base`: Primera banda del beat que contiene `win_lo` (0 fuera del modo band-serial).
+     * - `beat_lo`, `beat_hi`, `beat_hi_q`: Bandas de la ventana dentro del beat, relativas a `beat_base`,
+     *   `[beat_lo, beat_hi)` para el beat de las FIFOs y `[beat_lo, beat_hi_q)` para el beat en cálculo.
+     * - `beat_lanes`, `beat_lanes_q`: Componentes (carriles) que alcanzan esas bandas, `ceil(beat_hi/2^prec)`.
+     * - `lane_lo`: Primera componente con bandas de la ventana, desde la que la FSM emite los carriles.
+     * - `last_beat`: Marca de fin de píxel para el beat en cálculo (FSM).
+     * - `cfg_ok`: La combinación op_code / num_bands / ventana / band_serial / ref_mode / post_mode / prec es válida.
+     * - `in_avail`: Hay un beat disponible en las FIFOs que usa la FSM (solo la 1 con `ref_active`).
+     */
+    logic [31:0] beat_base;
+    logic [31:0] beat_max;
+    logic [31:0] beat_bands;
+    logic [31:0] beat_bands_q;
+    logic [31:0] win_lo, win_hi, win_base;
+    logic [31:0] beat_lo, beat_hi, beat_hi_q;
+    logic [31:0] beat_lanes;
+    logic [31:0] beat_lanes_q;
+    logic [31:0] lane_lo;
+    logic        win_ok;
+    logic        last_beat;
+    logic        cfg_ok;
+    logic        ref_bands_ok;
+    logic        prec_ok;
+    logic        in_avail;
+
+    assign beat_max     = 32'(COMPONENTS_MAX) << prec;
+    assign beat_bands   = (num_bands - beat_base > beat_max) ? beat_max : num_bands - beat_base;
+    assign win_lo       = (band_count == 16'd0) ? 32'd0 : 32'(band_first);
+    assign win_hi       = (band_count == 16'd0) ? num_bands : 32'(band_first) + 32'(band_count);
+    // floor(win_lo / (COMPONENTS_MAX*2^prec)) = floor((win_lo >> prec) / COMPONENTS_MAX)
+    assign win_base     = band_serial ? (((win_lo >> prec) / 32'(COMPONENTS_MAX)) * 32'(COMPONENTS_MAX)) << prec : 32'd0;
+    assign win_ok       = (band_count == 16'd0) || (op_code != OP_CROSS && win_hi <= num_bands);
+    assign beat_lo      = (win_lo > beat_base) ? win_lo - beat_base : 32'd0;
+    assign beat_hi      = (win_hi - beat_base < beat_bands)   ? win_hi - beat_base : beat_bands;
+    assign beat_hi_q    = (win_hi - beat_base < beat_bands_q) ? win_hi - beat_base : beat_bands_q;
+    assign beat_lanes   = (beat_hi   + (32'd1 << prec) - 1) >> prec;
+    assign beat_lanes_q = (beat_hi_q + (32'd1 << prec) - 1) >> prec;
+    assign lane_lo      = beat_lo >> prec;
+    assign last_beat    = (beat_base + beat_bands_q >= win_hi);
+    assign ref_bands_ok = (win_hi - win_base <= 32'(REF_BEATS) * beat_max);
+    assign prec_ok      = (prec == PREC_FULL) ||
+                          (SIMD_EN && prec != 2'd3 && (COMPONENT_WIDTH % (1 << prec)) == 0 &&
+                           (op_code == OP_DOT || op_code == OP_REF_LOAD));
+    assign cfg_ok       = (band_serial || num_bands <= beat_max) && prec_ok && win_ok &&
+                          (!ref_mode || ref_active || op_code == OP_REF_LOAD) && (!ref_active || ref_bands_ok) &&
+                          (post_mode == POST_NONE || (op_code == OP_DOT && post_mode != 2'd3)) &&
+                          ((op_code == OP_CROSS && num_bands == 3 && !band_serial) || (op_code == OP_DOT && num_bands > 0) ||
+                           (SAM_EN && COMPONENTS_MAX >= 3 && op_code == OP_SAM && num_bands > 0) ||
+                           (REF_NUM > 0 && op_code == OP_REF_LOAD && num_bands > 0 && ref_bands_ok));
+    assign in_avail     = !in1_empty && (ref_active || !in2_empty);
+
+    /**
+     * @var in1_vec, in2_vec
+     * @brief Componentes desempaquetados de la palabra disponible en la salida de cada FIFO
+     *
+     * La banda k del beat se toma de `data_out[(beat_bands-1-k)*COMPONENT_WIDTH +: COMPONENT_WIDTH]`,
+     * de forma que la componente más significativa es la banda 0. Las bandas >= beat_bands son 0.
+     * Con muestras empaquetadas la componente k reúne las bandas `k*2^prec .. k*2^prec+2^prec-1`,
+     * desempaquetadas igual a nivel de subpalabra (ver `lane_word`). Las bandas fuera de la ventana
+     * (`[beat_lo, beat_hi)`) también son 0.
+     */
+    logic signed [COMPONENT_WIDTH-1:0] in1_vec [0:COMPONENTS_MAX-1];
+    logic signed [COMPONENT_WIDTH-1:0] in2_vec [0:COMPONENTS_MAX-1];
+
+    /**
+     * @brief Componente (carril) k de un beat de `nb` bandas con el empaquetado `p`.
+     *
+     * La banda `k*2^p + s` se coloca en la subpalabra `2^p-1-s` del carril; solo se toman las bandas
+     * de `[lo, hi)` (con `hi <= nb`) y las demás son 0.
+     */
+    function automatic logic [COMPONENT_WIDTH-1:0] lane_word(
+        input logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w,
+        input logic [31:0]                               nb,
+        input logic [31:0]                               lo,
+        input logic [31:0]                               hi,
+        input int                                        k,
+        input logic [1:0]                                p
+    );
+        logic [COMPONENT_WIDTH-1:0] l;
+        l = '0;
+        case (p)
+            PREC_2: for (int s = 0; s < 2; s++) begin
+                if (32'(2*k + s) >= lo && 32'(2*k + s) < hi) l[(1-s)*SW2 +: SW2] = w[(nb - 1 - 32'(2*k + s))*SW2 +: SW2];
+            end
+            PREC_4: for (int s = 0; s < 4; s++) begin
+                if (32'(4*k + s) >= lo && 32'(4*k + s) < hi) l[(3-s)*SW4 +: SW4] = w[(nb - 1 - 32'(4*k + s))*SW4 +: SW4];
+            end
+            default: if (32'(k) >= lo && 32'(k) < hi) l = w[(nb - 1 - 32'(k))*COMPONENT_WIDTH +: COMPONENT_WIDTH];
+        endcase
+        return l;
+    endfunction
+
+    always_comb begin
+        for (int k = 0; k < COMPONENTS_MAX; k++) begin
+            in1_vec[k] = lane_word(in1_data_out, beat_bands, beat_lo, beat_hi, k, prec);
+            in2_vec[k] = lane_word(in2_data_out, beat_bands, beat_lo, beat_hi, k, prec);
+        end
+    end
+
+    /**
+     * @var ref_mem, ref_idx, beat_idx, ref_word, ref_vec
+     * @brief Banco de referencias persistente
+     *
+     * - `ref_mem[k][b]`: Beat b de la referencia k tal como se extrajo de la FIFO 2.
+     * - `ref_idx`: Referencia en carga (REF_LOAD) o en cálculo (COMPUTE con `ref_active`).
+     * - `beat_idx`: Beat del píxel correspondiente a `beat_base`.
+     * - `ref_word`, `ref_vec`: Beat de la referencia en cálculo y sus componentes, desempaquetadas
+     *   igual que `in2_vec` con las bandas del beat en cálculo (`beat_bands_q`).
+     */
+    localparam int REF_SLOTS = (REF_NUM > 0) ? REF_NUM : 1;
+    localparam int REF_W     = (REF_SLOTS > 1) ? $clog2(REF_SLOTS) : 1;
+    localparam int BEAT_W    = (REF_BEATS > 1) ? $clog2(REF_BEATS) : 1;
+
+    // Cada puntuación de REF_MODE ocupa una componente del resultado
+    if (REF_NUM > COMPONENTS_MAX) begin : g_check_ref_num
+        $error("hsi_vector_core: REF_NUM = %0d supera COMPONENTS_MAX = %0d", REF_NUM, COMPONENTS_MAX);
+    end
+
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] ref_mem [0:REF_SLOTS-1][0:REF_BEATS-1];
+    logic [REF_W-1:0]                          ref_idx;
+    logic [BEAT_W-1:0]                         beat_idx;
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] ref_word;
+    logic signed [COMPONENT_WIDTH-1:0]         ref_vec [0:COMPONENTS_MAX-1];
+
+    assign ref_word = ref_mem[ref_idx][beat_idx];
+
+    always_comb begin
+        for (int k = 0; k < COMPONENTS_MAX; k++) ref_vec[k] = lane_word(ref_word, beat_bands_q, beat_lo, beat_hi_q, k, prec);
+    end
+
+    /**
+     * @var ref_stored, ref_last, ref_loaded, ref_we, ref_wk, ref_wb
+     * @brief Control de la carga del banco (OP_REF_LOAD)
+     *
+     * - `ref_stored`: Se extrae el último beat de una referencia.
+     * - `ref_last`: Esa referencia es la última del banco.
+     * - `ref_loaded`: El banco se cargó completo; mantiene `pixel_done` hasta el siguiente `start`.
+     * - `ref_we`, `ref_wk`, `ref_wb`: Escritura del beat extraído, en el mismo ciclo con FWFT o en el
+     *   siguiente (con la posición registrada) con lectura registrada.
+     */
+    logic              ref_stored;
+    logic              ref_last;
+    logic              ref_loaded;
+    logic              ref_we;
+    logic [REF_W-1:0]  ref_wk;
+    logic [BEAT_W-1:0] ref_wb;
+
+    assign ref_pop    = (state == REF_LOAD) && !in2_empty;
+    assign ref_stored = ref_pop && (beat_base + beat_bands >= win_hi);
+    assign ref_last   = (ref_idx == REF_W'(REF_SLOTS - 1));
+
+    generate
+        if (FWFT) begin : g_ref_wr_fwft
+            assign ref_we = ref_pop;
+            assign ref_wk = ref_idx;
+            assign ref_wb = beat_idx;
+        end else begin : g_ref_wr_registered
+            always_ff @(posedge clk or negedge rst_n) begin
+                if (!rst_n) begin
+                    ref_we <= 1'b0;
+                    ref_wk <= '0;
+                    ref_wb <= '0;
+                end else begin
+                    ref_we <= ref_pop;
+                    ref_wk <= ref_idx;
+                    ref_wb <= beat_idx;
+                end
+            end
+        end
+    endgenerate
+
+    always_ff @(posedge clk) begin
+        if (REF_NUM > 0 && ref_we) ref_mem[ref_wk][ref_wb] <= in2_data_out;
+    end
+
+    /**
+     * @var mul_a, mul_b, mul_p
+     * @brief Banco de multiplicadores compartido entre OP_CROSS y los carriles de OP_DOT
+     *
+     * - OP_CROSS usa los 6 primeros multiplicadores para los productos cruzados.
+     * - OP_DOT usa los `DOT_LANES` primeros como carriles MAC sobre el bloque de bandas actual,
+     *   o los `COMPONENTS_MAX` primeros en modo streaming (píxel completo por ciclo).
+     */
+    localparam int MUL_LANES = (DOT_LANES > COMPONENTS_MAX) ? DOT_LANES : COMPONENTS_MAX;
+    localparam int NUM_MULS  = (MUL_LANES > 6) ? MUL_LANES : 6;
+    localparam int LOG_LANES = $clog2(DOT_LANES);
+
+    // El árbol de sumadores reduce DOT_LANES a la mitad en cada etapa
+    if (DOT_LANES < 1 || (DOT_LANES & (DOT_LANES - 1)) != 0) begin : g_check_dot_lanes
+        $error("hsi_vector_core: DOT_LANES = %0d no es una potencia de 2", DOT_LANES);
+    end
+
+    /**
+     * @brief Canales de acumulación: 0 = a·b (OP_DOT/OP_SAM), 1 = |a|², 2 = |b|² (solo SAM_EN)
+     *
+     * `CH_AA`/`CH_BB` son los canales de `|a|²`/`|b|²` y `SAM_AA`/`SAM_BB` las componentes de
+     * `result` que los reciben.
+     */
+    localparam int NUM_ACC = SAM_EN ? 3 : 1;
+    localparam int CH_AA   = SAM_EN ? 1 : 0;
+    localparam int CH_BB   = SAM_EN ? 2 : 0;
+    localparam int SAM_AA  = (COMPONENTS_MAX > 2) ? 2 : 0;
+    localparam int SAM_BB  = (COMPONENTS_MAX > 1) ? 1 : 0;
+
+    logic signed [COMPONENT_WIDTH-1:0] mul_a [0:NUM_MULS-1];
+    logic signed [COMPONENT_WIDTH-1:0] mul_b [0:NUM_MULS-1];
+    logic signed [ACC_W-1:0]           mul_p [0:NUM_MULS-1];
+
+    /**
+     * @var cross_res
+     * @brief Componentes del producto vectorial a partir del banco de multiplicadores
+     *
+     * Se mantienen en `COMPONENT_WIDTH` bits (aritmética modular), como antes de los acumuladores anchos.
+     */
+    logic signed [COMPONENT_WIDTH-1:0] cross_res [0:2];
+    assign cross_res[2] = COMPONENT_WIDTH'(mul_p[0] - mul_p[1]);
+    assign cross_res[1] = COMPONENT_WIDTH'(mul_p[2] - mul_p[3]);
+    assign cross_res[0] = COMPONENT_WIDTH'(mul_p[4] - mul_p[5]);
+
+    /**
+     * @var stream_vld, stream_head, stream_last, stream_adv, stream_acc, stream_dot, stream_res
+     * @brief Control del pipeline del modo streaming
+     *
+     * - `stream_vld`: La salida registrada de las FIFOs de entrada contiene un beat aún no procesado (FWFT = 0).
+     * - `stream_head`: Hay un beat disponible en la etapa de entrada (`stream_vld`, o FIFOs no vacías con FWFT).
+     * - `stream_last`: Ese beat es el último del píxel.
+     * - `stream_adv`: El beat se consume en este ciclo (el último pasa a `out_data_in`).
+     * - `stream_acc[c]`: Suma parcial del canal c de los beats anteriores del píxel (band-serial).
+     * - `stream_dot[c]`: Suma de los carriles del canal c del beat disponible en la salida de las FIFOs.
+     * - `stream_res[k]`: Componente k del resultado del píxel al consumir su último beat (`ACC_W` bits).
+     */
+    /* verilator lint_off UNUSEDSIGNAL */
+    logic                                       stream_vld;     // solo se usa con FWFT = 0
+    /* verilator lint_on UNUSEDSIGNAL */
+    logic                                       stream_head;
+    logic                                       stream_last;
+    logic                                       stream_adv;
+    logic signed [ACC_W-1:0]                    stream_acc [0:NUM_ACC-1];
+    logic signed [ACC_W-1:0]                    stream_dot [0:NUM_ACC-1];
+    logic signed [ACC_W-1:0]                    stream_res [0:COMPONENTS_MAX-1];
+
+    /**
+     * @var band_base, beat_done, ref_next, beat_end, dot_issue, tree_q, tree_ref, tree_vld, tree_pending
+     * @brief Control y etapas del árbol de sumadores segmentado de OP_DOT
+     *
+     * - `band_base`: Primera componente del bloque (relativa al beat) que se emite en el ciclo actual;
+     *   coincide con la primera banda a precisión completa.
+     * - `beat_done`: Se han emitido todas las componentes del beat en cálculo (para la referencia actual).
+     * - `ref_next`: Con `ref_active`, el beat se vuelve a recorrer con la referencia siguiente.
+     * - `beat_end`: El beat en cálculo está terminado.
+     * - `dot_issue`: Se emite un bloque de productos hacia el árbol en este ciclo.
+     * - `tree_q[c][s][j]`: Suma parcial j de la etapa s del canal c (la etapa 0 son los productos registrados).
+     * - `tree_ref[s]`: Referencia del bloque de la etapa s, que selecciona la componente de `result`.
+     * - `tree_vld[s]`: La etapa s contiene un bloque válido.
+     * - `tree_pending`: Queda algún bloque en las etapas previas a la última.
+     */
+    logic [31:0]                       band_base;
+    logic                              beat_done;
+    logic                              ref_next;
+    logic                              beat_end;
+    logic                              dot_issue;
+    logic signed [ACC_W-1:0]           tree_q [0:NUM_ACC-1][0:LOG_LANES][0:DOT_LANES-1];
+    logic [REF_W-1:0]                  tree_ref [0:LOG_LANES];
+    logic [LOG_LANES:0]                tree_vld;
+    logic                              tree_pending;
+
+    localparam logic [LOG_LANES:0] TREE_LAST = 1 << LOG_LANES;
+    assign tree_pending = |(tree_vld & ~TREE_LAST);
+    assign beat_done    = (band_base >= beat_lanes_q);
+    assign ref_next     = ref_active && beat_done && !ref_last;
+    assign beat_end     = beat_done && !ref_next;
+    assign dot_issue    = (state == COMPUTE) && is_mac && !beat_done;
+
     /**
      * @class error_code_t
      * @brief Código de error
@@ -270,6 +934,8 @@ module hsi_vector_core #(
      * - ERR_OUTPUT_FIFO_FULL: FIFO de salida llena al intentar escribir.
      * - ERR_BANDS: Número de bandas no válido (mayor que COMPONENTS_MAX).
      * - ERR_INVALID_FSM: Estado desconocido en la FSM.
+     *
+     * El código se conserva hasta el siguiente START en IDLE, que lo sustituye (ERR_NONE si es válido).
      */
     typedef enum logic [3:0] {
         ERR_NONE                 = 4'd0, ///< No hay error
@@ -281,35 +947,313 @@ module hsi_vector_core #(
     } error_code_t;
 
 
+    /**
+     * @brief Selección de operandos del banco de multiplicadores.
+     *
+     * Los operandos se toman de `vec1`/`vec2` en modo FSM (el segundo de `ref_vec` con `ref_active`)
+     * o directamente de la salida de las FIFOs en modo streaming. En OP_CROSS se cargan los pares del producto vectorial; en cualquier otro
+     * caso los carriles toman las bandas `lane_base .. lane_base+lanes-1` del beat (a cero las que
+     * exceden sus bandas).
+     */
+    logic signed [COMPONENT_WIDTH-1:0] src1 [0:COMPONENTS_MAX-1];
+    logic signed [COMPONENT_WIDTH-1:0] src2 [0:COMPONENTS_MAX-1];
+    logic [31:0]                       lane_base;
+    logic [31:0]                       lane_limit;
+    int                                lanes;
+
+    always_comb begin
+        for (int k = 0; k < COMPONENTS_MAX; k++) begin
+            src1[k] = (state == STREAM) ? in1_vec[k] : vec1[k];
+            src2[k] = (state == STREAM) ? in2_vec[k] : (ref_active ? ref_vec[k] : vec2[k]);
+        end
+        lane_base  = (state == STREAM) ? 32'd0 : band_base;
+        lane_limit = (state == STREAM) ? beat_lanes : beat_lanes_q;
+        lanes      = (state == STREAM) ? COMPONENTS_MAX : DOT_LANES;
+
+        for (int k = 0; k < NUM_MULS; k++) begin
+            mul_a[k] = '0;
+            mul_b[k] = '0;
+        end
+        if (op_code == OP_CROSS) begin
+            mul_a[0] = src1[1]; mul_b[0] = src2[2];
+            mul_a[1] = src1[2]; mul_b[1] = src2[1];
+            mul_a[2] = src1[2]; mul_b[2] = src2[0];
+            mul_a[3] = src1[0]; mul_b[3] = src2[2];
+            mul_a[4] = src1[0]; mul_b[4] = src2[1];
+            mul_a[5] = src1[1]; mul_b[5] = src2[0];
+        end else begin
+            for (int k = 0; k < NUM_MULS; k++) begin
+                if (k < lanes && lane_base + k < lane_limit) begin
+                    mul_a[k] = src1[lane_base + k];
+                    mul_b[k] = src2[lane_base + k];
+                end
+            end
+        end
+    end
+
+    /**
+     * @brief Producto de un carril en `ACC_W` bits: a·b a precisión completa o suma de los `2^p`
+     * productos de subpalabra con signo.
+     */
+    function automatic logic signed [ACC_W-1:0] simd_mul(
+        input logic signed [COMPONENT_WIDTH-1:0] a,
+        input logic signed [COMPONENT_WIDTH-1:0] b,
+        input logic [1:0]                        p
+    );
+        logic signed [ACC_W-1:0] acc;
+        logic signed [SW2-1:0]   a2, b2;
+        logic signed [SW4-1:0]   a4, b4;
+        acc = '0;
+        case (p)
+            PREC_2: for (int s = 0; s < 2; s++) begin
+                a2  = a[s*SW2 +: SW2];
+                b2  = b[s*SW2 +: SW2];
+                acc = acc + ACC_W'(a2) * ACC_W'(b2);
+            end
+            PREC_4: for (int s = 0; s < 4; s++) begin
+                a4  = a[s*SW4 +: SW4];
+                b4  = b[s*SW4 +: SW4];
+                acc = acc + ACC_W'(a4) * ACC_W'(b4);
+            end
+            default: acc = ACC_W'(a) * ACC_W'(b);
+        endcase
+        return acc;
+    endfunction
+
+    generate
+        for (genvar k = 0; k < NUM_MULS; k++) begin : g_mul
+            if (SIMD_EN) begin : g_simd
+                assign mul_p[k] = simd_mul(mul_a[k], mul_b[k], prec);
+            end else begin : g_full
+                assign mul_p[k] = ACC_W'(mul_a[k]) * ACC_W'(mul_b[k]);
+            end
+        end
+    endgenerate
+
+    /**
+     * @var acc_p
+     * @brief Productos de cada canal de acumulación
+     *
+     * El canal 0 son los productos `a_k·b_k` del banco compartido; con `SAM_EN` los canales 1 y 2
+     * elevan al cuadrado los mismos operandos de cada carril (`a_k²`, `b_k²`).
+     */
+    logic signed [ACC_W-1:0] acc_p [0:NUM_ACC-1][0:MUL_LANES-1];
+
+    generate
+        for (genvar k = 0; k < MUL_LANES; k++) begin : g_acc_p
+            assign acc_p[0][k] = mul_p[k];
+            if (SAM_EN) begin : g_sq
+                assign acc_p[1][k] = ACC_W'(mul_a[k]) * ACC_W'(mul_a[k]);
+                assign acc_p[2][k] = ACC_W'(mul_b[k]) * ACC_W'(mul_b[k]);
+            end
+        end
+    endgenerate
+
+    /**
+     * @brief Resultado del modo streaming y control valid/ready.
+     *
+     * OP_CROSS coloca las 3 componentes del producto vectorial; OP_DOT suma los `COMPONENTS_MAX`
+     * carriles del beat en un ciclo, le añade la suma parcial de los beats anteriores y deja el
+     * resultado en la componente menos significativa. OP_SAM hace lo mismo con sus tres canales y
+     * coloca `|a|²` y `|b|²` en las componentes `SAM_AA` y `SAM_BB`. Solo el último beat de cada
+     * píxel necesita hueco en la etapa de salida.
+     */
+    always_comb begin
+        for (int c = 0; c < NUM_ACC; c++) begin
+            stream_dot[c] = '0;
+            for (int k = 0; k < COMPONENTS_MAX; k++) stream_dot[c] = stream_dot[c] + acc_p[c][k];
+        end
+
+        for (int k = 0; k < COMPONENTS_MAX; k++) stream_res[k] = '0;
+        if (op_code == OP_CROSS) begin
+            for (int k = 0; k < 3; k++) stream_res[k] = ACC_W'(cross_res[k]);
+        end else begin
+            stream_res[0] = stream_acc[0] + stream_dot[0];
+            if (SAM_EN && op_code == OP_SAM) begin
+                stream_res[SAM_AA] = stream_acc[CH_AA] + stream_dot[CH_AA];
+                stream_res[SAM_BB] = stream_acc[CH_BB] + stream_dot[CH_BB];
+            end
+        end
+    end
+
+    /**
+     * @var post_in, post_k, post_idx, post_best, post_word
+     * @brief Escalado de la salida y etapa de postprocesado de OP_DOT
+     *
+     * - `post_in[k]`: Puntuación k del píxel que se escribe (`result` en WRITE, `stream_res` en STREAM),
+     *   devuelta a `COMPONENT_WIDTH` bits con `out_scale` en OP_DOT/OP_SAM (ver `scale_out`).
+     * - `post_k`: Puntuaciones válidas del píxel (`REF_SLOTS` con `ref_active`, 1 en otro caso).
+     * - `post_idx`, `post_best`: Índice y valor de la mayor puntuación (el menor índice si hay empate).
+     * - `post_word`: Palabra que se escribe en la FIFO de salida según `post_mode`.
+     */
+    localparam int POST_BEST = (COMPONENTS_MAX > 1) ? 1 : 0;
+
+    logic signed [COMPONENT_WIDTH-1:0]          post_in [0:COMPONENTS_MAX-1];
+    int                                         post_k;
+    logic [COMPONENT_WIDTH-1:0]                 post_idx;
+    logic signed [COMPONENT_WIDTH-1:0]          post_best;
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0]  post_word;
+
+    /**
+     * @brief Devuelve una suma de `ACC_W` bits al ancho de la FIFO: desplazamiento aritmético
+     * `sc[5:0]`, redondeo con `sc[6]` y saturación con `sc[7]` (truncado sin ella).
+     */
+    function automatic logic signed [COMPONENT_WIDTH-1:0] scale_out(
+        input logic signed [ACC_W-1:0] x,
+        input logic [7:0]              sc
+    );
+        logic signed [ACC_W-1:0] v;
+        v = x;
+        if (sc[6] && sc[5:0] != 6'd0) v = v + (ACC_W'(1) <<< (sc[5:0] - 6'd1));
+        v = v >>> sc[5:0];
+        if (sc[7]) begin
+            if (v > OUT_MAX)      v = OUT_MAX;
+            else if (v < OUT_MIN) v = OUT_MIN;
+        end
+        return COMPONENT_WIDTH'(v);
+    endfunction
+
+    always_comb begin
+        for (int k = 0; k < COMPONENTS_MAX; k++) begin
+            post_in[k] = (state == STREAM) ? COMPONENT_WIDTH'(stream_res[k]) : COMPONENT_WIDTH'(result[k]);
+            if (is_mac) post_in[k] = scale_out((state == STREAM) ? stream_res[k] : result[k], out_scale);
+        end
+        post_k = ref_active ? REF_SLOTS : 1;
+
+        post_idx  = '0;
+        post_best = post_in[0];
+        for (int k = 1; k < COMPONENTS_MAX; k++) begin
+            if (k < post_k && post_in[k] > post_best) begin
+                post_idx  = COMPONENT_WIDTH'(k);
+                post_best = post_in[k];
+            end
+        end
+
+        post_word = '0;
+        case (post_mode)
+            POST_ARGMAX: begin
+                // Con COMPONENTS_MAX = 1 solo cabe el índice
+                post_word[POST_BEST*COMPONENT_WIDTH +: COMPONENT_WIDTH] = post_best;
+                post_word[COMPONENT_WIDTH-1:0]                          = post_idx;
+            end
+            POST_THRESHOLD: begin
+                for (int k = 0; k < COMPONENTS_MAX && k < COMPONENT_WIDTH; k++) begin
+                    post_word[k] = (k < post_k) && (post_in[k] >= threshold);
+                end
+            end
+            default: begin
+                for (int k = 0; k < COMPONENTS_MAX; k++) post_word[k*COMPONENT_WIDTH +: COMPONENT_WIDTH] = post_in[k];
+            end
+        endcase
+    end
+
+    assign stream_last = (beat_base + beat_bands >= win_hi);
+    assign stream_head = FWFT ? (!in1_empty && !in2_empty) : stream_vld;
+    assign stream_adv  = (state == STREAM) && stream_head && (!stream_last || !out_wr_en || !out_full);
+    // Con FWFT la cabeza de las FIFOs es la etapa de entrada: se extrae al consumirse
+    assign stream_pop  = FWFT ? stream_adv :
+                         (state == STREAM) && !in1_empty && !in2_empty && (!stream_vld || stream_adv);
+    assign fsm_pop     = (state == CAPTURE) && in_avail;
+
+    /**
+     * @brief Captura del beat en vec1/vec2: en READ con lectura registrada o en el mismo ciclo de la
+     * extracción (CAPTURE) con FWFT.
+     */
+    logic capture_beat;
+    assign capture_beat = FWFT ? fsm_pop : (state == READ);
+
+    // Un resultado se acepta en la FIFO de salida cuando se escribe sin estar llena (o se almacena una referencia)
+    assign pixel_valid = (out_wr_en && !out_full) || ref_stored;
+
+    /**
+     * @brief Señales para los contadores de rendimiento del wrapper.
+     *
+     * `stall_in` se activa cuando el núcleo quiere un beat nuevo (CAPTURE, o STREAM con la etapa de
+     * entrada libre) y alguna FIFO de entrada que usa está vacía, o en REF_LOAD con la FIFO 2 vacía. `stall_out` se activa cuando hay un
+     * resultado pendiente de escribir (WRITE, o la etapa de salida de STREAM) y `out_full` lo retiene.
+     */
+    assign fsm_state = state;
+    assign stall_in  = ((state == CAPTURE) && !in_avail) ||
+                       ((in1_empty || in2_empty) && (state == STREAM && (!stream_head || stream_adv))) ||
+                       ((state == REF_LOAD) && in2_empty);
+    assign stall_out = out_full && ((state == WRITE) || (state == STREAM && out_wr_en));
+
+    /**
+     * @brief Árbol de sumadores segmentado.
+     *
+     * La etapa 0 registra los productos del bloque emitido; cada etapa siguiente suma pares de la
+     * anterior y el bit de validez avanza con los datos, igual que la referencia del bloque. La
+     * acumulación sobre `result[0]` (o `result[tree_ref]` con `ref_active`) se realiza en la FSM
+     * cuando la última etapa es válida.
+     */
+    always_ff @(posedge clk or negedge rst_n) begin
+        if (!rst_n) begin
+            tree_vld <= '0;
+        end else begin
+            tree_vld[0] <= dot_issue;
+            if (dot_issue) tree_ref[0] <= ref_idx;
+            for (int s = 1; s <= LOG_LANES; s++) tree_ref[s] <= tree_ref[s-1];
+            for (int c = 0; c < NUM_ACC; c++) begin
+                if (dot_issue) begin
+                    for (int k = 0; k < DOT_LANES; k++) tree_q[c][0][k] <= acc_p[c][k];
+                end
+                for (int s = 1; s <= LOG_LANES; s++) begin
+                    for (int j = 0; j < (DOT_LANES >> s); j++) begin
+                        tree_q[c][s][j] <= tree_q[c][s-1][2*j] + tree_q[c][s-1][2*j+1];
+                    end
+                end
+            end
+            for (int s = 1; s <= LOG_LANES; s++) tree_vld[s] <= tree_vld[s-1];
+        end
+    end
+
     always_ff @(posedge clk or negedge rst_n) begin
         if (!rst_n) begin
             state      <= IDLE;
-            in1_rd_en  <= 1'b0;
-            in2_rd_en  <= 1'b0;
             out_wr_en  <= 1'b0;
+            stream_vld <= 1'b0;
+            for (int c = 0; c < NUM_ACC; c++) stream_acc[c] <= '0;
             pixel_done <= 1'b0;
             error_code <= ERR_NONE;
+            band_base  <= '0;
+            beat_base  <= '0;
+            beat_bands_q <= '0;
+            ref_idx    <= '0;
+            beat_idx   <= '0;
+            ref_loaded <= 1'b0;
         end else begin
 
             state <= next_state;
 
+            // Acumulación de la salida del árbol (continúa entre beats de un mismo píxel)
+            if (tree_vld[LOG_LANES]) begin
+                if (ref_active) result[tree_ref[LOG_LANES]] <= result[tree_ref[LOG_LANES]] + tree_q[0][LOG_LANES][0];
+                else            result[0] <= result[0] + tree_q[0][LOG_LANES][0];
+                if (SAM_EN && op_code == OP_SAM) begin
+                    result[SAM_AA] <= result[SAM_AA] + tree_q[CH_AA][LOG_LANES][0];
+                    result[SAM_BB] <= result[SAM_BB] + tree_q[CH_BB][LOG_LANES][0];
+                end
+            end
+
             case (state)
                 IDLE: begin
-                    pixel_done <= !out_empty;
+                    // Un START descarta el pixel_done del trabajo anterior (p. ej. el de OP_REF_LOAD)
+                    pixel_done <= !start && (out_pending || ref_loaded);
+                    beat_base  <= win_base;
+                    beat_idx   <= '0;
+                    ref_idx    <= '0;
+                    for (int c = 0; c < NUM_ACC; c++) stream_acc[c] <= '0;
                     if (start) begin
-                        if(num_bands > COMPONENTS_MAX) begin
+                        ref_loaded <= 1'b0;
+                        error_code <= ERR_NONE;   // cada START sustituye el código del anterior
+                        if(!band_serial && num_bands > beat_max) begin
                             error_code <= ERR_BANDS;
                         end else begin   
-                            if ((op_code == OP_CROSS && num_bands == 3) || (op_code == OP_DOT && num_bands > 0)) begin
-                                if (!in1_empty && !in2_empty && !out_full) begin
-                                    in1_rd_en <= 1'b1;
-                                    in2_rd_en <= 1'b1;
-                                end else begin
-                                    if (in1_empty || in2_empty) begin
-                                        error_code <= ERR_INPUT_FIFO_EMPTY;
-                                    end else if (out_full) begin
-                                        error_code <= ERR_OUTPUT_FIFO_FULL;
-                                    end
+                            if (cfg_ok) begin
+                                if ((op_code == OP_REF_LOAD ? in2_empty : !in_avail) && !more_input) begin
+                                    error_code <= ERR_INPUT_FIFO_EMPTY;
+                                end else if (out_full) begin
+                                    error_code <= ERR_OUTPUT_FIFO_FULL;
                                 end
                             end else begin
                                 error_code <= ERR_OP;
@@ -318,37 +1262,38 @@ module hsi_vector_core #(
                     end
                 end
                 CAPTURE: begin
-                    in1_rd_en <= 1'b0;
-                    in2_rd_en <= 1'b0;
+                    // La palabra se extrae en este ciclo (fsm_pop); con FWFT se captura ya (capture_beat)
                 end
                 READ: begin
-                    for (i = 0; i < num_bands; i = i + 1) begin
-                        /* verilator lint_off BLKSEQ */
-                        vec1[num_bands - 1 - i] = in1_data_out[(i*COMPONENT_WIDTH) +: COMPONENT_WIDTH];
-                        vec2[num_bands - 1 - i] = in2_data_out[(i*COMPONENT_WIDTH) +: COMPONENT_WIDTH];
-                        /* verilator lint_on BLKSEQ */
-                    end
-                    for (i = 0; i < COMPONENTS_MAX; i = i + 1) result[i] <= 0;
-                    i = 0;
-
+                    // Captura de la palabra registrada por la FIFO (capture_beat, FWFT = 0)
                 end
                 COMPUTE: begin
                     if (op_code == OP_CROSS) begin
                         // Producto vectorial solo para 3 bandas
-                        result[2] <= vec1[1]*vec2[2] - vec1[2]*vec2[1];
-                        result[1] <= vec1[2]*vec2[0] - vec1[0]*vec2[2];
-                        result[0] <= vec1[0]*vec2[1] - vec1[1]*vec2[0];
-                    end else if (op_code == OP_DOT) begin
-                        result[0] <= result[0] + vec1[i]*vec2[i];
-                        i = i + 1;
+                        result[2] <= ACC_W'(cross_res[2]);
+                        result[1] <= ACC_W'(cross_res[1]);
+                        result[0] <= ACC_W'(cross_res[0]);
+                    end else if (is_mac) begin
+                        // Emisión de un bloque de DOT_LANES bandas por ciclo
+                        if (dot_issue) band_base <= band_base + DOT_LANES;
+                        if (ref_next) begin
+                            // Mismo beat contra la referencia siguiente
+                            ref_idx   <= ref_idx + 1'b1;
+                            band_base <= lane_lo;
+                        end else if (beat_done && !last_beat) begin
+                            // Beat completo pero no último: pasar al siguiente beat del píxel
+                            beat_base <= beat_base + beat_max;
+                            beat_idx  <= beat_idx + 1'b1;
+                        end
                     end
                 end
                 WRITE: begin
-                    // Concatenar resultado
-                    for (i = 0; i < num_bands; i = i + 1) begin
-                        out_data_in[i*COMPONENT_WIDTH +: COMPONENT_WIDTH] <= result[i];
-                    end
-                    out_wr_en   <= 1'b1;
+                    // Concatenar resultado (tras el postprocesado)
+                    out_data_in <= post_word;
+                    // Solo se escribe con hueco en la FIFO para no duplicar el resultado
+                    out_wr_en   <= !out_full;
+                    beat_base   <= win_base;
+                    beat_idx    <= '0;
                 end
                 WRITE_DONE: begin
                     out_wr_en <= 1'b0;
@@ -356,25 +1301,85 @@ module hsi_vector_core #(
                 ERROR: begin
                     // Se mantiene el error hasta nuevo start
                 end
+                STREAM: begin
+                    // Etapa de salida: se carga con el píxel completado o se libera al escribirse
+                    if (stream_adv && stream_last) begin
+                        out_data_in <= post_word;
+                        out_wr_en   <= 1'b1;
+                    end else if (!out_full) begin
+                        out_wr_en   <= 1'b0;
+                    end
+                    // Seguimiento de beats y suma parcial del píxel en curso
+                    if (stream_adv) begin
+                        if (stream_last) begin
+                            beat_base  <= win_base;
+                            for (int c = 0; c < NUM_ACC; c++) stream_acc[c] <= '0;
+                        end else begin
+                            beat_base  <= beat_base + beat_max;
+                            for (int c = 0; c < NUM_ACC; c++) stream_acc[c] <= stream_acc[c] + stream_dot[c];
+                        end
+                    end
+                    // Etapa de entrada: válida tras cada lectura de las FIFOs
+                    if (stream_pop)      stream_vld <= 1'b1;
+                    else if (stream_adv) stream_vld <= 1'b0;
+                end
+                REF_LOAD: begin
+                    // Cada beat extraído se escribe en ref_mem[ref_idx][beat_idx] (ref_we)
+                    if (ref_stored) begin
+                        beat_base <= win_base;
+                        beat_idx  <= '0;
+                        ref_idx   <= ref_idx + 1'b1;
+                        if (ref_last) ref_loaded <= 1'b1;
+                    end else if (ref_pop) begin
+                        beat_base <= beat_base + beat_max;
+                        beat_idx  <= beat_idx + 1'b1;
+                    end
+                end
                 default: begin
                     error_code <= ERR_INVALID_FSM; // Error por estado desconocido
                 end
             endcase
+
+            if (capture_beat) begin
+                for (i = 0; i < COMPONENTS_MAX; i = i + 1) begin
+                    vec1[i] <= in1_vec[i];
+                    vec2[i] <= in2_vec[i];
+                end
+                // El resultado solo se reinicia con el primer beat del píxel
+                if (beat_base == win_base) begin
+                    for (i = 0; i < COMPONENTS_MAX; i = i + 1) result[i] <= 0;
+                end
+                beat_bands_q <= beat_bands;
+                band_base    <= lane_lo;
+                ref_idx      <= '0;
+            end
         end
     end
     // logica de transición de estados
     always_comb begin
         next_state = state;
         case (state)
-            IDLE:    if (start && error_code == ERR_NONE && ((op_code == OP_CROSS && num_bands == 3) || (op_code == OP_DOT && num_bands > 0)) && !out_full) next_state = CAPTURE;
+            IDLE:    if (start && cfg_ok && !out_full) begin
+                         if (op_code == OP_REF_LOAD)          next_state = REF_LOAD;
+                         else if (stream_mode && !ref_active) next_state = STREAM;
+                         else                                 next_state = CAPTURE;
+                     end
                      else if (start && error_code != ERR_NONE) next_state = ERROR;
-            CAPTURE: if(!in1_empty && !in2_empty ) next_state = READ;
+            CAPTURE: if (in_avail) next_state = FWFT ? COMPUTE : READ;
+                     else if (!more_input && beat_base == win_base) next_state = IDLE;
             READ:    next_state = COMPUTE;
-            COMPUTE: if((op_code == OP_CROSS) || (op_code == OP_DOT && i >= num_bands)) next_state = WRITE;
+            COMPUTE: if (op_code == OP_CROSS) next_state = WRITE;
+                     else if (is_mac && beat_end) begin
+                         if (!last_beat)         next_state = CAPTURE;
+                         else if (!tree_pending) next_state = WRITE;
+                     end
             WRITE:   if(!out_full) next_state = WRITE_DONE;
-            WRITE_DONE: if(!in1_empty && !in2_empty) next_state = CAPTURE;
+            WRITE_DONE: if (in_avail || more_input) next_state = CAPTURE;
                         else next_state = IDLE;
             ERROR:   if (!start) next_state = IDLE;
+            STREAM:  if ((in1_empty || in2_empty) && !more_input && !stream_head && !out_wr_en && beat_base == win_base) next_state = IDLE;
+            REF_LOAD: if (ref_stored && ref_last) next_state = IDLE;
+                      else if (in2_empty && !more_input) next_state = IDLE;
             default: next_state = ERROR;
         endcase
     end
@@ -28,6 +28,83 @@
  *    - 0x04: Registro NUM_BANDS  [RW] - Número de bandas espectrales (ancho NUM_BANDS_WIDTH)
  *    - 0x08: Registro START      [WO] - Escribir 1 para iniciar procesamiento (auto-limpia)
  *    - 0x0C: Registro STATUS     [RO] - Bit 0: flag pixel_done, Bits [8:1]: error_code
+ *    - 0x10: Registro FIFO_STATUS [RO] - Flags full/empty/almost_full/almost_empty de las FIFOs (si EXPOSE_FIFO_STATUS=1)
+ *    - 0x14: Registro CONFIG     [RW] - Bit 0: STREAM (modo streaming del núcleo), Bit 1: BAND_SERIAL,
+ *                                       Bit 2: REF_MODE (OP_DOT contra el banco de referencias del núcleo),
+ *                                       Bits [4:3]: POST (postprocesado de OP_DOT: 0 ninguno, 1 ARGMAX, 2 THRESHOLD),
+ *                                       Bits [6:5]: PREC (muestras por componente: 0 una, 1 dos, 2 cuatro),
+ *                                       Bits [15:8]: OUT_SCALE de OP_DOT/OP_SAM ([13:8] SHIFT, 14 ROUND, 15 SAT)
+ *    - 0x18: Registro DMA_SRC1   [RW] - Dirección de la fuente 1 del DMA (si EXPOSE_DMA=1)
+ *    - 0x1C: Registro DMA_SRC2   [RW] - Dirección de la fuente 2 del DMA (si EXPOSE_DMA=1)
+ *    - 0x20: Registro DMA_DST    [RW] - Dirección de destino del DMA (si EXPOSE_DMA=1)
+ *    - 0x24: Registro PIXEL_COUNT [RW] - Número de píxeles de un trabajo (0 = un START por píxel)
+ *    - 0x28: Registro DMA_STRIDE [RW] - Bits [15:0]: stride de entrada, [31:16]: stride de salida, en bytes (si EXPOSE_DMA=1)
+ *    - 0x2C: Registro PROCESSED_COUNT [RO] - Resultados producidos desde el último START
+ *    - 0x30: Registro IRQ_ENABLE [RW] - Máscara de fuentes de interrupción
+ *    - 0x34: Registro IRQ_STATUS [RW1C] - Fuentes de interrupción pendientes (escribir 1 para limpiar)
+ *    - 0x38: Registro IRQ_LEVEL  [RW] - Bits [15:0]: umbral almost_full, [31:16]: umbral almost_empty de las FIFOs
+ *    - 0x3C: Registro PERF_CTRL  [WO] - Bit 0: CLEAR, pone a cero todos los contadores (si EXPOSE_PERF=1)
+ *    - 0x40 - 0x70: Contadores de rendimiento [RO] (si EXPOSE_PERF=1):
+ *        - 0x40 PERF_BUSY: ciclos con la FSM del núcleo fuera de IDLE
+ *        - 0x44 PERF_PIXELS: resultados escritos en la FIFO de salida
+ *        - 0x48 PERF_STALL_IN: ciclos esperando datos con alguna FIFO de entrada vacía
+ *        - 0x4C PERF_STALL_OUT: ciclos con un resultado retenido por out_full
+ *        - 0x50 + 4*s: ciclos en el estado s de la FSM (IDLE, CAPTURE, READ, COMPUTE, WRITE,
+ *          WRITE_DONE, ERROR, STREAM, REF_LOAD)
+ *    - 0x74: Registro FIFO_LEVEL_IN [RO] - Bits [15:0]: ocupación de la FIFO 1, [31:16]: de la FIFO 2 (si EXPOSE_FIFO_STATUS=1)
+ *    - 0x78: Registro FIFO_LEVEL_OUT [RO] - Bits [15:0]: ocupación de la FIFO de salida (si EXPOSE_FIFO_STATUS=1)
+ *    - 0x7C: Registro DESC_STATUS [RO] - Bits [7:0]: descriptores en cola, [15:8]: trabajos de la cola
+ *                                       terminados desde el último CLEAR_DONE, bit 16: cola llena (si DESC_DEPTH>0)
+ *    - 0x80: Registro THRESHOLD  [RW] - Umbral con signo de CONFIG.POST = THRESHOLD (se usan los
+ *                                       COMPONENT_WIDTH bits menos significativos)
+ *    - 0x84: Registro BAND_WINDOW [RW] - Bits [15:0]: primera banda, [31:16]: número de bandas de la
+ *                                       ventana (0 = todas las NUM_BANDS)
+ *    - 0x100 + 8*c: Registro PERF_CORE_PIXELS(c) [RO] - Resultados del núcleo c (si EXPOSE_PERF=1, c < NUM_CORES)
+ *    - 0x104 + 8*c: Registro PERF_CORE_BUSY(c) [RO] - Ciclos del núcleo c fuera de IDLE (si EXPOSE_PERF=1, c < NUM_CORES)
+ *
+ * Los contadores son de 32 bits, cuentan continuamente desde el reset (desbordan sin saturar) y
+ * solo se ponen a cero con PERF_CTRL.CLEAR. Comparando PERF_STALL_IN y PERF_STALL_OUT con
+ * PERF_BUSY se distingue un trabajo limitado por la entrada de datos de uno limitado por el cálculo.
+ * Con varios núcleos (`NUM_CORES` > 1) los contadores PERF_CORE_* muestran el reparto del trabajo;
+ * PERF_PIXELS sigue contando los resultados de todos ellos.
+ *
+ * Con PIXEL_COUNT = N > 0 un único START mantiene el núcleo activo (`job_active_o`) hasta que
+ * `pixel_valid_i` ha señalado N resultados; solo entonces se activa DONE y se libera BUSY. Con
+ * PIXEL_COUNT = 0 se mantiene el comportamiento original (DONE con el primer `pixel_done_i`).
+ *
+ * Cola de descriptores (`DESC_DEPTH` > 0): OP_CODE, NUM_BANDS, CONFIG, THRESHOLD, BAND_WINDOW, PIXEL_COUNT y los registros
+ * DMA_* son registros sombra. COMMAND.ENQUEUE (bit 4) copia su valor actual, junto con el bit
+ * DMA_START de la misma escritura, como un descriptor en una FIFO de `DESC_DEPTH` entradas; los bits
+ * START de esa escritura se ignoran y, con la cola llena, la escritura responde con `err_o`. Cuando
+ * el núcleo y el DMA quedan libres y no hay error, el wrapper extrae el siguiente descriptor, lo
+ * aplica a las salidas hacia el núcleo y el DMA y genera START (y DMA_START si se pidió) sin
+ * intervención del firmware, que puede reprogramar los registros sombra durante el trabajo. Cada
+ * trabajo de la cola activa DONE al terminar, que se limpia con el START del siguiente; el lote ha
+ * terminado con DONE activo, BUSY inactivo y DESC_STATUS[7:0] = 0. Un START directo (COMMAND.START
+ * o DMA_START sin ENQUEUE) vuelve a aplicar los registros sombra. Un error detiene la cola, que
+ * conserva los descriptores pendientes, mientras STATUS.ERROR esté activo; tras CLEAR_ERROR continúa
+ * con el siguiente descriptor. Los trabajos encolados deben usar PIXEL_COUNT > 0 o DMA: con
+ * PIXEL_COUNT = 0, un resultado del trabajo anterior sin leer activaría DONE de inmediato.
+ *
+ * Fuentes de interrupción (IRQ_ENABLE / IRQ_STATUS); `irq_o = |(IRQ_STATUS & IRQ_ENABLE)`:
+ *    - Bit 0 DONE: flanco de subida de STATUS.DONE (fin de píxel o de trabajo).
+ *    - Bit 1 ERROR: flanco de subida de STATUS.ERROR (código distinto de cero).
+ *    - Bit 2 OUT_LEVEL: almost_full de la FIFO de salida, al menos IRQ_LEVEL[15:0] resultados (por nivel).
+ *    - Bit 3 IN_LEVEL: almost_empty de ambas FIFOs de entrada, como mucho IRQ_LEVEL[31:16] palabras (por nivel).
+ * Las fuentes por nivel se reactivan mientras la condición se mantenga. Tras reset IRQ_LEVEL vale
+ * 0x0000_0001 (un resultado disponible / FIFOs de entrada vacías).
+ *
+ * Los umbrales de IRQ_LEVEL salen por `fifo_af_level_o` / `fifo_ae_level_o` hacia las FIFOs, que
+ * calculan `almost_full` (ocupación >= umbral) y `almost_empty` (ocupación <= umbral) con los mismos
+ * valores para las tres. Un productor puede programar el umbral almost_full como
+ * `FIFO_DEPTH - ráfaga + 1` y escribir una ráfaga completa mientras FIFO_STATUS indique que la FIFO
+ * de entrada no está almost_full, sin consultar `full` antes de cada palabra.
+ *
+ * FIFO_STATUS: Bit 0 IN1_FULL, Bit 1 IN2_FULL, Bit 2 OUT_FULL, Bit 3 OUT_EMPTY, Bit 4 IN1_EMPTY,
+ * Bit 5 IN2_EMPTY, Bits [8:6] ALMOST_FULL {OUT, IN2, IN1}, Bits [11:9] ALMOST_EMPTY {OUT, IN2, IN1}.
+ *
+ * COMMAND: Bit 0 START, Bit 1 CLEAR_DONE, Bit 2 CLEAR_ERROR, Bit 3 DMA_START, Bit 4 ENQUEUE.
+ * STATUS: Bit 0 DONE, Bits [4:1] ERROR, Bit 8 BUSY, Bit 9 DMA_BUSY, Bit 10 DMA_DONE.
  *
  * La interfaz OBI sigue el protocolo estándar con señales req_i, we_i, be_i, addr_i, wdata_i,
  * gnt_o, rvalid_o, rdata_o y err_o.
@@ -48,9 +125,38 @@
  * | err_o          | output    | Indicador de error en la transacción.                                      |
  * | op_code_o      | output    | Código de operación hacia el núcleo (producto vectorial o escalar).        |
  * | num_bands_o    | output    | Número de bandas espectrales hacia el núcleo.                              |
- * | start_o        | output    | Pulso de inicio de operación hacia el núcleo.                              |
- * | pixel_done_i   | input     | Señal que indica que el núcleo completó un cálculo.                        |
- * | error_code_i   | input     | Código de error proveniente del núcleo.                                    |
+ * | band_first_o   | output    | Primera banda de la ventana (BAND_WINDOW[15:0]).                           |
+ * | band_count_o   | output    | Bandas de la ventana, 0 = todas (BAND_WINDOW[31:16]).                      |
+ * | stream_mode_o  | output    | Modo streaming del núcleo (CONFIG.STREAM).                                 |
+ * | band_serial_o  | output    | Entrada de píxeles en beats sucesivos (CONFIG.BAND_SERIAL).                |
+ * | ref_mode_o     | output    | OP_DOT contra el banco de referencias (CONFIG.REF_MODE).                   |
+ * | post_mode_o    | output    | Postprocesado de OP_DOT (CONFIG.POST).                                     |
+ * | threshold_o    | output    | Umbral del postprocesado THRESHOLD (registro THRESHOLD).                   |
+ * | prec_o         | output    | Empaquetado de muestras por componente (CONFIG.PREC).                      |
+ * | out_scale_o    | output    | Escalado de la salida MAC {SAT, ROUND, SHIFT} (CONFIG[15:8]).              |
+ * | start_o        | output    | Inicio de operación hacia el núcleo; activo hasta que start_ready_i = 1.   |
+ * | start_ready_i  | input     | START aceptado por el núcleo (1 fijo sin cruce de dominio).                |
+ * | pixel_done_i   | input     | Fin de cálculo del núcleo; solo cuenta con BUSY, tras el ciclo de START.   |
+ * | pixel_valid_i  | input     | Pulso por cada resultado escrito por el núcleo (PROCESSED_COUNT).          |
+ * | job_active_o   | output    | Trabajo de PIXEL_COUNT píxeles en curso: el núcleo espera más datos.       |
+ * | error_code_i   | input     | Código de error del núcleo; se registra con BUSY, tras el ciclo de START.  |
+ * | dma_*_o        | output    | Direcciones y strides del DMA.                                             |
+ * | pixel_count_o  | output    | Número de píxeles del trabajo (PIXEL_COUNT), usado también por el DMA.     |
+ * | dma_start_o    | output    | Pulso de inicio del DMA (COMMAND.DMA_START).                               |
+ * | dma_done_i     | input     | Pulso de fin de transferencia del DMA.                                     |
+ * | core_state_i   | input     | Estado de la FSM del núcleo (contadores de rendimiento).                   |
+ * | stall_in_i     | input     | El núcleo espera datos en las FIFOs de entrada.                            |
+ * | stall_out_i    | input     | El núcleo tiene un resultado retenido por out_full.                        |
+ * | core_valid_i   | input     | Pulso de resultado de cada núcleo (PERF_CORE_PIXELS).                      |
+ * | core_busy_i    | input     | Núcleo fuera de IDLE, uno por núcleo (PERF_CORE_BUSY).                     |
+ * | in1_level_i    | input     | Ocupación de la FIFO de entrada 1.                                         |
+ * | in2_level_i    | input     | Ocupación de la FIFO de entrada 2.                                         |
+ * | out_level_i    | input     | Ocupación de la FIFO de salida.                                            |
+ * | almost_full_i  | input     | almost_full de {salida, entrada 2, entrada 1}.                             |
+ * | almost_empty_i | input     | almost_empty de {salida, entrada 2, entrada 1}.                            |
+ * | fifo_af_level_o| output    | Umbral almost_full de las FIFOs (IRQ_LEVEL[15:0]).                         |
+ * | fifo_ae_level_o| output    | Umbral almost_empty de las FIFOs (IRQ_LEVEL[31:16]).                       |
+ * | irq_o          | output    | Línea de interrupción (activa en alto).                                    |
  */
  
 
@@ -59,7 +165,11 @@ module hsi_vector_core_wrapper #(
     parameter int NUM_BANDS_WIDTH     = 32,
     parameter int ERR_WIDTH           = 4,
     parameter bit READ_CLEAR_DONE     = 0,
-    parameter bit EXPOSE_FIFO_STATUS  = 0
+    parameter bit EXPOSE_FIFO_STATUS  = 0,
+    parameter bit EXPOSE_DMA          = 0,
+    parameter bit EXPOSE_PERF         = 0,
+    parameter int NUM_CORES           = 1,
+    parameter int DESC_DEPTH          = 4
 ) (
     input  logic                     clk_i,
     input  logic                     rst_ni,
@@ -80,10 +190,32 @@ module hsi_vector_core_wrapper #(
     // Señales hacia el núcleo
     output logic [OP_CODE_WIDTH-1:0] op_code_o,
     output logic [NUM_BANDS_WIDTH-1:0] num_bands_o,
+    output logic [15:0]              band_first_o,
+    output logic [15:0]              band_count_o,
+    output logic                     stream_mode_o,
+    output logic                     band_serial_o,
+    output logic                     ref_mode_o,
+    output logic [1:0]               post_mode_o,
+    output logic [31:0]              threshold_o,
+    output logic [1:0]               prec_o,
+    output logic [7:0]               out_scale_o,
     output logic                     start_o,
+    input  logic                     start_ready_i,
+    output logic                     job_active_o,
+
+    // Configuración del DMA
+    output logic [31:0]              dma_src1_addr_o,
+    output logic [31:0]              dma_src2_addr_o,
+    output logic [31:0]              dma_dst_addr_o,
+    output logic [31:0]              pixel_count_o,
+    output logic [15:0]              dma_src_stride_o,
+    output logic [15:0]              dma_dst_stride_o,
+    output logic                     dma_start_o,
+    input  logic                     dma_done_i,
 
     // Señales desde el núcleo
     input  logic                     pixel_done_i,
+    input  logic                     pixel_valid_i,
     input  logic [ERR_WIDTH-1:0]     error_code_i,
 
     // FIFO status
@@ -92,7 +224,26 @@ module hsi_vector_core_wrapper #(
     input  logic                     out_full_i,
     input  logic                     out_empty_i,
     input  logic                     in1_empty_i,
-    input  logic                     in2_empty_i
+    input  logic                     in2_empty_i,
+
+    // Contadores de rendimiento
+    /* verilator lint_off UNUSED */
+    input  logic [3:0]               core_state_i,
+    input  logic                     stall_in_i,
+    input  logic                     stall_out_i,
+    input  logic [NUM_CORES-1:0]     core_valid_i,
+    input  logic [NUM_CORES-1:0]     core_busy_i,
+    /* verilator lint_on UNUSED */
+
+    // Ocupación de las FIFOs e interrupción
+    input  logic [15:0]              in1_level_i,
+    input  logic [15:0]              in2_level_i,
+    input  logic [15:0]              out_level_i,
+    input  logic [2:0]               almost_full_i,
+    input  logic [2:0]               almost_empty_i,
+    output logic [15:0]              fifo_af_level_o,
+    output logic [15:0]              fifo_ae_level_o,
+    output logic                     irq_o
 );
 
         // ============================================================================
@@ -100,11 +251,54 @@ module hsi_vector_core_wrapper #(
      *  @brief Direcciones en bytes alineadas a palabra de 32 bits.
      *  @{
      */
-    localparam logic [5:0] ADDR_OPCODE      = 6'h00;  /**< Dirección del registro OP_CODE (RW). */
-    localparam logic [5:0] ADDR_NUM_BANDS   = 6'h04;  /**< Dirección del registro NUM_BANDS (RW). */
-    localparam logic [5:0] ADDR_COMMAND     = 6'h08;  /**< Dirección del registro COMMAND (WO): start, clear_done, clear_error. */
-    localparam logic [5:0] ADDR_STATUS      = 6'h0C;  /**< Dirección del registro STATUS (RO): done, error, busy. */
-    localparam logic [5:0] ADDR_FIFO_STATUS = 6'h10;  /**< Dirección del registro FIFO_STATUS (RO, si EXPOSE_FIFO_STATUS=1). */
+    localparam logic [8:0] ADDR_OPCODE      = 9'h000;  /**< Dirección del registro OP_CODE (RW). */
+    localparam logic [8:0] ADDR_NUM_BANDS   = 9'h004;  /**< Dirección del registro NUM_BANDS (RW). */
+    localparam logic [8:0] ADDR_COMMAND     = 9'h008;  /**< Dirección del registro COMMAND (WO): start, clear_done, clear_error. */
+    localparam logic [8:0] ADDR_STATUS      = 9'h00C;  /**< Dirección del registro STATUS (RO): done, error, busy. */
+    localparam logic [8:0] ADDR_FIFO_STATUS = 9'h010;  /**< Dirección del registro FIFO_STATUS (RO, si EXPOSE_FIFO_STATUS=1). */
+    localparam logic [8:0] ADDR_CONFIG      = 9'h014;  /**< Dirección del registro CONFIG (RW): modo de funcionamiento del núcleo. */
+    localparam logic [8:0] ADDR_DMA_SRC1    = 9'h018;  /**< Dirección del registro DMA_SRC1 (RW, si EXPOSE_DMA=1). */
+    localparam logic [8:0] ADDR_DMA_SRC2    = 9'h01C;  /**< Dirección del registro DMA_SRC2 (RW, si EXPOSE_DMA=1). */
+    localparam logic [8:0] ADDR_DMA_DST     = 9'h020;  /**< Dirección del registro DMA_DST (RW, si EXPOSE_DMA=1). */
+    localparam logic [8:0] ADDR_PIXEL_COUNT = 9'h024;  /**< Dirección del registro PIXEL_COUNT (RW): píxeles por trabajo. */
+    localparam logic [8:0] ADDR_DMA_STRIDE  = 9'h028;  /**< Dirección del registro DMA_STRIDE (RW, si EXPOSE_DMA=1). */
+    localparam logic [8:0] ADDR_PROCESSED   = 9'h02C;  /**< Dirección del registro PROCESSED_COUNT (RO): resultados del trabajo. */
+    localparam logic [8:0] ADDR_IRQ_ENABLE  = 9'h030;  /**< Dirección del registro IRQ_ENABLE (RW). */
+    localparam logic [8:0] ADDR_IRQ_STATUS  = 9'h034;  /**< Dirección del registro IRQ_STATUS (RW1C). */
+    localparam logic [8:0] ADDR_IRQ_LEVEL   = 9'h038;  /**< Dirección del registro IRQ_LEVEL (RW): umbrales almost_full / almost_empty. */
+    localparam logic [8:0] ADDR_PERF_CTRL   = 9'h03C;  /**< Dirección del registro PERF_CTRL (WO, si EXPOSE_PERF=1): bit 0 CLEAR. */
+    localparam logic [8:0] ADDR_PERF_BASE   = 9'h040;  /**< Primer contador de rendimiento (RO, si EXPOSE_PERF=1). */
+    localparam logic [8:0] ADDR_FIFO_LEVEL_IN  = 9'h074;  /**< Dirección del registro FIFO_LEVEL_IN (RO, si EXPOSE_FIFO_STATUS=1). */
+    localparam logic [8:0] ADDR_FIFO_LEVEL_OUT = 9'h078;  /**< Dirección del registro FIFO_LEVEL_OUT (RO, si EXPOSE_FIFO_STATUS=1). */
+    localparam logic [8:0] ADDR_DESC_STATUS = 9'h07C;  /**< Dirección del registro DESC_STATUS (RO, si DESC_DEPTH>0). */
+    localparam logic [8:0] ADDR_THRESHOLD   = 9'h080;  /**< Dirección del registro THRESHOLD (RW): umbral del postprocesado. */
+    localparam logic [8:0] ADDR_BAND_WINDOW = 9'h084;  /**< Dirección del registro BAND_WINDOW (RW): ventana de bandas. */
+    localparam logic [8:0] ADDR_CORE_BASE   = 9'h100;  /**< PERF_CORE_PIXELS(0); cada núcleo ocupa 8 bytes (RO, si EXPOSE_PERF=1). */
+    /** @} */
+
+    /** @name Fuentes de interrupción
+     *  @brief Posición de cada fuente en IRQ_ENABLE / IRQ_STATUS.
+     *  @{
+     */
+    localparam int IRQ_DONE      = 0;  /**< Fin de píxel o de trabajo. */
+    localparam int IRQ_ERROR     = 1;  /**< Error capturado del núcleo. */
+    localparam int IRQ_OUT_LEVEL = 2;  /**< FIFO de salida por encima del umbral. */
+    localparam int IRQ_IN_LEVEL  = 3;  /**< FIFOs de entrada por debajo del umbral. */
+    /** @} */
+
+    /** @name Contadores de rendimiento
+     *  @brief Índice de cada contador; el contador k se lee en ADDR_PERF_BASE + 4*k.
+     *  @{
+     */
+    localparam int PERF_BUSY      = 0;   /**< Ciclos con la FSM del núcleo fuera de IDLE. */
+    localparam int PERF_PIXELS    = 1;   /**< Resultados escritos en la FIFO de salida. */
+    localparam int PERF_STALL_IN  = 2;   /**< Ciclos esperando datos en las FIFOs de entrada. */
+    localparam int PERF_STALL_OUT = 3;   /**< Ciclos detenidos por out_full. */
+    localparam int PERF_STATE0    = 4;   /**< Ciclos en el estado 0 de la FSM; le siguen los demás estados. */
+    localparam int PERF_STATES    = 9;   /**< Número de estados de la FSM del núcleo (IDLE .. REF_LOAD). */
+    localparam int PERF_NUM       = PERF_STATE0 + PERF_STATES;
+    localparam int CORE_MAX       = 16;  /**< Núcleos direccionables en 0x100 - 0x17C. */
+    localparam int CORE_NUM       = (NUM_CORES < CORE_MAX) ? NUM_CORES : CORE_MAX; /**< Núcleos con PERF_CORE_*. */
     /** @} */
 
     // ============================================================================
@@ -114,10 +308,32 @@ module hsi_vector_core_wrapper #(
      */
     logic [OP_CODE_WIDTH-1:0]     op_code_reg;      /**< Registro de código de operación configurado. */
     logic [NUM_BANDS_WIDTH-1:0]   num_bands_reg;    /**< Registro del número de bandas configurado. */
+    logic                         stream_mode_reg;  /**< CONFIG.STREAM: modo streaming del núcleo. */
+    logic                         band_serial_reg;  /**< CONFIG.BAND_SERIAL: píxeles en beats de COMPONENTS_MAX bandas. */
+    logic                         ref_mode_reg;     /**< CONFIG.REF_MODE: segundo operando desde el banco de referencias. */
+    logic [1:0]                   post_mode_reg;    /**< CONFIG.POST: postprocesado de OP_DOT. */
+    logic [31:0]                  threshold_reg;    /**< Umbral del postprocesado THRESHOLD. */
+    logic [31:0]                  band_window_reg;  /**< BAND_WINDOW: {número de bandas, primera banda}. */
+    logic [1:0]                   prec_reg;         /**< CONFIG.PREC: muestras empaquetadas por componente. */
+    logic [7:0]                   out_scale_reg;    /**< CONFIG.OUT_SCALE: {SAT, ROUND, SHIFT} de la salida MAC. */
     logic                         start_pulse_reg;  /**< Pulso de inicio de operación hacia el núcleo. */
     logic                         done_flag_reg;    /**< Bandera que indica operación finalizada. */
     logic [ERR_WIDTH-1:0]         error_code_reg;   /**< Último código de error recibido del núcleo. */
     logic                         busy_reg;         /**< Bandera que indica núcleo ocupado. */
+    logic [31:0]                  dma_src1_reg;     /**< Dirección de la fuente 1 del DMA. */
+    logic [31:0]                  dma_src2_reg;     /**< Dirección de la fuente 2 del DMA. */
+    logic [31:0]                  dma_dst_reg;      /**< Dirección de destino del DMA. */
+    logic [31:0]                  pixel_count_reg;  /**< Número de píxeles del trabajo (0 = un píxel por START). */
+    logic [31:0]                  processed_reg;    /**< Resultados producidos desde el último START. */
+    logic [31:0]                  dma_stride_reg;   /**< Strides de entrada ([15:0]) y salida ([31:16]) del DMA. */
+    logic                         dma_start_reg;    /**< Pulso de inicio hacia el DMA. */
+    logic                         dma_busy_reg;     /**< Bandera que indica DMA ocupado. */
+    logic                         dma_done_reg;     /**< Bandera que indica transferencia DMA finalizada. */
+    logic [3:0]                   irq_enable_reg;   /**< Máscara de fuentes de interrupción. */
+    logic [3:0]                   irq_status_reg;   /**< Fuentes de interrupción pendientes. */
+    logic [31:0]                  irq_level_reg;    /**< Umbrales de salida ([15:0]) y entrada ([31:16]). */
+    logic                         done_flag_d;      /**< DONE del ciclo anterior (detección de flanco). */
+    logic                         error_flag_d;     /**< ERROR del ciclo anterior (detección de flanco). */
     /** @} */
 
     // ============================================================================
@@ -125,7 +341,7 @@ module hsi_vector_core_wrapper #(
      *  @brief Retienen información relevante de la transacción durante una respuesta.
      *  @{
      */
-    logic [5:0] addr_lat;      /**< Dirección latched de la transacción (6 bits significativos). */
+    logic [8:0] addr_lat;      /**< Dirección latched de la transacción (9 bits significativos). */
     logic       we_lat;        /**< Bandera latched de escritura (1: write, 0: read). */
     logic       bus_err_lat;   /**< Bandera latched de error detectado durante la transacción. */
     /** @} */
@@ -140,18 +356,26 @@ module hsi_vector_core_wrapper #(
      * del maestro OBI. La FSM tiene dos estados y gestiona las señales `gnt_o`, `rvalid_o`, `err_o` y `rdata_o`
      * según la fase de la transacción.
      *
+     * El esclavo está segmentado: `gnt_o` sigue a `req_i` en ambos estados, de modo que una nueva petición
+     * se concede en el mismo ciclo en que se devuelve `rvalid_o` de la anterior (una transacción pendiente
+     * como máximo). Peticiones consecutivas permanecen en S_RESP y se sirven a razón de una por ciclo.
+     * Las escrituras se aplican en el ciclo de concesión y la respuesta de una lectura refleja el estado
+     * de los registros tras todas las escrituras concedidas antes que ella.
+     *
      * @dot
      * digraph FSM {
      *   rankdir=LR;
      *   node [shape=ellipse, style=filled, fillcolor=lightgray];
 
      *   S_IDLE -> S_RESP [ label="req_i" ];
-     *   S_RESP -> S_IDLE [ label="always (respuesta enviada)" ];
+     *   S_RESP -> S_RESP [ label="req_i (respuesta enviada y nueva concesión)" ];
+     *   S_RESP -> S_IDLE [ label="!req_i (respuesta enviada)" ];
      * }
      * @enddot
      *
      * - `S_IDLE`: Estado de espera. Otorga `gnt_o` cuando `req_i` está activo.
-     * - `S_RESP`: Estado de respuesta. Produce `rvalid_o`, `err_o`, y `rdata_o` según la dirección latched.
+     * - `S_RESP`: Estado de respuesta. Produce `rvalid_o`, `err_o`, y `rdata_o` según la dirección latched
+     *   y otorga `gnt_o` a la siguiente petición si `req_i` está activo.
      *
      * La respuesta puede incluir:
      * - Código de operación (`ADDR_OPCODE`)
@@ -201,7 +425,8 @@ module hsi_vector_core_wrapper #(
      * @details
      * Esta lógica combinacional detecta si la dirección recibida en `addr_i` se corresponde con un
      * registro implementado dentro del wrapper. Si la dirección es válida, `addr_valid_comb` se activa.
-     * La dirección ADDR_FIFO_STATUS solo es válida si el parámetro `EXPOSE_FIFO_STATUS` está activado.
+     * La dirección ADDR_FIFO_STATUS solo es válida si el parámetro `EXPOSE_FIFO_STATUS` está activado y
+ * los registros del DMA solo si `EXPOSE_DMA` está activado.
      *
      * | Dirección         | Registro        | Condición                   |
      * |-------------------|------------------|------------------------------|
@@ -210,25 +435,253 @@ module hsi_vector_core_wrapper #(
      * | 0x08              | COMMAND         | Siempre válida               |
      * | 0x0C              | STATUS          | Siempre válida               |
      * | 0x10              | FIFO_STATUS     | Válida solo si expuesta      |
+     * | 0x14              | CONFIG          | Siempre válida               |
+ * | 0x18 - 0x20       | DMA_SRC/DST     | Válidas solo si EXPOSE_DMA   |
+ * | 0x24              | PIXEL_COUNT     | Siempre válida               |
+ * | 0x28              | DMA_STRIDE      | Válida solo si EXPOSE_DMA    |
+ * | 0x2C              | PROCESSED_COUNT | Siempre válida               |
+ * | 0x30 - 0x38       | IRQ_*           | Siempre válidas              |
+ * | 0x3C - 0x70       | PERF_*          | Válidas solo si EXPOSE_PERF  |
+ * | 0x74 - 0x78       | FIFO_LEVEL_*    | Válidas solo si expuesta     |
+ * | 0x7C              | DESC_STATUS     | Válida solo si DESC_DEPTH>0  |
+ * | 0x80              | THRESHOLD       | Siempre válida               |
+ * | 0x84              | BAND_WINDOW     | Siempre válida               |
+ * | 0x100 - 0x17C     | PERF_CORE_*     | Válidas si EXPOSE_PERF y c < NUM_CORES |
      */
     logic addr_valid_comb;
 
+    /**
+     * @brief Indica si una dirección corresponde a uno de los PERF_NUM contadores de rendimiento.
+     */
+    function automatic logic is_perf_addr (input logic [8:0] a);
+        is_perf_addr = (a >= ADDR_PERF_BASE) && (a < ADDR_PERF_BASE + 9'(4*PERF_NUM)) && (a[1:0] == 2'b00);
+    endfunction
+
+    /**
+     * @brief Indica si una dirección corresponde a un contador PERF_CORE_* de un núcleo instanciado.
+     */
+    function automatic logic is_core_addr (input logic [8:0] a);
+        is_core_addr = (a >= ADDR_CORE_BASE) && (a < ADDR_CORE_BASE + 9'(8*CORE_NUM)) && (a[1:0] == 2'b00);
+    endfunction
+
     always_comb begin
-        unique case (addr_i[5:0])
+        unique case (addr_i[8:0])
             ADDR_OPCODE,
             ADDR_NUM_BANDS,
             ADDR_COMMAND,
-            ADDR_STATUS:      addr_valid_comb = 1'b1;
-            ADDR_FIFO_STATUS: addr_valid_comb = (EXPOSE_FIFO_STATUS) ? 1'b1 : 1'b0;
-            default:          addr_valid_comb = 1'b0;
+            ADDR_STATUS,
+            ADDR_CONFIG,
+            ADDR_PIXEL_COUNT,
+            ADDR_PROCESSED,
+            ADDR_IRQ_ENABLE,
+            ADDR_IRQ_STATUS,
+            ADDR_IRQ_LEVEL,
+            ADDR_THRESHOLD,
+            ADDR_BAND_WINDOW: addr_valid_comb = 1'b1;
+            ADDR_FIFO_STATUS,
+            ADDR_FIFO_LEVEL_IN,
+            ADDR_FIFO_LEVEL_OUT: addr_valid_comb = (EXPOSE_FIFO_STATUS) ? 1'b1 : 1'b0;
+            ADDR_DMA_SRC1,
+            ADDR_DMA_SRC2,
+            ADDR_DMA_DST,
+            ADDR_DMA_STRIDE:  addr_valid_comb = (EXPOSE_DMA) ? 1'b1 : 1'b0;
+            ADDR_PERF_CTRL:   addr_valid_comb = (EXPOSE_PERF) ? 1'b1 : 1'b0;
+            ADDR_DESC_STATUS: addr_valid_comb = (DESC_DEPTH > 0) ? 1'b1 : 1'b0;
+            default:          addr_valid_comb = EXPOSE_PERF && (is_perf_addr(addr_i[8:0]) || is_core_addr(addr_i[8:0]));
         endcase
     end
 
 
+    /**
+     * @brief Cola de descriptores de trabajo.
+     *
+     * @details
+     * Cada descriptor es una copia de los registros sombra en el momento de COMMAND.ENQUEUE. El
+     * descriptor en curso (`cur_desc`) alimenta las salidas hacia el núcleo y el DMA mientras
+     * `cur_valid` está activo; un START directo lo desactiva y las salidas vuelven a seguir a los
+     * registros sombra, como sin cola.
+     */
+    typedef struct packed {
+        logic [OP_CODE_WIDTH-1:0]   op_code;
+        logic [NUM_BANDS_WIDTH-1:0] num_bands;
+        logic [14:0]                cfg;          /**< {OUT_SCALE, PREC, POST, REF_MODE, BAND_SERIAL, STREAM}. */
+        logic [31:0]                threshold;
+        logic [31:0]                band_window;
+        logic [31:0]                pixel_count;
+        logic [31:0]                dma_src1;
+        logic [31:0]                dma_src2;
+        logic [31:0]                dma_dst;
+        logic [31:0]                dma_stride;
+        logic                       dma;          /**< Lanzar también el DMA. */
+    } desc_t;
+
+    localparam int DESC_LW = (DESC_DEPTH > 0) ? $clog2(DESC_DEPTH) + 1 : 1;
+
+    desc_t              shadow_desc;   /**< Registros sombra en formato de descriptor. */
+    desc_t              head_desc;     /**< Cabeza de la cola (FWFT). */
+    desc_t              cur_desc;      /**< Descriptor del trabajo lanzado desde la cola. */
+    logic               cur_valid;     /**< Las salidas siguen a `cur_desc`. */
+    logic               desc_full, desc_empty;
+    logic [DESC_LW-1:0] desc_level;
+    logic               desc_push, desc_pop, desc_reject;
+    logic               cmd_wr;        /**< Escritura concedida de COMMAND en este ciclo. */
+    logic [7:0]         desc_done_cnt; /**< Trabajos de la cola terminados desde CLEAR_DONE. */
+    logic [31:0]        job_count;     /**< PIXEL_COUNT del trabajo en curso. */
+    logic               job_end;       /**< El trabajo en curso termina en este ciclo. */
+
+    assign shadow_desc = '{op_code: op_code_reg, num_bands: num_bands_reg,
+                           cfg: {out_scale_reg, prec_reg, post_mode_reg, ref_mode_reg, band_serial_reg, stream_mode_reg},
+                           threshold: threshold_reg, band_window: band_window_reg,
+                           pixel_count: pixel_count_reg, dma_src1: dma_src1_reg, dma_src2: dma_src2_reg,
+                           dma_dst: dma_dst_reg, dma_stride: dma_stride_reg, dma: wdata_i[3]};
+
+    assign cmd_wr      = gnt_o && we_i && addr_valid_comb && addr_i[8:0] == ADDR_COMMAND && be_i[0];
+    assign desc_push   = cmd_wr && wdata_i[4] && !desc_full;
+    assign desc_reject = cmd_wr && wdata_i[4] && desc_full;
+    assign desc_pop    = !desc_empty && !cmd_wr && !busy_reg && !dma_busy_reg && !start_pulse_reg &&
+                         !dma_start_reg && error_code_reg == 0;
+
+    generate
+        if (DESC_DEPTH > 0) begin : g_desc
+            fifo_cache #(.WIDTH($bits(desc_t)), .DEPTH(DESC_DEPTH), .FWFT(1)) i_desc_fifo (
+                .clk(clk_i), .rst_n(rst_ni),
+                .wr_en(desc_push), .rd_en(desc_pop),
+                .data_in(shadow_desc), .data_out(head_desc),
+                .full(desc_full), .empty(desc_empty),
+                .level(desc_level),
+                .af_level('0), .ae_level('0),
+                /* verilator lint_off PINCONNECTEMPTY */
+                .almost_full(), .almost_empty()
+                /* verilator lint_on PINCONNECTEMPTY */
+            );
+        end else begin : g_no_desc
+            assign head_desc  = '0;
+            assign desc_full  = 1'b1;
+            assign desc_empty = 1'b1;
+            assign desc_level = '0;
+        end
+    endgenerate
+
     // Asignaciones a core
-    assign op_code_o   = op_code_reg;
-    assign num_bands_o = num_bands_reg;
-    assign start_o     = start_pulse_reg;
+    assign op_code_o     = cur_valid ? cur_desc.op_code   : op_code_reg;
+    assign num_bands_o   = cur_valid ? cur_desc.num_bands : num_bands_reg;
+    assign band_first_o  = cur_valid ? cur_desc.band_window[15:0]  : band_window_reg[15:0];
+    assign band_count_o  = cur_valid ? cur_desc.band_window[31:16] : band_window_reg[31:16];
+    assign stream_mode_o = cur_valid ? cur_desc.cfg[0]    : stream_mode_reg;
+    assign band_serial_o = cur_valid ? cur_desc.cfg[1]    : band_serial_reg;
+    assign ref_mode_o    = cur_valid ? cur_desc.cfg[2]    : ref_mode_reg;
+    assign post_mode_o   = cur_valid ? cur_desc.cfg[4:3]  : post_mode_reg;
+    assign threshold_o   = cur_valid ? cur_desc.threshold : threshold_reg;
+    assign prec_o        = cur_valid ? cur_desc.cfg[6:5]  : prec_reg;
+    assign out_scale_o   = cur_valid ? cur_desc.cfg[14:7] : out_scale_reg;
+    assign start_o       = start_pulse_reg;
+    assign job_count     = cur_valid ? cur_desc.pixel_count : pixel_count_reg;
+    assign job_active_o  = busy_reg && (job_count != 0);
+    assign job_end       = busy_reg && ((pixel_done_i && job_count == 0 && !start_pulse_reg) ||
+                                        (pixel_valid_i && job_count != 0 && processed_reg + 1 >= job_count));
+    assign irq_o        = |(irq_status_reg & irq_enable_reg);
+
+    /**
+     * @brief Umbrales hacia las FIFOs; sus indicadores almost_* alimentan las fuentes por nivel.
+     */
+    assign fifo_af_level_o = irq_level_reg[15:0];
+    assign fifo_ae_level_o = irq_level_reg[31:16];
+
+    /**
+     * @brief Activación y limpieza (W1C) de IRQ_STATUS; la activación tiene prioridad.
+     */
+    logic [3:0] irq_set, irq_clr;
+    assign irq_set[IRQ_DONE]      = done_flag_reg && !done_flag_d;
+    assign irq_set[IRQ_ERROR]     = (error_code_reg != 0) && !error_flag_d;
+    assign irq_set[IRQ_OUT_LEVEL] = almost_full_i[2];
+    assign irq_set[IRQ_IN_LEVEL]  = almost_empty_i[0] && almost_empty_i[1];
+    assign irq_clr = (gnt_o && we_i && addr_i[8:0] == ADDR_IRQ_STATUS && be_i[0]) ?
+                     wdata_i[3:0] : 4'h0;
+
+    /**
+     * @brief Contadores de rendimiento del núcleo.
+     *
+     * @details
+     * Cuentan ciclo a ciclo a partir del estado de la FSM del núcleo y de sus señales de bloqueo, sin
+     * depender de BUSY ni de PIXEL_COUNT, por lo que también reflejan el modo de un START por píxel.
+     * La escritura de PERF_CTRL con el bit 0 a 1 los pone a cero en el ciclo de concesión. Con
+     * `EXPOSE_PERF = 0` no se implementan y se leen como cero.
+     */
+    logic [31:0] perf_cnt [0:PERF_NUM-1];
+    logic        perf_clr;
+    logic [3:0]  perf_idx;
+    assign perf_clr = gnt_o && we_i && addr_valid_comb && addr_i[8:0] == ADDR_PERF_CTRL && be_i[0] && wdata_i[0];
+    assign perf_idx = 4'(addr_lat[8:2] - ADDR_PERF_BASE[8:2]);
+
+    /**
+     * @brief Contadores por núcleo: resultados (pulsos de `core_valid_i`) y ciclos fuera de IDLE.
+     *
+     * Las entradas se extienden a CORE_MAX con ceros; los contadores de núcleos no instanciados
+     * no se incrementan nunca.
+     */
+    logic [31:0]         core_pix_cnt  [0:CORE_MAX-1];
+    logic [31:0]         core_busy_cnt [0:CORE_MAX-1];
+    logic [CORE_MAX-1:0] core_valid_w, core_busy_w;
+    logic [3:0]          core_idx;
+    assign core_valid_w = CORE_MAX'(core_valid_i);
+    assign core_busy_w  = CORE_MAX'(core_busy_i);
+    assign core_idx     = addr_lat[6:3];
+
+    generate
+        if (EXPOSE_PERF) begin : g_perf
+            always_ff @(posedge clk_i or negedge rst_ni) begin
+                if (!rst_ni) begin
+                    for (int k = 0; k < PERF_NUM; k++) perf_cnt[k] <= '0;
+                end else if (perf_clr) begin
+                    for (int k = 0; k < PERF_NUM; k++) perf_cnt[k] <= '0;
+                end else begin
+                    if (core_state_i != 4'd0) perf_cnt[PERF_BUSY]      <= perf_cnt[PERF_BUSY] + 1;
+                    if (pixel_valid_i)        perf_cnt[PERF_PIXELS]    <= perf_cnt[PERF_PIXELS] + 1;
+                    if (stall_in_i)           perf_cnt[PERF_STALL_IN]  <= perf_cnt[PERF_STALL_IN] + 1;
+                    if (stall_out_i)          perf_cnt[PERF_STALL_OUT] <= perf_cnt[PERF_STALL_OUT] + 1;
+                    for (int k = 0; k < PERF_STATES; k++) begin
+                        if (int'(core_state_i) == k) perf_cnt[PERF_STATE0+k] <= perf_cnt[PERF_STATE0+k] + 1;
+                    end
+                end
+            end
+
+            always_ff @(posedge clk_i or negedge rst_ni) begin
+                if (!rst_ni) begin
+                    for (int c = 0; c < CORE_MAX; c++) begin
+                        core_pix_cnt[c]  <= '0;
+                        core_busy_cnt[c] <= '0;
+                    end
+                end else if (perf_clr) begin
+                    for (int c = 0; c < CORE_MAX; c++) begin
+                        core_pix_cnt[c]  <= '0;
+                        core_busy_cnt[c] <= '0;
+                    end
+                end else begin
+                    for (int c = 0; c < CORE_MAX; c++) begin
+                        if (core_valid_w[c]) core_pix_cnt[c]  <= core_pix_cnt[c] + 1;
+                        if (core_busy_w[c])  core_busy_cnt[c] <= core_busy_cnt[c] + 1;
+                    end
+                end
+            end
+        end else begin : g_no_perf
+            always_comb begin
+                for (int k = 0; k < PERF_NUM; k++) perf_cnt[k] = '0;
+                for (int c = 0; c < CORE_MAX; c++) begin
+                    core_pix_cnt[c]  = '0;
+                    core_busy_cnt[c] = '0;
+                end
+            end
+        end
+    endgenerate
+
+    // Asignaciones al DMA
+    assign dma_src1_addr_o   = cur_valid ? cur_desc.dma_src1 : dma_src1_reg;
+    assign dma_src2_addr_o   = cur_valid ? cur_desc.dma_src2 : dma_src2_reg;
+    assign dma_dst_addr_o    = cur_valid ? cur_desc.dma_dst  : dma_dst_reg;
+    assign pixel_count_o     = job_count;
+    assign dma_src_stride_o  = cur_valid ? cur_desc.dma_stride[15:0]  : dma_stride_reg[15:0];
+    assign dma_dst_stride_o  = cur_valid ? cur_desc.dma_stride[31:16] : dma_stride_reg[31:16];
+    assign dma_start_o       = dma_start_reg;
 
     // FSM combinacional
     always_comb begin
@@ -257,6 +710,8 @@ module hsi_vector_core_wrapper #(
                             s[0]   = done_flag_reg;
                             s[4:1] = error_code_reg;
                             s[8]   = busy_reg;
+                            s[9]   = dma_busy_reg;
+                            s[10]  = dma_done_reg;
                             rdata_o = s;
                         end
                         ADDR_FIFO_STATUS: if (EXPOSE_FIFO_STATUS) begin
@@ -267,12 +722,36 @@ module hsi_vector_core_wrapper #(
                             f[3] = out_empty_i;
                             f[4] = in1_empty_i;
                             f[5] = in2_empty_i;
+                            f[8:6]  = almost_full_i;
+                            f[11:9] = almost_empty_i;
                             rdata_o = f;
                         end
-                        default: rdata_o = 32'h0;
+                        ADDR_FIFO_LEVEL_IN:  if (EXPOSE_FIFO_STATUS) rdata_o = {in2_level_i, in1_level_i};
+                        ADDR_FIFO_LEVEL_OUT: if (EXPOSE_FIFO_STATUS) rdata_o = {16'h0, out_level_i};
+                        ADDR_CONFIG:    rdata_o = {16'h0, out_scale_reg, 1'b0, prec_reg, post_mode_reg, ref_mode_reg, band_serial_reg, stream_mode_reg};
+                        ADDR_THRESHOLD: rdata_o = threshold_reg;
+                        ADDR_BAND_WINDOW: rdata_o = band_window_reg;
+                        ADDR_DMA_SRC1:    rdata_o = dma_src1_reg;
+                        ADDR_DMA_SRC2:    rdata_o = dma_src2_reg;
+                        ADDR_DMA_DST:     rdata_o = dma_dst_reg;
+                        ADDR_PIXEL_COUNT: rdata_o = pixel_count_reg;
+                        ADDR_DMA_STRIDE:  rdata_o = dma_stride_reg;
+                        ADDR_PROCESSED:   rdata_o = processed_reg;
+                        ADDR_IRQ_ENABLE:  rdata_o = {28'h0, irq_enable_reg};
+                        ADDR_IRQ_STATUS:  rdata_o = {28'h0, irq_status_reg};
+                        ADDR_IRQ_LEVEL:   rdata_o = irq_level_reg;
+                        ADDR_PERF_CTRL:   rdata_o = 32'h0;
+                        ADDR_DESC_STATUS: if (DESC_DEPTH > 0) rdata_o = {15'h0, desc_full, desc_done_cnt, 8'(desc_level)};
+                        default: begin
+                            if (EXPOSE_PERF && is_perf_addr(addr_lat))      rdata_o = perf_cnt[perf_idx];
+                            else if (EXPOSE_PERF && is_core_addr(addr_lat)) rdata_o = addr_lat[2] ? core_busy_cnt[core_idx]
+                                                                                                  : core_pix_cnt[core_idx];
+                        end
                     endcase
                 end
-                state_d = S_IDLE;
+                // Concesión de la siguiente petición en el mismo ciclo de la respuesta
+                gnt_o   = req_i;
+                state_d = req_i ? S_RESP : S_IDLE;
             end
         endcase
     end
@@ -283,23 +762,49 @@ module hsi_vector_core_wrapper #(
             state_q         <= S_IDLE;
             op_code_reg     <= '0;
             num_bands_reg   <= '0;
+            stream_mode_reg <= 1'b0;
+            band_serial_reg <= 1'b0;
+            ref_mode_reg    <= 1'b0;
+            post_mode_reg   <= 2'd0;
+            threshold_reg   <= '0;
+            band_window_reg <= '0;
+            prec_reg        <= 2'd0;
+            out_scale_reg   <= 8'd0;
             start_pulse_reg <= 1'b0;
             done_flag_reg   <= 1'b0;
             error_code_reg  <= '0;
             busy_reg        <= 1'b0;
+            dma_src1_reg    <= '0;
+            dma_src2_reg    <= '0;
+            dma_dst_reg     <= '0;
+            pixel_count_reg <= '0;
+            processed_reg   <= '0;
+            irq_enable_reg  <= '0;
+            irq_status_reg  <= '0;
+            irq_level_reg   <= 32'h0000_0001;
+            done_flag_d     <= 1'b0;
+            error_flag_d    <= 1'b0;
+            dma_stride_reg  <= '0;
+            dma_start_reg   <= 1'b0;
+            dma_busy_reg    <= 1'b0;
+            dma_done_reg    <= 1'b0;
             addr_lat        <= '0;
             we_lat          <= 1'b0;
             bus_err_lat     <= 1'b0;
+            cur_desc        <= '0;
+            cur_valid       <= 1'b0;
+            desc_done_cnt   <= '0;
         end else begin
             state_q <= state_d;
-            if (start_pulse_reg) start_pulse_reg <= 1'b0; // pulso 1 ciclo
+            if (start_pulse_reg && start_ready_i) start_pulse_reg <= 1'b0; // pulso hasta su aceptación
+            if (dma_start_reg)   dma_start_reg   <= 1'b0;
 
-            if (state_q == S_IDLE && req_i) begin
-                addr_lat    <= addr_i[5:0];
+            if (gnt_o) begin
+                addr_lat    <= addr_i[8:0];
                 we_lat      <= we_i;
-                bus_err_lat <= ~addr_valid_comb;
+                bus_err_lat <= ~addr_valid_comb || desc_reject;
                 if (we_i && addr_valid_comb) begin
-                    unique case (addr_i[5:0])
+                    unique case (addr_i[8:0])
                         ADDR_OPCODE: begin
                             if (be_i[0]) op_code_reg <= wdata_i[OP_CODE_WIDTH-1:0];
                         end
@@ -308,21 +813,52 @@ module hsi_vector_core_wrapper #(
                             logic [31:0] new_nb = apply_be(num_bands_reg, wdata_i, be_i);
                             num_bands_reg <= new_nb[NUM_BANDS_WIDTH-1:0];
                         end
+                        ADDR_CONFIG: begin
+                            if (be_i[0]) begin
+                                stream_mode_reg <= wdata_i[0];
+                                band_serial_reg <= wdata_i[1];
+                                ref_mode_reg    <= wdata_i[2];
+                                post_mode_reg   <= wdata_i[4:3];
+                                prec_reg        <= wdata_i[6:5];
+                            end
+                            if (be_i[1]) out_scale_reg <= wdata_i[15:8];
+                        end
+                        ADDR_DMA_SRC1:    dma_src1_reg    <= apply_be(dma_src1_reg, wdata_i, be_i);
+                        ADDR_DMA_SRC2:    dma_src2_reg    <= apply_be(dma_src2_reg, wdata_i, be_i);
+                        ADDR_DMA_DST:     dma_dst_reg     <= apply_be(dma_dst_reg, wdata_i, be_i);
+                        ADDR_PIXEL_COUNT: pixel_count_reg <= apply_be(pixel_count_reg, wdata_i, be_i);
+                        ADDR_DMA_STRIDE:  dma_stride_reg  <= apply_be(dma_stride_reg, wdata_i, be_i);
+                        ADDR_THRESHOLD:   threshold_reg   <= apply_be(threshold_reg, wdata_i, be_i);
+                        ADDR_BAND_WINDOW: band_window_reg <= apply_be(band_window_reg, wdata_i, be_i);
+                        ADDR_IRQ_ENABLE:  if (be_i[0]) irq_enable_reg <= wdata_i[3:0];
+                        ADDR_IRQ_STATUS:  ; // W1C, ver irq_clr
+                        ADDR_PERF_CTRL:   ; // ver perf_clr
+                        ADDR_IRQ_LEVEL:   irq_level_reg   <= apply_be(irq_level_reg, wdata_i, be_i);
                         ADDR_COMMAND: begin
-                            logic [2:0] cmd;
+                            logic [4:0] cmd;                             // {ENQUEUE, DMA_START, CLEAR_ERROR, CLEAR_DONE, START}
                             /* verilator lint_off UNUSED*/
                             logic [31:0] tmp_full;
                             /* verilator lint_on UNUSED*/
-                            logic [2:0]  tmp;
                             tmp_full = apply_be(32'h0, wdata_i, be_i);
-                            tmp      = tmp_full[2:0];
-                            cmd = tmp[2:0];
-                            if (cmd[1]) done_flag_reg  <= 1'b0;          // CLEAR_DONE
+                            cmd      = tmp_full[4:0];
+                            if (cmd[1]) begin                            // CLEAR_DONE
+                                done_flag_reg <= 1'b0;
+                                dma_done_reg  <= 1'b0;
+                                desc_done_cnt <= '0;
+                            end
                             if (cmd[2]) error_code_reg <= '0;            // CLEAR_ERROR
-                            if (cmd[0] && !busy_reg) begin               // START
+                            if (cmd[0] && !cmd[4] && !busy_reg) begin    // START
                                 start_pulse_reg <= 1'b1;
                                 done_flag_reg   <= 1'b0;
                                 busy_reg        <= 1'b1;
+                                processed_reg   <= '0;
+                                cur_valid       <= 1'b0;
+                            end
+                            if (cmd[3] && !cmd[4] && EXPOSE_DMA && !dma_busy_reg) begin // DMA_START
+                                dma_start_reg <= 1'b1;
+                                dma_done_reg  <= 1'b0;
+                                dma_busy_reg  <= 1'b1;
+                                cur_valid     <= 1'b0;
                             end
                         end
                         default: ; // RO
@@ -330,18 +866,54 @@ module hsi_vector_core_wrapper #(
                 end
             end
 
-            // Estado del núcleo
-            if (error_code_i != 0) begin
+            // Estado del núcleo: el código de error solo cuenta con un trabajo en curso y después del
+            // ciclo de START (el núcleo conserva el último código hasta el siguiente START)
+            if (error_code_i != 0 && busy_reg && !start_pulse_reg) begin
                 error_code_reg <= error_code_i;
                 busy_reg       <= 1'b0;
             end
-            if (pixel_done_i) begin
+            // Igual que el código de error: un pixel_done anterior (p. ej. de OP_REF_LOAD) no cierra
+            // el trabajo recién lanzado
+            if (pixel_done_i && job_count == 0 && busy_reg && !start_pulse_reg) begin
                 done_flag_reg <= 1'b1;
                 busy_reg      <= 1'b0;
             end
+            if (pixel_valid_i) begin
+                processed_reg <= processed_reg + 1;
+                // Fin de trabajo: DONE solo con el último de los PIXEL_COUNT resultados
+                if (busy_reg && job_count != 0 && processed_reg + 1 >= job_count) begin
+                    done_flag_reg <= 1'b1;
+                    busy_reg      <= 1'b0;
+                end
+            end
+            if (job_end && cur_valid) desc_done_cnt <= desc_done_cnt + 1'b1;
 
-            if (READ_CLEAR_DONE && state_q == S_RESP && !we_lat && addr_lat==ADDR_STATUS && rvalid_o)
+            // Siguiente descriptor de la cola: se aplica y se lanza como un START (+ DMA_START)
+            if (desc_pop) begin
+                cur_desc        <= head_desc;
+                cur_valid       <= 1'b1;
+                start_pulse_reg <= 1'b1;
+                done_flag_reg   <= 1'b0;
+                busy_reg        <= 1'b1;
+                processed_reg   <= '0;
+                if (head_desc.dma && EXPOSE_DMA) begin
+                    dma_start_reg <= 1'b1;
+                    dma_done_reg  <= 1'b0;
+                    dma_busy_reg  <= 1'b1;
+                end
+            end
+            if (dma_done_i) begin
+                dma_done_reg <= 1'b1;
+                dma_busy_reg <= 1'b0;
+            end
+
+            if (READ_CLEAR_DONE && !we_lat && addr_lat==ADDR_STATUS && rvalid_o)
                 done_flag_reg <= 1'b0;
+
+            // Interrupciones
+            done_flag_d    <= done_flag_reg;
+            error_flag_d   <= (error_code_reg != 0);
+            irq_status_reg <= (irq_status_reg & ~irq_clr) | irq_set;
         end
     end
 
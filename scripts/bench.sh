@@ -0,0 +1,25 @@
+#!/bin/bash
+# Throughput de simulación de hsi_accel_obi_tb con el perfil perf de Verilator.
+# Uso: scripts/bench.sh <píxeles> <hilos>...   (normalmente a través de `make bench`)
+set -euo pipefail
+
+PIXELS=${1:?píxeles}
+shift
+THREADS=${*:-1}
+LOG_DIR=build_bench
+mkdir -p "$LOG_DIR"
+
+printf "%-8s %12s %12s %10s %14s %14s\n" threads pixels cycles wall_s cycles/s pixels/s
+for t in $THREADS; do
+  log="$LOG_DIR/hsi_obi_t$t.log"
+  make --no-print-directory hsi_obi PROFILE=perf THREADS="$t" \
+       SIM_ARGS="+bench=$PIXELS +sim_stats +max_time=0" > "$log" 2>&1 \
+    || { echo "threads=$t: fallo, ver $log" >&2; exit 1; }
+  bench=$(grep '^\[BENCH\]' "$log" | tail -n1)
+  stats=$(grep '^\[sim_main\] sim_time=' "$log" | tail -n1)
+  px=$(sed -E 's/.*pixels=([0-9]+).*/\1/' <<< "$bench")
+  cyc=$(sed -E 's/.*total_cycles=([0-9]+).*/\1/' <<< "$bench")
+  wall=$(sed -E 's/.*wall_s=([0-9.]+).*/\1/' <<< "$stats")
+  awk -v t="$t" -v p="$px" -v c="$cyc" -v w="$wall" \
+      'BEGIN { printf "%-8s %12d %12d %10.3f %14.0f %14.0f\n", t, p, c, w, c / w, p / w }'
+done
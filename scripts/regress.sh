@@ -0,0 +1,89 @@
+#!/bin/bash
+# Regresión con semillas en paralelo sobre los binarios ya compilados en <build_dir>/<target>/.
+# Uso: scripts/regress.sh <build_dir> <reg_dir> <jobs> <seed0> <seeds> <golden> <target>...
+#      (normalmente a través de `make regress`)
+# Cada ejecución corre en <reg_dir>/<target>/seed_<n>/, con su propio sim.log, logs/ y coverage.dat,
+# de modo que ninguna pisa a otra. Al final se combinan las coberturas en <reg_dir>/coverage.dat.
+# Los testbench sin estímulo aleatorio son deterministas y solo corren la semilla <seed0>.
+set -euo pipefail
+
+BUILD_DIR=${1:?build_dir}
+REG_DIR=${2:?reg_dir}
+JOBS=${3:?jobs}
+SEED0=${4:?seed0}
+SEEDS=${5:?seeds}
+GOLDEN=${6:?golden}
+shift 6
+TARGETS=${*:?targets}
+
+declare -A TOP=(
+  [fifo_cache]=Vfifo_cache_tb
+  [hsi_core]=Vhsi_vector_core_tb
+  [hsi_wrapper]=Vhsi_vector_core_wrapper_tb
+  [hsi_obi]=Vhsi_accel_obi_tb
+  [hsi_obi_cpp]=Vhsi_accel_obi
+)
+
+# Targets cuyo estímulo depende de la semilla ($urandom o +seed=)
+declare -A RANDOM_STIM=(
+  [fifo_cache]=1
+  [hsi_obi_cpp]=1
+)
+
+rm -rf "$REG_DIR"
+mkdir -p "$REG_DIR"
+REG_DIR=$(cd "$REG_DIR" && pwd)
+BUILD_DIR=$(cd "$BUILD_DIR" && pwd)
+
+for t in $TARGETS; do
+  [[ -n "${TOP[$t]:-}" ]] || { echo "regress: target desconocido '$t'" >&2; exit 2; }
+  [[ -x "$BUILD_DIR/$t/${TOP[$t]}" ]] || { echo "regress: falta $BUILD_DIR/$t/${TOP[$t]}" >&2; exit 2; }
+done
+
+# Una ejecución: PASS si termina con estado 0 y el log no contiene fallos
+run_one() {
+  local t=$1 seed=$2 bin=$3
+  local dir="$REG_DIR/$t/seed_$seed"
+  local args="+notrace +verilator+seed+$seed"
+  [[ $t == hsi_obi_cpp ]] && args="$args +seed=$seed +golden=$GOLDEN"
+  mkdir -p "$dir"
+  local t0=$SECONDS status=0
+  (cd "$dir" && "$bin" $args) > "$dir/sim.log" 2>&1 || status=$?
+  if [[ $status -eq 0 ]] && grep -qE '\[FAIL\]|FAILED|%Error' "$dir/sim.log"; then status=1; fi
+  local res=PASS
+  [[ $status -eq 0 ]] || res=FAIL
+  printf "%-12s %6s %-4s %4ds\n" "$t" "$seed" "$res" $((SECONDS - t0)) | tee "$dir/result"
+}
+export -f run_one
+export REG_DIR GOLDEN
+
+echo "regress: $SEEDS semillas desde $SEED0 para: $TARGETS ($JOBS procesos; una sola en los deterministas)"
+for t in $TARGETS; do
+  n=$SEEDS
+  [[ -n "${RANDOM_STIM[$t]:-}" ]] || n=1
+  for ((s = SEED0; s < SEED0 + n; s++)); do
+    echo "$t $s $BUILD_DIR/$t/${TOP[$t]}"
+  done
+done | xargs -P "$JOBS" -L 1 bash -c 'run_one "$@"' _
+
+echo
+printf "%-12s %6s %6s\n" target pass fail
+fails=0
+for t in $TARGETS; do
+  p=$(cat "$REG_DIR/$t"/seed_*/result | grep -c ' PASS ' || true)
+  f=$(cat "$REG_DIR/$t"/seed_*/result | grep -c ' FAIL ' || true)
+  fails=$((fails + f))
+  printf "%-12s %6d %6d\n" "$t" "$p" "$f"
+done
+for r in $(grep -l ' FAIL ' "$REG_DIR"/*/seed_*/result || true); do
+  echo "  fallo: $(dirname "$r")/sim.log"
+done
+
+# El perfil perf no instrumenta cobertura: no hay nada que combinar
+mapfile -t cov < <(find "$REG_DIR" -name coverage.dat -path '*/seed_*' | sort)
+if [[ ${#cov[@]} -gt 0 ]]; then
+  verilator_coverage --write "$REG_DIR/coverage.dat" --write-info "$REG_DIR/coverage.info" "${cov[@]}"
+  echo "regress: ${#cov[@]} coberturas combinadas en $REG_DIR/coverage.dat"
+fi
+
+[[ $fails -eq 0 ]]
@@ -0,0 +1,1298 @@
+/**
+ * @file hsi_accel_obi_main.cpp
+ * @brief Banco de pruebas en C++ dirigido por ciclos para `hsi_accel_obi`.
+ *
+ * @details
+ * Instancia directamente el modelo Verilator de `hsi_accel_obi` (sin testbench SystemVerilog ni
+ * `--timing`), genera `clk_i` desde C++ y modela la memoria esclava del puerto DMA. Las tareas
+ * `obi_write`, `obi_read`, `push_vectors`, `wait_result` y `mem_write_pixel` reproducen ciclo a ciclo
+ * las de `tb/hsi_accel_obi_tb.sv`, de modo que las secuencias de prueba se trasladan línea a línea.
+ * El programa termina en cuanto se completa la secuencia y devuelve 1 si algún requisito falla.
+ *
+ * Se compila con `make hsi_obi_cpp`, que fija `COMPONENT_WIDTH = 16`, `COMPONENTS_MAX = 3`,
+ * `FIFO_DEPTH = OBI_FIFO_DEPTH` (8 por defecto) y `DMA_EN = 1` con `-G`, igual que la instancia `dut`
+ * del testbench SV; con esos valores los puertos de píxel son de 48 bits (`QData` en Verilator). La
+ * misma profundidad llega al banco como `HSI_FIFO_DEPTH`.
+ *
+ * Requisitos validados (mismos identificadores que `hsi_accel_obi_tb`):
+ * - R1.2: CROSS con 3 bandas.
+ * - R2.2: DOT con 3 bandas, sólo la componente Z no nula.
+ * - R4.1: Modo streaming: 3 píxeles DOT con un único START.
+ * - R5.1: Modo band-serial: píxel DOT de 7 bandas en 3 beats.
+ * - R6.1: DMA: 3 píxeles DOT leídos de memoria y resultados escritos en DST.
+ * - R7.1: Trabajo de PIXEL_COUNT = 3 píxeles: DONE solo tras el último y PROCESSED_COUNT = 3.
+ * - R12.1: OP_REF_LOAD por DMA: PERF_STATE(REF_LOAD) cuenta la carga y PERF_STATE(1..8) suma PERF_BUSY.
+ *
+ * Con `+cube=<cubo.hdr>` no se ejecutan los requisitos: los píxeles de un cubo ENVI (`hsi_envi_cube.h`)
+ * se envían en modo STREAM | BAND_SERIAL a `in1_data_i` y, como segundo operando en `in2_data_i`, los
+ * de `+cube2=<cubo.hdr>` (mismas dimensiones) o el píxel `+ref_pixel=<n>` del primer cubo. El cubo
+ * se lee de la proyección en memoria beat a beat, y cada resultado se escribe en cuanto sale de la
+ * FIFO, así que ni la entrada ni la salida llegan a residir completas en RAM. Con `+check` cada
+ * resultado se compara además con el modelo de referencia.
+ *
+ * Con `+golden=<n>`, tras los requisitos se ejecuta una comparación diferencial con
+ * `HsiGoldenModel` (`hsi_golden_model.h`): `n` píxeles aleatorios repartidos en trabajos
+ * STREAM de `+golden_batch` píxeles, cada uno con una configuración aleatoria válida (OP_CROSS,
+ * OP_DOT con PREC, BAND_SERIAL, BAND_WINDOW, OUT_SCALE y postprocesado, u OP_SAM). El modelo evalúa el
+ * lote completo antes del trabajo y cada palabra se compara en cuanto se extrae de `fifo_out`. Después
+ * se lanzan `+golden_errors` configuraciones aleatorias (válidas o no) con las FIFOs vacías y se
+ * compara STATUS.ERR con `HsiGoldenModel::start_error()`.
+ *
+ * Con `+model=tlm` las mismas secuencias (requisitos, `+golden` y `+cube`) se ejecutan sobre
+ * `HsiAccelTlm` (`hsi_accel_tlm.h`), el modelo loosely-timed del acelerador, en lugar del DUT
+ * Verilator: el firmware y los scripts cambian entre RTL y modelo rápido sin recompilar, y los ciclos
+ * que se informan son estimados. La traza y la cobertura solo existen con el RTL.
+ *
+ * Compilado con `make hsi_obi_cpp SAVABLE=1` (`--savable`, sin cobertura), `+save=<archivo>` guarda
+ * el estado del DUT, la memoria DMA y el tiempo simulado en el primer punto de checkpoint que cumpla
+ * `+save_event` y `+save_at`: tras el reset (`reset`), con el trabajo de `+cube` configurado y
+ * arrancado (`cube`) o entre dos trabajos de `+golden` (`golden`). `+restore=<archivo>` sustituye al
+ * reset y reanuda la secuencia en ese punto: el cubo empieza a fluir directamente y `+golden`
+ * continúa con los píxeles restantes, con la semilla de la nueva ejecución, de modo que un único
+ * estado inicial sirve para muchas variantes. El checkpoint solo es válido para el mismo binario.
+ *
+ * Cada flujo (`+cube` y cada trabajo de `+golden`) se mide con `HsiLatencyStats`
+ * (`hsi_latency_stats.h`): latencia de cada píxel desde el `in1_wr_en_i` de su primer beat hasta su
+ * palabra en `out_data_o` (histograma, p50, p99 y máximo), píxeles por ciclo, ciclos sin escritura
+ * por ocupación de las FIFOs o sin resultado, y la diferencia de PERF_* del trabajo. Al terminar se
+ * escribe el informe JSON en `+stats_json`. Con `+model=tlm` los ciclos son los estimados.
+ *
+ * @section plusargs Opciones
+ * | Plusarg              | Descripción                                                    |
+ * |----------------------|----------------------------------------------------------------|
+ * | `+notrace`           | No abre la traza (si el modelo se compiló con traza).          |
+ * | `+trace_file=<ruta>` | Archivo de traza (por defecto `logs/waves_cpp.fst`).            |
+ * | `+max_cycles=<n>`    | Ciclos máximos de espera de cada tarea (por defecto 10000).    |
+ * | `+cube=<hdr>`        | Cubo ENVI de entrada (BSQ, BIL o BIP; uint8, int16 o uint16).  |
+ * | `+cube2=<hdr>`       | Cubo del segundo operando, píxel a píxel.                      |
+ * | `+ref_pixel=<n>`     | Píxel de `+cube` usado como segundo operando (por defecto 0).  |
+ * | `+op=<n>`            | OP_CODE: 2 DOT (por defecto) o 3 SAM.                           |
+ * | `+out_scale=<n>`     | CONFIG.OUT_SCALE (bits [15:8] de CONFIG).                       |
+ * | `+pixels=<n>`        | Procesa solo los primeros `n` píxeles.                          |
+ * | `+out=<ruta>`        | Resultados en BIP int16 (por defecto `logs/results.bip` + `.hdr`). |
+ * | `+check`             | Compara los resultados del cubo con el modelo de referencia.    |
+ * | `+golden=<n>`        | Píxeles aleatorios comparados con el modelo de referencia.      |
+ * | `+golden_batch=<n>`  | Píxeles por trabajo y por lote del modelo (por defecto 4096).  |
+ * | `+golden_errors=<n>` | Configuraciones de error comparadas (por defecto 64).           |
+ * | `+seed=<n>`          | Semilla del generador aleatorio (por defecto 1).                |
+ * | `+model=<rtl\|tlm>`  | DUT Verilator (por defecto) o modelo rápido `HsiAccelTlm`.      |
+ * | `+tlm_report`        | Con `+model=tlm`, imprime los ciclos estimados de cada trabajo. |
+ * | `+save=<archivo>`    | Guarda un checkpoint (requiere `SAVABLE=1`).                    |
+ * | `+save_event=<fase>` | Fase del checkpoint: `reset`, `cube` o `golden` (cualquiera).   |
+ * | `+save_at=<n>`       | Primer punto de checkpoint a partir del ciclo `n`.              |
+ * | `+restore=<archivo>` | Reanuda desde un checkpoint en lugar de empezar con reset.      |
+ * | `+stats_json=<ruta>` | Informe de latencias (por defecto `logs/stats.json`).           |
+ * | `+out_stall=<pct>`   | % de ciclos de `stream()` sin extraer resultados (0..99).       |
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+#include "verilated.h"
+#include <verilated_cov.h>
+
+#if VM_TRACE_FST
+# include "verilated_fst_c.h"
+typedef VerilatedFstC TraceFile;
+# define TRACE_DEFAULT_FILE "logs/waves_cpp.fst"
+#elif VM_TRACE
+# include "verilated_vcd_c.h"
+typedef VerilatedVcdC TraceFile;
+# define TRACE_DEFAULT_FILE "logs/waves_cpp.vcd"
+#endif
+
+#if SIM_SAVABLE
+# include "verilated_save.h"
+#endif
+
+#include "Vhsi_accel_obi.h"
+#include "hsi_accel_tlm.h"
+#include "hsi_envi_cube.h"
+#include "hsi_golden_model.h"
+#include "hsi_latency_stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <sys/stat.h>
+#include <vector>
+
+/// @brief `FIFO_DEPTH` del DUT compilado (`-GFIFO_DEPTH`), fijado por el Makefile
+#ifndef HSI_FIFO_DEPTH
+# define HSI_FIFO_DEPTH 8
+#endif
+
+/// @brief Tiempo simulado: dos unidades por ciclo de `clk_i`
+vluint64_t main_time = 0;
+
+/// @brief Función requerida por Verilator para obtener el timestamp
+double sc_time_stamp() {
+    return main_time;
+}
+
+/// @brief Puntos de la secuencia en que se puede guardar un checkpoint (y desde los que se reanuda)
+enum CheckpointPhase : uint32_t { CP_NONE = 0, CP_RESET = 1, CP_CUBE = 2, CP_GOLDEN = 3 };
+
+/// @brief Nombres de `+save_event`, indexados por `CheckpointPhase`
+static const char* const CP_NAMES[] = {"", "reset", "cube", "golden"};
+
+/// @brief Posición de la secuencia guardada junto al estado del modelo
+struct Checkpoint {
+    uint32_t phase = CP_NONE;
+    uint64_t arg = 0;                          ///< CP_CUBE: píxeles del trabajo; CP_GOLDEN: píxeles ya comparados
+};
+
+/**
+ * @class HsiHarnessBase
+ * @brief Parte común de los bancos RTL y TLM: configuración compilada, memoria del puerto DMA,
+ * empaquetado de píxeles y contabilidad de requisitos.
+ */
+class HsiHarnessBase {
+public:
+    static const int CW = 16;                  ///< COMPONENT_WIDTH
+    static const int CM = 3;                   ///< COMPONENTS_MAX
+    static const uint32_t FIFO_DEPTH = HSI_FIFO_DEPTH; ///< FIFO_DEPTH
+    static_assert(HSI_FIFO_DEPTH >= 4, "stream() deja un margen de 4 palabras en las FIFOs de entrada");
+    static const int MEM_WORDS = 256;          ///< Palabras de la memoria DMA
+
+    /// @brief Compara vectores y contabiliza el resultado
+    void check_result(const char* label, int e0, int e1, int e2, int a0, int a1, int a2) {
+        if (e0 == a0 && e1 == a1 && e2 == a2) {
+            VL_PRINTF("[PASS] %s -> (%d,%d,%d)\n", label, a0, a1, a2);
+        } else {
+            VL_PRINTF("[FAIL] %s: esperado (%d,%d,%d) pero obtuve (%d,%d,%d)\n",
+                      label, e0, e1, e2, a0, a1, a2);
+            m_errors++;
+        }
+    }
+
+    /// @brief Comprobación simple con mensaje de fallo
+    void check(bool ok, const char* label) {
+        if (ok) {
+            VL_PRINTF("[PASS] %s\n", label);
+        } else {
+            VL_PRINTF("[FAIL] %s\n", label);
+            m_errors++;
+        }
+    }
+
+    /// @brief Escritura directa en la memoria del puerto DMA (dirección en bytes)
+    void mem_write(uint32_t addr, uint32_t data) {
+        m_mem[(addr >> 2) & (MEM_WORDS - 1)] = data;
+    }
+
+    uint32_t mem_read(uint32_t addr) const {
+        return m_mem[(addr >> 2) & (MEM_WORDS - 1)];
+    }
+
+    /// @brief Píxel {x,y,z} de 48 bits en dos palabras little-endian: {y,z} y {0,x}
+    void mem_write_pixel(uint32_t addr, int x, int y, int z) {
+        mem_write(addr,     (comp(y) << CW) | comp(z));
+        mem_write(addr + 4, comp(x));
+    }
+
+    static uint32_t comp(int v) {
+        return static_cast<uint32_t>(v) & ((1u << CW) - 1);
+    }
+
+    /// @brief Componente `idx` (0 = más significativa) con extensión de signo
+    static int unpack(uint64_t v, int idx) {
+        const uint32_t c = static_cast<uint32_t>(v >> ((CM - 1 - idx) * CW)) & ((1u << CW) - 1);
+        return static_cast<int16_t>(c);
+    }
+
+    int errors() const { return m_errors; }
+
+    /// @brief Latencias y bloqueos de los flujos de `stream()`
+    HsiLatencyStats& stats() { return m_stats; }
+
+    /// @brief `+out_stall`: porcentaje de ciclos en que `stream()` no extrae resultados
+    void set_out_stall(uint32_t pct, uint64_t seed) {
+        m_out_stall = pct;
+        m_stall_rng.seed(seed);
+    }
+    uint32_t out_stall() const { return m_out_stall; }
+
+    /// @brief Checkpoints no disponibles: sustituidas por `HsiAccelObiHarness` con `SAVABLE=1`
+    bool save(const std::string&, const Checkpoint&) {
+        return no_checkpoint("+save");
+    }
+    bool restore(const std::string&, Checkpoint&) {
+        return no_checkpoint("+restore");
+    }
+
+protected:
+    HsiHarnessBase() {
+        for (int i = 0; i < MEM_WORDS; i++) m_mem[i] = 0;
+    }
+
+    static uint64_t pack(int x, int y, int z) {
+        return (static_cast<uint64_t>(comp(x)) << (2 * CW)) | (static_cast<uint64_t>(comp(y)) << CW) | comp(z);
+    }
+
+    /// @brief Sorteo de un ciclo de retención de la salida
+    bool stall_cycle() {
+        return m_out_stall != 0 && m_stall_rng() % 100 < m_out_stall;
+    }
+
+    bool no_checkpoint(const char* what) {
+        VL_PRINTF("[FAIL] %s requiere el DUT Verilator compilado con SAVABLE=1\n", what);
+        m_errors++;
+        return false;
+    }
+
+    uint32_t m_mem[MEM_WORDS];                 ///< Memoria esclava del puerto DMA
+    int m_errors = 0;                          ///< Requisitos fallidos
+    HsiLatencyStats m_stats;                   ///< Medidas de `stream()`
+    uint32_t m_out_stall = 0;                  ///< `+out_stall` (%)
+    std::mt19937_64 m_stall_rng;               ///< Generador propio: no altera los datos de `+golden`
+};
+
+/**
+ * @class HsiAccelObiHarness
+ * @brief Reloj, bus OBI esclavo, memoria DMA y puertos FIFO de `hsi_accel_obi`.
+ *
+ * @details
+ * `tick()` avanza un ciclo completo de `clk_i`. La memoria del puerto DMA concede cada petición en
+ * el mismo ciclo (`dma_gnt_i = dma_req_o`) y responde en el siguiente, igual que la del testbench
+ * SV: 256 palabras direccionadas con `dma_addr_o[9:2]`.
+ */
+class HsiAccelObiHarness : public HsiHarnessBase {
+public:
+    explicit HsiAccelObiHarness(vluint64_t max_cycles) : m_max_cycles(max_cycles) {
+        m_top = new Vhsi_accel_obi;
+    }
+
+    ~HsiAccelObiHarness() {
+#if VM_TRACE
+        if (m_tfp) {
+            m_tfp->close();
+            delete m_tfp;
+        }
+#endif
+        m_top->final();
+        delete m_top;
+    }
+
+#if VM_TRACE
+    /// @brief Conecta el modelo a un archivo de traza
+    void trace(const std::string& file) {
+        const std::string::size_type slash = file.rfind('/');
+        if (slash != std::string::npos) mkdir(file.substr(0, slash).c_str(), 0755);
+        m_tfp = new TraceFile;
+        m_top->trace(m_tfp, 99);
+        m_tfp->open(file.c_str());
+    }
+#endif
+
+    /// @brief Reset activo en bajo durante 3 ciclos y 2 ciclos de espera, como el testbench SV
+    void reset() {
+        m_top->clk_i = 0;
+        m_top->core_clk_i = 0;
+        m_top->rst_ni = 0;
+        m_top->req_i = 0; m_top->we_i = 0; m_top->be_i = 0; m_top->addr_i = 0; m_top->wdata_i = 0;
+        m_top->in1_wr_en_i = 0; m_top->in2_wr_en_i = 0; m_top->out_rd_en_i = 0;
+        m_top->in1_data_i = 0; m_top->in2_data_i = 0;
+        m_top->dma_gnt_i = 0; m_top->dma_rvalid_i = 0; m_top->dma_rdata_i = 0;
+        m_top->eval();
+        for (int i = 0; i < 3; i++) tick();
+        m_top->rst_ni = 1;
+        for (int i = 0; i < 2; i++) tick();
+    }
+
+    /// @brief Un ciclo de reloj: flanco de bajada, concesión DMA, flanco de subida y respuesta de memoria
+    void tick() {
+        m_top->clk_i = 0;
+        m_top->core_clk_i = 0;
+        m_top->eval();
+        m_top->dma_gnt_i = m_top->dma_req_o;
+        m_top->eval();
+        dump();
+        main_time++;
+
+        const bool dma_acc = m_top->dma_req_o && m_top->dma_gnt_i;
+        const bool dma_we = m_top->dma_we_o;
+        const uint32_t dma_idx = (m_top->dma_addr_o >> 2) & (MEM_WORDS - 1);
+        const uint32_t dma_wdata = m_top->dma_wdata_o;
+
+        m_top->clk_i = 1;
+        m_top->core_clk_i = 1;
+        m_top->eval();
+        m_top->dma_rvalid_i = dma_acc;
+        if (dma_acc) {
+            if (dma_we) m_mem[dma_idx] = dma_wdata;
+            else        m_top->dma_rdata_i = m_mem[dma_idx];
+        }
+        m_top->eval();
+        dump();
+        main_time++;
+        m_cycles++;
+    }
+
+    void ticks(int n) {
+        for (int i = 0; i < n; i++) tick();
+    }
+
+    /// @brief Escritura OBI: petición durante un ciclo (concesión inmediata del wrapper)
+    void obi_write(uint32_t addr, uint32_t data, uint8_t be = 0xF) {
+        m_top->addr_i = addr; m_top->wdata_i = data; m_top->be_i = be;
+        m_top->we_i = 1; m_top->req_i = 1;
+        tick();
+        m_top->req_i = 0; m_top->we_i = 0;
+        tick();
+    }
+
+    /// @brief Lectura OBI: petición durante un ciclo y espera de `rvalid_o`
+    uint32_t obi_read(uint32_t addr) {
+        m_top->addr_i = addr; m_top->we_i = 0; m_top->req_i = 1; m_top->be_i = 0xF;
+        tick();
+        m_top->req_i = 0;
+        if (!wait_for([this] { return m_top->rvalid_o != 0; }, "rvalid_o")) return 0;
+        return m_top->rdata_o;
+    }
+
+    /// @brief Escribe un par de vectores {x,y,z} en las FIFOs de entrada durante un ciclo
+    void push_vectors(int x1, int y1, int z1, int x2, int y2, int z2) {
+        tick();
+        m_top->in1_data_i = pack(x1, y1, z1);
+        m_top->in2_data_i = pack(x2, y2, z2);
+        m_top->in1_wr_en_i = 1;
+        m_top->in2_wr_en_i = 1;
+        tick();
+        m_top->in1_wr_en_i = 0;
+        m_top->in2_wr_en_i = 0;
+    }
+
+    /// @brief Espera un resultado en la FIFO de salida y lo extrae como {x,y,z} con signo
+    bool wait_result(int& rx, int& ry, int& rz) {
+        if (!wait_for([this] { return !m_top->out_empty_o; }, "out_empty_o = 0")) return false;
+        tick();
+        m_top->out_rd_en_i = 1;
+        tick();
+        m_top->out_rd_en_i = 0;
+        const uint64_t v = m_top->out_data_o;
+        rx = unpack(v, 0);
+        ry = unpack(v, 1);
+        rz = unpack(v, 2);
+        return true;
+    }
+
+    /**
+     * @brief Flujo continuo: un beat de entrada y un resultado por ciclo como máximo.
+     *
+     * @details
+     * Mantiene `req_i` activo leyendo `FIFO_LEVEL_IN` (0x74) en cada ciclo, y escribe un beat mientras
+     * la última ocupación leída deje sitio para los beats que esa lectura aún no refleja (margen de 4).
+     * Extrae un resultado en cada ciclo con `out_empty_o = 0`, salvo en los ciclos retenidos por
+     * `+out_stall`. El ciclo de cada beat y de cada resultado, y los ciclos sin escritura o sin
+     * resultado, se anotan en `stats()`.
+     *
+     * @param beats     Beats de entrada a enviar
+     * @param next_beat `void(uint64_t& v1, uint64_t& v2)`, produce el siguiente beat
+     * @param results   Resultados a recibir
+     * @param on_result `void(uint64_t v)`, recibe cada resultado en orden
+     * @return `false` si pasan `max_cycles` ciclos sin enviar ni recibir nada
+     */
+    template <typename BeatFn, typename ResultFn>
+    bool stream(uint64_t beats, BeatFn next_beat, uint64_t results, ResultFn on_result) {
+        uint64_t sent = 0, recv = 0, idle = 0;
+        uint32_t level = 0;
+        m_top->addr_i = 0x74; m_top->we_i = 0; m_top->be_i = 0xF; m_top->req_i = 1;
+        while (recv < results) {
+            const bool push = sent < beats && level + 4 <= FIFO_DEPTH;
+            if (push) {
+                uint64_t v1 = 0, v2 = 0;
+                next_beat(v1, v2);
+                m_top->in1_data_i = v1;
+                m_top->in2_data_i = v2;
+            }
+            m_top->in1_wr_en_i = push;
+            m_top->in2_wr_en_i = push;
+            const bool pop = !m_top->out_empty_o && !stall_cycle();
+            m_top->out_rd_en_i = pop;
+            if (push) m_stats.beat(m_cycles);
+            if (pop) m_stats.result(m_cycles);
+            if (!push && sent < beats) m_stats.input_blocked();
+            if (m_top->out_empty_o) m_stats.output_wait();
+            tick();
+            if (push) sent++;
+            if (pop) {
+                on_result(static_cast<uint64_t>(m_top->out_data_o));
+                recv++;
+            }
+            if (m_top->rvalid_o) level = std::max(m_top->rdata_o & 0xFFFFu, m_top->rdata_o >> 16);
+            idle = (push || pop) ? 0 : idle + 1;
+            if (idle > m_max_cycles) {
+                VL_PRINTF("[FAIL] flujo detenido: %llu/%llu beats enviados, %llu/%llu resultados\n",
+                          static_cast<unsigned long long>(sent), static_cast<unsigned long long>(beats),
+                          static_cast<unsigned long long>(recv), static_cast<unsigned long long>(results));
+                m_errors++;
+                break;
+            }
+        }
+        m_top->req_i = 0;
+        m_top->in1_wr_en_i = 0; m_top->in2_wr_en_i = 0; m_top->out_rd_en_i = 0;
+        tick();
+        return recv == results;
+    }
+
+    vluint64_t cycles() const { return m_cycles; }
+
+#if SIM_SAVABLE
+    /**
+     * @brief Guarda el estado del modelo Verilator (`--savable`), la memoria del puerto DMA, el tiempo
+     * simulado y la posición `cp` de la secuencia.
+     */
+    bool save(const std::string& file, const Checkpoint& cp) {
+        VerilatedSave os;
+        os.open(file.c_str());
+        if (!os.isOpen()) {
+            VL_PRINTF("[FAIL] %s: no se puede crear el checkpoint\n", file.c_str());
+            m_errors++;
+            return false;
+        }
+        os.write(&cp.phase, sizeof(cp.phase));
+        os.write(&cp.arg, sizeof(cp.arg));
+        os.write(&main_time, sizeof(main_time));
+        os.write(&m_cycles, sizeof(m_cycles));
+        os.write(m_mem, sizeof(m_mem));
+        os << *m_top;
+        os.close();
+        VL_PRINTF("[SAVE] checkpoint '%s' en %s (ciclo %llu)\n", CP_NAMES[cp.phase], file.c_str(),
+                  static_cast<unsigned long long>(m_cycles));
+        return true;
+    }
+
+    /// @brief Restaura un checkpoint de `save()` en lugar de `reset()`; `cp` indica dónde reanudar
+    bool restore(const std::string& file, Checkpoint& cp) {
+        VerilatedRestore os;
+        os.open(file.c_str());
+        if (!os.isOpen()) {
+            VL_PRINTF("[FAIL] %s: no se puede abrir el checkpoint\n", file.c_str());
+            m_errors++;
+            return false;
+        }
+        os.read(&cp.phase, sizeof(cp.phase));
+        os.read(&cp.arg, sizeof(cp.arg));
+        os.read(&main_time, sizeof(main_time));
+        os.read(&m_cycles, sizeof(m_cycles));
+        os.read(m_mem, sizeof(m_mem));
+        os >> *m_top;
+        os.close();
+        if (cp.phase == CP_NONE || cp.phase > CP_GOLDEN) {
+            VL_PRINTF("[FAIL] %s: fase de checkpoint desconocida (%u)\n", file.c_str(), cp.phase);
+            m_errors++;
+            return false;
+        }
+        VL_PRINTF("[RESTORE] checkpoint '%s' de %s (ciclo %llu)\n", CP_NAMES[cp.phase], file.c_str(),
+                  static_cast<unsigned long long>(m_cycles));
+        return true;
+    }
+#endif
+
+private:
+    /// @brief Avanza ciclos hasta que `cond` se cumpla o se agote `max_cycles`
+    template <typename Cond>
+    bool wait_for(Cond cond, const char* what) {
+        for (vluint64_t n = 0; !cond(); n++) {
+            if (n >= m_max_cycles) {
+                VL_PRINTF("[FAIL] timeout esperando %s tras %llu ciclos\n", what,
+                          static_cast<unsigned long long>(n));
+                m_errors++;
+                return false;
+            }
+            tick();
+        }
+        return true;
+    }
+
+    void dump() {
+#if VM_TRACE
+        if (m_tfp) m_tfp->dump(main_time);
+#endif
+    }
+
+    Vhsi_accel_obi* m_top;                     ///< Modelo del DUT
+#if VM_TRACE
+    TraceFile* m_tfp = nullptr;                ///< Traza opcional
+#endif
+    vluint64_t m_max_cycles;                   ///< Límite de espera de cada tarea
+    vluint64_t m_cycles = 0;                   ///< Ciclos de reloj simulados
+};
+
+/**
+ * @class HsiAccelTlmHarness
+ * @brief Mismas tareas que `HsiAccelObiHarness` sobre `HsiAccelTlm` (`+model=tlm`).
+ *
+ * @details
+ * El modelo se construye con los parámetros de la instancia compilada (`CW`, `CM`, `FIFO_DEPTH`,
+ * `DMA_EN = 1`) y la misma memoria de 256 palabras. No hay reloj: cada lectura, escritura o acceso a
+ * las FIFOs termina todo el trabajo que el modelo puede hacer, así que `wait_result` solo falla si
+ * el resultado no llegará nunca, y `cycles()` devuelve los ciclos estimados.
+ */
+class HsiAccelTlmHarness : public HsiHarnessBase {
+public:
+    HsiAccelTlmHarness() : m_tlm(params()) {
+        m_tlm.set_memory([this](uint32_t a) { return mem_read(a); },
+                         [this](uint32_t a, uint32_t d) { mem_write(a, d); });
+    }
+
+    /// @brief Imprime el resumen de cada trabajo terminado
+    void report_jobs() {
+        m_tlm.set_job_hook([](const HsiAccelTlm::JobStats& j) {
+            VL_PRINTF("[TLM] trabajo op=%u%s: %u píxeles, ciclos %llu..%llu (%llu), núcleo ocupado %llu\n",
+                      j.op, j.dma ? " DMA" : "", j.pixels, static_cast<unsigned long long>(j.start),
+                      static_cast<unsigned long long>(j.end), static_cast<unsigned long long>(j.cycles()),
+                      static_cast<unsigned long long>(j.core_busy));
+        });
+    }
+
+    void reset() { m_tlm.reset(); }
+    void tick() { m_tlm.idle(1); }
+    void ticks(int n) { m_tlm.idle(static_cast<uint64_t>(n)); }
+
+    void obi_write(uint32_t addr, uint32_t data, uint8_t be = 0xF) { m_tlm.write(addr, data, be); }
+    uint32_t obi_read(uint32_t addr) { return m_tlm.read(addr); }
+
+    void push_vectors(int x1, int y1, int z1, int x2, int y2, int z2) {
+        m_tlm.push(true, pack(x1, y1, z1), true, pack(x2, y2, z2));
+    }
+
+    bool wait_result(int& rx, int& ry, int& rz) {
+        uint64_t v = 0;
+        if (!m_tlm.pop(v)) {
+            VL_PRINTF("[FAIL] timeout esperando out_empty_o = 0 (modelo sin resultados pendientes)\n");
+            m_errors++;
+            return false;
+        }
+        rx = unpack(v, 0);
+        ry = unpack(v, 1);
+        rz = unpack(v, 2);
+        return true;
+    }
+
+    /// @brief Flujo continuo: llena las FIFOs de entrada y vacía la de salida hasta recibir `results`,
+    /// con `+out_stall` como ciclos de bus sin extraer; `stats()` recibe los ciclos estimados de cada
+    /// beat y resultado
+    template <typename BeatFn, typename ResultFn>
+    bool stream(uint64_t beats, BeatFn next_beat, uint64_t results, ResultFn on_result) {
+        uint64_t sent = 0, recv = 0;
+        while (recv < results) {
+            bool progress = false;
+            while (sent < beats && !m_tlm.in1_full() && !m_tlm.in2_full()) {
+                uint64_t v1 = 0, v2 = 0;
+                next_beat(v1, v2);
+                m_tlm.push(true, v1, true, v2);
+                m_stats.beat(m_tlm.now());
+                sent++;
+                progress = true;
+            }
+            uint64_t v = 0;
+            while (recv < results) {
+                if (stall_cycle()) {           // ciclo de bus sin extraer, como out_rd_en_i = 0
+                    m_tlm.idle(1);
+                    progress = true;
+                    break;
+                }
+                if (!m_tlm.pop(v)) break;
+                m_stats.result(m_tlm.now());
+                on_result(v);
+                recv++;
+                progress = true;
+            }
+            if (!progress) {
+                VL_PRINTF("[FAIL] flujo detenido: %llu/%llu beats enviados, %llu/%llu resultados\n",
+                          static_cast<unsigned long long>(sent), static_cast<unsigned long long>(beats),
+                          static_cast<unsigned long long>(recv), static_cast<unsigned long long>(results));
+                m_errors++;
+                break;
+            }
+        }
+        return recv == results;
+    }
+
+    vluint64_t cycles() const { return m_tlm.cycles(); }
+
+private:
+    static HsiAccelTlm::Params params() {
+        HsiAccelTlm::Params p;
+        p.core.component_width = CW;
+        p.core.components_max = CM;
+        p.fifo_depth = FIFO_DEPTH;
+        p.dma_en = true;
+        return p;
+    }
+
+    HsiAccelTlm m_tlm;                         ///< Modelo rápido
+};
+
+/// @brief Valor numérico de un plusarg `+<name><valor>`
+static vluint64_t plusarg_u64(const char* name, vluint64_t def) {
+    const std::string arg = Verilated::commandArgsPlusMatch(name);
+    if (arg.empty()) return def;
+    return std::strtoull(arg.c_str() + 1 + std::string(name).size(), nullptr, 0);
+}
+
+/// @brief Texto de un plusarg `+<name><valor>` ("" si no aparece)
+static std::string plusarg_str(const char* name) {
+    const std::string arg = Verilated::commandArgsPlusMatch(name);
+    return arg.empty() ? arg : arg.substr(1 + std::string(name).size());
+}
+
+/// @brief PERF_BUSY, PERF_PIXELS, PERF_STALL_IN y PERF_STALL_OUT
+template <typename Harness>
+static HsiLatencyStats::Perf read_perf(Harness& h) {
+    HsiLatencyStats::Perf p;
+    p.busy = h.obi_read(0x40);
+    p.pixels = h.obi_read(0x44);
+    p.stall_in = h.obi_read(0x48);
+    p.stall_out = h.obi_read(0x4C);
+    return p;
+}
+
+/// @brief Cierra la medida del trabajo con la diferencia de PERF_* respecto a `p0`
+template <typename Harness>
+static void stats_end(Harness& h, const HsiLatencyStats::Perf& p0) {
+    HsiLatencyStats::Perf p = read_perf(h);
+    p.busy -= p0.busy;
+    p.pixels -= p0.pixels;
+    p.stall_in -= p0.stall_in;
+    p.stall_out -= p0.stall_out;
+    h.stats().end(h.cycles(), p);
+}
+
+/**
+ * @brief Guarda el checkpoint `+save=<archivo>` en el primer punto de la secuencia que cumpla
+ * `+save_event=<fase>` (cualquiera si no se indica) y que se alcance en el ciclo `+save_at` o después.
+ */
+template <typename Harness>
+static void checkpoint(Harness& h, CheckpointPhase phase, uint64_t arg) {
+    static bool saved = false;
+    const std::string file = plusarg_str("save=");
+    if (saved || file.empty()) return;
+    const std::string event = plusarg_str("save_event=");
+    if ((!event.empty() && event != CP_NAMES[phase]) || h.cycles() < plusarg_u64("save_at=", 0)) return;
+    Checkpoint cp;
+    cp.phase = phase;
+    cp.arg = arg;
+    saved = true;
+    h.save(file, cp);
+}
+
+/**
+ * @brief Secuencia de requisitos: mismas operaciones y valores que `hsi_accel_obi_tb`.
+ */
+template <typename Harness>
+static void run_tests(Harness& h) {
+    const uint32_t OP_CROSS = 1;
+    const uint32_t OP_DOT = 2;
+    int rx = 0, ry = 0, rz = 0;
+
+    // R1.2: (1,0,0) x (0,1,0) = (0,0,1)
+    h.obi_write(0x00, OP_CROSS);           // OP_CODE
+    h.obi_write(0x04, 3);                  // NUM_BANDS
+    h.push_vectors(1, 0, 0, 0, 1, 0);
+    h.obi_write(0x08, 0x1);                // START
+    if (h.wait_result(rx, ry, rz)) h.check_result("R1.2 (CROSS)", 0, 0, 1, rx, ry, rz);
+
+    // R2.2: (1,2,3)·(4,5,6) = 32
+    h.obi_write(0x00, OP_DOT);
+    h.push_vectors(1, 2, 3, 4, 5, 6);
+    h.obi_write(0x08, 0x1);
+    if (h.wait_result(rx, ry, rz)) h.check_result("R2.2 (DOT)", 0, 0, 32, rx, ry, rz);
+
+    // R4.1: 3 píxeles DOT con un único START
+    h.obi_write(0x14, 0x1);                // CONFIG.STREAM
+    h.push_vectors(1, 2, 3, 4, 5, 6);
+    h.push_vectors(1, 1, 1, 2, 2, 2);
+    h.push_vectors(-1, 2, 0, 3, 1, 7);
+    h.obi_write(0x08, 0x1);
+    if (h.wait_result(rx, ry, rz)) h.check_result("R4.1 (STREAM px0)", 0, 0, 32, rx, ry, rz);
+    if (h.wait_result(rx, ry, rz)) h.check_result("R4.1 (STREAM px1)", 0, 0, 6, rx, ry, rz);
+    if (h.wait_result(rx, ry, rz)) h.check_result("R4.1 (STREAM px2)", 0, 0, -1, rx, ry, rz);
+    h.obi_write(0x14, 0x0);
+
+    // R5.1: (1..7)·(1,1,1,2,2,2,3) = 57 en beats de 3 bandas
+    h.obi_write(0x14, 0x2);                // CONFIG.BAND_SERIAL
+    h.obi_write(0x04, 7);
+    h.push_vectors(1, 2, 3, 1, 1, 1);
+    h.push_vectors(4, 5, 6, 2, 2, 2);
+    h.push_vectors(0, 0, 7, 0, 0, 3);
+    h.obi_write(0x08, 0x1);
+    if (h.wait_result(rx, ry, rz)) h.check_result("R5.1 (BAND_SERIAL)", 0, 0, 57, rx, ry, rz);
+    h.obi_write(0x14, 0x0);
+    h.obi_write(0x04, 3);
+
+    // R6.1: los mismos 3 píxeles que R4.1 desde memoria, resultados en 0x300
+    h.mem_write_pixel(0x100, 1, 2, 3);
+    h.mem_write_pixel(0x108, 1, 1, 1);
+    h.mem_write_pixel(0x110, -1, 2, 0);
+    h.mem_write_pixel(0x200, 4, 5, 6);
+    h.mem_write_pixel(0x208, 2, 2, 2);
+    h.mem_write_pixel(0x210, 3, 1, 7);
+    h.obi_write(0x18, 0x100);              // DMA_SRC1
+    h.obi_write(0x1C, 0x200);              // DMA_SRC2
+    h.obi_write(0x20, 0x300);              // DMA_DST
+    h.obi_write(0x24, 3);                  // PIXEL_COUNT
+    h.obi_write(0x28, 0x0);                // DMA_STRIDE (empaquetado)
+    h.obi_write(0x08, 0x9);                // START | DMA_START
+    uint32_t status = 0;
+    for (int t = 0; t < 1000 && !(status & (1u << 10)); t++) status = h.obi_read(0x0C);
+    h.check((status & (1u << 10)) && (h.mem_read(0x300) & 0xFFFF) == 32 && (h.mem_read(0x308) & 0xFFFF) == 6 &&
+            (h.mem_read(0x310) & 0xFFFF) == 0xFFFF && h.mem_read(0x304) == 0,
+            "R6.1 (DMA): resultados en memoria (32,6,-1)");
+    h.obi_write(0x08, 0x2);                // CLEAR_DONE
+
+    // R7.1: trabajo de 3 píxeles (PIXEL_COUNT sigue a 3), START antes de cargar datos
+    h.obi_write(0x08, 0x1);
+    h.push_vectors(1, 2, 3, 4, 5, 6);
+    bool ok = h.wait_result(rx, ry, rz) && rz == 32;
+    status = h.obi_read(0x0C);
+    ok = ok && !(status & 0x1) && (status & (1u << 8));
+    h.push_vectors(1, 1, 1, 2, 2, 2);
+    h.push_vectors(-1, 2, 0, 3, 1, 7);
+    ok = h.wait_result(rx, ry, rz) && rz == 6 && ok;
+    ok = h.wait_result(rx, ry, rz) && rz == -1 && ok;
+    h.ticks(2);
+    status = h.obi_read(0x0C);
+    const uint32_t processed = h.obi_read(0x2C);
+    h.check(ok && (status & 0x1) && !(status & (1u << 8)) && processed == 3,
+            "R7.1 (JOB): 3 píxeles con un único START, PROCESSED_COUNT = 3");
+    h.obi_write(0x24, 0);                  // PIXEL_COUNT = 0
+    h.obi_write(0x08, 0x2);                // CLEAR_DONE
+
+    // R12.1: OP_REF_LOAD por DMA (3 referencias de DMA_SRC2); PERF_STATE(REF_LOAD) cuenta la carga y
+    // los contadores por estado distintos de IDLE suman PERF_BUSY
+    h.mem_write_pixel(0x200, 1, 0, 0);
+    h.mem_write_pixel(0x208, 0, 1, 0);
+    h.mem_write_pixel(0x210, 0, 0, 1);
+    h.obi_write(0x3C, 0x1);                // PERF_CTRL.CLEAR
+    h.obi_write(0x00, 4);                  // OP_REF_LOAD
+    h.obi_write(0x1C, 0x200);
+    h.obi_write(0x24, 3);
+    h.obi_write(0x08, 0x9);
+    status = 0;
+    for (int t = 0; t < 1000 && (status & 0x501) != 0x401; t++) status = h.obi_read(0x0C);
+    h.ticks(2);
+    const uint32_t busy = h.obi_read(0x40);
+    const uint32_t ref_load = h.obi_read(0x70);
+    uint32_t states = 0;
+    for (uint32_t a = 0x54; a <= 0x70; a += 4) states += h.obi_read(a);
+    h.check((status & 0x501) == 0x401 && h.obi_read(0x2C) == 3 && ref_load != 0 && states == busy,
+            "R12.1 (REF_LOAD): PERF_STATE(REF_LOAD) > 0 y PERF_STATE(1..8) = PERF_BUSY");
+    h.obi_write(0x24, 0);
+    h.obi_write(0x00, OP_DOT);
+    h.obi_write(0x08, 0x2);
+}
+
+/// @brief Parámetros del modelo de referencia para la configuración compilada del DUT
+static HsiGoldenModel::Params golden_params() {
+    HsiGoldenModel::Params p;
+    p.component_width = HsiHarnessBase::CW;
+    p.components_max = HsiHarnessBase::CM;
+    return p;
+}
+
+/**
+ * @brief Escribe la configuración de un trabajo en OP_CODE, NUM_BANDS, CONFIG, THRESHOLD y BAND_WINDOW.
+ */
+template <typename Harness>
+static void program_job(Harness& h, const HsiGoldenModel::Config& c, bool stream) {
+    h.obi_write(0x00, c.op);
+    h.obi_write(0x04, c.num_bands);
+    h.obi_write(0x14, (stream ? 0x1u : 0x0u) | (c.band_serial ? 0x2u : 0x0u) | (c.ref_mode ? 0x4u : 0x0u) |
+                      (c.post & 0x3) << 3 | (c.prec & 0x3) << 5 | static_cast<uint32_t>(c.out_scale) << 8);
+    h.obi_write(0x80, static_cast<uint32_t>(c.threshold));
+    h.obi_write(0x84, static_cast<uint32_t>(c.band_count) << 16 | c.band_first);
+}
+
+/**
+ * @brief Configuración aleatoria de un trabajo.
+ *
+ * @details
+ * Con `valid = true` se repite hasta obtener una que el modelo cubra, repartida entre OP_CROSS,
+ * OP_DOT y OP_SAM; con `valid = false` los campos se eligen sin restricciones (incluidos códigos de
+ * operación, precisiones y postprocesados no válidos) para ejercitar las condiciones de error.
+ */
+static HsiGoldenModel::Config random_config(std::mt19937_64& rng, const HsiGoldenModel& m, bool valid) {
+    auto rnd = [&rng](uint32_t n) { return static_cast<uint32_t>(rng() % n); };
+    HsiGoldenModel::Config c;
+    for (;;) {
+        c = HsiGoldenModel::Config();
+        if (!valid) {
+            c.op = rnd(6);
+            c.num_bands = rnd(8);
+            c.band_serial = rnd(2);
+            c.ref_mode = rnd(8) == 0;
+            c.post = rnd(4);
+            c.prec = rnd(4);
+            if (rnd(4) == 0) {
+                c.band_first = static_cast<uint16_t>(rnd(8));
+                c.band_count = static_cast<uint16_t>(rnd(8));
+            }
+            return c;
+        }
+        const uint32_t kind = rnd(8);
+        if (kind < 2) {
+            c.op = HsiGoldenModel::OP_CROSS;
+            c.out_scale = static_cast<uint8_t>(rng());     // OP_CROSS no escala: debe ignorarse
+        } else {
+            c.op = (kind < 6) ? HsiGoldenModel::OP_DOT : HsiGoldenModel::OP_SAM;
+            c.band_serial = rnd(2);
+            c.prec = (c.op == HsiGoldenModel::OP_DOT) ? rnd(3) : 0;
+            const uint32_t beat_max = static_cast<uint32_t>(HsiHarnessBase::CM) << c.prec;
+            c.num_bands = 1 + rnd(c.band_serial ? 4 * beat_max : beat_max);
+            if (rnd(4) == 0) {
+                c.band_first = static_cast<uint16_t>(rnd(c.num_bands));
+                c.band_count = static_cast<uint16_t>(1 + rnd(c.num_bands - c.band_first));
+            }
+            if (c.op == HsiGoldenModel::OP_DOT) c.post = rnd(3);
+            c.out_scale = static_cast<uint8_t>((rnd(2) ? 0x80 : 0) | (rnd(2) ? 0x40 : 0) | rnd(24));
+            c.threshold = static_cast<int32_t>(rng());
+        }
+        if (m.supported(c)) return c;
+    }
+}
+
+/**
+ * @brief Comparación diferencial del DUT con `HsiGoldenModel` sobre píxeles aleatorios.
+ *
+ * @details
+ * Las muestras de cada lote se generan en disposición planar dentro del rango de `SW = CW >> prec`
+ * bits; en uno de cada cuatro lotes se eligen solo entre los extremos ({-2^(SW-1), -1, 0, 1,
+ * 2^(SW-1)-1}) para forzar el módulo de CROSS, el desbordamiento hacia `ACC_W` y la saturación.
+ * El lote se evalúa entero con `eval_batch` antes del trabajo, de modo que durante la simulación
+ * cada resultado extraído solo cuesta una comparación con `expected[i]`.
+ *
+ * @param resume Píxeles ya comparados antes del checkpoint restaurado (0 desde el principio)
+ */
+template <typename Harness>
+static void run_golden(Harness& h, uint64_t total, uint64_t resume) {
+    const HsiGoldenModel model(golden_params());
+    const uint64_t batch = std::max<uint64_t>(1, plusarg_u64("golden_batch=", 4096));
+    const uint64_t seed = plusarg_u64("seed=", 1);
+    std::mt19937_64 rng(seed);
+
+    std::vector<int32_t> a, b;
+    std::vector<uint64_t> expected;
+    uint64_t done = resume, jobs = 0, mismatches = 0;
+    double model_s = 0;
+    bool ok = true;
+    const auto t0 = std::chrono::steady_clock::now();
+
+    VL_PRINTF("[GOLDEN] %llu píxeles en lotes de %llu, semilla %llu\n", static_cast<unsigned long long>(total),
+              static_cast<unsigned long long>(batch), static_cast<unsigned long long>(seed));
+
+    while (ok && done < total) {
+        checkpoint(h, CP_GOLDEN, done);
+        const HsiGoldenModel::Config c = random_config(rng, model, true);
+        const size_t n = static_cast<size_t>(std::min(batch, total - done));
+        const int sw = model.sample_width(c);
+        const int32_t lo = -(1 << (sw - 1)), hi = (1 << (sw - 1)) - 1;
+        const int32_t corners[5] = {lo, -1, 0, 1, hi};
+        const bool corner = rng() % 4 == 0;
+        std::uniform_int_distribution<int32_t> dist(lo, hi);
+        a.resize(static_cast<size_t>(c.num_bands) * n);
+        b.resize(a.size());
+        for (size_t i = 0; i < a.size(); i++) {
+            a[i] = corner ? corners[rng() % 5] : dist(rng);
+            b[i] = corner ? corners[rng() % 5] : dist(rng);
+        }
+        expected.resize(n);
+        const auto m0 = std::chrono::steady_clock::now();
+        model.eval_batch(c, a.data(), b.data(), n, expected.data());
+        model_s += std::chrono::duration<double>(std::chrono::steady_clock::now() - m0).count();
+
+        const uint32_t beats_px = model.beats(c);
+        HsiLatencyStats::JobInfo info;
+        info.name = "golden";
+        info.op = c.op;
+        info.num_bands = c.num_bands;
+        info.band_serial = c.band_serial;
+        info.prec = c.prec;
+        info.post = c.post;
+        info.beats_per_pixel = beats_px;
+        info.out_stall = h.out_stall();
+
+        program_job(h, c, true);
+        h.obi_write(0x24, static_cast<uint32_t>(n));
+        const HsiLatencyStats::Perf p0 = read_perf(h);
+        h.stats().begin(info, h.cycles());
+        h.obi_write(0x08, 0x1);            // START
+
+        size_t px = 0, rx = 0;
+        uint32_t beat = 0;
+        auto next_beat = [&](uint64_t& v1, uint64_t& v2) {
+            v1 = model.beat_word(c, a.data(), n, px, beat);
+            v2 = model.beat_word(c, b.data(), n, px, beat);
+            if (++beat == beats_px) {
+                beat = 0;
+                px++;
+            }
+        };
+        auto on_result = [&](uint64_t v) {
+            if (v != expected[rx] && ++mismatches <= 10) {
+                VL_PRINTF("[FAIL] GOLDEN trabajo %llu píxel %zu (op=%u bands=%u serial=%d prec=%u post=%u "
+                          "out_scale=0x%02x window=%u+%u): esperado 0x%012llx pero obtuve 0x%012llx\n",
+                          static_cast<unsigned long long>(jobs), rx, c.op, c.num_bands, c.band_serial,
+                          c.prec, c.post, c.out_scale, c.band_first, c.band_count,
+                          static_cast<unsigned long long>(expected[rx]), static_cast<unsigned long long>(v));
+            }
+            rx++;
+        };
+        ok = h.stream(n * beats_px, next_beat, n, on_result);
+        stats_end(h, p0);
+
+        uint32_t status = 0;
+        for (int t = 0; t < 100 && !(status & 0x1); t++) status = h.obi_read(0x0C);
+        if (!(status & 0x1) || (status & 0x1E)) {
+            VL_PRINTF("[FAIL] GOLDEN trabajo %llu: STATUS = 0x%08x tras %zu resultados\n",
+                      static_cast<unsigned long long>(jobs), status, rx);
+            ok = false;
+        }
+        h.obi_write(0x08, 0x2);            // CLEAR_DONE
+        done += n;
+        jobs++;
+    }
+    h.obi_write(0x24, 0);
+    h.obi_write(0x14, 0);
+    h.obi_write(0x84, 0);
+
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    VL_PRINTF("[GOLDEN] %llu píxeles en %llu trabajos, %llu discrepancias; modelo %.3f s de %.3f s\n",
+              static_cast<unsigned long long>(done), static_cast<unsigned long long>(jobs),
+              static_cast<unsigned long long>(mismatches), model_s, wall);
+    h.check(ok && mismatches == 0, "GOLDEN: fifo_out coincide con el modelo de referencia");
+
+    // Códigos de error de START con las FIFOs vacías y sin trabajo pendiente. Entre casos solo se
+    // escribe CLEAR_ERROR: cada START debe sustituir el código del anterior sin reset.
+    const uint64_t err_cases = plusarg_u64("golden_errors=", 64);
+    uint64_t err_fail = 0;
+    h.reset();
+    for (uint64_t i = 0; i < err_cases; i++) {
+        const HsiGoldenModel::Config c = random_config(rng, model, false);
+        h.obi_write(0x08, 0x4);            // CLEAR_ERROR
+        program_job(h, c, rng() % 2);
+        h.obi_write(0x08, 0x1);
+        h.ticks(4);
+        const int got = static_cast<int>((h.obi_read(0x0C) >> 1) & 0xF);
+        const int exp = model.start_error(c, true, false, false);
+        if (got != exp && ++err_fail <= 10) {
+            VL_PRINTF("[FAIL] GOLDEN error (op=%u bands=%u serial=%d ref=%d prec=%u post=%u window=%u+%u): "
+                      "esperado ERR=%d pero obtuve ERR=%d\n", c.op, c.num_bands, c.band_serial, c.ref_mode,
+                      c.prec, c.post, c.band_first, c.band_count, exp, got);
+        }
+    }
+    h.reset();
+    VL_PRINTF("[GOLDEN] %llu configuraciones de error, %llu discrepancias\n",
+              static_cast<unsigned long long>(err_cases), static_cast<unsigned long long>(err_fail));
+    h.check(err_fail == 0, "GOLDEN: STATUS.ERR coincide con el modelo de referencia");
+}
+
+/**
+ * @brief Procesa un cubo ENVI completo en un único trabajo STREAM | BAND_SERIAL.
+ *
+ * @details
+ * Cada píxel ocupa `ceil(bands / CM)` beats; el último, parcial, se alinea a la componente menos
+ * significativa como espera el núcleo. `PIXEL_COUNT` mantiene el núcleo ocupado entre beats.
+ *
+ * Con un checkpoint `cube` restaurado (`cp`) el trabajo ya está configurado y arrancado, y empieza
+ * directamente el flujo.
+ *
+ * @return `false` si no se pudo abrir algún cubo o el flujo no terminó
+ */
+template <typename Harness>
+static bool run_cube(Harness& h, const std::string& cube_hdr, const Checkpoint& cp) {
+    const int CM = HsiHarnessBase::CM;
+    HsiEnviCube cube, cube2;
+    if (!cube.open(cube_hdr)) {
+        VL_PRINTF("[FAIL] %s\n", cube.error().c_str());
+        return false;
+    }
+    std::string cube2_hdr = Verilated::commandArgsPlusMatch("cube2=");
+    const bool pairwise = !cube2_hdr.empty();
+    if (pairwise) {
+        cube2_hdr = cube2_hdr.substr(sizeof("+cube2=") - 1);
+        if (!cube2.open(cube2_hdr)) {
+            VL_PRINTF("[FAIL] %s\n", cube2.error().c_str());
+            return false;
+        }
+        if (cube2.pixels() < cube.pixels() || cube2.bands() != cube.bands()) {
+            VL_PRINTF("[FAIL] %s: dimensiones distintas de %s\n", cube2_hdr.c_str(), cube_hdr.c_str());
+            return false;
+        }
+    }
+    const HsiEnviCube& src2 = pairwise ? cube2 : cube;
+    const uint64_t ref_pixel = plusarg_u64("ref_pixel=", 0);
+    const uint64_t pixels = std::min<uint64_t>(plusarg_u64("pixels=", cube.pixels()), cube.pixels());
+    const uint32_t bands = cube.bands();
+    const uint32_t beats_px = (bands + CM - 1) / CM;
+    if (ref_pixel >= cube.pixels() || pixels == 0 || pixels > 0xFFFFFFFFull) {
+        VL_PRINTF("[FAIL] +ref_pixel o +pixels fuera de rango\n");
+        return false;
+    }
+
+    std::string out = Verilated::commandArgsPlusMatch("out=");
+    out = out.empty() ? "logs/results.bip" : out.substr(sizeof("+out=") - 1);
+    const std::string::size_type slash = out.rfind('/');
+    if (slash != std::string::npos) mkdir(out.substr(0, slash).c_str(), 0755);
+    FILE* fout = std::fopen(out.c_str(), "wb");
+    if (!fout) {
+        VL_PRINTF("[FAIL] %s: no se puede crear\n", out.c_str());
+        return false;
+    }
+    std::setvbuf(fout, nullptr, _IOFBF, 1 << 20);
+
+    VL_PRINTF("[CUBE] %s: %llu x %llu píxeles, %u bandas, %u beats por píxel, %llu píxeles a procesar\n",
+              cube_hdr.c_str(), static_cast<unsigned long long>(cube.samples()),
+              static_cast<unsigned long long>(cube.lines()), bands, beats_px,
+              static_cast<unsigned long long>(pixels));
+
+    // +check: los resultados se comparan con el modelo de referencia, evaluado por lotes al recibirlos
+    HsiGoldenModel::Config cfg;
+    cfg.op = static_cast<uint32_t>(plusarg_u64("op=", 2));
+    cfg.num_bands = bands;
+    cfg.band_serial = true;
+    cfg.out_scale = static_cast<uint8_t>(plusarg_u64("out_scale=", 0));
+    const bool check = Verilated::commandArgsPlusMatch("check")[0] != '\0';
+    const HsiGoldenModel model(golden_params());
+    if (check && !model.supported(cfg)) {
+        VL_PRINTF("[FAIL] +check: configuración no cubierta por el modelo de referencia\n");
+        std::fclose(fout);
+        return false;
+    }
+
+    HsiLatencyStats::JobInfo info;
+    info.name = "cube";
+    info.op = cfg.op;
+    info.num_bands = bands;
+    info.band_serial = true;
+    info.beats_per_pixel = beats_px;
+    info.out_stall = h.out_stall();
+    HsiLatencyStats::Perf p0;
+    if (cp.phase != CP_CUBE) {
+        h.obi_write(0x00, cfg.op);
+        h.obi_write(0x04, bands);
+        h.obi_write(0x14, 0x3 | static_cast<uint32_t>(cfg.out_scale) << 8);
+        h.obi_write(0x24, static_cast<uint32_t>(pixels));
+        p0 = read_perf(h);
+        h.stats().begin(info, h.cycles());
+        h.obi_write(0x08, 0x1);            // START
+        checkpoint(h, CP_CUBE, pixels);
+    } else if (cp.arg != pixels) {
+        VL_PRINTF("[FAIL] el checkpoint se guardó para %llu píxeles, no %llu\n",
+                  static_cast<unsigned long long>(cp.arg), static_cast<unsigned long long>(pixels));
+        std::fclose(fout);
+        return false;
+    } else {
+        p0 = read_perf(h);
+        h.stats().begin(info, h.cycles());
+    }
+
+    // Beat `beat` del píxel actual: bandas [beat*CM, ...) alineadas a la componente menos significativa
+    uint64_t pix = 0;
+    uint32_t beat = 0;
+    auto lanes = [&](const HsiEnviCube& c, uint64_t p) {
+        const uint32_t first = beat * CM;
+        const uint32_t n = std::min<uint32_t>(CM, bands - first);
+        uint64_t v = 0;
+        for (uint32_t i = 0; i < n; i++)
+            v |= static_cast<uint64_t>(HsiHarnessBase::comp(c.sample(p, first + i)))
+                 << ((n - 1 - i) * HsiHarnessBase::CW);
+        return v;
+    };
+    auto next_beat = [&](uint64_t& v1, uint64_t& v2) {
+        v1 = lanes(cube, pix);
+        v2 = lanes(src2, pairwise ? pix : ref_pixel);
+        if (++beat == beats_px) {
+            beat = 0;
+            pix++;
+        }
+    };
+    const size_t CHECK_BATCH = 4096;
+    std::vector<int32_t> ca, cb;
+    std::vector<uint64_t> expected;
+    uint64_t rx = 0, mismatches = 0;
+    auto check_result = [&](uint64_t v) {
+        const size_t i = static_cast<size_t>(rx % CHECK_BATCH);
+        if (i == 0) {
+            const size_t n = static_cast<size_t>(std::min<uint64_t>(CHECK_BATCH, pixels - rx));
+            ca.resize(static_cast<size_t>(bands) * n);
+            cb.resize(ca.size());
+            for (uint32_t band = 0; band < bands; band++) {
+                for (size_t p = 0; p < n; p++) {
+                    ca[band * n + p] = cube.sample(rx + p, band);
+                    cb[band * n + p] = src2.sample(pairwise ? rx + p : ref_pixel, band);
+                }
+            }
+            expected.resize(n);
+            model.eval_batch(cfg, ca.data(), cb.data(), n, expected.data());
+        }
+        if (v != expected[i] && ++mismatches <= 10) {
+            VL_PRINTF("[FAIL] CHECK píxel %llu: esperado 0x%012llx pero obtuve 0x%012llx\n",
+                      static_cast<unsigned long long>(rx), static_cast<unsigned long long>(expected[i]),
+                      static_cast<unsigned long long>(v));
+        }
+        rx++;
+    };
+    auto on_result = [&](uint64_t v) {
+        if (check) check_result(v);
+        unsigned char rec[2 * CM];
+        for (int c = 0; c < CM; c++) {
+            const uint32_t x = HsiHarnessBase::comp(HsiHarnessBase::unpack(v, c));
+            rec[2 * c] = static_cast<unsigned char>(x);
+            rec[2 * c + 1] = static_cast<unsigned char>(x >> 8);
+        }
+        std::fwrite(rec, 1, sizeof(rec), fout);
+    };
+
+    const auto t0 = std::chrono::steady_clock::now();
+    const vluint64_t c0 = h.cycles();
+    const bool ok = h.stream(pixels * beats_px, next_beat, pixels, on_result);
+    const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    stats_end(h, p0);
+    std::fclose(fout);
+
+    // La cabecera describe una imagen de `samples` columnas; con +pixels parcial, tantas filas como quepan
+    const uint64_t out_lines = (pixels % cube.samples()) ? 1 : pixels / cube.samples();
+    const uint64_t out_samples = (pixels % cube.samples()) ? pixels : cube.samples();
+    hsi_envi_write_header(out + ".hdr", out_samples, out_lines, CM, 2);
+    VL_PRINTF("[CUBE] %llu resultados en %s, %llu ciclos, %.3f s (%.0f píxeles/s)\n",
+              static_cast<unsigned long long>(pixels), out.c_str(),
+              static_cast<unsigned long long>(h.cycles() - c0), wall, wall > 0 ? pixels / wall : 0.0);
+    if (check) {
+        VL_PRINTF("[CHECK] %llu resultados comparados con el modelo de referencia, %llu discrepancias\n",
+                  static_cast<unsigned long long>(rx), static_cast<unsigned long long>(mismatches));
+        h.check(mismatches == 0, "CHECK: resultados del cubo iguales al modelo de referencia");
+    }
+    return ok;
+}
+
+/**
+ * @brief Reset (o `+restore`), cubo o secuencia de requisitos (más `+golden`), informe de latencias y
+ * resumen.
+ *
+ * @param model Nombre del modelo en el informe JSON ("rtl" o "tlm")
+ * @return Número de requisitos fallidos
+ */
+template <typename Harness>
+static int run(Harness& h, const char* model) {
+    // +restore sustituye al reset y a la parte de la secuencia anterior al checkpoint
+    Checkpoint cp;
+    const std::string restore = plusarg_str("restore=");
+    if (!restore.empty()) {
+        if (!h.restore(restore, cp)) return h.errors();
+    } else {
+        h.reset();
+        checkpoint(h, CP_RESET, 0);
+    }
+
+    const std::string cube = plusarg_str("cube=");
+    const uint64_t golden = plusarg_u64("golden=", 0);
+    const uint64_t out_stall = plusarg_u64("out_stall=", 0);
+    if (out_stall > 99) {
+        VL_PRINTF("[FAIL] +out_stall=%llu fuera de rango (0..99)\n", static_cast<unsigned long long>(out_stall));
+        return h.errors() + 1;
+    }
+    h.set_out_stall(static_cast<uint32_t>(out_stall), plusarg_u64("seed=", 1));
+    // La fase del checkpoint fija qué resto de la secuencia se reanuda: exige los mismos plusargs
+    if (cp.phase == CP_CUBE && cube.empty()) {
+        VL_PRINTF("[FAIL] checkpoint 'cube' sin +cube=<hdr>\n");
+        return h.errors() + 1;
+    }
+    if (cp.phase == CP_GOLDEN && (!cube.empty() || golden == 0)) {
+        VL_PRINTF("[FAIL] checkpoint 'golden' requiere +golden=<n> y no admite +cube\n");
+        return h.errors() + 1;
+    }
+    int errors;
+    if (!cube.empty()) {
+        errors = run_cube(h, cube, cp) ? h.errors() : h.errors() + 1;
+    } else if (cp.phase == CP_GOLDEN) {
+        run_golden(h, golden, cp.arg);
+        errors = h.errors();
+    } else {
+        run_tests(h);
+        if (golden) {
+            h.reset();
+            run_golden(h, golden, 0);
+        }
+        errors = h.errors();
+    }
+
+    // Informe de los flujos (+cube y cada trabajo de +golden); los requisitos no usan stream()
+    if (!h.stats().empty()) {
+        std::string json = plusarg_str("stats_json=");
+        json = json.empty() ? "logs/stats.json" : json;
+        char config[128];
+        std::snprintf(config, sizeof(config), "{\"component_width\": %d, \"components_max\": %d, \"fifo_depth\": %u}",
+                      Harness::CW, Harness::CM, Harness::FIFO_DEPTH);
+        if (h.stats().write_json(json, model, config)) {
+            VL_PRINTF("[STATS] latencias y rendimiento en %s\n", json.c_str());
+        } else {
+            VL_PRINTF("[FAIL] %s: no se puede crear el informe\n", json.c_str());
+            errors++;
+        }
+    }
+
+    if (!cube.empty())
+        VL_PRINTF("CUBO %s\n", errors == 0 ? "PROCESADO" : "CON ERRORES");
+    else if (errors == 0)
+        VL_PRINTF("TEST COMPLETO TODOS LOS REQUISITOS VERIFICADOS CON ÉXITO (%llu ciclos)\n",
+                  static_cast<unsigned long long>(h.cycles()));
+    else
+        VL_PRINTF("TEST COMPLETO ERRORES DETECTADOS: %d\n", errors);
+    return errors;
+}
+
+/**
+ * @brief Punto de entrada: elige el DUT Verilator o el modelo rápido (`+model=tlm`) y ejecuta `run()`.
+ *
+ * @return 0 si todos los requisitos pasan, 1 en caso contrario
+ */
+int main(int argc, char** argv) {
+    Verilated::commandArgs(argc, argv);
+
+    std::string model = Verilated::commandArgsPlusMatch("model=");
+    model = model.empty() ? "rtl" : model.substr(sizeof("+model=") - 1);
+    if (model == "tlm") {
+        HsiAccelTlmHarness t;
+        if (Verilated::commandArgsPlusMatch("tlm_report")[0] != '\0') t.report_jobs();
+        VL_PRINTF("[TLM] modelo loosely-timed, ciclos estimados\n");
+        return run(t, "tlm") ? 1 : 0;
+    }
+    if (model != "rtl") {
+        VL_PRINTF("[FAIL] +model=%s: se esperaba rtl o tlm\n", model.c_str());
+        return 1;
+    }
+
+#if VM_TRACE
+    const bool trace_en = Verilated::commandArgsPlusMatch("notrace")[0] == '\0';
+    std::string trace_file = Verilated::commandArgsPlusMatch("trace_file=");
+    trace_file = trace_file.empty() ? TRACE_DEFAULT_FILE : trace_file.substr(sizeof("+trace_file=") - 1);
+    if (trace_en) Verilated::traceEverOn(true);
+#endif
+
+    HsiAccelObiHarness* h = new HsiAccelObiHarness(plusarg_u64("max_cycles=", 10000));
+#if VM_TRACE
+    if (trace_en) h->trace(trace_file);
+#endif
+
+    const int errors = run(*h, "rtl");
+
+#if VM_COVERAGE
+    Verilated::threadContextp()->coveragep()->write("coverage.dat");
+#endif
+    delete h;
+    return errors ? 1 : 0;
+}
@@ -0,0 +1,678 @@
+/**
+ * @file hsi_accel_tlm.cpp
+ * @brief Implementación del modelo loosely-timed de `hsi_accel_obi`.
+ *
+ * @details
+ * `wrapper_step`, `core_step` y `dma_step` reproducen cada uno una transición de
+ * `hsi_vector_core_wrapper`, de la FSM de `hsi_vector_core` y de `hsi_dma`; `evaluate()` los repite
+ * hasta que ninguno progresa. Los comentarios indican la expresión del RTL que se sigue.
+ *
+ * Costes estimados, en ciclos de `clk_i`:
+ * - Núcleo en modo FSM: 1 ciclo de CAPTURE por beat y, por cada referencia (una sin REF_MODE),
+ *   `ceil(carriles / DOT_LANES)` ciclos de emisión más 1; por píxel, `log2(DOT_LANES)` ciclos del
+ *   árbol de sumadores más WRITE y WRITE_DONE. OP_CROSS: 2 ciclos por píxel más la escritura.
+ * - Núcleo en STREAM y OP_REF_LOAD: 1 ciclo por beat.
+ * - DMA: `WPB + 3` ciclos por beat leído (arbitraje, peticiones, última respuesta y escritura en la
+ *   FIFO), 2 por beat saltado y `palabras + 4` por resultado escrito.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+#include "hsi_accel_tlm.h"
+
+#include <algorithm>
+
+namespace {
+
+enum Addr : uint32_t {
+    ADDR_OPCODE = 0x00, ADDR_NUM_BANDS = 0x04, ADDR_COMMAND = 0x08, ADDR_STATUS = 0x0C,
+    ADDR_FIFO_STATUS = 0x10, ADDR_CONFIG = 0x14, ADDR_DMA_SRC1 = 0x18, ADDR_DMA_SRC2 = 0x1C,
+    ADDR_DMA_DST = 0x20, ADDR_PIXEL_COUNT = 0x24, ADDR_DMA_STRIDE = 0x28, ADDR_PROCESSED = 0x2C,
+    ADDR_IRQ_ENABLE = 0x30, ADDR_IRQ_STATUS = 0x34, ADDR_IRQ_LEVEL = 0x38, ADDR_PERF_CTRL = 0x3C,
+    ADDR_PERF_BASE = 0x40, ADDR_FIFO_LEVEL_IN = 0x74, ADDR_FIFO_LEVEL_OUT = 0x78,
+    ADDR_DESC_STATUS = 0x7C, ADDR_THRESHOLD = 0x80, ADDR_BAND_WINDOW = 0x84, ADDR_CORE_BASE = 0x100
+};
+
+enum Irq { IRQ_DONE = 1, IRQ_ERROR = 2, IRQ_OUT_LEVEL = 4, IRQ_IN_LEVEL = 8 };
+
+/// @brief Índices de estado de la FSM del núcleo en PERF_STATE (`fsm_state`)
+enum PerfState { S_IDLE = 0, S_CAPTURE = 1, S_COMPUTE = 3, S_WRITE = 4, S_STREAM = 7, S_REF_LOAD = 8 };
+
+const uint32_t PERF_NUM = 13;                  ///< PERF_BUSY .. PERF_STATE(8)
+
+uint32_t apply_be(uint32_t orig, uint32_t data, uint8_t be) {
+    uint32_t v = orig;
+    for (int i = 0; i < 4; i++) {
+        if (be & (1 << i)) v = (v & ~(0xFFu << (8 * i))) | (data & (0xFFu << (8 * i)));
+    }
+    return v;
+}
+
+} // namespace
+
+HsiAccelTlm::HsiAccelTlm(const Params& p)
+    : m_p(p), m_model(p.core), m_cw(p.core.component_width), m_cm(p.core.components_max),
+      m_wpb(static_cast<uint32_t>((p.core.component_width * p.core.components_max + 31) / 32)),
+      m_npw(static_cast<uint32_t>((std::min(2 * p.core.component_width,
+                                            p.core.component_width * p.core.components_max) + 31) / 32)) {
+    reset();
+}
+
+void HsiAccelTlm::set_memory(MemRead rd, MemWrite wr) {
+    m_mem_rd = rd;
+    m_mem_wr = wr;
+}
+
+void HsiAccelTlm::reset() {
+    m_shadow = Desc();
+    m_cur = Desc();
+    m_cur_valid = false;
+    m_desc.clear();
+    m_desc_done = 0;
+    m_done = m_busy = false;
+    m_err_reg = 0;
+    m_dma_busy = m_dma_done = false;
+    m_processed = 0;
+    m_irq_enable = m_irq_status = 0;
+    m_irq_level = 1;
+    m_in1.clear();
+    m_in2.clear();
+    m_out.clear();
+
+    m_state = C_IDLE;
+    m_core_err = 0;
+    m_pixel_done = m_ref_loaded = false;
+    m_beat = m_ref_idx = 0;
+    m_have_res = false;
+    m_ref_mem.assign(static_cast<size_t>(m_model.ref_slots()) * std::max(1, m_p.core.ref_beats), 0);
+
+    m_dma_rd_left = m_dma_wr_left = 0;
+
+    m_now = cycles();
+    m_core_t = m_dma_t = m_now;
+    m_perf_t0 = m_now;
+    m_perf_busy = m_perf_pixels = m_perf_stall_in = 0;
+    std::fill(m_perf_state, m_perf_state + PERF_STATES, 0);
+    m_job_open = m_job_core_done = false;
+}
+
+uint64_t HsiAccelTlm::cycles() const {
+    return std::max(m_now, std::max(m_core_t, m_dma_t));
+}
+
+HsiGoldenModel::Config HsiAccelTlm::config(const Desc& d) const {
+    HsiGoldenModel::Config c;
+    c.op = d.op;
+    c.num_bands = d.num_bands;
+    c.band_serial = d.cfg & 0x2;
+    c.ref_mode = d.cfg & 0x4;
+    c.post = (d.cfg >> 3) & 0x3;
+    c.prec = (d.cfg >> 5) & 0x3;
+    c.out_scale = static_cast<uint8_t>(d.cfg >> 8);
+    c.threshold = static_cast<int32_t>(d.threshold);
+    c.band_first = static_cast<uint16_t>(d.band_window);
+    c.band_count = static_cast<uint16_t>(d.band_window >> 16);
+    return c;
+}
+
+bool HsiAccelTlm::addr_valid(uint32_t a) const {
+    switch (a) {
+    case ADDR_OPCODE: case ADDR_NUM_BANDS: case ADDR_COMMAND: case ADDR_STATUS: case ADDR_CONFIG:
+    case ADDR_PIXEL_COUNT: case ADDR_PROCESSED: case ADDR_IRQ_ENABLE: case ADDR_IRQ_STATUS:
+    case ADDR_IRQ_LEVEL: case ADDR_THRESHOLD: case ADDR_BAND_WINDOW:
+    case ADDR_FIFO_STATUS: case ADDR_FIFO_LEVEL_IN: case ADDR_FIFO_LEVEL_OUT:  // EXPOSE_FIFO_STATUS = 1
+        return true;
+    case ADDR_DMA_SRC1: case ADDR_DMA_SRC2: case ADDR_DMA_DST: case ADDR_DMA_STRIDE:
+        return m_p.dma_en;
+    case ADDR_PERF_CTRL:
+        return m_p.perf_en;
+    case ADDR_DESC_STATUS:
+        return m_p.desc_depth > 0;
+    default:
+        // PERF_* y PERF_CORE_* de un único núcleo
+        return m_p.perf_en && (a & 0x3) == 0 &&
+               ((a >= ADDR_PERF_BASE && a < ADDR_PERF_BASE + 4 * PERF_NUM) || a == ADDR_CORE_BASE ||
+                a == ADDR_CORE_BASE + 4);
+    }
+}
+
+uint32_t HsiAccelTlm::status_fifo() const {
+    // fifo_af_level / fifo_ae_level se limitan a FIFO_DEPTH + 1 y FIFO_DEPTH en hsi_accel_obi
+    const uint32_t af = std::min<uint32_t>(m_irq_level & 0xFFFF, m_p.fifo_depth + 1);
+    const uint32_t ae = std::min<uint32_t>(m_irq_level >> 16, m_p.fifo_depth);
+    const size_t lv[3] = {m_in1.size(), m_in2.size(), m_out.size()};
+    uint32_t f = (in1_full() ? 0x1u : 0) | (in2_full() ? 0x2u : 0) |
+                 (m_out.size() >= m_p.fifo_depth ? 0x4u : 0) | (m_out.empty() ? 0x8u : 0) |
+                 (m_in1.empty() ? 0x10u : 0) | (m_in2.empty() ? 0x20u : 0);
+    for (int k = 0; k < 3; k++) {
+        if (lv[k] >= af) f |= 1u << (6 + k);
+        if (lv[k] <= ae) f |= 1u << (9 + k);
+    }
+    return f;
+}
+
+uint32_t HsiAccelTlm::read(uint32_t addr, bool* err) {
+    m_now += BUS_CYCLES;
+    const uint32_t a = addr & 0x1FF;
+    const bool valid = addr_valid(a);
+    if (err) *err = !valid;
+    if (!valid) return 0;
+
+    switch (a) {
+    case ADDR_OPCODE:         return m_shadow.op;
+    case ADDR_NUM_BANDS:      return m_shadow.num_bands;
+    case ADDR_STATUS:
+        return (m_done ? 0x1u : 0) | static_cast<uint32_t>(m_err_reg) << 1 | (m_busy ? 0x100u : 0) |
+               (m_dma_busy ? 0x200u : 0) | (m_dma_done ? 0x400u : 0);
+    case ADDR_FIFO_STATUS:    return status_fifo();
+    case ADDR_FIFO_LEVEL_IN:  return static_cast<uint32_t>(m_in2.size() << 16 | m_in1.size());
+    case ADDR_FIFO_LEVEL_OUT: return static_cast<uint32_t>(m_out.size());
+    case ADDR_CONFIG:         return m_shadow.cfg;
+    case ADDR_THRESHOLD:      return m_shadow.threshold;
+    case ADDR_BAND_WINDOW:    return m_shadow.band_window;
+    case ADDR_DMA_SRC1:       return m_shadow.dma_src1;
+    case ADDR_DMA_SRC2:       return m_shadow.dma_src2;
+    case ADDR_DMA_DST:        return m_shadow.dma_dst;
+    case ADDR_PIXEL_COUNT:    return m_shadow.pixel_count;
+    case ADDR_DMA_STRIDE:     return m_shadow.dma_stride;
+    case ADDR_PROCESSED:      return m_processed;
+    case ADDR_IRQ_ENABLE:     return m_irq_enable;
+    case ADDR_IRQ_STATUS:     return m_irq_status;
+    case ADDR_IRQ_LEVEL:      return m_irq_level;
+    case ADDR_DESC_STATUS:
+        return (m_desc.size() >= m_p.desc_depth ? 0x10000u : 0) | (m_desc_done & 0xFF) << 8 |
+               static_cast<uint32_t>(m_desc.size());
+    case ADDR_CORE_BASE:      return static_cast<uint32_t>(m_perf_pixels);
+    case ADDR_CORE_BASE + 4:  return static_cast<uint32_t>(m_perf_busy);
+    case ADDR_COMMAND:
+    case ADDR_PERF_CTRL:      return 0;
+    default: {
+        const uint32_t k = (a - ADDR_PERF_BASE) >> 2;
+        switch (k) {
+        case 0:  return static_cast<uint32_t>(m_perf_busy);
+        case 1:  return static_cast<uint32_t>(m_perf_pixels);
+        case 2:  return static_cast<uint32_t>(m_perf_stall_in);
+        case 3:  return 0;                 // PERF_STALL_OUT no se estima
+        case 4:  return static_cast<uint32_t>(cycles() - m_perf_t0 - std::min(m_perf_busy, cycles() - m_perf_t0));
+        default: return static_cast<uint32_t>(m_perf_state[k - 4]);
+        }
+    }
+    }
+}
+
+bool HsiAccelTlm::write(uint32_t addr, uint32_t data, uint8_t be) {
+    m_now += BUS_CYCLES;
+    const uint32_t a = addr & 0x1FF;
+    if (!addr_valid(a)) return false;
+
+    bool ok = true, start = false, dma_start = false;
+    switch (a) {
+    case ADDR_OPCODE:      if (be & 0x1) m_shadow.op = data & 0xF; break;
+    case ADDR_NUM_BANDS:   m_shadow.num_bands = apply_be(m_shadow.num_bands, data, be); break;
+    case ADDR_CONFIG:
+        // Lectura {OUT_SCALE, 0, PREC, POST, REF_MODE, BAND_SERIAL, STREAM}
+        if (be & 0x1) m_shadow.cfg = (m_shadow.cfg & ~0x7Fu) | (data & 0x7F);
+        if (be & 0x2) m_shadow.cfg = (m_shadow.cfg & ~0xFF00u) | (data & 0xFF00);
+        break;
+    case ADDR_DMA_SRC1:    m_shadow.dma_src1 = apply_be(m_shadow.dma_src1, data, be); break;
+    case ADDR_DMA_SRC2:    m_shadow.dma_src2 = apply_be(m_shadow.dma_src2, data, be); break;
+    case ADDR_DMA_DST:     m_shadow.dma_dst = apply_be(m_shadow.dma_dst, data, be); break;
+    case ADDR_PIXEL_COUNT: m_shadow.pixel_count = apply_be(m_shadow.pixel_count, data, be); break;
+    case ADDR_DMA_STRIDE:  m_shadow.dma_stride = apply_be(m_shadow.dma_stride, data, be); break;
+    case ADDR_THRESHOLD:   m_shadow.threshold = apply_be(m_shadow.threshold, data, be); break;
+    case ADDR_BAND_WINDOW: m_shadow.band_window = apply_be(m_shadow.band_window, data, be); break;
+    case ADDR_IRQ_ENABLE:  if (be & 0x1) m_irq_enable = data & 0xF; break;
+    case ADDR_IRQ_STATUS:  if (be & 0x1) m_irq_status &= ~(data & 0xF); break;
+    case ADDR_IRQ_LEVEL:   m_irq_level = apply_be(m_irq_level, data, be); break;
+    case ADDR_PERF_CTRL:
+        if ((be & 0x1) && (data & 0x1)) {
+            m_perf_t0 = cycles();
+            m_perf_busy = m_perf_pixels = m_perf_stall_in = 0;
+            std::fill(m_perf_state, m_perf_state + PERF_STATES, 0);
+        }
+        break;
+    case ADDR_COMMAND: {
+        if (!(be & 0x1)) break;
+        const bool enqueue = data & 0x10;
+        if (enqueue) {
+            if (m_desc.size() >= m_p.desc_depth) {
+                ok = false;                    // desc_reject
+            } else {
+                Desc d = m_shadow;
+                d.dma = data & 0x8;
+                m_desc.push_back(d);
+            }
+        }
+        if (data & 0x2) {                      // CLEAR_DONE
+            m_done = m_dma_done = false;
+            m_desc_done = 0;
+        }
+        if (data & 0x4) m_err_reg = 0;         // CLEAR_ERROR
+        if ((data & 0x1) && !enqueue && !m_busy) {
+            m_done = false;
+            m_busy = true;
+            m_processed = 0;
+            m_cur_valid = false;
+            start = true;
+        }
+        if ((data & 0x8) && !enqueue && m_p.dma_en && !m_dma_busy) {
+            m_dma_done = false;
+            m_dma_busy = true;
+            m_cur_valid = false;
+            dma_start = true;
+        }
+        break;
+    }
+    default: break;                            // RO
+    }
+
+    // El DMA arranca antes que el núcleo para que este vea more_input
+    if (dma_start) start_dma();
+    if (start) start_core();
+    evaluate();
+    return ok;
+}
+
+void HsiAccelTlm::push(bool en1, uint64_t v1, bool en2, uint64_t v2) {
+    m_now += PORT_CYCLES;
+    if (en1 && !in1_full()) m_in1.push_back({v1, m_now});
+    if (en2 && !in2_full()) m_in2.push_back({v2, m_now});
+    evaluate();
+}
+
+bool HsiAccelTlm::pop(uint64_t& v) {
+    m_now += PORT_CYCLES;
+    if (m_out.empty()) return false;
+    m_now = std::max(m_now, m_out.front().t);
+    v = m_out.front().data;
+    m_out.pop_front();
+    evaluate();
+    return true;
+}
+
+void HsiAccelTlm::evaluate() {
+    for (;;) {
+        bool progress = wrapper_step();
+        progress = dma_step() || progress;
+        progress = core_step() || progress;
+        if (!progress) break;
+    }
+    // Fuentes por nivel (con los mismos umbrales que FIFO_STATUS)
+    const uint32_t f = status_fifo();
+    if (f & 0x100) m_irq_status |= IRQ_OUT_LEVEL;
+    if ((f & 0x200) && (f & 0x400)) m_irq_status |= IRQ_IN_LEVEL;
+}
+
+void HsiAccelTlm::set_done() {
+    if (!m_done) m_irq_status |= IRQ_DONE;
+    m_done = true;
+}
+
+void HsiAccelTlm::set_error(int e) {
+    if (m_err_reg == 0) m_irq_status |= IRQ_ERROR;
+    m_err_reg = e;
+}
+
+bool HsiAccelTlm::wrapper_step() {
+    bool progress = false;
+
+    // error_code_reg <= error_code_i solo con un trabajo en curso; BUSY se libera
+    if (m_core_err && m_busy) {
+        set_error(m_core_err);
+        m_busy = false;
+        m_job_core_done = true;
+        close_job();
+        progress = true;
+    }
+
+    // pixel_done se registra en IDLE; con PIXEL_COUNT = 0 activa DONE y libera BUSY
+    if (m_state == C_IDLE) m_pixel_done = !m_out.empty() || m_ref_loaded;
+    if (m_pixel_done && job_count() == 0 && (!m_done || m_busy)) {
+        if (m_busy) job_end();
+        set_done();
+        progress = true;
+    }
+
+    // desc_pop: núcleo y DMA libres y sin error
+    if (!m_desc.empty() && !m_busy && !m_dma_busy && m_err_reg == 0) {
+        m_cur = m_desc.front();
+        m_desc.pop_front();
+        m_cur_valid = true;
+        m_done = false;
+        m_busy = true;
+        m_processed = 0;
+        if (m_cur.dma && m_p.dma_en) {
+            m_dma_done = false;
+            m_dma_busy = true;
+            start_dma();
+        }
+        start_core();
+        progress = true;
+    }
+    return progress;
+}
+
+void HsiAccelTlm::job_end() {
+    m_busy = false;
+    if (m_cur_valid) m_desc_done++;
+    m_job.core_end = m_core_t;
+    m_job_core_done = true;
+    close_job();
+}
+
+void HsiAccelTlm::close_job() {
+    if (!m_job_open || !m_job_core_done || (m_job.dma && m_dma_busy)) return;
+    m_job.end = std::max(m_job.core_end, m_job.dma ? m_dma_t : 0);
+    m_job.core_busy = m_perf_busy - m_job_busy0;
+    m_job_open = false;
+    if (m_job_hook) m_job_hook(m_job);
+}
+
+void HsiAccelTlm::pixel_valid() {
+    m_processed++;
+    m_perf_pixels++;
+    m_job.pixels++;
+    // Fin de trabajo: DONE solo con el último de los PIXEL_COUNT resultados
+    if (m_busy && job_count() != 0 && m_processed >= job_count()) {
+        set_done();
+        job_end();
+    }
+}
+
+void HsiAccelTlm::start_core() {
+    // El pulso de START se pierde si el núcleo no está en IDLE
+    if (m_state != C_IDLE) return;
+    m_cc = config(active());
+    m_stream = active().cfg & 0x1;
+
+    // Un START descarta el pixel_done del trabajo anterior (p. ej. el de OP_REF_LOAD)
+    m_pixel_done = false;
+    m_ref_loaded = false;
+
+    const bool ref_load = m_cc.op == HsiGoldenModel::OP_REF_LOAD;
+    m_ref_active = m_model.ref_active(m_cc);
+    const bool in_empty = ref_load ? m_in2.empty() : (m_in1.empty() || (!m_ref_active && m_in2.empty()));
+    const int e = m_model.start_error(m_cc, in_empty, m_out.size() >= m_p.fifo_depth, more_input());
+    // Cada START sustituye el código de error del anterior
+    m_core_err = e;
+    if (e) return;
+
+    if (m_job_open) {
+        m_job_core_done = true;
+        close_job();
+    }
+    m_core_t = std::max(m_core_t, m_now);
+    m_job = JobStats();
+    m_job.op = m_cc.op;
+    m_job.dma = m_dma_busy;
+    m_job.start = m_core_t;
+    m_job_busy0 = m_perf_busy;
+    m_job_open = true;
+    m_job_core_done = false;
+
+    setup_job();
+    m_state = ref_load ? C_REF_LOAD : C_RUN;
+}
+
+void HsiAccelTlm::setup_job() {
+    const HsiGoldenModel::Config& c = m_cc;
+    m_beats = m_model.beats(c);
+    m_beat = 0;
+    m_ref_idx = 0;
+    m_have_res = false;
+    m_pa.assign(c.num_bands, 0);
+    m_pb.assign(c.num_bands, 0);
+
+    const int slots = m_model.ref_slots();
+    const uint32_t ref_beats = static_cast<uint32_t>(std::max(1, m_p.core.ref_beats));
+    if (m_ref_active) {
+        // ref_vec: cada beat guardado se desempaqueta con la geometría del trabajo en curso
+        m_refs.assign(static_cast<size_t>(slots) * c.num_bands, 0);
+        for (int k = 0; k < slots; k++)
+            for (uint32_t b = 0; b < m_beats && b < ref_beats; b++)
+                m_model.unpack_beat(c, m_ref_mem[k * ref_beats + b], b, m_refs.data() + k * c.num_bands, 1, 0);
+    }
+
+    // Coste de cada beat y de la escritura del píxel
+    m_beat_cost.assign(m_beats, 1);
+    m_pixel_cost = 0;
+    const bool fsm = c.op != HsiGoldenModel::OP_REF_LOAD && (!m_stream || m_ref_active);
+    if (!fsm) return;
+    int log_lanes = 0;
+    while ((1u << log_lanes) < m_p.dot_lanes) log_lanes++;
+    if (c.op == HsiGoldenModel::OP_CROSS) {
+        m_beat_cost[0] = 2;                    // CAPTURE + COMPUTE
+        m_pixel_cost = 2;                      // WRITE + WRITE_DONE
+        return;
+    }
+    const uint32_t bmax = m_model.beat_max(c), lo_w = m_model.win_lo(c), hi_w = m_model.win_hi(c);
+    const uint32_t refs = m_ref_active ? static_cast<uint32_t>(slots) : 1;
+    for (uint32_t b = 0; b < m_beats; b++) {
+        const uint32_t base = m_model.win_base(c) + b * bmax;
+        const uint32_t nb = std::min(bmax, c.num_bands - base);
+        const uint32_t lo = lo_w > base ? lo_w - base : 0;
+        const uint32_t hi = std::min(hi_w - base, nb);
+        const uint32_t lanes_hi = (hi + (1u << c.prec) - 1) >> c.prec;
+        const uint32_t lanes = lanes_hi > (lo >> c.prec) ? lanes_hi - (lo >> c.prec) : 0;
+        m_beat_cost[b] = 1 + refs * ((lanes + m_p.dot_lanes - 1) / m_p.dot_lanes + 1);
+    }
+    m_pixel_cost = static_cast<uint64_t>(log_lanes) + 2;
+}
+
+void HsiAccelTlm::core_time(uint64_t ready, uint64_t cost, int state) {
+    // Espera al dato en CAPTURE (stall_in) y después el coste del beat o de la escritura
+    if (ready > m_core_t) {
+        m_perf_stall_in += ready - m_core_t;
+        m_perf_busy += ready - m_core_t;
+        m_perf_state[m_state == C_REF_LOAD ? S_REF_LOAD : m_stream && !m_ref_active ? S_STREAM : S_CAPTURE] +=
+            ready - m_core_t;
+        m_core_t = ready;
+    }
+    m_core_t += cost;
+    m_perf_busy += cost;
+    m_perf_state[state] += cost;
+}
+
+bool HsiAccelTlm::core_step() {
+    const bool stream = m_stream && !m_ref_active;
+    const bool out_full = m_out.size() >= m_p.fifo_depth;
+
+    if (m_state == C_REF_LOAD) {
+        if (!m_in2.empty()) {
+            const Entry e = m_in2.front();
+            m_in2.pop_front();
+            const uint32_t ref_beats = static_cast<uint32_t>(std::max(1, m_p.core.ref_beats));
+            if (m_beat < ref_beats) m_ref_mem[m_ref_idx * ref_beats + m_beat] = e.data;
+            core_time(e.t, 1, S_REF_LOAD);
+            if (++m_beat == m_beats) {
+                // ref_stored: cada referencia cuenta como un pixel_valid
+                m_beat = 0;
+                pixel_valid();
+                if (++m_ref_idx == static_cast<uint32_t>(m_model.ref_slots())) {
+                    m_state = C_IDLE;
+                    m_ref_loaded = true;
+                }
+            }
+            return true;
+        }
+        if (!more_input()) {
+            m_state = C_IDLE;                  // Carga abandonada: el banco queda a medias
+            return true;
+        }
+        return false;
+    }
+    if (m_state != C_RUN) return false;
+
+    // Resultado retenido hasta que haya hueco en la FIFO de salida
+    if (m_have_res && !out_full) {
+        m_out.push_back({m_res.data, std::max(m_res.t, m_now)});
+        m_have_res = false;
+        pixel_valid();
+        return true;
+    }
+
+    // En STREAM la etapa de entrada sigue con los beats no finales del píxel siguiente
+    const bool in_avail = !m_in1.empty() && (m_ref_active || !m_in2.empty());
+    const bool can_beat = !m_have_res || (stream && m_beat + 1 < m_beats);
+    if (in_avail && can_beat) {
+        const Entry e1 = m_in1.front();
+        m_in1.pop_front();
+        uint64_t ready = e1.t;
+        m_model.unpack_beat(m_cc, e1.data, m_beat, m_pa.data(), 1, 0);
+        if (!m_ref_active) {
+            const Entry e2 = m_in2.front();
+            m_in2.pop_front();
+            ready = std::max(ready, e2.t);
+            m_model.unpack_beat(m_cc, e2.data, m_beat, m_pb.data(), 1, 0);
+        }
+        core_time(ready, m_beat_cost[m_beat], stream ? S_STREAM : S_COMPUTE);
+        if (++m_beat == m_beats) {
+            m_beat = 0;
+            uint64_t w = 0;
+            if (m_ref_active) m_model.eval_refs(m_cc, m_pa.data(), m_refs.data(), 1, &w);
+            else              m_model.eval_batch(m_cc, m_pa.data(), m_pb.data(), 1, &w);
+            core_time(0, m_pixel_cost, S_WRITE);
+            m_res = {w, m_core_t};
+            m_have_res = true;
+        }
+        return true;
+    }
+
+    // Vuelta a IDLE en el límite de píxel sin datos ni productor pendiente
+    if (!m_have_res && m_beat == 0 && !in_avail && !more_input()) {
+        m_state = C_IDLE;
+        return true;
+    }
+    return false;
+}
+
+void HsiAccelTlm::start_dma() {
+    const Desc& d = active();
+    m_dc = config(d);
+    const bool ref_load = m_dc.op == HsiGoldenModel::OP_REF_LOAD;
+    // OP_REF_LOAD solo llena la FIFO 2 y REF_MODE solo usa la FIFO 1
+    m_dma_src1_en = !ref_load;
+    m_dma_src2_en = ref_load || !m_dc.ref_mode;
+    m_dma_wr_words = m_dc.post != 0 ? m_npw : m_wpb;
+    m_dma_src_step = (d.dma_stride & 0xFFFF) ? (d.dma_stride & 0xFFFF) : m_wpb * 4;
+    m_dma_dst_step = (d.dma_stride >> 16) ? (d.dma_stride >> 16) : m_dma_wr_words * 4;
+    m_dma_src[0] = d.dma_src1;
+    m_dma_src[1] = d.dma_src2;
+    m_dma_dst = d.dma_dst;
+    m_dma_rd_left = d.pixel_count;
+    m_dma_wr_left = m_dma_src1_en ? d.pixel_count : 0;
+    m_dma_rd_band = 0;
+    m_dma_sel = !m_dma_src1_en;
+    m_dma_skip_known = false;
+    m_dma_lead_off = m_dma_tail_off = m_dma_lead_band = 0;
+    m_dma_t = std::max(m_dma_t, m_now);
+    if (d.pixel_count == 0) {
+        m_dma_busy = false;
+        m_dma_done = true;
+    }
+}
+
+bool HsiAccelTlm::dma_step() {
+    if (!m_dma_busy) return false;
+
+    // D_ARB: escribir un resultado tiene prioridad sobre leer un beat
+    if (m_dma_wr_left != 0 && !m_out.empty()) {
+        const Entry e = m_out.front();
+        m_out.pop_front();
+        m_dma_t = std::max(m_dma_t, e.t);
+        for (uint32_t i = 0; i < m_dma_wr_words; i++) {
+            const uint32_t w = i < 2 ? static_cast<uint32_t>(e.data >> (32 * i)) : 0;
+            if (m_mem_wr) m_mem_wr(m_dma_dst + 4 * i, w);
+        }
+        m_dma_dst += m_dma_dst_step;
+        m_dma_wr_left--;
+        m_dma_t += m_dma_wr_words + 4;
+        return true;
+    }
+
+    if (m_dma_rd_left != 0) {
+        const uint32_t bmax = m_model.beat_max(m_dc);
+        const bool skip = m_dc.band_serial && m_dc.band_count != 0 &&
+                          (m_dma_rd_band + bmax <= m_dc.band_first ||
+                           m_dma_rd_band >= static_cast<uint32_t>(m_dc.band_first) + m_dc.band_count);
+        if (skip) {
+            // Salto en D_ARB (un ciclo) de las dos fuentes: una posición de beat en el primer píxel,
+            // después el hueco entero (el final de un píxel y el principio del siguiente a la vez)
+            uint32_t off, band;
+            bool end;
+            if (!m_dma_skip_known) {
+                off = m_dma_src_step;
+                end = m_dma_rd_band + bmax >= m_dc.num_bands;
+                band = end ? 0 : m_dma_rd_band + bmax;
+                if (m_dma_rd_band < m_dc.band_first) {
+                    m_dma_lead_off += m_dma_src_step;
+                    m_dma_lead_band = m_dma_rd_band + bmax;
+                } else {
+                    m_dma_tail_off += m_dma_src_step;
+                }
+            } else if (m_dma_rd_band < m_dc.band_first) {
+                off = m_dma_lead_off;
+                end = m_dma_lead_band >= m_dc.num_bands;
+                band = end ? 0 : m_dma_lead_band;
+            } else {
+                off = m_dma_tail_off + m_dma_lead_off;
+                end = true;
+                band = m_dma_lead_band;
+            }
+            if (m_dma_src1_en) m_dma_src[0] += off;
+            if (m_dma_src2_en) m_dma_src[1] += off;
+            m_dma_rd_band = band;
+            if (end) {
+                m_dma_rd_left--;
+                m_dma_skip_known = true;
+            }
+            m_dma_t += 1;
+            return true;
+        }
+        std::deque<Entry>& fifo = m_dma_sel ? m_in2 : m_in1;
+        if (fifo.size() < m_p.fifo_depth) {
+            uint32_t& ptr = m_dma_src[m_dma_sel];
+            const int dw = m_cw * m_cm;
+            uint64_t v = 0;
+            for (uint32_t i = 0; i < m_wpb; i++) {
+                const uint32_t w = m_mem_rd ? m_mem_rd(ptr + 4 * i) : 0;
+                if (i < 2) v |= static_cast<uint64_t>(w) << (32 * i);
+            }
+            if (dw < 64) v &= (1ull << dw) - 1;
+            m_dma_t += m_wpb + 3;
+            fifo.push_back({v, m_dma_t});
+            ptr += m_dma_src_step;
+            // D_PUSH: SRC1 y SRC2 alternan; el píxel avanza tras la última fuente y el último beat
+            if (!m_dma_sel && m_dma_src2_en) {
+                m_dma_sel = true;
+            } else {
+                m_dma_sel = !m_dma_src1_en;
+                if (!m_dc.band_serial || m_dma_rd_band + bmax >= m_dc.num_bands) {
+                    m_dma_rd_band = 0;
+                    m_dma_rd_left--;
+                    m_dma_skip_known = true;
+                } else {
+                    m_dma_rd_band += bmax;
+                }
+            }
+            return true;
+        }
+        return false;
+    }
+
+    if (m_dma_wr_left == 0) {
+        m_dma_busy = false;
+        m_dma_done = true;
+        close_job();
+        return true;
+    }
+    return false;
+}
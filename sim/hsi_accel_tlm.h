@@ -0,0 +1,226 @@
+/**
+ * @file hsi_accel_tlm.h
+ * @brief Modelo rápido con temporización aproximada (loosely-timed) de `hsi_accel_obi`.
+ *
+ * @details
+ * `HsiAccelTlm` sustituye a la simulación RTL para desarrollar y probar firmware con imágenes de
+ * tamaño real. Reproduce a nivel de transacción lo que el software observa del acelerador:
+ *
+ * - El mapa de registros de `hsi_vector_core_wrapper` (OP_CODE 0x00, NUM_BANDS 0x04, COMMAND 0x08,
+ *   STATUS 0x0C, FIFO_STATUS 0x10, CONFIG, DMA_*, PIXEL_COUNT, PROCESSED_COUNT, IRQ_*, PERF_*,
+ *   FIFO_LEVEL_*, DESC_STATUS, THRESHOLD, BAND_WINDOW y PERF_CORE_*), con las mismas reglas de
+ *   escritura (byte enables, W1C, COMMAND.START ignorado con BUSY), la cola de descriptores y
+ *   `err_o` en direcciones no implementadas o con ENQUEUE y la cola llena.
+ * - Las FIFOs de entrada y salida de `FIFO_DEPTH` palabras: una escritura con la FIFO llena se
+ *   descarta, `almost_full` / `almost_empty` se calculan con los umbrales de IRQ_LEVEL.
+ * - La FSM del núcleo a nivel de beat: errores de START (`HsiGoldenModel::start_error`, el código se
+ *   conserva hasta el siguiente START), trabajos de PIXEL_COUNT píxeles, `more_input`, BAND_SERIAL,
+ *   retención del resultado con la FIFO de salida llena, OP_REF_LOAD y REF_MODE. Las palabras de
+ *   salida las calcula `HsiGoldenModel`, exacto a nivel de bit.
+ * - El DMA `hsi_dma` (`dma_en`): mismo orden de lecturas y escrituras, strides, saltos de la
+ *   ventana de bandas, resultados de una palabra con CONFIG.POST y fuentes de REF_LOAD / REF_MODE.
+ *
+ * El modelo no tiene reloj: cada acceso (`read`, `write`, `push`, `pop`) avanza el núcleo y el
+ * DMA hasta que ninguno puede progresar sin nuevos datos o espacio. La temporización se estima por
+ * separado (ver `cycles()`): el bus cuenta `BUS_CYCLES` ciclos por acceso OBI y `PORT_CYCLES` por
+ * escritura o lectura de las FIFOs, y el núcleo y el DMA llevan cada uno su tiempo local, sumando el
+ * coste aproximado de cada beat o resultado y esperando al instante en que se escribió en la FIFO la
+ * palabra que consumen. Los contadores PERF_* y el
+ * resumen de cada trabajo (`set_job_hook`) usan esas estimaciones; PERF_STALL_OUT no se estima.
+ *
+ * Diferencias conocidas con el RTL: un solo núcleo (`NUM_CORES = 1`), sin `DUAL_CLOCK`, y la
+ * configuración del núcleo y del DMA se captura con START / DMA_START en lugar de seguirse de forma
+ * continua (el RTL ya exige no cambiarla con BUSY).
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+#ifndef HSI_ACCEL_TLM_H
+#define HSI_ACCEL_TLM_H
+
+#include "hsi_golden_model.h"
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+
+/**
+ * @class HsiAccelTlm
+ * @brief Registros, FIFOs, núcleo y DMA de `hsi_accel_obi` a nivel de transacción.
+ */
+class HsiAccelTlm {
+public:
+    static const uint64_t BUS_CYCLES = 2;      ///< Ciclos estimados de un acceso OBI
+    static const uint64_t PORT_CYCLES = 1;     ///< Ciclos estimados de `push` / `pop`
+
+    /// @brief Parámetros de síntesis de `hsi_accel_obi` y del núcleo
+    struct Params {
+        HsiGoldenModel::Params core;           ///< COMPONENT_WIDTH, COMPONENTS_MAX, REF_*, SAM_EN...
+        uint32_t fifo_depth = 16;
+        bool dma_en = false;
+        bool perf_en = true;
+        uint32_t desc_depth = 4;
+        uint32_t dot_lanes = 4;                ///< Carriles MAC (solo temporización)
+    };
+
+    /// @brief Resumen de un trabajo terminado
+    struct JobStats {
+        uint32_t op = 0;
+        uint32_t pixels = 0;                   ///< Resultados (o referencias) del trabajo
+        bool dma = false;                      ///< Lanzado con DMA_START
+        uint64_t start = 0;                    ///< Ciclo estimado de START
+        uint64_t core_end = 0;                 ///< Ciclo estimado del último resultado del núcleo
+        uint64_t end = 0;                      ///< Ciclo estimado de fin (incluido el DMA)
+        uint64_t core_busy = 0;                ///< Ciclos estimados del núcleo fuera de IDLE
+        uint64_t cycles() const { return end - start; }
+    };
+
+    using MemRead = std::function<uint32_t(uint32_t addr)>;
+    using MemWrite = std::function<void(uint32_t addr, uint32_t data)>;
+    using JobHook = std::function<void(const JobStats&)>;
+
+    explicit HsiAccelTlm(const Params& p);
+
+    /// @brief Memoria del puerto maestro del DMA (direcciones en bytes, palabras de 32 bits)
+    void set_memory(MemRead rd, MemWrite wr);
+
+    /// @brief Función llamada al terminar cada trabajo
+    void set_job_hook(JobHook hook) { m_job_hook = hook; }
+
+    /// @brief Estado de reset (registros, FIFOs, núcleo, banco de referencias, DMA y PERF_*);
+    /// el tiempo estimado sigue avanzando
+    void reset();
+
+    /**
+     * @brief Lectura OBI.
+     * @param err `err_o` de la respuesta (opcional)
+     */
+    uint32_t read(uint32_t addr, bool* err = nullptr);
+
+    /// @brief Escritura OBI; devuelve `false` si la respuesta lleva `err_o`
+    bool write(uint32_t addr, uint32_t data, uint8_t be = 0xF);
+
+    /// @brief Un ciclo de los puertos de entrada: cada palabra habilitada se descarta con su FIFO llena
+    void push(bool en1, uint64_t v1, bool en2, uint64_t v2);
+
+    /// @brief Extrae un resultado de la FIFO de salida; `false` si está vacía
+    bool pop(uint64_t& v);
+
+    /// @brief Avanza `n` ciclos de bus sin accesos
+    void idle(uint64_t n) { m_now += n; }
+
+    bool in1_full() const { return m_in1.size() >= m_p.fifo_depth; }
+    bool in2_full() const { return m_in2.size() >= m_p.fifo_depth; }
+    bool out_empty() const { return m_out.empty(); }
+    bool irq() const { return (m_irq_status & m_irq_enable) != 0; }
+
+    /// @brief Ciclos estimados desde la construcción: el mayor de los tiempos del bus, del núcleo y del DMA
+    uint64_t cycles() const;
+
+    /// @brief Ciclo estimado del bus: el del último `read`, `write`, `push` o `pop`
+    uint64_t now() const { return m_now; }
+
+private:
+    enum CoreState { C_IDLE, C_RUN, C_REF_LOAD };
+
+    /// @brief Palabra de una FIFO con el ciclo estimado en que se escribió
+    struct Entry {
+        uint64_t data;
+        uint64_t t;
+    };
+
+    /// @brief Registros sombra copiados por COMMAND.ENQUEUE
+    struct Desc {
+        uint32_t op = 0, num_bands = 0, cfg = 0, threshold = 0, band_window = 0, pixel_count = 0;
+        uint32_t dma_src1 = 0, dma_src2 = 0, dma_dst = 0, dma_stride = 0;
+        bool dma = false;
+    };
+
+    const Desc& active() const { return m_cur_valid ? m_cur : m_shadow; }
+    uint32_t job_count() const { return active().pixel_count; }
+    HsiGoldenModel::Config config(const Desc& d) const;
+    bool addr_valid(uint32_t a) const;
+    uint32_t status_fifo() const;
+
+    void evaluate();
+    bool wrapper_step();
+    bool core_step();
+    bool dma_step();
+
+    void start_core();
+    void start_dma();
+    void pixel_valid();
+    void job_end();
+    void close_job();
+    void set_done();
+    void set_error(int e);
+    bool more_input() const { return (m_busy && job_count() != 0) || (m_dma_busy && m_dma_rd_left != 0); }
+    void core_time(uint64_t ready, uint64_t cost, int state);
+    void setup_job();
+
+    Params m_p;
+    HsiGoldenModel m_model;
+    int m_cw, m_cm;
+    uint32_t m_wpb;                            ///< Palabras de bus por beat
+    uint32_t m_npw;                            ///< Palabras de bus por resultado con CONFIG.POST
+    MemRead m_mem_rd;
+    MemWrite m_mem_wr;
+    JobHook m_job_hook;
+
+    // Registros del wrapper
+    Desc m_shadow, m_cur;
+    bool m_cur_valid = false;
+    std::deque<Desc> m_desc;
+    uint32_t m_desc_done = 0;
+    bool m_done = false, m_busy = false;
+    int m_err_reg = 0;
+    bool m_dma_busy = false, m_dma_done = false;
+    uint32_t m_processed = 0;
+    uint32_t m_irq_enable = 0, m_irq_status = 0, m_irq_level = 1;
+
+    // FIFOs
+    std::deque<Entry> m_in1, m_in2, m_out;
+
+    // Núcleo
+    CoreState m_state = C_IDLE;
+    HsiGoldenModel::Config m_cc;               ///< Configuración capturada con START
+    bool m_stream = false, m_ref_active = false;
+    int m_core_err = 0;
+    bool m_pixel_done = false, m_ref_loaded = false;
+    uint32_t m_beats = 1, m_beat = 0, m_ref_idx = 0;
+    bool m_have_res = false;
+    Entry m_res = {0, 0};
+    std::vector<int32_t> m_pa, m_pb, m_refs;
+    std::vector<uint64_t> m_ref_mem;           ///< `ref_mem[k][b]` en `k * ref_beats + b`
+    std::vector<uint64_t> m_beat_cost;         ///< Ciclos estimados de cada beat del píxel
+    uint64_t m_pixel_cost = 0;                 ///< Ciclos estimados de escritura del resultado
+
+    // DMA
+    HsiGoldenModel::Config m_dc;
+    uint32_t m_dma_src[2] = {0, 0}, m_dma_dst = 0, m_dma_rd_left = 0, m_dma_wr_left = 0, m_dma_rd_band = 0;
+    uint32_t m_dma_src_step = 0, m_dma_dst_step = 0, m_dma_wr_words = 0;
+    bool m_dma_sel = false, m_dma_src1_en = true, m_dma_src2_en = true;
+    bool m_dma_skip_known = false;             ///< Huecos de la ventana medidos en el primer píxel
+    uint32_t m_dma_lead_off = 0, m_dma_tail_off = 0, m_dma_lead_band = 0;
+
+    // Temporización
+    uint64_t m_now = 0, m_core_t = 0, m_dma_t = 0;
+    uint64_t m_perf_t0 = 0;                    ///< Ciclo de la última puesta a cero de PERF_*
+    uint64_t m_perf_busy = 0, m_perf_pixels = 0, m_perf_stall_in = 0;
+    static const int PERF_STATES = 9;          ///< Estados de la FSM del núcleo (IDLE .. REF_LOAD)
+    uint64_t m_perf_state[PERF_STATES] = {0, 0, 0, 0, 0, 0, 0, 0, 0};
+    JobStats m_job;
+    uint64_t m_job_busy0 = 0;                  ///< PERF_BUSY al empezar el trabajo
+    bool m_job_open = false, m_job_core_done = false;
+};
+
+#endif
@@ -0,0 +1,166 @@
+/**
+ * @file hsi_envi_cube.cpp
+ * @brief Implementación del lector de cubos ENVI proyectados en memoria.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+#include "hsi_envi_cube.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <fcntl.h>
+#include <fstream>
+#include <map>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+/// @brief Elimina espacios al principio y al final
+static std::string trim(const std::string& s) {
+    const std::string::size_type b = s.find_first_not_of(" \t\r\n");
+    if (b == std::string::npos) return "";
+    const std::string::size_type e = s.find_last_not_of(" \t\r\n");
+    return s.substr(b, e - b + 1);
+}
+
+static std::string lower(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return std::tolower(c); });
+    return s;
+}
+
+/**
+ * @brief Lee los pares `clave = valor` de una cabecera ENVI.
+ *
+ * @details
+ * Las claves se guardan en minúsculas. Los valores entre llaves pueden ocupar varias líneas
+ * (p. ej. `wavelength = { ... }`) y se guardan sin las llaves.
+ */
+static bool parse_header(const std::string& path, std::map<std::string, std::string>& kv) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::string line;
+    if (!std::getline(in, line) || trim(line) != "ENVI") return false;
+    while (std::getline(in, line)) {
+        const std::string::size_type eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        const std::string key = lower(trim(line.substr(0, eq)));
+        std::string value = trim(line.substr(eq + 1));
+        if (!value.empty() && value[0] == '{') {
+            while (value.find('}') == std::string::npos && std::getline(in, line)) value += " " + trim(line);
+            const std::string::size_type close = value.find('}');
+            value = trim(value.substr(1, close == std::string::npos ? std::string::npos : close - 1));
+        }
+        kv[key] = value;
+    }
+    return true;
+}
+
+static bool file_exists(const std::string& path) {
+    struct stat st;
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+}
+
+HsiEnviCube::~HsiEnviCube() {
+    if (m_map) munmap(m_map, m_map_len);
+}
+
+bool HsiEnviCube::fail(const std::string& msg) {
+    m_error = msg;
+    return false;
+}
+
+bool HsiEnviCube::open(const std::string& hdr_path, const std::string& data_path) {
+    std::map<std::string, std::string> kv;
+    if (!parse_header(hdr_path, kv)) return fail(hdr_path + ": no es una cabecera ENVI");
+
+    const char* required[] = {"samples", "lines", "bands", "data type", "interleave"};
+    for (const char* k : required)
+        if (kv.find(k) == kv.end()) return fail(hdr_path + ": falta '" + k + "'");
+
+    m_samples = std::strtoull(kv["samples"].c_str(), nullptr, 10);
+    m_lines = std::strtoull(kv["lines"].c_str(), nullptr, 10);
+    m_bands = static_cast<uint32_t>(std::strtoul(kv["bands"].c_str(), nullptr, 10));
+    if (m_samples == 0 || m_lines == 0 || m_bands == 0) return fail(hdr_path + ": dimensiones nulas");
+
+    const std::string il = lower(kv["interleave"]);
+    if (il == "bsq")      m_interleave = BSQ;
+    else if (il == "bil") m_interleave = BIL;
+    else if (il == "bip") m_interleave = BIP;
+    else return fail(hdr_path + ": interleave '" + il + "' no soportado");
+
+    switch (std::atoi(kv["data type"].c_str())) {
+    case 1:  m_elem = 1; m_signed = false; break;
+    case 2:  m_elem = 2; m_signed = true;  break;
+    case 12: m_elem = 2; m_signed = false; break;
+    default: return fail(hdr_path + ": data type " + kv["data type"] + " no soportado (1, 2 o 12)");
+    }
+    m_big_endian = kv.count("byte order") && std::atoi(kv["byte order"].c_str()) == 1;
+    const uint64_t offset = kv.count("header offset") ? std::strtoull(kv["header offset"].c_str(), nullptr, 10) : 0;
+
+    // Archivo de datos: explícito, la cabecera sin ".hdr" o con una extensión habitual
+    std::string data = data_path;
+    if (data.empty()) {
+        std::string base = hdr_path;
+        if (base.size() > 4 && lower(base.substr(base.size() - 4)) == ".hdr") base.resize(base.size() - 4);
+        const char* exts[] = {"", ".img", ".raw", ".dat", ".bsq", ".bil", ".bip"};
+        for (const char* e : exts) {
+            if (file_exists(base + e)) {
+                data = base + e;
+                break;
+            }
+        }
+        if (data.empty()) return fail(hdr_path + ": no se encuentra el archivo de datos");
+    }
+
+    const int fd = ::open(data.c_str(), O_RDONLY);
+    if (fd < 0) return fail(data + ": no se puede abrir");
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        ::close(fd);
+        return fail(data + ": fstat");
+    }
+    const uint64_t need = offset + pixels() * m_bands * m_elem;
+    if (static_cast<uint64_t>(st.st_size) < need) {
+        ::close(fd);
+        return fail(data + ": tamaño " + std::to_string(st.st_size) + " menor que el indicado por la cabecera ("
+                    + std::to_string(need) + ")");
+    }
+    m_map_len = static_cast<size_t>(need);
+    m_map = mmap(nullptr, m_map_len, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);                               ///< La proyección sigue siendo válida sin el descriptor
+    if (m_map == MAP_FAILED) {
+        m_map = nullptr;
+        return fail(data + ": mmap");
+    }
+    // BIP se recorre en orden; en BIL/BSQ cada píxel salta entre líneas o planos
+    madvise(m_map, m_map_len, m_interleave == BIP ? MADV_SEQUENTIAL : MADV_NORMAL);
+    m_data = static_cast<const uint8_t*>(m_map) + offset;
+    return true;
+}
+
+bool hsi_envi_write_header(const std::string& hdr_path, uint64_t samples, uint64_t lines,
+                           uint32_t bands, int data_type) {
+    std::ofstream out(hdr_path);
+    if (!out) return false;
+    out << "ENVI\n"
+        << "description = {hsi_accel_obi results}\n"
+        << "samples = " << samples << "\n"
+        << "lines = " << lines << "\n"
+        << "bands = " << bands << "\n"
+        << "header offset = 0\n"
+        << "file type = ENVI Standard\n"
+        << "data type = " << data_type << "\n"
+        << "interleave = bip\n"
+        << "byte order = 0\n";
+    return static_cast<bool>(out);
+}
@@ -0,0 +1,114 @@
+/**
+ * @file hsi_envi_cube.h
+ * @brief Lectura de cubos hiperespectrales ENVI (BSQ/BIL/BIP) proyectados en memoria.
+ *
+ * @details
+ * `HsiEnviCube` interpreta la cabecera `.hdr` de ENVI y proyecta el archivo de datos con `mmap` en
+ * solo lectura, sin copiarlo: cada muestra se lee directamente de la proyección calculando su
+ * desplazamiento según el entrelazado, de modo que un píxel se obtiene en orden BIP sea cual sea el
+ * formato del archivo y el sistema operativo solo carga las páginas que se recorren. Admite los tipos
+ * de dato ENVI 1 (uint8), 2 (int16) y 12 (uint16), en cualquier orden de bytes.
+ *
+ * `hsi_envi_write_header()` genera la cabecera de un cubo de salida con el mismo formato.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+#ifndef HSI_ENVI_CUBE_H
+#define HSI_ENVI_CUBE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class HsiEnviCube
+ * @brief Cubo ENVI proyectado en memoria con acceso por píxel y banda.
+ *
+ * @details
+ * Los píxeles se numeran en orden de barrido (`pixel = line * samples + sample`). `sample()` devuelve
+ * el valor de la banda `band` del píxel `pixel` convertido a entero con signo; los datos uint16 se
+ * reinterpretan como los 16 bits del componente del acelerador.
+ */
+class HsiEnviCube {
+public:
+    enum Interleave { BSQ, BIL, BIP };
+
+    HsiEnviCube() = default;
+    ~HsiEnviCube();
+    HsiEnviCube(const HsiEnviCube&) = delete;
+    HsiEnviCube& operator=(const HsiEnviCube&) = delete;
+
+    /**
+     * @brief Lee la cabecera y proyecta el archivo de datos.
+     *
+     * @param hdr_path Ruta de la cabecera `.hdr`
+     * @param data_path Ruta del archivo de datos; vacía para buscar la de la cabecera sin `.hdr`
+     *                  o con `.img`, `.raw`, `.dat`, `.bsq`, `.bil` o `.bip`
+     * @return `false` si el cubo no es válido; el motivo queda en `error()`
+     */
+    bool open(const std::string& hdr_path, const std::string& data_path = "");
+
+    const std::string& error() const { return m_error; }
+    uint64_t samples() const { return m_samples; }
+    uint64_t lines() const { return m_lines; }
+    uint32_t bands() const { return m_bands; }
+    uint64_t pixels() const { return m_samples * m_lines; }
+    Interleave interleave() const { return m_interleave; }
+
+    /// @brief Banda `band` del píxel `pixel`, leída de la proyección
+    int32_t sample(uint64_t pixel, uint32_t band) const {
+        const uint64_t line = pixel / m_samples;
+        const uint64_t col = pixel % m_samples;
+        uint64_t idx;
+        switch (m_interleave) {
+        case BIP: idx = pixel * m_bands + band; break;
+        case BIL: idx = (line * m_bands + band) * m_samples + col; break;
+        default:  idx = static_cast<uint64_t>(band) * pixels() + pixel; break;
+        }
+        const uint8_t* p = m_data + idx * m_elem;
+        if (m_elem == 1) return p[0];
+        const uint16_t raw = m_big_endian ? static_cast<uint16_t>(p[0] << 8 | p[1])
+                                          : static_cast<uint16_t>(p[1] << 8 | p[0]);
+        return m_signed ? static_cast<int16_t>(raw) : raw;
+    }
+
+private:
+    bool fail(const std::string& msg);
+
+    std::string m_error;
+    uint64_t m_samples = 0;
+    uint64_t m_lines = 0;
+    uint32_t m_bands = 0;
+    Interleave m_interleave = BSQ;
+    size_t m_elem = 0;                         ///< Bytes por muestra
+    bool m_signed = false;
+    bool m_big_endian = false;                 ///< `byte order = 1` en la cabecera
+
+    void* m_map = nullptr;                     ///< Proyección del archivo completo
+    size_t m_map_len = 0;
+    const uint8_t* m_data = nullptr;           ///< Primera muestra (tras `header offset`)
+};
+
+/**
+ * @brief Escribe la cabecera ENVI de un cubo BIP little-endian.
+ *
+ * @param hdr_path  Ruta de la cabecera
+ * @param samples   Columnas
+ * @param lines     Filas
+ * @param bands     Bandas por píxel
+ * @param data_type Tipo de dato ENVI (p. ej. 2 para int16)
+ * @return `false` si no se pudo escribir
+ */
+bool hsi_envi_write_header(const std::string& hdr_path, uint64_t samples, uint64_t lines,
+                           uint32_t bands, int data_type);
+
+#endif
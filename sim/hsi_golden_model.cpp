@@ -0,0 +1,245 @@
+/**
+ * @file hsi_golden_model.cpp
+ * @brief Implementación del modelo de referencia de `hsi_vector_core`.
+ *
+ * @details
+ * Cada función reproduce la expresión del mismo nombre en `hw/rtl/hsi_vector_core.sv`
+ * (`cfg_ok`, `win_base`, `scale_out`, `post_word`...); los comentarios indican las diferencias de
+ * formulación que no cambian el resultado.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+#include "hsi_golden_model.h"
+
+#include <algorithm>
+
+HsiGoldenModel::HsiGoldenModel() : HsiGoldenModel(Params()) {}
+
+HsiGoldenModel::HsiGoldenModel(const Params& p)
+    : m_p(p), m_cw(p.component_width), m_cm(p.components_max),
+      m_acc_w(2 * p.component_width + p.acc_guard) {}
+
+int64_t HsiGoldenModel::wrap(int64_t v, int w) const {
+    return static_cast<int64_t>(static_cast<uint64_t>(v) << (64 - w)) >> (64 - w);
+}
+
+uint32_t HsiGoldenModel::win_lo(const Config& c) const {
+    return c.band_count == 0 ? 0 : c.band_first;
+}
+
+uint32_t HsiGoldenModel::win_hi(const Config& c) const {
+    return c.band_count == 0 ? c.num_bands : static_cast<uint32_t>(c.band_first) + c.band_count;
+}
+
+uint32_t HsiGoldenModel::win_base(const Config& c) const {
+    if (!c.band_serial) return 0;
+    return ((win_lo(c) >> c.prec) / m_cm * m_cm) << c.prec;
+}
+
+bool HsiGoldenModel::cfg_ok(const Config& c) const {
+    const uint32_t bmax = beat_max(c);
+    const bool ref_bands_ok = win_hi(c) - win_base(c) <= static_cast<uint32_t>(m_p.ref_beats) * bmax;
+    const bool prec_ok = c.prec == 0 ||
+                         (m_p.simd_en && c.prec != 3 && m_cw % (1 << c.prec) == 0 &&
+                          (c.op == OP_DOT || c.op == OP_REF_LOAD));
+    const bool win_ok = c.band_count == 0 || (c.op != OP_CROSS && win_hi(c) <= c.num_bands);
+    return (c.band_serial || c.num_bands <= bmax) && prec_ok && win_ok &&
+           (!c.ref_mode || ref_active(c) || c.op == OP_REF_LOAD) && (!ref_active(c) || ref_bands_ok) &&
+           (c.post == POST_NONE || (c.op == OP_DOT && c.post != 3)) &&
+           ((c.op == OP_CROSS && c.num_bands == 3 && !c.band_serial) || (c.op == OP_DOT && c.num_bands > 0) ||
+            (m_p.sam_en && m_cm >= 3 && c.op == OP_SAM && c.num_bands > 0) ||
+            (m_p.ref_num > 0 && c.op == OP_REF_LOAD && c.num_bands > 0 && ref_bands_ok));
+}
+
+int HsiGoldenModel::start_error(const Config& c, bool in_empty, bool out_full, bool more_input) const {
+    if (!c.band_serial && c.num_bands > beat_max(c)) return ERR_BANDS;
+    if (!cfg_ok(c)) return ERR_OP;
+    if (in_empty && !more_input) return ERR_INPUT_FIFO_EMPTY;
+    if (out_full) return ERR_OUTPUT_FIFO_FULL;
+    return ERR_NONE;
+}
+
+bool HsiGoldenModel::supported(const Config& c) const {
+    return cfg_ok(c) && c.op != OP_REF_LOAD;
+}
+
+uint32_t HsiGoldenModel::beats(const Config& c) const {
+    if (!c.band_serial) return 1;
+    // El píxel termina en el beat con beat_base + beat_bands >= win_hi
+    const uint32_t bmax = beat_max(c);
+    return std::max<uint32_t>(1, (win_hi(c) - win_base(c) + bmax - 1) / bmax);
+}
+
+uint64_t HsiGoldenModel::beat_word(const Config& c, const int32_t* x, size_t n, size_t p, uint32_t beat) const {
+    const int sw = sample_width(c);
+    const uint64_t mask = (sw == 64) ? ~0ull : (1ull << sw) - 1;
+    const uint32_t base = win_base(c) + beat * beat_max(c);
+    const uint32_t nb = std::min(beat_max(c), c.num_bands - base);
+    uint64_t v = 0;
+    for (uint32_t j = 0; j < nb; j++)
+        v |= (static_cast<uint64_t>(x[(base + j) * n + p]) & mask) << ((nb - 1 - j) * sw);
+    return v;
+}
+
+void HsiGoldenModel::unpack_beat(const Config& c, uint64_t w, uint32_t beat, int32_t* x, size_t n, size_t p) const {
+    const int sw = sample_width(c);
+    const uint32_t base = win_base(c) + beat * beat_max(c);
+    const uint32_t nb = std::min(beat_max(c), c.num_bands - base);
+    for (uint32_t j = 0; j < nb; j++) {
+        const uint64_t v = w >> ((nb - 1 - j) * sw);
+        x[(base + j) * n + p] = static_cast<int32_t>(wrap(static_cast<int64_t>(v), sw));
+    }
+}
+
+int64_t HsiGoldenModel::scale_out(int64_t x, uint8_t sc) const {
+    const int sh = sc & 0x3F;
+    int64_t v = x;
+    // ACC_W'(1) <<< (sh - 1) se anula cuando el desplazamiento alcanza ACC_W
+    if ((sc & 0x40) && sh != 0 && sh - 1 < m_acc_w) v = wrap(v + (int64_t(1) << (sh - 1)), m_acc_w);
+    v >>= sh;                                  // sh <= 63: relleno de signo como >>> en ACC_W bits
+    if (sc & 0x80) {
+        const int64_t out_max = (int64_t(1) << (m_cw - 1)) - 1;
+        v = std::min(std::max(v, -out_max - 1), out_max);
+    }
+    return wrap(v, m_cw);
+}
+
+uint64_t HsiGoldenModel::post_word(const Config& c, const int64_t* res, int post_k) const {
+    const bool is_mac = c.op == OP_DOT || c.op == OP_SAM;
+    const uint64_t mask = (1ull << m_cw) - 1;
+    uint64_t w = 0;
+    switch (c.post) {
+    case POST_ARGMAX: {
+        // Mayor puntuación entre las post_k primeras (el menor índice si hay empate)
+        int idx = 0;
+        int64_t best = scale_out(res[0], c.out_scale);
+        for (int k = 1; k < m_cm && k < post_k; k++) {
+            const int64_t v = scale_out(res[k], c.out_scale);
+            if (v > best) {
+                idx = k;
+                best = v;
+            }
+        }
+        const int pos = (m_cm > 1) ? 1 : 0;
+        w = (static_cast<uint64_t>(best) & mask) << (pos * m_cw);
+        w = (w & ~mask) | static_cast<uint64_t>(idx);
+        break;
+    }
+    case POST_THRESHOLD:
+        for (int k = 0; k < m_cm && k < m_cw && k < post_k; k++)
+            if (scale_out(res[k], c.out_scale) >= wrap(c.threshold, m_cw)) w |= 1ull << k;
+        break;
+    default:
+        for (int k = 0; k < m_cm; k++) {
+            const int64_t v = is_mac ? scale_out(res[k], c.out_scale) : wrap(res[k], m_cw);
+            w |= (static_cast<uint64_t>(v) & mask) << (k * m_cw);
+        }
+        break;
+    }
+    return w;
+}
+
+void HsiGoldenModel::dot_planar(const Config& c, const int32_t* a, const int32_t* b, size_t b_stride, size_t n,
+                                int64_t* acc) const {
+    // b_stride = n: segundo operando planar por píxel; b_stride = 0: el mismo vector en todos
+    const int sh = 32 - sample_width(c);
+    const uint32_t hi = win_hi(c);
+    for (uint32_t band = win_lo(c); band < hi; band++) {
+        const int32_t* pa = a + band * n;
+        if (b_stride) {
+            const int32_t* pb = b + band * b_stride;
+            for (size_t p = 0; p < n; p++) {
+                const int64_t x = static_cast<int32_t>(static_cast<uint32_t>(pa[p]) << sh) >> sh;
+                const int64_t y = static_cast<int32_t>(static_cast<uint32_t>(pb[p]) << sh) >> sh;
+                acc[p] += x * y;
+            }
+        } else {
+            const int64_t y = static_cast<int32_t>(static_cast<uint32_t>(b[band]) << sh) >> sh;
+            for (size_t p = 0; p < n; p++) {
+                const int64_t x = static_cast<int32_t>(static_cast<uint32_t>(pa[p]) << sh) >> sh;
+                acc[p] += x * y;
+            }
+        }
+    }
+}
+
+void HsiGoldenModel::eval_batch(const Config& c, const int32_t* a, const int32_t* b, size_t n, uint64_t* out) const {
+    int64_t res[64] = {0};
+
+    if (c.op == OP_CROSS) {
+        // cross_res[k] = COMPONENT_WIDTH'(...): la resta completa y el truncado final son equivalentes
+        const int sh = 32 - m_cw;
+        for (size_t p = 0; p < n; p++) {
+            int64_t s1[3], s2[3];
+            for (int k = 0; k < 3; k++) {
+                s1[k] = static_cast<int32_t>(static_cast<uint32_t>(a[k * n + p]) << sh) >> sh;
+                s2[k] = static_cast<int32_t>(static_cast<uint32_t>(b[k * n + p]) << sh) >> sh;
+            }
+            res[2] = wrap(s1[1] * s2[2] - s1[2] * s2[1], m_cw);
+            res[1] = wrap(s1[2] * s2[0] - s1[0] * s2[2], m_cw);
+            res[0] = wrap(s1[0] * s2[1] - s1[1] * s2[0], m_cw);
+            out[p] = post_word(c, res, 1);
+        }
+        return;
+    }
+
+    // OP_DOT / OP_SAM: una pasada por banda de la ventana sobre los n píxeles del lote. Cada producto
+    // de subpalabra cabe en 2*SW bits y la suma de hasta 65535 bandas no desborda 64 bits, de modo que
+    // reducir a ACC_W al final da la misma suma modular que el acumulador del núcleo.
+    const bool sam = c.op == OP_SAM;
+    const int sh = 32 - sample_width(c);
+    for (int ch = 0; ch < (sam ? 3 : 1); ch++) m_acc[ch].assign(n, 0);
+    int64_t* acc = m_acc[0].data();
+    int64_t* acc_aa = sam ? m_acc[1].data() : nullptr;
+    int64_t* acc_bb = sam ? m_acc[2].data() : nullptr;
+
+    if (sam) {
+        const uint32_t hi = win_hi(c);
+        for (uint32_t band = win_lo(c); band < hi; band++) {
+            const int32_t* pa = a + band * n;
+            const int32_t* pb = b + band * n;
+            for (size_t p = 0; p < n; p++) {
+                const int64_t x = static_cast<int32_t>(static_cast<uint32_t>(pa[p]) << sh) >> sh;
+                const int64_t y = static_cast<int32_t>(static_cast<uint32_t>(pb[p]) << sh) >> sh;
+                acc[p] += x * y;
+                acc_aa[p] += x * x;
+                acc_bb[p] += y * y;
+            }
+        }
+    } else {
+        dot_planar(c, a, b, n, n, acc);
+    }
+
+    // SAM_AA = 2 y SAM_BB = 1 (OP_SAM exige COMPONENTS_MAX >= 3)
+    for (size_t p = 0; p < n; p++) {
+        res[0] = wrap(acc[p], m_acc_w);
+        if (sam) {
+            res[2] = wrap(acc_aa[p], m_acc_w);
+            res[1] = wrap(acc_bb[p], m_acc_w);
+        }
+        out[p] = post_word(c, res, 1);
+    }
+}
+
+void HsiGoldenModel::eval_refs(const Config& c, const int32_t* a, const int32_t* refs, size_t n, uint64_t* out) const {
+    // La referencia k acumula sobre result[k]; las componentes sin referencia quedan a cero
+    const int slots = std::min(ref_slots(), m_cm);
+    m_ref_acc.assign(static_cast<size_t>(slots) * n, 0);
+    for (int k = 0; k < slots; k++)
+        dot_planar(c, a, refs + static_cast<size_t>(k) * c.num_bands, 0, n, m_ref_acc.data() + k * n);
+
+    int64_t res[64] = {0};
+    for (size_t p = 0; p < n; p++) {
+        for (int k = 0; k < slots; k++) res[k] = wrap(m_ref_acc[k * n + p], m_acc_w);
+        out[p] = post_word(c, res, ref_slots());
+    }
+}
@@ -0,0 +1,156 @@
+/**
+ * @file hsi_golden_model.h
+ * @brief Modelo de referencia en C++, exacto a nivel de bit, de `hsi_vector_core`.
+ *
+ * @details
+ * `HsiGoldenModel` reproduce la palabra que el núcleo escribe en `fifo_out` para cada píxel y el
+ * código de error que fija al recibir START, a partir de la misma configuración que recibe el núcleo:
+ *
+ * - OP_CROSS: producto vectorial con cada componente reducida a `COMPONENT_WIDTH` bits (aritmética
+ *   modular), componente X en la posición más significativa.
+ * - OP_DOT y OP_SAM: sumas con signo en `ACC_W = 2*COMPONENT_WIDTH + ACC_GUARD` bits, con
+ *   `BAND_SERIAL`, la ventana `BAND_WINDOW`, el empaquetado de subpalabra `PREC` (solo DOT) y el
+ *   escalado de salida `OUT_SCALE` (desplazamiento, redondeo, saturación o truncado).
+ * - OP_DOT con `REF_MODE` contra el banco de referencias (`eval_refs`).
+ * - Postprocesado ARGMAX / THRESHOLD de OP_DOT, con una puntuación o `REF_NUM` con `REF_MODE`.
+ * - Condiciones de ERR_OP, ERR_BANDS, ERR_INPUT_FIFO_EMPTY y ERR_OUTPUT_FIFO_FULL en IDLE.
+ *
+ * Los píxeles se evalúan por lotes (`eval_batch`) con las muestras en disposición planar
+ * (`x[band * n + pixel]`): el bucle interno recorre píxeles contiguos de una misma banda, sin
+ * dependencias entre iteraciones, y el compilador lo vectoriza con `-O3`. Las sumas se hacen en 64
+ * bits y se reducen a `ACC_W` al final, lo que equivale a la acumulación modular del hardware.
+ * OP_REF_LOAD no produce resultados: quien use el modelo guarda los beats de cada referencia y los
+ * desempaqueta con `unpack_beat` para `eval_refs` (ver `HsiAccelTlm`).
+ *
+ * Requiere `COMPONENT_WIDTH * COMPONENTS_MAX <= 64` y `ACC_W <= 62`.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+#ifndef HSI_GOLDEN_MODEL_H
+#define HSI_GOLDEN_MODEL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class HsiGoldenModel
+ * @brief Referencia de `hsi_vector_core` para comparación diferencial con el DUT.
+ */
+class HsiGoldenModel {
+public:
+    enum Op { OP_CROSS = 1, OP_DOT = 2, OP_SAM = 3, OP_REF_LOAD = 4 };
+    enum Err { ERR_NONE = 0, ERR_OP = 1, ERR_INPUT_FIFO_EMPTY = 2, ERR_OUTPUT_FIFO_FULL = 3, ERR_BANDS = 4 };
+    enum Post { POST_NONE = 0, POST_ARGMAX = 1, POST_THRESHOLD = 2 };
+
+    /// @brief Parámetros de síntesis del núcleo
+    struct Params {
+        int component_width = 16;
+        int components_max = 3;
+        int acc_guard = 8;
+        int ref_num = 3;
+        int ref_beats = 1;
+        bool sam_en = true;
+        bool simd_en = true;
+    };
+
+    /// @brief Configuración de un trabajo, tal como la recibe el núcleo desde el wrapper
+    struct Config {
+        uint32_t op = OP_DOT;
+        uint32_t num_bands = 3;
+        bool band_serial = false;
+        bool ref_mode = false;
+        uint32_t post = POST_NONE;
+        uint32_t prec = 0;
+        uint8_t out_scale = 0;                 ///< {SAT, ROUND, SHIFT[5:0]}
+        int32_t threshold = 0;
+        uint16_t band_first = 0;
+        uint16_t band_count = 0;               ///< 0: ventana completa
+    };
+
+    HsiGoldenModel();
+    explicit HsiGoldenModel(const Params& p);
+
+    /// @brief `cfg_ok` del núcleo: la configuración es válida para la operación
+    bool cfg_ok(const Config& c) const;
+
+    /// @brief Código de error que fija START en IDLE (ERR_NONE si el trabajo arranca)
+    int start_error(const Config& c, bool in_empty, bool out_full, bool more_input) const;
+
+    /// @brief La configuración es válida y produce resultados (todas salvo OP_REF_LOAD)
+    bool supported(const Config& c) const;
+
+    /// @brief OP_DOT contra el banco de referencias (`REF_MODE` con `REF_NUM > 0`)
+    bool ref_active(const Config& c) const { return m_p.ref_num > 0 && c.ref_mode && c.op == OP_DOT; }
+
+    /// @brief Referencias del banco: `max(REF_NUM, 1)`
+    int ref_slots() const { return m_p.ref_num > 0 ? m_p.ref_num : 1; }
+
+    /// @brief Bits de cada muestra: `COMPONENT_WIDTH >> prec`
+    int sample_width(const Config& c) const { return m_cw >> c.prec; }
+
+    /// @brief Beats de entrada por píxel (desde el beat que contiene el inicio de la ventana)
+    uint32_t beats(const Config& c) const;
+
+    /// @brief `win_lo`, `win_hi` y `win_base` del núcleo: ventana de bandas `[win_lo, win_hi)` y
+    /// primera banda del beat que contiene `win_lo` (0 fuera de band-serial)
+    uint32_t win_lo(const Config& c) const;
+    uint32_t win_hi(const Config& c) const;
+    uint32_t win_base(const Config& c) const;
+
+    /// @brief Bandas de un beat completo: `COMPONENTS_MAX << prec`
+    uint32_t beat_max(const Config& c) const { return static_cast<uint32_t>(m_cm) << c.prec; }
+
+    /**
+     * @brief Palabra de entrada del beat `beat` del píxel `p`.
+     *
+     * @param x Muestras en disposición planar `x[band * n + p]`, con `num_bands` bandas
+     * @param n Píxeles del lote
+     */
+    uint64_t beat_word(const Config& c, const int32_t* x, size_t n, size_t p, uint32_t beat) const;
+
+    /// @brief Inversa de `beat_word`: muestras con signo del beat `beat` en `x[band * n + p]`
+    void unpack_beat(const Config& c, uint64_t w, uint32_t beat, int32_t* x, size_t n, size_t p) const;
+
+    /**
+     * @brief Palabras de salida de `n` píxeles.
+     *
+     * @param a, b Muestras planar de los dos operandos (`num_bands` bandas cada uno)
+     * @param out  `n` palabras de `COMPONENT_WIDTH*COMPONENTS_MAX` bits
+     */
+    void eval_batch(const Config& c, const int32_t* a, const int32_t* b, size_t n, uint64_t* out) const;
+
+    /**
+     * @brief Palabras de salida de OP_DOT con `REF_MODE`: la componente k es el producto escalar
+     * (escalado) del píxel con la referencia k.
+     *
+     * @param a    Muestras planar de los `n` píxeles
+     * @param refs `ref_slots()` referencias planar de un píxel cada una: `refs[k * num_bands + band]`
+     */
+    void eval_refs(const Config& c, const int32_t* a, const int32_t* refs, size_t n, uint64_t* out) const;
+
+private:
+    int64_t wrap(int64_t v, int w) const;      ///< Extensión de signo desde `w` bits
+    int64_t scale_out(int64_t x, uint8_t sc) const;
+    uint64_t post_word(const Config& c, const int64_t* res, int post_k) const;
+    void dot_planar(const Config& c, const int32_t* a, const int32_t* b, size_t b_stride, size_t n,
+                    int64_t* acc) const;
+
+    Params m_p;
+    int m_cw;                                  ///< COMPONENT_WIDTH
+    int m_cm;                                  ///< COMPONENTS_MAX
+    int m_acc_w;                               ///< ACC_W
+    mutable std::vector<int64_t> m_acc[3];     ///< Acumuladores por lote: a·b, |a|², |b|²
+    mutable std::vector<int64_t> m_ref_acc;    ///< Acumuladores por lote y referencia
+};
+
+#endif
@@ -0,0 +1,187 @@
+/**
+ * @file hsi_latency_stats.cpp
+ * @brief Implementación de los histogramas de latencia y del informe JSON.
+ *
+ * @details
+ * Formato del informe:
+ * ```json
+ * {
+ *   "model": "rtl", "config": {...},
+ *   "total": {"pixels": ..., "latency": {"min": ..., "p50": ..., "p99": ..., "max": ..., "mean": ...,
+ *             "histogram": [[latencia, píxeles], ...]}, ...},
+ *   "jobs": [{"name": "golden", "op": 2, "num_bands": 7, ..., "out_stall": 0, "latency": {...},
+ *             "pixels_per_cycle": ..., "sustained_pixels_per_cycle": ...,
+ *             "stalls": {"input_blocked": ..., "output_wait": ...},
+ *             "perf": {"busy": ..., "pixels": ..., "stall_in": ..., "stall_out": ...}}, ...]
+ * }
+ * ```
+ * El histograma solo lista las latencias con algún píxel; en cada trabajo se omite y quedan los
+ * percentiles.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+#include "hsi_latency_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sys/stat.h>
+
+void HsiLatencyStats::Histogram::add(uint64_t l) {
+    if (l >= count.size()) count.resize(static_cast<size_t>(l) + 1, 0);
+    count[static_cast<size_t>(l)]++;
+    n++;
+    sum += l;
+}
+
+void HsiLatencyStats::Histogram::merge(const Histogram& o) {
+    if (o.count.size() > count.size()) count.resize(o.count.size(), 0);
+    for (size_t l = 0; l < o.count.size(); l++) count[l] += o.count[l];
+    n += o.n;
+    sum += o.sum;
+}
+
+uint64_t HsiLatencyStats::Histogram::percentile(double p) const {
+    if (n == 0) return 0;
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p * static_cast<double>(n))));
+    uint64_t cum = 0;
+    for (size_t l = 0; l < count.size(); l++) {
+        cum += count[l];
+        if (cum >= rank) return l;
+    }
+    return count.size() - 1;
+}
+
+void HsiLatencyStats::begin(const JobInfo& info, uint64_t cycle) {
+    m_cur = Job();
+    m_cur.info = info;
+    m_cur.info.beats_per_pixel = std::max<uint32_t>(1, info.beats_per_pixel);
+    m_cur.start = cycle;
+    m_inflight.clear();
+}
+
+void HsiLatencyStats::beat(uint64_t cycle) {
+    if (m_cur.beats == 0) m_cur.first_beat = cycle;
+    if (m_cur.beats % m_cur.info.beats_per_pixel == 0) m_inflight.push_back(cycle);
+    m_cur.beats++;
+}
+
+void HsiLatencyStats::result(uint64_t cycle) {
+    if (m_cur.pixels == 0) m_cur.first_result = cycle;
+    m_cur.last_result = cycle;
+    m_cur.pixels++;
+    // Un resultado sin beat previo (p. ej. DMA) no tiene latencia medible
+    if (m_inflight.empty()) return;
+    m_cur.latency.add(cycle - std::min(cycle, m_inflight.front()));
+    m_inflight.pop_front();
+}
+
+void HsiLatencyStats::end(uint64_t cycle, const Perf& perf) {
+    m_cur.end = cycle;
+    m_cur.perf = perf;
+    m_jobs.push_back(m_cur);
+    m_inflight.clear();
+}
+
+/// @brief Objeto JSON con min/p50/p99/max/mean y, opcionalmente, el histograma disperso
+static void write_latency(std::FILE* f, const std::vector<uint64_t>& count, uint64_t n, uint64_t sum,
+                          uint64_t p50, uint64_t p99, bool histogram) {
+    uint64_t lo = 0, hi = 0;
+    bool any = false;
+    for (size_t l = 0; l < count.size(); l++) {
+        if (!count[l]) continue;
+        if (!any) lo = l;
+        any = true;
+        hi = l;
+    }
+    std::fprintf(f, "{\"samples\": %llu, \"min\": %llu, \"p50\": %llu, \"p99\": %llu, \"max\": %llu, \"mean\": %.3f",
+                 static_cast<unsigned long long>(n), static_cast<unsigned long long>(lo),
+                 static_cast<unsigned long long>(p50), static_cast<unsigned long long>(p99),
+                 static_cast<unsigned long long>(hi), n ? static_cast<double>(sum) / static_cast<double>(n) : 0.0);
+    if (histogram) {
+        std::fprintf(f, ", \"histogram\": [");
+        bool first = true;
+        for (size_t l = 0; l < count.size(); l++) {
+            if (!count[l]) continue;
+            std::fprintf(f, "%s[%zu, %llu]", first ? "" : ", ", l, static_cast<unsigned long long>(count[l]));
+            first = false;
+        }
+        std::fprintf(f, "]");
+    }
+    std::fprintf(f, "}");
+}
+
+/// @brief Cociente con denominador nulo a 0
+static double ratio(uint64_t a, uint64_t b) {
+    return b ? static_cast<double>(a) / static_cast<double>(b) : 0.0;
+}
+
+void HsiLatencyStats::write_job(std::FILE* f, const Job& j, const char* indent) {
+    const uint64_t span = j.pixels ? j.last_result - std::min(j.last_result, j.first_beat) : 0;
+    const uint64_t steady = j.pixels > 1 ? j.last_result - j.first_result : 0;
+    std::fprintf(f, "%s{\"name\": \"%s\", \"op\": %u, \"num_bands\": %u, \"band_serial\": %s, \"prec\": %u, "
+                    "\"post\": %u, \"beats_per_pixel\": %u, \"out_stall\": %u,\n",
+                 indent, j.info.name.c_str(), j.info.op, j.info.num_bands, j.info.band_serial ? "true" : "false",
+                 j.info.prec, j.info.post, j.info.beats_per_pixel, j.info.out_stall);
+    std::fprintf(f, "%s \"pixels\": %llu, \"beats\": %llu, \"cycles\": %llu, \"pixels_per_cycle\": %.6f, "
+                    "\"sustained_pixels_per_cycle\": %.6f,\n",
+                 indent, static_cast<unsigned long long>(j.pixels), static_cast<unsigned long long>(j.beats),
+                 static_cast<unsigned long long>(j.end - j.start), ratio(j.pixels, span),
+                 ratio(j.pixels > 1 ? j.pixels - 1 : 0, steady));
+    std::fprintf(f, "%s \"latency\": ", indent);
+    write_latency(f, j.latency.count, j.latency.n, j.latency.sum, j.latency.percentile(0.50),
+                  j.latency.percentile(0.99), false);
+    std::fprintf(f, ",\n%s \"stalls\": {\"input_blocked\": %llu, \"output_wait\": %llu},\n", indent,
+                 static_cast<unsigned long long>(j.input_blocked), static_cast<unsigned long long>(j.output_wait));
+    std::fprintf(f, "%s \"perf\": {\"busy\": %u, \"pixels\": %u, \"stall_in\": %u, \"stall_out\": %u}}", indent,
+                 j.perf.busy, j.perf.pixels, j.perf.stall_in, j.perf.stall_out);
+}
+
+bool HsiLatencyStats::write_json(const std::string& path, const std::string& model, const std::string& config) const {
+    const std::string::size_type slash = path.rfind('/');
+    if (slash != std::string::npos) mkdir(path.substr(0, slash).c_str(), 0755);
+    std::FILE* f = std::fopen(path.c_str(), "w");
+    if (!f) return false;
+
+    Histogram total;
+    uint64_t pixels = 0, beats = 0, cycles = 0, blocked = 0, wait = 0;
+    Perf perf;
+    for (const Job& j : m_jobs) {
+        total.merge(j.latency);
+        pixels += j.pixels;
+        beats += j.beats;
+        cycles += j.end - j.start;
+        blocked += j.input_blocked;
+        wait += j.output_wait;
+        perf.busy += j.perf.busy;
+        perf.pixels += j.perf.pixels;
+        perf.stall_in += j.perf.stall_in;
+        perf.stall_out += j.perf.stall_out;
+    }
+
+    std::fprintf(f, "{\n  \"model\": \"%s\",\n  \"config\": %s,\n", model.c_str(), config.c_str());
+    std::fprintf(f, "  \"total\": {\"jobs\": %zu, \"pixels\": %llu, \"beats\": %llu, \"cycles\": %llu, "
+                    "\"pixels_per_cycle\": %.6f,\n    \"latency\": ",
+                 m_jobs.size(), static_cast<unsigned long long>(pixels), static_cast<unsigned long long>(beats),
+                 static_cast<unsigned long long>(cycles), ratio(pixels, cycles));
+    write_latency(f, total.count, total.n, total.sum, total.percentile(0.50), total.percentile(0.99), true);
+    std::fprintf(f, ",\n    \"stalls\": {\"input_blocked\": %llu, \"output_wait\": %llu},\n",
+                 static_cast<unsigned long long>(blocked), static_cast<unsigned long long>(wait));
+    std::fprintf(f, "    \"perf\": {\"busy\": %u, \"pixels\": %u, \"stall_in\": %u, \"stall_out\": %u}},\n",
+                 perf.busy, perf.pixels, perf.stall_in, perf.stall_out);
+    std::fprintf(f, "  \"jobs\": [\n");
+    for (size_t i = 0; i < m_jobs.size(); i++) {
+        write_job(f, m_jobs[i], "    ");
+        std::fprintf(f, "%s\n", i + 1 < m_jobs.size() ? "," : "");
+    }
+    std::fprintf(f, "  ]\n}\n");
+    return std::fclose(f) == 0;
+}
@@ -0,0 +1,116 @@
+/**
+ * @file hsi_latency_stats.h
+ * @brief Latencia por píxel, rendimiento sostenido y bloqueos de los flujos del banco C++.
+ *
+ * @details
+ * `HsiLatencyStats` recibe del banco el ciclo de cada beat escrito en las FIFOs de entrada
+ * (`in1_wr_en_i`) y de cada resultado extraído de `out_data_o`. Como el núcleo entrega los
+ * resultados en el orden de los píxeles, la latencia del píxel i es la distancia entre su primer beat
+ * y el resultado i; basta una cola con los píxeles en vuelo. Las latencias se acumulan en un
+ * histograma exacto (un contador por ciclo de latencia), del que salen p50, p99 y máximo.
+ *
+ * Por trabajo se guardan además los píxeles por ciclo (desde el primer beat hasta el último
+ * resultado y, en régimen permanente, entre el primer y el último resultado), los ciclos en que el
+ * banco no escribió por ocupación de las FIFOs de entrada o esperó un resultado, y la diferencia de
+ * los contadores PERF_* del DUT. `write_json()` escribe todos los trabajos y el agregado en JSON.
+ *
+ * @author
+ * Alejandro Fernández Rodríguez, UCLM
+ *
+ * @version 1.0
+ * @date 2025
+ *
+ * @copyright
+ * Copyright (c) 2025 Alejandro Fernández Rodríguez
+ * Licensed under the MIT License.
+ */
+
+#ifndef HSI_LATENCY_STATS_H
+#define HSI_LATENCY_STATS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <string>
+#include <vector>
+
+/**
+ * @class HsiLatencyStats
+ * @brief Histogramas de latencia y resumen de rendimiento por trabajo.
+ */
+class HsiLatencyStats {
+public:
+    /// @brief Descripción del trabajo medido
+    struct JobInfo {
+        std::string name;                      ///< Origen: "cube" o "golden"
+        uint32_t op = 0;
+        uint32_t num_bands = 0;
+        bool band_serial = false;
+        uint32_t prec = 0;
+        uint32_t post = 0;
+        uint32_t beats_per_pixel = 1;
+        uint32_t out_stall = 0;                ///< `+out_stall`: % de ciclos sin extraer resultados
+    };
+
+    /// @brief Contadores PERF_* leídos del DUT (BUSY, PIXELS, STALL_IN, STALL_OUT)
+    struct Perf {
+        uint32_t busy = 0, pixels = 0, stall_in = 0, stall_out = 0;
+    };
+
+    /// @brief Empieza un trabajo en el ciclo `cycle`
+    void begin(const JobInfo& info, uint64_t cycle);
+
+    /// @brief Beat escrito en las FIFOs de entrada; el primero de cada píxel abre su latencia
+    void beat(uint64_t cycle);
+
+    /// @brief Resultado extraído de la FIFO de salida, del píxel en vuelo más antiguo
+    void result(uint64_t cycle);
+
+    /// @brief Ciclo sin escritura a pesar de quedar beats (ocupación de las FIFOs de entrada)
+    void input_blocked() { m_cur.input_blocked++; }
+
+    /// @brief Ciclo esperando un resultado con la FIFO de salida vacía
+    void output_wait() { m_cur.output_wait++; }
+
+    /// @brief Cierra el trabajo con la diferencia de PERF_* entre su inicio y su fin
+    void end(uint64_t cycle, const Perf& perf);
+
+    /**
+     * @brief Escribe el informe JSON.
+     *
+     * @param model Modelo medido ("rtl" o "tlm")
+     * @param config Objeto JSON con la configuración compilada del DUT
+     * @return `false` si no se pudo crear el archivo
+     */
+    bool write_json(const std::string& path, const std::string& model, const std::string& config) const;
+
+    bool empty() const { return m_jobs.empty(); }
+
+private:
+    /// @brief Histograma exacto: `count[l]` píxeles con latencia `l` ciclos
+    struct Histogram {
+        std::vector<uint64_t> count;
+        uint64_t n = 0, sum = 0;
+        void add(uint64_t l);
+        void merge(const Histogram& o);
+        uint64_t percentile(double p) const;   ///< Rango más cercano; 0 sin muestras
+    };
+
+    struct Job {
+        JobInfo info;
+        uint64_t start = 0, end = 0;           ///< Ciclos de `begin()` y `end()`
+        uint64_t first_beat = 0, first_result = 0, last_result = 0;
+        uint64_t beats = 0, pixels = 0;
+        uint64_t input_blocked = 0, output_wait = 0;
+        Perf perf;
+        Histogram latency;
+    };
+
+    static void write_job(std::FILE* f, const Job& j, const char* indent);
+
+    Job m_cur;
+    std::deque<uint64_t> m_inflight;           ///< Ciclo del primer beat de cada píxel sin resultado
+    std::vector<Job> m_jobs;
+};
+
+#endif
@@ -4,8 +4,8 @@
  *
  * @details
  * Este archivo implementa un entorno mínimo para simular un DUT (Device Under Test) generado con Verilator.
- * Admite trazado VCD (cambio de señales) y cobertura de código. El nombre del módulo a simular debe proporcionarse
- * mediante macros de compilación:
+ * Admite trazado de señales (FST con `--trace-fst`, VCD con `--trace`) y cobertura de código. El nombre del
+ * módulo a simular debe proporcionarse mediante macros de compilación:
  *
  * - `VL_MODULE`     → cadena con el nombre del archivo de cabecera del DUT, por ejemplo `"Vmodulo_tb.h"`.
  * - `VL_TOP_TYPE`   → tipo del objeto top-level generado por Verilator, por ejemplo `Vmodulo_tb`.
@@ -15,7 +15,41 @@
  * verilator ... -DVL_MODULE="\\\"Vmodulo_tb.h\\\"" -DVL_TOP_TYPE=Vmodulo_tb ...
  * ```
  *
- * La simulación se detiene tras alcanzar un tiempo máximo (`MAX_TIME`) o cuando el DUT indique finalización.
+ * La simulación se detiene tras alcanzar un tiempo máximo (`+max_time=<t>`, por defecto 1000000, 0 sin
+ * límite) o cuando el DUT indique finalización. Con `+sim_stats` se imprime al terminar el tiempo simulado y
+ * el tiempo real empleado, que usa `make bench`.
+ *
+ * Compilado con `-DSIM_FAST_STEP` (perfil `PROFILE=perf`), el bucle salta directamente al siguiente
+ * instante con eventos pendientes (`nextTimeSlot()`, requiere `--timing`) en lugar de avanzar de unidad
+ * en unidad, lo que evita miles de evaluaciones vacías por ciclo de reloj.
+ *
+ * @section plusargs Control de la traza en tiempo de ejecución
+ * | Plusarg              | Descripción                                                              |
+ * |----------------------|--------------------------------------------------------------------------|
+ * | `+notrace`           | No abre la traza ni activa `traceEverOn`: simulación a velocidad máxima.  |
+ * | `+trace_file=<ruta>` | Archivo de salida (por defecto `logs/waves.fst`, o `.vcd` con `--trace`). |
+ * | `+trace_depth=<n>`   | Niveles de jerarquía trazados (por defecto 99, todos).                   |
+ * | `+trace_start=<t>`   | Empieza a volcar en el instante `t` (por defecto 0).                     |
+ * | `+trace_stop=<t>`    | Deja de volcar en el instante `t` (por defecto 0, hasta el final).       |
+ * | `+trace_trigger`     | No vuelca hasta que el testbench llame a `sim_trace_on()`.               |
+ * | `+trace_ring=<n>`    | Solo VCD: guarda la traza en memoria y escribe los últimos `n` a `2n`     |
+ * |                      | instantes únicamente si la simulación falla.                             |
+ *
+ * Los instantes se expresan en unidades de `main_time`. Desde SystemVerilog la ventana puede abrirse y
+ * cerrarse sobre un evento concreto declarando
+ * `import "DPI-C" function void sim_trace_on();` y `import "DPI-C" function void sim_trace_off();`.
+ *
+ * @section ring Traza en anillo
+ * Con `+trace_ring=<n>` el VCD se escribe en dos segmentos de memoria de `n` instantes que se
+ * alternan: al empezar cada segmento Verilator reabre la traza (`openNext`) y vuelca el estado
+ * completo, así que cada segmento es un VCD autónomo. El anillo solo llega a disco cuando:
+ * - un `$error`/`$fatal` detiene la simulación (callback de salida de Verilator),
+ * - la simulación termina con `$finish` y el contador de errores de Verilator no es cero,
+ * - el testbench llama a `sim_trace_flush()` (`import "DPI-C" function void sim_trace_flush();`),
+ *   p. ej. al subir una señal de disparo propia.
+ *
+ * El segmento más reciente se escribe en `+trace_file` y el anterior en el mismo nombre con el
+ * sufijo `_prev`. Una simulación correcta no escribe ninguna traza.
  *
  * @author
  * Alejandro Fernández Rodríguez, UCLM
@@ -29,9 +63,24 @@
  */
 
 #include "verilated.h"
-#include "verilated_vcd_c.h"
 #include <verilated_cov.h>
 
+#if VM_TRACE_FST
+# include "verilated_fst_c.h"
+typedef VerilatedFstC TraceFile;               ///< Formato de traza: FST comprimido
+# define TRACE_DEFAULT_FILE "logs/waves.fst"
+#elif VM_TRACE
+# include "verilated_vcd_c.h"
+typedef VerilatedVcdC TraceFile;               ///< Formato de traza: VCD
+# define TRACE_DEFAULT_FILE "logs/waves.vcd"
+#endif
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <sys/stat.h>
+
 /// @brief Verifica que las macros requeridas estén definidas
 #ifndef VL_MODULE
 # error "Debe definir VL_MODULE como el nombre del archivo .h del DUT (por ejemplo: -DVL_MODULE='\\\"Vfifo_cache_tb.h\\\"')"
@@ -47,47 +96,222 @@
 /// @brief Reloj simulado actual en unidades Verilator
 vluint64_t main_time = 0;
 
+/// @brief Volcado activo: controlado por la ventana `+trace_start`/`+trace_stop` y por el testbench
+static bool trace_on = false;
+
 /// @brief Función requerida por Verilator para obtener el timestamp
 double sc_time_stamp() {
     return main_time;
 }
 
+/// @brief Abre la ventana de traza (importada por el testbench con DPI-C)
+extern "C" void sim_trace_on() {
+    trace_on = true;
+}
+
+/// @brief Cierra la ventana de traza (importada por el testbench con DPI-C)
+extern "C" void sim_trace_off() {
+    trace_on = false;
+}
+
+/// @brief Volcado del anillo de traza solicitado por el testbench
+static bool ring_flush_req = false;
+
+/// @brief Escribe el anillo de traza en disco (importada por el testbench con DPI-C)
+extern "C" void sim_trace_flush() {
+    ring_flush_req = true;
+}
+
+#if VM_TRACE && !VM_TRACE_FST
+/**
+ * @class RingVcdFile
+ * @brief Destino en memoria de `VerilatedVcdC` con dos segmentos alternos.
+ *
+ * @details
+ * Cada `open()` (el inicial y los de `openNext`) descarta el segmento más antiguo y empieza a
+ * llenar el otro; `write()` solo añade al segmento actual, sin acceso a disco.
+ */
+class RingVcdFile : public VerilatedVcdFile {
+public:
+    bool open(const std::string&) override {
+        m_cur ^= 1;
+        m_seg[m_cur].clear();
+        return true;
+    }
+    void close() override {}
+    ssize_t write(const char* bufp, ssize_t len) override {
+        m_seg[m_cur].append(bufp, static_cast<size_t>(len));
+        return len;
+    }
+
+    /// @brief Escribe el segmento actual en `name` y el anterior en `name` con sufijo `_prev`
+    void save(const std::string& name) const {
+        const std::string::size_type dot = name.rfind('.');
+        const std::string prev = (dot == std::string::npos) ? name + "_prev"
+                               : name.substr(0, dot) + "_prev" + name.substr(dot);
+        if (!m_seg[m_cur ^ 1].empty()) std::ofstream(prev, std::ios::binary) << m_seg[m_cur ^ 1];
+        std::ofstream(name, std::ios::binary) << m_seg[m_cur];
+    }
+
+private:
+    std::string m_seg[2];                      ///< Segmentos de traza VCD
+    int m_cur = 1;                             ///< Segmento en uso (el primer open pasa al 0)
+};
+
+/// @brief Estado compartido con el callback de salida de Verilator
+struct RingState {
+    VerilatedVcdC* tfp;                        ///< Trazador conectado al anillo
+    RingVcdFile* ring;                         ///< Anillo en memoria
+    std::string file;                          ///< Archivo de salida
+};
+
+/// @brief Vuelca el anillo a disco
+static void ring_save(RingState* st) {
+    st->tfp->flush();                          ///< Vacía el buffer interno de VerilatedVcdC al anillo
+    st->ring->save(st->file);
+    VL_PRINTF("[sim_main] Traza en anillo escrita en %s (t=%llu)\n", st->file.c_str(),
+              static_cast<unsigned long long>(main_time));
+}
+
+/// @brief Callback de salida: un `$error`/`$fatal` aborta la simulación antes de volver a `main`
+static void ring_exit_cb(void* datap) {
+    ring_save(static_cast<RingState*>(datap));
+}
+#endif
+
+/**
+ * @brief Devuelve el valor numérico de un plusarg `+<name><valor>`.
+ *
+ * @param name Prefijo del plusarg incluido el `=`, por ejemplo `"trace_depth="`
+ * @param def  Valor devuelto si el plusarg no aparece
+ */
+static vluint64_t plusarg_u64(const char* name, vluint64_t def) {
+    const std::string arg = Verilated::commandArgsPlusMatch(name);
+    if (arg.empty()) return def;
+    return std::strtoull(arg.c_str() + 1 + std::string(name).size(), nullptr, 0);
+}
+
 /**
  * @brief Punto de entrada principal para la simulación.
  *
  * @param argc Número de argumentos de línea de comandos
  * @param argv Argumentos de línea de comandos
- * @return Código de salida estándar (0 si correcto)
+ * @return 0 si correcto, 1 si el testbench notificó algún `$error` (para `make regress`)
  *
  * @details
- * Crea el objeto `top` del DUT, inicializa la traza VCD, ejecuta la simulación
- * durante un máximo de `MAX_TIME` ciclos y escribe los resultados de cobertura.
+ * Crea el objeto `top` del DUT, abre la traza salvo con `+notrace`, ejecuta la simulación
+ * durante un máximo de `MAX_TIME` ciclos volcando solo dentro de la ventana configurada
+ * y escribe los resultados de cobertura.
  */
 int main(int argc, char **argv) {
     Verilated::commandArgs(argc, argv);        ///< Procesa argumentos de simulación
-    Verilated::traceEverOn(true);              ///< Habilita trazado VCD global
+    const vluint64_t max_time = plusarg_u64("max_time=", 1000000); ///< Límite de tiempo simulado
+    const bool sim_stats = Verilated::commandArgsPlusMatch("sim_stats")[0] != '\0';
+    const auto wall_t0 = std::chrono::steady_clock::now();
+
+#if VM_TRACE
+    const bool trace_en = Verilated::commandArgsPlusMatch("notrace")[0] == '\0';
+    const vluint64_t trace_start = plusarg_u64("trace_start=", 0);
+    const vluint64_t trace_stop  = plusarg_u64("trace_stop=", 0);
+    const int trace_depth = static_cast<int>(plusarg_u64("trace_depth=", 99));
+    const bool trace_trigger = Verilated::commandArgsPlusMatch("trace_trigger")[0] != '\0';
+    std::string trace_file = Verilated::commandArgsPlusMatch("trace_file=");
+    trace_file = trace_file.empty() ? TRACE_DEFAULT_FILE : trace_file.substr(sizeof("+trace_file=") - 1);
+# if !VM_TRACE_FST
+    const vluint64_t trace_ring = plusarg_u64("trace_ring=", 0);
+# else
+    if (Verilated::commandArgsPlusMatch("trace_ring=")[0] != '\0')
+        VL_PRINTF("[sim_main] +trace_ring requiere compilar con --trace (VCD); se ignora\n");
+# endif
+
+    if (trace_en) Verilated::traceEverOn(true); ///< Sin traza el modelo no registra actividad
+#endif
 
     VL_TOP_TYPE* top = new VL_TOP_TYPE;        ///< Instancia del DUT
 
-    VerilatedVcdC* tfp = new VerilatedVcdC;    ///< Objeto de traza VCD
-    top->trace(tfp, 99);                       ///< Conecta el DUT al trazador
-    tfp->open("dump.vcd");                     ///< Archivo de salida de señales
+#if VM_TRACE
+    TraceFile* tfp = nullptr;                  ///< Objeto de traza (FST o VCD)
+# if !VM_TRACE_FST
+    RingVcdFile* ring = nullptr;               ///< Anillo en memoria con `+trace_ring`
+# endif
+    if (trace_en) {
+        const std::string::size_type slash = trace_file.rfind('/');
+        if (slash != std::string::npos) mkdir(trace_file.substr(0, slash).c_str(), 0755);
+# if !VM_TRACE_FST
+        if (trace_ring) ring = new RingVcdFile;
+        tfp = new TraceFile(ring);             ///< Con `ring` nulo VerilatedVcdC escribe en disco
+# else
+        tfp = new TraceFile;
+# endif
+        top->trace(tfp, trace_depth);          ///< Conecta el DUT al trazador
+        tfp->open(trace_file.c_str());         ///< Archivo de salida de señales
+        trace_on = (trace_start == 0) && !trace_trigger;
+    }
+# if !VM_TRACE_FST
+    RingState ring_st{tfp, ring, trace_file};
+    if (ring) Verilated::addExitCb(ring_exit_cb, &ring_st);
+# endif
+#endif
 
     top->eval();                               ///< Evaluación inicial
-    tfp->dump(main_time);                      ///< Dump del primer estado
+#if VM_TRACE
+    if (tfp && trace_on) tfp->dump(main_time); ///< Dump del primer estado
+#endif
 
-    const vluint64_t MAX_TIME = 1000000;       ///< Límite máximo de tiempo simulado
-    while (!Verilated::gotFinish() && main_time < MAX_TIME) {
+    while (!Verilated::gotFinish() && (max_time == 0 || main_time < max_time)) {
+#ifdef SIM_FAST_STEP
+        if (!top->eventsPending()) break;      ///< Nada más que simular
+        main_time = top->nextTimeSlot();       ///< Salto al siguiente instante con eventos
+        Verilated::threadContextp()->time(main_time);
+#else
         main_time++;
         Verilated::timeInc(1);                 ///< Incremento interno de tiempo Verilator
+#endif
         top->eval();                           ///< Evaluación del DUT
-        tfp->dump(main_time);                  ///< Dump al archivo VCD
+#if VM_TRACE
+        if (tfp) {
+            if (main_time == trace_start && !trace_trigger) trace_on = true;
+            if (main_time == trace_stop) trace_on = false;
+# if !VM_TRACE_FST
+            if (ring && main_time % trace_ring == 0) tfp->openNext(true); ///< Nuevo segmento
+# endif
+            if (trace_on) tfp->dump(main_time); ///< Dump solo dentro de la ventana
+        }
+# if !VM_TRACE_FST
+        if (ring && ring_flush_req) {
+            ring_flush_req = false;
+            ring_save(&ring_st);
+        }
+# endif
+#endif
     }
 
+    if (sim_stats) {
+        const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_t0).count();
+        VL_PRINTF("[sim_main] sim_time=%llu wall_s=%.6f\n", static_cast<unsigned long long>(main_time), wall_s);
+    }
+
+#if VM_COVERAGE
     Verilated::threadContextp()->coveragep()->write("coverage.dat"); ///< Dump de cobertura
+#endif
 
-    tfp->close();                              ///< Cierra el archivo de traza
-    delete tfp;
+#if VM_TRACE && !VM_TRACE_FST
+    if (ring) {
+        if (Verilated::threadContextp()->gotError() || Verilated::threadContextp()->errorCount() > 0)
+            ring_save(&ring_st);
+        Verilated::removeExitCb(ring_exit_cb, &ring_st);
+    }
+#endif
+#if VM_TRACE
+    if (tfp) {
+        tfp->close();                          ///< Cierra el archivo de traza
+        delete tfp;
+    }
+# if !VM_TRACE_FST
+    delete ring;
+# endif
+#endif
+    const bool failed = Verilated::threadContextp()->gotError() || Verilated::threadContextp()->errorCount() > 0;
     delete top;
-    return 0;
+    return failed ? 1 : 0;
 }
@@ -22,6 +22,15 @@
  * R8: Integridad de datos: data_out debe coincidir con la secuencia escrita.
  * R9: Operaciones back-to-back de escritura y lectura consecutivas sin errores.
  * R10: Comportamiento robusto bajo secuencias aleatorias sin violaciones.
+ * R11: La salida level coincide con el número de palabras almacenadas.
+ * R12: almost_full (level >= AF_LEVEL) y almost_empty (level <= AE_LEVEL) siguen a la ocupación.
+ * R13: Con FWFT = 1 la palabra de cabeza está en data_out sin lectura previa y rd_en la consume
+ *      en el mismo ciclo, avanzando a la siguiente.
+ * R14: Las instancias con STORAGE = "SRAM" (lectura registrada) y STORAGE = "BRAM" (FWFT) se
+ *      comportan ciclo a ciclo igual que las de registros con los mismos estímulos.
+ * R15: fifo_cache_async con escritura en clk y lectura en un reloj más lento entrega los datos en
+ *      orden y sin pérdidas, sin superar DEPTH palabras en ninguno de los dos niveles, y queda vacía
+ *      en ambos dominios al final.
  *
  * Cobertura funcional
  * -------------------------------------------------------------------------
@@ -32,6 +41,8 @@ module fifo_cache_tb;
     // Parámetros
     parameter int WIDTH = 16;
     parameter int DEPTH = 8;
+    localparam int AF_LEVEL = DEPTH - 2;
+    localparam int AE_LEVEL = 2;
 
     // Señales DUT
     logic                  clk;
@@ -42,6 +53,36 @@ module fifo_cache_tb;
     logic [WIDTH-1:0]      data_out;
     logic                  full;
     logic                  empty;
+    logic [$clog2(DEPTH):0] level;
+    logic                  almost_full;
+    logic                  almost_empty;
+
+    // Instancia FWFT (R13)
+    logic                  fw_wr_en, fw_rd_en;
+    logic [WIDTH-1:0]      fw_data_in, fw_data_out;
+    logic                  fw_empty;
+    /* verilator lint_off UNUSEDSIGNAL */
+    logic                  fw_full, fw_af, fw_ae;
+    logic [$clog2(DEPTH):0] fw_level;
+    /* verilator lint_on UNUSEDSIGNAL */
+
+    // Instancias con memoria de lectura síncrona (R14), en paralelo con uut y uut_fwft
+    logic [WIDTH-1:0]      sr_data_out, br_data_out;
+    logic                  sr_full, sr_empty, br_empty;
+    logic [$clog2(DEPTH):0] sr_level, br_level;
+    /* verilator lint_off UNUSEDSIGNAL */
+    logic                  sr_af, sr_ae, br_full, br_af, br_ae;
+    /* verilator lint_on UNUSEDSIGNAL */
+    logic                  rd_seen = 1'b0;
+    int                    r14_errors = 0;
+
+    // Instancia de doble reloj (R15)
+    logic                  rclk;
+    logic                  as_wr_en, as_rd_en;
+    logic [WIDTH-1:0]      as_data_in, as_data_out;
+    logic                  as_full, as_empty;
+    logic [$clog2(DEPTH):0] as_wr_level, as_rd_level;
+    int                    r15_errors = 0;
 
     // Modelo de referencia
     logic [WIDTH-1:0] golden_mem [0:DEPTH-1];
@@ -59,11 +100,115 @@ module fifo_cache_tb;
         .data_in  (data_in),
         .data_out (data_out),
         .full     (full),
-        .empty    (empty)
+        .empty    (empty),
+        .level    (level),
+        .af_level (($clog2(DEPTH)+1)'(AF_LEVEL)),
+        .ae_level (($clog2(DEPTH)+1)'(AE_LEVEL)),
+        .almost_full  (almost_full),
+        .almost_empty (almost_empty)
+    );
+
+    fifo_cache #(
+        .WIDTH (WIDTH),
+        .DEPTH (DEPTH),
+        .FWFT  (1'b1)
+    ) uut_fwft (
+        .clk      (clk),
+        .rst_n    (rst_n),
+        .wr_en    (fw_wr_en),
+        .rd_en    (fw_rd_en),
+        .data_in  (fw_data_in),
+        .data_out (fw_data_out),
+        .full     (fw_full),
+        .empty    (fw_empty),
+        .level    (fw_level),
+        .af_level (($clog2(DEPTH)+1)'(AF_LEVEL)),
+        .ae_level (($clog2(DEPTH)+1)'(AE_LEVEL)),
+        .almost_full  (fw_af),
+        .almost_empty (fw_ae)
+    );
+
+    fifo_cache #(
+        .WIDTH   (WIDTH),
+        .DEPTH   (DEPTH),
+        .STORAGE ("SRAM")
+    ) uut_sram (
+        .clk      (clk),
+        .rst_n    (rst_n),
+        .wr_en    (wr_en),
+        .rd_en    (rd_en),
+        .data_in  (data_in),
+        .data_out (sr_data_out),
+        .full     (sr_full),
+        .empty    (sr_empty),
+        .level    (sr_level),
+        .af_level (($clog2(DEPTH)+1)'(AF_LEVEL)),
+        .ae_level (($clog2(DEPTH)+1)'(AE_LEVEL)),
+        .almost_full  (sr_af),
+        .almost_empty (sr_ae)
     );
 
+    fifo_cache #(
+        .WIDTH   (WIDTH),
+        .DEPTH   (DEPTH),
+        .FWFT    (1'b1),
+        .STORAGE ("BRAM")
+    ) uut_bram (
+        .clk      (clk),
+        .rst_n    (rst_n),
+        .wr_en    (fw_wr_en),
+        .rd_en    (fw_rd_en),
+        .data_in  (fw_data_in),
+        .data_out (br_data_out),
+        .full     (br_full),
+        .empty    (br_empty),
+        .level    (br_level),
+        .af_level (($clog2(DEPTH)+1)'(AF_LEVEL)),
+        .ae_level (($clog2(DEPTH)+1)'(AE_LEVEL)),
+        .almost_full  (br_af),
+        .almost_empty (br_ae)
+    );
+
+    fifo_cache_async #(
+        .WIDTH (WIDTH),
+        .DEPTH (DEPTH),
+        .FWFT  (1'b1)
+    ) uut_async (
+        .wr_clk   (clk),
+        .wr_rst_n (rst_n),
+        .wr_en    (as_wr_en),
+        .data_in  (as_data_in),
+        .full     (as_full),
+        .wr_level (as_wr_level),
+        .rd_clk   (rclk),
+        .rd_rst_n (rst_n),
+        .rd_en    (as_rd_en),
+        .data_out (as_data_out),
+        .empty    (as_empty),
+        .rd_level (as_rd_level)
+    );
+
+    // Comparación ciclo a ciclo (R14); data_out registrado solo es significativo tras la primera lectura
+    always @(negedge clk) begin
+        if (rst_n) begin
+            if (sr_full !== full || sr_empty !== empty || sr_level !== level ||
+                (rd_seen && sr_data_out !== data_out)) begin
+                $error("R14 FAILED: SRAM data_out=%h level=%0d, registros data_out=%h level=%0d",
+                       sr_data_out, sr_level, data_out, level);
+                r14_errors++;
+            end
+            if (br_empty !== fw_empty || br_level !== fw_level ||
+                (!fw_empty && br_data_out !== fw_data_out)) begin
+                $error("R14 FAILED: BRAM FWFT data_out=%h, registros FWFT data_out=%h", br_data_out, fw_data_out);
+                r14_errors++;
+            end
+            if (rd_en && !empty) rd_seen <= 1'b1;
+        end
+    end
+
     // Generación de reloj
     always #5 clk = ~clk;
+    always #7 rclk = ~rclk;   // dominio de lectura de uut_async, no relacionado con clk
 
     // Cobertura funcional: usando covergroup solo en simuladores compatibles
 `ifndef VERILATOR
@@ -91,11 +236,19 @@ module fifo_cache_tb;
         rd_en         = 0;
         data_in       = '0;
         current_count = 0;
+        fw_wr_en      = 0;
+        fw_rd_en      = 0;
+        rclk          = 0;
+        as_wr_en      = 0;
+        as_rd_en      = 0;
+        as_data_in    = '0;
+        fw_data_in    = '0;
 
         // Reset y R1
         #10 rst_n = 1;
         @(posedge clk);
         assert (empty) else $error("R1 FAILED: FIFO debe estar vacía tras reset");
+        assert (almost_empty && !almost_full) else $error("R12 FAILED: almost_empty/almost_full incorrectos tras reset");
         $display("R1 PASSED: FIFO vacía tras reset");
 
         // Test 1: llenar FIFO (R2, R3)
@@ -114,6 +267,8 @@ module fifo_cache_tb;
         @(negedge clk); wr_en = 0;
         @(posedge clk);
         assert(full) else $error("R3 FAILED: full no activo tras DEPTH escrituras");
+        assert(level == DEPTH) else $error("R11 FAILED: level=%0d tras DEPTH escrituras", level);
+        assert(almost_full && !almost_empty) else $error("R12 FAILED: almost_full/almost_empty incorrectos con la FIFO llena");
         $display("R2 PASSED: Escrituras normales OK");
         $display("R3 PASSED: full activo al llegar a DEPTH");
 
@@ -174,8 +329,80 @@ module fifo_cache_tb;
 `ifndef VERILATOR
             cg.sample();
 `endif
+            @(negedge clk);
+            assert(int'(level) == current_count) else $error("R11 FAILED: level=%0d esperado %0d", level, current_count);
+            assert(almost_full == (current_count >= AF_LEVEL) && almost_empty == (current_count <= AE_LEVEL))
+                else $error("R12 FAILED: almost_full=%0b almost_empty=%0b con %0d palabras", almost_full, almost_empty, current_count);
         end
         $display("R9,R10 PASSED: secuencias back-to-back y aleatorias OK");
+        $display("R11 PASSED: level coincide con la ocupación");
+        $display("R12 PASSED: almost_full/almost_empty siguen a los umbrales");
+
+        // Test 5: FWFT (R13)
+        for (int i = 0; i < 3; i++) begin
+            @(negedge clk); fw_wr_en = 1; fw_data_in = WIDTH'(16'hA0 + i);
+        end
+        @(negedge clk); fw_wr_en = 0;
+        assert(!fw_empty && fw_data_out == 16'hA0) else $error("R13 FAILED: cabeza %h esperada 00A0", fw_data_out);
+        for (int i = 0; i < 3; i++) begin
+            @(negedge clk);
+            assert(fw_data_out == WIDTH'(16'hA0 + i)) else $error("R13 FAILED: dato %0d = %h", i, fw_data_out);
+            fw_rd_en = 1;
+            @(posedge clk);
+            #1 fw_rd_en = 0;
+        end
+        @(negedge clk);
+        assert(fw_empty) else $error("R13 FAILED: FIFO FWFT no vacía tras 3 lecturas");
+        $display("R13 PASSED: FWFT presenta la cabeza sin latencia de lectura");
+
+        // Ráfaga que llena y vacía la FIFO FWFT con escrituras y lecturas simultáneas (R14)
+        for (int i = 0; i < 3*DEPTH; i++) begin
+            @(negedge clk);
+            fw_wr_en   = (i < 2*DEPTH) && ($urandom_range(0,3) != 0);
+            fw_data_in = WIDTH'($urandom);
+            fw_rd_en   = $urandom_range(0,1) && !fw_empty;
+        end
+        @(negedge clk); fw_wr_en = 0; fw_rd_en = 0;
+        assert(r14_errors == 0) else $error("R14 FAILED: %0d discrepancias", r14_errors);
+        $display("R14 PASSED: almacenamiento SRAM/BRAM equivalente al de registros");
+
+        // Doble reloj (R15): secuencia 0, 1, 2... escrita en clk y comprobada al leer en rclk
+        fork
+            begin
+                for (int n = 0; n < 4*DEPTH; ) begin
+                    @(negedge clk);
+                    as_wr_en = 1'b0;
+                    if (!as_full && $urandom_range(0,3) != 0) begin
+                        as_wr_en   = 1'b1;
+                        as_data_in = WIDTH'(n);
+                        n++;
+                    end
+                    if (int'(as_wr_level) > DEPTH) r15_errors++;
+                end
+                @(negedge clk); as_wr_en = 1'b0;
+            end
+            begin
+                for (int n = 0; n < 4*DEPTH; ) begin
+                    @(negedge rclk);
+                    as_rd_en = 1'b0;
+                    if (!as_empty && $urandom_range(0,1) != 0) begin
+                        if (as_data_out !== WIDTH'(n)) begin
+                            $error("R15 FAILED: leído %h, esperado %h", as_data_out, WIDTH'(n));
+                            r15_errors++;
+                        end
+                        as_rd_en = 1'b1;
+                        n++;
+                    end
+                    if (int'(as_rd_level) > DEPTH) r15_errors++;
+                end
+                @(negedge rclk); as_rd_en = 1'b0;
+            end
+        join
+        repeat (4) @(negedge rclk);
+        assert(r15_errors == 0 && as_empty && as_wr_level == 0 && as_rd_level == 0)
+            else $error("R15 FAILED: %0d errores, empty=%0b wr_level=%0d rd_level=%0d",
+                        r15_errors, as_empty, as_wr_level, as_rd_level);
+        $display("R15 PASSED: FIFO de doble reloj sin pérdidas ni desbordamientos");
 
         // Fin
         @(posedge clk);
@@ -20,6 +20,40 @@
  * R2.2: Validación del resultado DOT: sólo componente Z no nulo.
  * R3.1: Detección de error ERR_OP cuando num_bands != 3 para OP_CODE=CROSS.
  * R3.2: Detección de error ERR_BANDS cuando num_bands > COMPONENTS_MAX.
+ * R4.1: Modo streaming (CONFIG.STREAM): varios píxeles DOT con un único START.
+ * R5.1: Modo band-serial (CONFIG.BAND_SERIAL): píxel DOT de 7 bandas en 3 beats.
+ * R6.1: DMA: 3 píxeles DOT leídos de memoria por el puerto maestro OBI y resultados escritos en DST.
+ * R7.1: Trabajo de PIXEL_COUNT = 3 píxeles con un único START: DONE solo tras el último resultado
+ *       y PROCESSED_COUNT = 3.
+ * R8.1: Con IRQ_ENABLE.DONE, irq_o se activa al terminar un píxel y se limpia escribiendo IRQ_STATUS.
+ * R9.1: Contadores de rendimiento durante el trabajo de R7.1: PERF_PIXELS = 3 y PERF_STALL_IN
+ *       distinto de cero (START antes de cargar los datos), acotado por PERF_BUSY.
+ * R10.1: Con IRQ_LEVEL = 2 (almost_full con 2 palabras, almost_empty con 0), dos píxeles encolados
+ *       se reflejan en FIFO_LEVEL_IN y en los bits almost_* de FIFO_STATUS.
+ * R11.1: Con DUAL_CLOCK = 1 y el núcleo a un reloj más rápido que el bus, un píxel CROSS con un
+ *       START y un trabajo streaming de PIXEL_COUNT = 3 píxeles DOT dan los resultados correctos,
+ *       DONE y PROCESSED_COUNT = 3.
+ * R11.2: Con DUAL_CLOCK = 1, dos trabajos de PIXEL_COUNT = 1 encolados seguidos reciben cada uno su
+ *       START (el segundo en cuanto termina el primero): resultados 32 y 6 y DESC_STATUS[15:8] = 2.
+ * R12.1: Banco de referencias por DMA: OP_REF_LOAD con PIXEL_COUNT = 3 lee 3 referencias solo de
+ *       DMA_SRC2 (DONE, DMA_DONE y PROCESSED_COUNT = 3) y un trabajo OP_DOT con CONFIG.REF_MODE lee
+ *       2 píxeles solo de DMA_SRC1 y escribe 3 productos escalares por píxel en DMA_DST.
+ * R12.2: Con CONFIG.POST = ARGMAX, los mismos 2 píxeles contra el banco escriben por DMA una sola
+ *       palabra por píxel {mejor puntuación, índice}: {32,0} y {15,0}, empaquetadas cada 4 bytes.
+ * R12.3: Tras un OP_REF_LOAD, un OP_DOT con REF_MODE y PIXEL_COUNT = 0 no termina con el pixel_done
+ *       de la carga: DONE llega con el resultado (2,6,32) ya en la FIFO de salida.
+ * R13.1: Con NUM_CORES = 2, un trabajo de PIXEL_COUNT = 4 píxeles DOT se reparte entre los dos
+ *       núcleos (PERF_CORE_PIXELS = 2 en cada uno) y los resultados salen en orden de píxel.
+ * R13.2: En ese trabajo PERF_BUSY cuenta los ciclos con algún núcleo activo: no es menor que el
+ *       PERF_CORE_BUSY de ninguno de los dos.
+ * R13.3: Con PIXEL_COUNT = 0 y 3 píxeles encolados (dos para el núcleo 0), DONE espera a ambos
+ *       núcleos: PROCESSED_COUNT = 3 al verlo, sin error y con los resultados 32, 6 y -1 en orden.
+ * R14.1: Con BAND_WINDOW = {3, 4} y BAND_SERIAL, 2 píxeles de 9 bandas (3 beats) leídos por DMA solo
+ *       desde el beat de la banda 4: (1..9)·(1,..,1) y (1..9)·(2,..,2) sobre las bandas 4..6 dan 18 y 36.
+ *
+ * Con `+bench=<n>` no se ejecutan los requisitos: se lanza un único trabajo DOT streaming de `n`
+ * píxeles por DMA (la memoria de 1 KiB se recorre de forma circular) y se imprime la línea
+ * `[BENCH] pixels=<n> job_cycles=<c> total_cycles=<t>` que procesa `scripts/bench.sh`.
  *
  * Cobertura funcional:
  * - Camino de escritura y lectura por OBI.
@@ -40,6 +74,7 @@ module hsi_accel_obi_tb;
 
   localparam [31:0] OP_CROSS = 32'd1;
   localparam [31:0] OP_DOT   = 32'd2;
+  localparam [31:0] OP_REF_LOAD = 32'd4;
   /* verilator lint_off UNUSEDPARAM */
   localparam ERR_NONE  = 4'd0;
   /* verilator lint_on UNUSEDPARAM */
@@ -62,6 +97,7 @@ module hsi_accel_obi_tb;
   logic gnt_o, rvalid_o, err_o;
   /* verilator lint_on UNUSEDSIGNAL */
   logic [31:0] rdata_o;
+  logic        irq_o;
 
   // Datos HSI
   logic in1_wr_en, in2_wr_en;
@@ -70,11 +106,54 @@ module hsi_accel_obi_tb;
   logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] out_data_o;
   logic out_empty_o;
 
+  // Puerto maestro OBI (DMA) y memoria del testbench
+  logic        dma_req, dma_we, dma_gnt, dma_rvalid;
+  /* verilator lint_off UNUSEDSIGNAL */
+  logic [3:0]  dma_be;
+  logic [31:0] dma_addr;
+  /* verilator lint_on UNUSEDSIGNAL */
+  logic [31:0] dma_wdata, dma_rdata;
+  logic [31:0] mem [0:255];
+  logic        tb_mem_we = 1'b0;
+  logic [7:0]  tb_mem_addr = '0;
+  logic [31:0] tb_mem_wdata = '0;
+
   // Internos
   integer error_count = 0;
   /* verilator lint_off UNUSEDSIGNAL */
   logic [31:0] data_rd;
+  logic [31:0] rdata_job;
+  logic [31:0] rdata_perf;
+  logic [31:0] rdata_core1;
+  logic        empty_at_done;
+  /* verilator lint_on UNUSEDSIGNAL */
+
+  // Segunda instancia con doble reloj (R11.1)
+  logic        core_clk = 0;
+  logic        dc_req, dc_we;
+  logic [31:0] dc_addr, dc_wdata, dc_rdata;
+  logic        dc_rvalid;
+  /* verilator lint_off UNUSEDSIGNAL */
+  logic        dc_gnt, dc_err, dc_irq;
+  logic        dc_dma_req, dc_dma_we;
+  logic [3:0]  dc_dma_be;
+  logic [31:0] dc_dma_addr, dc_dma_wdata;
+  /* verilator lint_on UNUSEDSIGNAL */
+  logic        dc_in_wr_en, dc_out_rd_en, dc_out_empty;
+  logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] dc_in1_data, dc_in2_data, dc_out_data;
+
+  // Tercera instancia con dos núcleos (R13.1)
+  logic        mc_req, mc_we;
+  logic [31:0] mc_addr, mc_wdata, mc_rdata;
+  logic        mc_rvalid;
+  /* verilator lint_off UNUSEDSIGNAL */
+  logic        mc_gnt, mc_err, mc_irq;
+  logic        mc_dma_req, mc_dma_we;
+  logic [3:0]  mc_dma_be;
+  logic [31:0] mc_dma_addr, mc_dma_wdata;
   /* verilator lint_on UNUSEDSIGNAL */
+  logic        mc_in_wr_en, mc_out_rd_en, mc_out_empty;
+  logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] mc_in1_data, mc_in2_data, mc_out_data;
 
   // ---------------------------------------
   // Instancia del DUT
@@ -82,10 +161,12 @@ module hsi_accel_obi_tb;
   hsi_accel_obi #(
     .COMPONENT_WIDTH(COMPONENT_WIDTH),
     .COMPONENTS_MAX(COMPONENTS_MAX),
-    .FIFO_DEPTH(FIFO_DEPTH)
+    .FIFO_DEPTH(FIFO_DEPTH),
+    .DMA_EN(1)
   ) dut (
     .clk_i(clk),
     .rst_ni(rst_ni),
+    .core_clk_i(clk),
     .req_i(req_i),
     .we_i(we_i),
     .be_i(be_i),
@@ -95,6 +176,15 @@ module hsi_accel_obi_tb;
     .rvalid_o(rvalid_o),
     .rdata_o(rdata_o),
     .err_o(err_o),
+    .irq_o(irq_o),
+    .dma_req_o(dma_req),
+    .dma_we_o(dma_we),
+    .dma_be_o(dma_be),
+    .dma_addr_o(dma_addr),
+    .dma_wdata_o(dma_wdata),
+    .dma_gnt_i(dma_gnt),
+    .dma_rvalid_i(dma_rvalid),
+    .dma_rdata_i(dma_rdata),
     .in1_wr_en_i(in1_wr_en),
     .in2_wr_en_i(in2_wr_en),
     .in1_data_i(in1_data_i),
@@ -104,19 +194,110 @@ module hsi_accel_obi_tb;
     .out_data_o(out_data_o)
   );
 
+  hsi_accel_obi #(
+    .COMPONENT_WIDTH(COMPONENT_WIDTH),
+    .COMPONENTS_MAX(COMPONENTS_MAX),
+    .FIFO_DEPTH(FIFO_DEPTH),
+    .DUAL_CLOCK(1)
+  ) dut_dc (
+    .clk_i(clk),
+    .rst_ni(rst_ni),
+    .core_clk_i(core_clk),
+    .req_i(dc_req),
+    .we_i(dc_we),
+    .be_i(4'hF),
+    .addr_i(dc_addr),
+    .wdata_i(dc_wdata),
+    .gnt_o(dc_gnt),
+    .rvalid_o(dc_rvalid),
+    .rdata_o(dc_rdata),
+    .err_o(dc_err),
+    .irq_o(dc_irq),
+    .dma_req_o(dc_dma_req),
+    .dma_we_o(dc_dma_we),
+    .dma_be_o(dc_dma_be),
+    .dma_addr_o(dc_dma_addr),
+    .dma_wdata_o(dc_dma_wdata),
+    .dma_gnt_i(1'b0),
+    .dma_rvalid_i(1'b0),
+    .dma_rdata_i(32'h0),
+    .in1_wr_en_i(dc_in_wr_en),
+    .in2_wr_en_i(dc_in_wr_en),
+    .in1_data_i(dc_in1_data),
+    .in2_data_i(dc_in2_data),
+    .out_rd_en_i(dc_out_rd_en),
+    .out_empty_o(dc_out_empty),
+    .out_data_o(dc_out_data)
+  );
+
+  hsi_accel_obi #(
+    .COMPONENT_WIDTH(COMPONENT_WIDTH),
+    .COMPONENTS_MAX(COMPONENTS_MAX),
+    .FIFO_DEPTH(FIFO_DEPTH),
+    .NUM_CORES(2)
+  ) dut_mc (
+    .clk_i(clk),
+    .rst_ni(rst_ni),
+    .core_clk_i(clk),
+    .req_i(mc_req),
+    .we_i(mc_we),
+    .be_i(4'hF),
+    .addr_i(mc_addr),
+    .wdata_i(mc_wdata),
+    .gnt_o(mc_gnt),
+    .rvalid_o(mc_rvalid),
+    .rdata_o(mc_rdata),
+    .err_o(mc_err),
+    .irq_o(mc_irq),
+    .dma_req_o(mc_dma_req),
+    .dma_we_o(mc_dma_we),
+    .dma_be_o(mc_dma_be),
+    .dma_addr_o(mc_dma_addr),
+    .dma_wdata_o(mc_dma_wdata),
+    .dma_gnt_i(1'b0),
+    .dma_rvalid_i(1'b0),
+    .dma_rdata_i(32'h0),
+    .in1_wr_en_i(mc_in_wr_en),
+    .in2_wr_en_i(mc_in_wr_en),
+    .in1_data_i(mc_in1_data),
+    .in2_data_i(mc_in2_data),
+    .out_rd_en_i(mc_out_rd_en),
+    .out_empty_o(mc_out_empty),
+    .out_data_o(mc_out_data)
+  );
+
   // ---------------------------------------
   // Clock & Reset
   // ---------------------------------------
   always #5 clk = ~clk;
+  always #3 core_clk = ~core_clk;   // núcleo de dut_dc más rápido que el bus
 
   initial begin
     req_i = 0; we_i = 0; be_i = 0; addr_i = 0; wdata_i = 0;
     in1_wr_en = 0; in2_wr_en = 0; out_rd_en = 0;
+    dc_req = 0; dc_we = 0; dc_addr = 0; dc_wdata = 0;
+    dc_in_wr_en = 0; dc_out_rd_en = 0; dc_in1_data = 0; dc_in2_data = 0;
+    mc_req = 0; mc_we = 0; mc_addr = 0; mc_wdata = 0;
+    mc_in_wr_en = 0; mc_out_rd_en = 0; mc_in1_data = 0; mc_in2_data = 0;
     rst_ni = 0;
     repeat (3) @(posedge clk);
     rst_ni = 1;
   end
 
+  // ---------------------------------------
+  // Memoria esclava OBI (concesión inmediata, respuesta al ciclo siguiente)
+  // ---------------------------------------
+  assign dma_gnt = dma_req;
+
+  always_ff @(posedge clk) begin
+    dma_rvalid <= dma_req && dma_gnt;
+    if (dma_req && dma_gnt) begin
+      if (dma_we) mem[dma_addr[9:2]] <= dma_wdata;
+      else        dma_rdata <= mem[dma_addr[9:2]];
+    end
+    if (tb_mem_we) mem[tb_mem_addr] <= tb_mem_wdata;
+  end
+
   // ---------------------------------------
   // Funciones auxiliares
   // ---------------------------------------
@@ -140,6 +321,105 @@ module hsi_accel_obi_tb;
     end
   endtask
 
+  task mem_write(input [31:0] addr, input [31:0] data);
+    begin
+      @(posedge clk);
+      tb_mem_addr = addr[9:2]; tb_mem_wdata = data; tb_mem_we = 1'b1;
+      @(posedge clk);
+      tb_mem_we = 1'b0;
+    end
+  endtask
+
+  // Píxel {x,y,z} de 48 bits en dos palabras little-endian: {y,z} y {0,x}
+  task mem_write_pixel(input [31:0] addr, input [COMPONENT_WIDTH-1:0] x, y, z);
+    begin
+      mem_write(addr,     {y, z});
+      mem_write(addr + 4, {16'h0, x});
+    end
+  endtask
+
+  // Accesos a dut_dc (bus en clk)
+  task dc_obi_write(input [31:0] addr, input [31:0] data);
+    begin
+      @(posedge clk);
+      dc_addr = addr; dc_wdata = data; dc_we = 1'b1; dc_req = 1'b1;
+      @(posedge clk);
+      dc_req = 0; dc_we = 0;
+    end
+  endtask
+
+  task dc_obi_read(input [31:0] addr, output [31:0] data);
+    begin
+      @(posedge clk);
+      dc_addr = addr; dc_we = 0; dc_req = 1'b1;
+      @(posedge clk);
+      dc_req = 0;
+      wait (dc_rvalid);
+      data = dc_rdata;
+    end
+  endtask
+
+  task dc_push_vectors(input [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] v1, v2);
+    begin
+      @(posedge clk);
+      dc_in1_data = v1; dc_in2_data = v2; dc_in_wr_en = 1;
+      @(posedge clk);
+      dc_in_wr_en = 0;
+    end
+  endtask
+
+  task dc_wait_result(output [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] res);
+    begin
+      wait (!dc_out_empty);
+      @(posedge clk);
+      dc_out_rd_en = 1;
+      @(posedge clk);
+      dc_out_rd_en = 0;
+      res = dc_out_data;
+    end
+  endtask
+
+  // Accesos a dut_mc
+  task mc_obi_write(input [31:0] addr, input [31:0] data);
+    begin
+      @(posedge clk);
+      mc_addr = addr; mc_wdata = data; mc_we = 1'b1; mc_req = 1'b1;
+      @(posedge clk);
+      mc_req = 0; mc_we = 0;
+    end
+  endtask
+
+  task mc_obi_read(input [31:0] addr, output [31:0] data);
+    begin
+      @(posedge clk);
+      mc_addr = addr; mc_we = 0; mc_req = 1'b1;
+      @(posedge clk);
+      mc_req = 0;
+      wait (mc_rvalid);
+      data = mc_rdata;
+    end
+  endtask
+
+  task mc_push_vectors(input [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] v1, v2);
+    begin
+      @(posedge clk);
+      mc_in1_data = v1; mc_in2_data = v2; mc_in_wr_en = 1;
+      @(posedge clk);
+      mc_in_wr_en = 0;
+    end
+  endtask
+
+  task mc_wait_result(output [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] res);
+    begin
+      wait (!mc_out_empty);
+      @(posedge clk);
+      mc_out_rd_en = 1;
+      @(posedge clk);
+      mc_out_rd_en = 0;
+      res = mc_out_data;
+    end
+  endtask
+
   function automatic signed [COMPONENT_WIDTH-1:0] get_comp(
     input logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] vec,
     input int idx
@@ -189,6 +469,30 @@ module hsi_accel_obi_tb;
     end
   endtask
 
+  // Trabajo de rendimiento (+bench): N píxeles DOT streaming por DMA, sin comprobar resultados
+  task bench_run(input int unsigned pixels);
+    time t0;
+    begin
+      for (int w = 0; w < 16; w++) mem_write(32'(w * 4), 32'(w + 1));
+      obi_write(32'h00, OP_DOT, 4'hF);
+      obi_write(32'h04, 32'd3, 4'hF);
+      obi_write(32'h14, 32'h1, 4'hF);      // CONFIG.STREAM
+      obi_write(32'h18, 32'h000, 4'hF);    // DMA_SRC1
+      obi_write(32'h1C, 32'h200, 4'hF);    // DMA_SRC2
+      obi_write(32'h20, 32'h100, 4'hF);    // DMA_DST
+      obi_write(32'h24, pixels, 4'hF);     // PIXEL_COUNT
+      obi_write(32'h28, 32'h0, 4'hF);
+      t0 = $time;
+      obi_write(32'h08, 32'h9, 4'hF);      // START | DMA_START
+      data_rd = '0;
+      while (!data_rd[10]) begin
+        repeat (64) @(posedge clk);
+        obi_read(32'h0C, data_rd);
+      end
+      $display("[BENCH] pixels=%0d job_cycles=%0d total_cycles=%0d", pixels, ($time - t0) / 10, $time / 10);
+    end
+  endtask
+
   // ---------------------------------------
   // Test principal
   // ---------------------------------------
@@ -196,12 +500,20 @@ module hsi_accel_obi_tb;
     logic signed [COMPONENT_WIDTH-1:0] rx;
     logic signed [COMPONENT_WIDTH-1:0] ry;
     logic signed [COMPONENT_WIDTH-1:0] rz;
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] dc_res [0:3];
+    int unsigned bench_pixels;
 
 
     // Esperar reset
     wait (rst_ni);
     repeat (2) @(posedge clk);
 
+    if ($value$plusargs("bench=%d", bench_pixels)) begin
+      bench_run(bench_pixels);
+      $finish;
+      disable testbench;
+    end
+
     // Configurar operación CROSS con 3 bandas
     obi_write(32'h00, OP_CROSS, 4'hF);     // OP_CODE
     obi_write(32'h04, 32'd3, 4'hF);        // NUM_BANDS
@@ -227,6 +539,260 @@ module hsi_accel_obi_tb;
     end else
     $display("[PASS] R2.2 (DOT): resultado (%0d,%0d,%0d)", rx, ry, rz);
 
+    // Streaming: 3 píxeles DOT con un único START
+    obi_write(32'h14, 32'h1, 4'hF);        // CONFIG.STREAM
+    push_vectors(1,2,3, 4,5,6);
+    push_vectors(1,1,1, 2,2,2);
+    push_vectors(-1,2,0, 3,1,7);
+    obi_write(32'h08, 32'h1, 4'hF);
+    wait_result(rx, ry, rz);
+    check_result("R4.1 (STREAM px0)", 0, 0, 32, rx, ry, rz);
+    wait_result(rx, ry, rz);
+    check_result("R4.1 (STREAM px1)", 0, 0, 6, rx, ry, rz);
+    wait_result(rx, ry, rz);
+    check_result("R4.1 (STREAM px2)", 0, 0, -1, rx, ry, rz);
+    obi_write(32'h14, 32'h0, 4'hF);
+
+    // Band-serial: (1..7)·(1,1,1,2,2,2,3) = 57 en beats de 3 bandas
+    obi_write(32'h14, 32'h2, 4'hF);        // CONFIG.BAND_SERIAL
+    obi_write(32'h04, 32'd7, 4'hF);
+    push_vectors(1,2,3, 1,1,1);
+    push_vectors(4,5,6, 2,2,2);
+    push_vectors(0,0,7, 0,0,3);
+    obi_write(32'h08, 32'h1, 4'hF);
+    wait_result(rx, ry, rz);
+    if (rx !== 0 || ry !== 0 || rz !== 57) begin
+      $error("[FAIL] R5.1 (BAND_SERIAL): resultado (%0d,%0d,%0d), esperado (0,0,57)", rx, ry, rz);
+      error_count++;
+    end else
+      $display("[PASS] R5.1 (BAND_SERIAL): resultado (%0d,%0d,%0d)", rx, ry, rz);
+    obi_write(32'h14, 32'h0, 4'hF);
+    obi_write(32'h04, 32'd3, 4'hF);
+
+    // DMA: los mismos 3 píxeles que R4.1 desde memoria, resultados en 0x300
+    mem_write_pixel(32'h100,  1, 2, 3);
+    mem_write_pixel(32'h108,  1, 1, 1);
+    mem_write_pixel(32'h110, -1, 2, 0);
+    mem_write_pixel(32'h200,  4, 5, 6);
+    mem_write_pixel(32'h208,  2, 2, 2);
+    mem_write_pixel(32'h210,  3, 1, 7);
+    obi_write(32'h18, 32'h100, 4'hF);      // DMA_SRC1
+    obi_write(32'h1C, 32'h200, 4'hF);      // DMA_SRC2
+    obi_write(32'h20, 32'h300, 4'hF);      // DMA_DST
+    obi_write(32'h24, 32'd3, 4'hF);        // PIXEL_COUNT
+    obi_write(32'h28, 32'h0, 4'hF);        // DMA_STRIDE (empaquetado)
+    obi_write(32'h08, 32'h9, 4'hF);        // START | DMA_START
+    data_rd = '0;
+    for (int t = 0; t < 1000 && !data_rd[10]; t++) obi_read(32'h0C, data_rd);
+    if (!data_rd[10]) begin
+      $error("[FAIL] R6.1 (DMA): DMA_DONE no se activó");
+      error_count++;
+    end else if (mem[8'hC0][15:0] !== 16'd32 || mem[8'hC2][15:0] !== 16'd6 ||
+                 mem[8'hC4][15:0] !== 16'hFFFF || mem[8'hC1] !== 32'h0) begin
+      $error("[FAIL] R6.1 (DMA): resultados en memoria (%0d,%0d,%0d), esperado (32,6,-1)",
+             $signed(mem[8'hC0][15:0]), $signed(mem[8'hC2][15:0]), $signed(mem[8'hC4][15:0]));
+      error_count++;
+    end else
+      $display("[PASS] R6.1 (DMA): resultados en memoria (32,6,-1)");
+    obi_write(32'h08, 32'h2, 4'hF);        // CLEAR_DONE
+
+    // Trabajo de 3 píxeles (PIXEL_COUNT sigue a 3): START antes de cargar datos
+    obi_write(32'h3C, 32'h1, 4'hF);        // PERF_CTRL.CLEAR
+    obi_write(32'h08, 32'h1, 4'hF);
+    push_vectors(1,2,3, 4,5,6);
+    wait_result(rx, ry, rz);
+    if (rz !== 32) begin
+      $error("[FAIL] R7.1 (JOB px0): resultado %0d, esperado 32", rz);
+      error_count++;
+    end
+    obi_read(32'h0C, data_rd);
+    if (data_rd[0] !== 1'b0 || data_rd[8] !== 1'b1) begin
+      $error("[FAIL] R7.1 (JOB): DONE/BUSY = %0b/%0b antes del último píxel", data_rd[0], data_rd[8]);
+      error_count++;
+    end
+    push_vectors(1,1,1, 2,2,2);
+    push_vectors(-1,2,0, 3,1,7);
+    wait_result(rx, ry, rz);
+    if (rz !== 6) begin
+      $error("[FAIL] R7.1 (JOB px1): resultado %0d, esperado 6", rz);
+      error_count++;
+    end
+    wait_result(rx, ry, rz);
+    if (rz !== -1) begin
+      $error("[FAIL] R7.1 (JOB px2): resultado %0d, esperado -1", rz);
+      error_count++;
+    end
+    repeat (2) @(posedge clk);
+    obi_read(32'h0C, data_rd);
+    obi_read(32'h2C, rdata_job);
+    if (data_rd[0] !== 1'b1 || data_rd[8] !== 1'b0 || rdata_job !== 32'd3) begin
+      $error("[FAIL] R7.1 (JOB): DONE/BUSY = %0b/%0b, PROCESSED_COUNT = %0d", data_rd[0], data_rd[8], rdata_job);
+      error_count++;
+    end else
+      $display("[PASS] R7.1 (JOB): 3 píxeles con un único START, PROCESSED_COUNT = %0d", rdata_job);
+    obi_read(32'h44, rdata_job);           // PERF_PIXELS
+    obi_read(32'h48, data_rd);             // PERF_STALL_IN
+    obi_read(32'h40, rdata_perf);          // PERF_BUSY
+    if (rdata_job !== 32'd3 || data_rd == 32'd0 || rdata_perf < data_rd) begin
+      $error("[FAIL] R9.1 (PERF): PIXELS = %0d, STALL_IN = %0d, BUSY = %0d", rdata_job, data_rd, rdata_perf);
+      error_count++;
+    end else
+      $display("[PASS] R9.1 (PERF): %0d ciclos ocupados, %0d esperando datos", rdata_perf, data_rd);
+    obi_write(32'h24, 32'd0, 4'hF);        // PIXEL_COUNT = 0 (un START por píxel)
+    obi_write(32'h08, 32'h2, 4'hF);        // CLEAR_DONE
+
+    // Interrupción de fin de píxel
+    obi_write(32'h34, 32'hF, 4'hF);        // limpiar IRQ_STATUS
+    obi_write(32'h30, 32'h1, 4'hF);        // IRQ_ENABLE.DONE
+    if (irq_o) begin
+      $error("[FAIL] R8.1 (IRQ): irq_o activo antes del START");
+      error_count++;
+    end
+    push_vectors(1,2,3, 4,5,6);
+    obi_write(32'h08, 32'h1, 4'hF);
+    wait (irq_o);
+    wait_result(rx, ry, rz);
+    obi_write(32'h34, 32'h1, 4'hF);
+    if (irq_o || rz !== 32) begin
+      $error("[FAIL] R8.1 (IRQ): irq_o=%0b tras W1C, resultado %0d", irq_o, rz);
+      error_count++;
+    end else
+      $display("[PASS] R8.1 (IRQ): irq_o con DONE y limpieza W1C");
+    obi_write(32'h30, 32'h0, 4'hF);
+
+    // Umbrales almost_full / almost_empty y ocupación visibles por OBI
+    obi_write(32'h38, 32'h0000_0002, 4'hF);
+    push_vectors(1,2,3, 4,5,6);
+    push_vectors(1,1,1, 2,2,2);
+    obi_read(32'h74, rdata_job);           // FIFO_LEVEL_IN
+    obi_read(32'h10, data_rd);             // FIFO_STATUS
+    if (rdata_job !== 32'h0002_0002 || data_rd[8:6] !== 3'b011 || data_rd[11:9] !== 3'b100) begin
+      $error("[FAIL] R10.1 (FIFO): FIFO_LEVEL_IN = %h, almost_full = %b, almost_empty = %b",
+             rdata_job, data_rd[8:6], data_rd[11:9]);
+      error_count++;
+    end else
+      $display("[PASS] R10.1 (FIFO): ocupación 2/2 con almost_full en las FIFOs de entrada");
+    obi_write(32'h08, 32'h1, 4'hF);        // consumir ambos píxeles
+    wait_result(rx, ry, rz);
+    wait_result(rx, ry, rz);
+    obi_write(32'h08, 32'h2, 4'hF);
+    obi_write(32'h38, 32'h0000_0001, 4'hF);
+
+    // Banco de referencias cargado por DMA y píxeles contra él
+    mem_write_pixel(32'h140, 4, 5, 6);     // referencias 0..2
+    mem_write_pixel(32'h148, 1, 1, 1);
+    mem_write_pixel(32'h150, 0, 1, 0);
+    mem_write_pixel(32'h180, 1, 2, 3);     // píxeles
+    mem_write_pixel(32'h188, 1, 1, 1);
+    obi_write(32'h00, OP_REF_LOAD, 4'hF);
+    obi_write(32'h04, 32'd3, 4'hF);
+    obi_write(32'h1C, 32'h140, 4'hF);      // DMA_SRC2
+    obi_write(32'h24, 32'd3, 4'hF);        // PIXEL_COUNT = número de referencias
+    obi_write(32'h08, 32'h9, 4'hF);        // START | DMA_START
+    data_rd = '0;
+    for (int t = 0; t < 1000 && !(data_rd[10] && data_rd[0]); t++) obi_read(32'h0C, data_rd);
+    obi_read(32'h2C, rdata_job);
+    if (!data_rd[10] || !data_rd[0] || data_rd[4:1] !== 4'd0 || rdata_job !== 32'd3) begin
+      $error("[FAIL] R12.1 (REF_LOAD): STATUS %h, PROCESSED_COUNT %0d", data_rd, rdata_job);
+      error_count++;
+    end
+    obi_write(32'h08, 32'h2, 4'hF);        // CLEAR_DONE
+    obi_write(32'h00, OP_DOT, 4'hF);
+    obi_write(32'h14, 32'h4, 4'hF);        // CONFIG.REF_MODE
+    obi_write(32'h18, 32'h180, 4'hF);      // DMA_SRC1
+    obi_write(32'h20, 32'h340, 4'hF);      // DMA_DST
+    obi_write(32'h24, 32'd2, 4'hF);
+    obi_write(32'h08, 32'h9, 4'hF);
+    data_rd = '0;
+    for (int t = 0; t < 1000 && !data_rd[10]; t++) obi_read(32'h0C, data_rd);
+    if (!data_rd[10] || mem[8'hD0] !== {16'd6, 16'd32} || mem[8'hD1] !== {16'h0, 16'd2} ||
+        mem[8'hD2] !== {16'd3, 16'd15} || mem[8'hD3] !== {16'h0, 16'd1}) begin
+      $error("[FAIL] R12.1 (REF_MODE): DMA_DONE %0b, resultados %h %h %h %h, esperado (32,6,2) y (15,3,1)",
+             data_rd[10], mem[8'hD0], mem[8'hD1], mem[8'hD2], mem[8'hD3]);
+      error_count++;
+    end else
+      $display("[PASS] R12.1 (REF): 3 referencias por DMA y 2 píxeles contra el banco");
+    obi_write(32'h08, 32'h2, 4'hF);        // CLEAR_DONE
+    mem_write(32'h388, 32'hDEAD_BEEF);     // no debe escribirse con una palabra por píxel
+    obi_write(32'h14, 32'hC, 4'hF);        // CONFIG.REF_MODE | CONFIG.POST = ARGMAX
+    obi_write(32'h20, 32'h380, 4'hF);      // DMA_DST
+    obi_write(32'h08, 32'h9, 4'hF);
+    data_rd = '0;
+    for (int t = 0; t < 1000 && !data_rd[10]; t++) obi_read(32'h0C, data_rd);
+    if (!data_rd[10] || mem[8'hE0] !== {16'd32, 16'd0} || mem[8'hE1] !== {16'd15, 16'd0} ||
+        mem[8'hE2] !== 32'hDEAD_BEEF) begin
+      $error("[FAIL] R12.2 (ARGMAX): DMA_DONE %0b, resultados %h %h %h, esperado {32,0} y {15,0}",
+             data_rd[10], mem[8'hE0], mem[8'hE1], mem[8'hE2]);
+      error_count++;
+    end else
+      $display("[PASS] R12.2 (ARGMAX): una palabra por píxel con índice y puntuación");
+
+    // Carga del banco seguida de un trabajo sin PIXEL_COUNT: el pixel_done de la carga no cuenta
+    obi_write(32'h08, 32'h2, 4'hF);        // CLEAR_DONE
+    obi_write(32'h00, OP_REF_LOAD, 4'hF);
+    obi_write(32'h14, 32'h0, 4'hF);
+    obi_write(32'h24, 32'd3, 4'hF);        // mismas referencias en DMA_SRC2
+    obi_write(32'h08, 32'h9, 4'hF);
+    data_rd = '0;
+    for (int t = 0; t < 1000 && !(data_rd[10] && data_rd[0]); t++) obi_read(32'h0C, data_rd);
+    obi_write(32'h08, 32'h2, 4'hF);
+    obi_write(32'h00, OP_DOT, 4'hF);
+    obi_write(32'h14, 32'h4, 4'hF);        // CONFIG.REF_MODE
+    obi_write(32'h24, 32'd0, 4'hF);
+    @(posedge clk);
+    in1_data_i = {16'sd1, 16'sd2, 16'sd3};
+    in1_wr_en  = 1;
+    @(posedge clk);
+    in1_wr_en  = 0;
+    obi_write(32'h08, 32'h1, 4'hF);        // START
+    data_rd = '0;
+    for (int t = 0; t < 1000 && !data_rd[0]; t++) obi_read(32'h0C, data_rd);
+    empty_at_done = out_empty_o;
+    wait_result(rx, ry, rz);
+    if (!data_rd[0] || data_rd[4:1] !== 4'd0 || empty_at_done || rx !== 16'sd2 || ry !== 16'sd6 ||
+        rz !== 16'sd32) begin
+      $error("[FAIL] R12.3 (REF_LOAD + DOT): STATUS %h, FIFO vacía en DONE %0b, resultado (%0d,%0d,%0d)",
+             data_rd, empty_at_done, rx, ry, rz);
+      error_count++;
+    end else
+      $display("[PASS] R12.3 (REF_LOAD + DOT): DONE con el resultado del trabajo, no con la carga");
+    obi_write(32'h14, 32'h0, 4'hF);
+    obi_write(32'h24, 32'd0, 4'hF);
+    obi_write(32'h08, 32'h2, 4'hF);
+
+    // Ventana de bandas: el DMA salta el primer beat de cada píxel (relleno que no debe llegar al núcleo)
+    for (int p = 0; p < 2; p++) begin
+      mem_write_pixel(32'h220 + 24*p,  100, 100, 100);
+      mem_write_pixel(32'h228 + 24*p,  4, 5, 6);
+      mem_write_pixel(32'h230 + 24*p,  7, 8, 9);
+      mem_write_pixel(32'h260 + 24*p,  100, 100, 100);
+      mem_write_pixel(32'h268 + 24*p,  16'(p+1), 16'(p+1), 16'(p+1));
+      mem_write_pixel(32'h270 + 24*p,  16'(p+1), 16'(p+1), 16'(p+1));
+    end
+    obi_write(32'h00, OP_DOT, 4'hF);
+    obi_write(32'h04, 32'd9, 4'hF);
+    obi_write(32'h14, 32'h2, 4'hF);        // CONFIG.BAND_SERIAL
+    obi_write(32'h84, 32'h0003_0004, 4'hF); // BAND_WINDOW: bandas 4..6
+    obi_write(32'h18, 32'h220, 4'hF);
+    obi_write(32'h1C, 32'h260, 4'hF);
+    obi_write(32'h20, 32'h3A0, 4'hF);
+    obi_write(32'h24, 32'd2, 4'hF);
+    obi_write(32'h08, 32'h9, 4'hF);
+    data_rd = '0;
+    for (int t = 0; t < 1000 && !data_rd[10]; t++) obi_read(32'h0C, data_rd);
+    if (!data_rd[10] || data_rd[4:1] !== 4'd0 || mem[8'hE8] !== {16'h0, 16'd18} ||
+        mem[8'hEA] !== {16'h0, 16'd36}) begin
+      $error("[FAIL] R14.1 (BAND_WINDOW): STATUS %h, resultados %h %h, esperado 18 y 36",
+             data_rd, mem[8'hE8], mem[8'hEA]);
+      error_count++;
+    end else
+      $display("[PASS] R14.1 (BAND_WINDOW): 2 píxeles con la ventana 4..6 leída por DMA");
+    obi_write(32'h84, 32'h0, 4'hF);
+    obi_write(32'h14, 32'h0, 4'hF);
+    obi_write(32'h24, 32'd0, 4'hF);
+    obi_write(32'h04, 32'd3, 4'hF);
+    obi_write(32'h08, 32'h2, 4'hF);
+
 
     // Error: OP_CROSS pero num_bands != 3
     obi_write(32'h00, OP_CROSS, 4'hF);
@@ -247,6 +813,109 @@ module hsi_accel_obi_tb;
     else
       $display("[PASS] R3.2: ERROR_CODE = %0d", data_rd[4:1]);
 
+    // Doble reloj: CROSS con un START y trabajo streaming de 3 píxeles DOT
+    dc_obi_write(32'h00, OP_CROSS);
+    dc_obi_write(32'h04, 32'd3);
+    dc_push_vectors({16'sd1, 16'sd0, 16'sd0}, {16'sd0, 16'sd1, 16'sd0});
+    dc_obi_write(32'h08, 32'h1);
+    data_rd = '0;
+    for (int t = 0; t < 100 && !data_rd[0]; t++) dc_obi_read(32'h0C, data_rd);
+    dc_wait_result(dc_res[0]);
+    dc_obi_write(32'h08, 32'h2);           // CLEAR_DONE
+    dc_obi_write(32'h00, OP_DOT);
+    dc_obi_write(32'h14, 32'h1);           // CONFIG.STREAM
+    dc_obi_write(32'h24, 32'd3);           // PIXEL_COUNT
+    dc_push_vectors({16'sd1, 16'sd2, 16'sd3}, {16'sd4, 16'sd5, 16'sd6});
+    dc_push_vectors({16'sd1, 16'sd1, 16'sd1}, {16'sd2, 16'sd2, 16'sd2});
+    dc_push_vectors({-16'sd1, 16'sd2, 16'sd0}, {16'sd3, 16'sd1, 16'sd7});
+    dc_obi_write(32'h08, 32'h1);
+    for (int p = 1; p < 4; p++) dc_wait_result(dc_res[p]);
+    repeat (8) @(posedge clk);
+    dc_obi_read(32'h0C, rdata_perf);
+    dc_obi_read(32'h2C, rdata_job);
+    if (dc_res[0] !== {16'sd0, 16'sd0, 16'sd1} || data_rd[0] !== 1'b1 ||
+        dc_res[1][15:0] !== 16'd32 || dc_res[2][15:0] !== 16'd6 || dc_res[3][15:0] !== 16'hFFFF ||
+        rdata_perf[0] !== 1'b1 || rdata_perf[8] !== 1'b0 || rdata_job !== 32'd3) begin
+      $error("[FAIL] R11.1 (DUAL_CLOCK): CROSS %h, DOT %h/%h/%h, STATUS %h/%h, PROCESSED_COUNT %0d",
+             dc_res[0], dc_res[1], dc_res[2], dc_res[3], data_rd, rdata_perf, rdata_job);
+      error_count++;
+    end else
+      $display("[PASS] R11.1 (DUAL_CLOCK): resultados y PROCESSED_COUNT = %0d con el núcleo a otro reloj", rdata_job);
+
+    // Doble reloj: dos trabajos de la cola seguidos; el segundo START sale en cuanto termina el primero
+    dc_obi_write(32'h08, 32'h2);           // CLEAR_DONE
+    dc_obi_write(32'h24, 32'd1);           // PIXEL_COUNT
+    dc_obi_write(32'h08, 32'h10);          // ENQUEUE
+    dc_obi_write(32'h08, 32'h10);          // ENQUEUE
+    dc_push_vectors({16'sd1, 16'sd2, 16'sd3}, {16'sd4, 16'sd5, 16'sd6});
+    dc_wait_result(dc_res[0]);
+    dc_push_vectors({16'sd1, 16'sd1, 16'sd1}, {16'sd2, 16'sd2, 16'sd2});
+    dc_wait_result(dc_res[1]);
+    data_rd = '0;
+    for (int t = 0; t < 100 && data_rd[15:8] != 8'd2; t++) dc_obi_read(32'h7C, data_rd);
+    dc_obi_read(32'h0C, rdata_perf);
+    if (dc_res[0][15:0] !== 16'd32 || dc_res[1][15:0] !== 16'd6 || data_rd[15:0] !== 16'h0200 ||
+        rdata_perf[0] !== 1'b1 || rdata_perf[8] !== 1'b0) begin
+      $error("[FAIL] R11.2 (DUAL_CLOCK): DOT %h/%h, DESC_STATUS %h, STATUS %h",
+             dc_res[0], dc_res[1], data_rd, rdata_perf);
+      error_count++;
+    end else
+      $display("[PASS] R11.2 (DUAL_CLOCK): dos START seguidos de la cola, DESC_STATUS = %h", data_rd[15:0]);
+
+    // Dos núcleos: trabajo de 4 píxeles DOT repartido en turno circular
+    mc_obi_write(32'h00, OP_DOT);
+    mc_obi_write(32'h04, 32'd3);
+    mc_obi_write(32'h24, 32'd4);           // PIXEL_COUNT
+    mc_obi_write(32'h3C, 32'h1);           // PERF_CTRL.CLEAR
+    mc_obi_write(32'h08, 32'h1);
+    mc_push_vectors({16'sd1, 16'sd2, 16'sd3}, {16'sd4, 16'sd5, 16'sd6});
+    mc_push_vectors({16'sd1, 16'sd1, 16'sd1}, {16'sd2, 16'sd2, 16'sd2});
+    mc_push_vectors({-16'sd1, 16'sd2, 16'sd0}, {16'sd3, 16'sd1, 16'sd7});
+    mc_push_vectors({16'sd2, 16'sd0, 16'sd0}, {16'sd5, 16'sd5, 16'sd5});
+    for (int p = 0; p < 4; p++) mc_wait_result(dc_res[p]);
+    repeat (4) @(posedge clk);
+    mc_obi_read(32'h0C, data_rd);
+    mc_obi_read(32'h2C, rdata_job);
+    mc_obi_read(32'h100, rdata_perf);      // PERF_CORE_PIXELS(0)
+    mc_obi_read(32'h108, rdata_core1);  // PERF_CORE_PIXELS(1)
+    if (dc_res[0][15:0] !== 16'd32 || dc_res[1][15:0] !== 16'd6 || dc_res[2][15:0] !== 16'hFFFF ||
+        dc_res[3][15:0] !== 16'd10 || data_rd[0] !== 1'b1 || data_rd[8] !== 1'b0 || rdata_job !== 32'd4 ||
+        rdata_perf !== 32'd2 || rdata_core1 !== 32'd2) begin
+      $error("[FAIL] R13.1 (NUM_CORES): DOT %h/%h/%h/%h, STATUS %h, PROCESSED_COUNT %0d, CORE_PIXELS %0d/%0d",
+             dc_res[0], dc_res[1], dc_res[2], dc_res[3], data_rd, rdata_job, rdata_perf, rdata_core1);
+      error_count++;
+    end else
+      $display("[PASS] R13.1 (NUM_CORES): 4 píxeles en orden, %0d/%0d por núcleo", rdata_perf, rdata_core1);
+
+    // PERF_BUSY agrega los núcleos: no es menor que el PERF_CORE_BUSY de ninguno
+    mc_obi_read(32'h40, rdata_job);        // PERF_BUSY
+    mc_obi_read(32'h104, rdata_perf);      // PERF_CORE_BUSY(0)
+    mc_obi_read(32'h10C, rdata_core1);     // PERF_CORE_BUSY(1)
+    if (rdata_perf == 0 || rdata_core1 == 0 || rdata_job < rdata_perf || rdata_job < rdata_core1) begin
+      $error("[FAIL] R13.2 (NUM_CORES): PERF_BUSY %0d, PERF_CORE_BUSY %0d/%0d", rdata_job, rdata_perf, rdata_core1);
+      error_count++;
+    end else
+      $display("[PASS] R13.2 (NUM_CORES): PERF_BUSY = %0d >= PERF_CORE_BUSY %0d/%0d", rdata_job, rdata_perf, rdata_core1);
+
+    // Sin PIXEL_COUNT: DONE no llega con el primer núcleo que termina, sino con los dos
+    mc_obi_write(32'h08, 32'h2);           // CLEAR_DONE
+    mc_obi_write(32'h24, 32'd0);
+    mc_push_vectors({16'sd1, 16'sd2, 16'sd3}, {16'sd4, 16'sd5, 16'sd6});
+    mc_push_vectors({16'sd1, 16'sd1, 16'sd1}, {16'sd2, 16'sd2, 16'sd2});
+    mc_push_vectors({-16'sd1, 16'sd2, 16'sd0}, {16'sd3, 16'sd1, 16'sd7});
+    mc_obi_write(32'h08, 32'h1);
+    data_rd = '0;
+    for (int t = 0; t < 1000 && !data_rd[0]; t++) mc_obi_read(32'h0C, data_rd);
+    mc_obi_read(32'h2C, rdata_job);
+    for (int p = 0; p < 3; p++) mc_wait_result(dc_res[p]);
+    if (data_rd[0] !== 1'b1 || data_rd[4:1] !== 4'd0 || rdata_job !== 32'd3 || dc_res[0][15:0] !== 16'd32 ||
+        dc_res[1][15:0] !== 16'd6 || dc_res[2][15:0] !== 16'hFFFF) begin
+      $error("[FAIL] R13.3 (NUM_CORES): STATUS %h, PROCESSED_COUNT %0d al DONE, DOT %h/%h/%h",
+             data_rd, rdata_job, dc_res[0], dc_res[1], dc_res[2]);
+      error_count++;
+    end else
+      $display("[PASS] R13.3 (NUM_CORES): DONE con los 3 píxeles de ambos núcleos");
+
     if (error_count == 0)
       $display("TEST COMPLETOTODOS LOS REQUISITOS VERIFICADOS CON ÉXITO");
     else
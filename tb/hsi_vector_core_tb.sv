@@ -21,9 +21,65 @@
  * R2.1: (1,0,0)·(0,1,0) = 0
  * R2.2: (1,2,3)·(4,5,6) = 32
  * R2.3: (-1,0,0)·(0,1,0) = 0
+ * R2.4: Con num_bands = 2 solo se acumulan las 2 bandas menos significativas:
+ *       (1,2,3)·(4,5,6) -> 2*5 + 3*6 = 28 (bloque parcial de carriles MAC)
+ * R4: Modo streaming (stream_mode = 1):
+ * R4.1: Varios píxeles DOT encolados se procesan con un único start y salen en orden.
+ * R4.2: Varios píxeles CROSS encolados se procesan con un único start y salen en orden.
+ * R4.3: in1_level / in2_level reflejan los píxeles encolados y out_level vuelve a 0 al vaciar la salida.
+ * R4.4: Con af_level = 3 y ae_level = 1, almost_full se activa en las FIFOs de entrada con 3 píxeles
+ *       encolados y almost_empty en las tres FIFOs al terminar.
+ * R5: Modo band-serial (band_serial = 1), píxel de 7 bandas en 3 beats (3+3+1):
+ *       (1..7)·(1,1,1,2,2,2,3) = 57
+ * R5.1: Con la FSM por píxel.
+ * R5.2: Con el modo streaming (un beat por ciclo).
+ * R6: Productor externo (more_input = 1):
+ * R6.1: Un start con las FIFOs vacías no genera error y el núcleo espera los datos; dos píxeles
+ *       DOT separados por huecos producen dos resultados y dos pulsos de pixel_valid. Al bajar
+ *       more_input el núcleo vuelve a IDLE (R3 arranca desde IDLE).
+ * R6.2: Los huecos sin datos activan stall_in (al menos 5 ciclos), sin stall_out, y fsm_state
+ *       vuelve a IDLE al terminar.
+ * R7: FIFOs de entrada first-word-fall-through (FWFT = 1):
+ * R7.1: En todas las pruebas anteriores la FSM captura cada beat en CAPTURE y no pasa por READ.
+ * R8: OP_SAM devuelve {|a|², |b|², a·b} en una sola pasada:
+ * R8.1: Con la FSM por píxel: (1,2,3),(4,5,6) -> (14,77,32).
+ * R8.2: En streaming, 2 píxeles con un único start: (14,77,32) y (3,12,6).
+ * R8.3: En band-serial, píxel de 7 bandas: (140,24,57).
+ * R9: Banco de referencias persistente (OP_REF_LOAD + ref_mode):
+ * R9.1: OP_REF_LOAD carga 3 referencias desde la FIFO 2: 3 pulsos de pixel_valid, pixel_done
+ *       activo al terminar, FIFO 2 vacía y ningún resultado en la FIFO de salida.
+ * R9.2: Con ref_mode = 1, 2 píxeles de la FIFO 1 con un único start producen 3 productos escalares
+ *       cada uno (referencia k en la componente k): (1,2,3) -> (32,6,2), (1,1,1) -> (15,3,1).
+ * R9.3: El banco se conserva entre trabajos y stream_mode se ignora: (2,0,-1) -> (2,1,0).
+ * R9.4: En band-serial, 3 referencias de 7 bandas cargadas mientras llegan (more_input) y el
+ *       píxel (1..7) -> (57,28,1).
+ * R10: Postprocesado de OP_DOT (post_mode), con el banco (4,5,6), (1,1,1), (0,1,0):
+ * R10.1: ARGMAX con ref_mode: índice en la componente 0 y puntuación en la 1; (1,2,3) -> (0,32),
+ *        (-1,-1,-1) -> (2,-1) y, con empate, (1,0,-1) -> (1,0).
+ * R10.2: THRESHOLD = 3 con ref_mode: máscara en la componente 0; (1,2,3) -> 3, (0,1,0) -> 1,
+ *        (-1,-1,-1) -> 0.
+ * R10.3: THRESHOLD = 10 sin referencias en streaming: (1,2,3)·(4,5,6) -> 1, (1,0,0)·(0,1,0) -> 0.
+ * R11: Muestras empaquetadas (prec) en OP_DOT:
+ * R11.1: prec = 1, 6 bandas de 8 bits en un beat: (1..6)·(1,1,1,1,1,-1) = 9.
+ * R11.2: prec = 2, 12 bandas de 4 bits en un beat: (1..7,-1..-5)·(1,..,1) = 13.
+ * R11.3: prec = 1 en streaming y band-serial, 2 píxeles de 8 bandas en 2 beats (6+2) cada uno:
+ *        (1..8)·(2,..,2) = 72 y (1..8)·(1,..,1) = 36.
+ * R12: Acumulación ancha y escalado de salida (out_scale) en OP_DOT, (200,200,200)·(200,200,200) = 120000:
+ * R12.1: out_scale = 0 conserva los 16 bits bajos (-11072), como la aritmética modular anterior.
+ * R12.2: SAT sin desplazamiento satura a 32767.
+ * R12.3: SHIFT = 4 trunca (200,200,201)·(200,200,200) = 120200 a 7512 y con ROUND redondea a 7513.
+ * R12.4: SAT en streaming satura -120000 a -32768.
+ * R13: Ventana de bandas (band_first, band_count) en OP_DOT:
+ * R13.1: Sin band-serial, ventana {1, 1} sobre (1,2,3)·(4,5,6): solo la banda 1 -> 10.
+ * R13.2: Band-serial, 9 bandas y ventana {4, 3}: solo se entregan los beats de las bandas 3..8 y
+ *        (4,5,6,7,8,9)·(1,..,1) sobre las bandas 4..6 da 18.
+ * R13.3: Lo mismo en streaming con 2 píxeles: 18 y 36.
  * R3: El core debe gestionar correctamente los errores:
  * R3.1: Si se recibe un código de operación OP_CROSS pero num_bands != 3, debe generar ERR_OP.
  * R3.2: Si num_bands > COMPONENTS_MAX, debe generar ERR_BANDS.
+ * R3.3: ref_mode con una operación distinta de OP_DOT debe generar ERR_OP.
+ * R3.4: Tras un reset, post_mode con una operación distinta de OP_DOT debe generar ERR_OP.
+ * R3.5: Tras un reset, prec != 0 con OP_CROSS debe generar ERR_OP.
  * -------------------------------------------------------------------------
  */
 `timescale 1ns/1ps
@@ -35,9 +91,13 @@ module hsi_vector_core_tb;
   parameter int COMPONENT_WIDTH = 16;
   parameter int COMPONENTS_MAX  = 3;      
   parameter int FIFO_DEPTH      = 8;
+  parameter int DOT_LANES       = 2;      // 3 bandas -> 2 bloques y árbol de 1 etapa
+  parameter int REF_BEATS       = 3;      // referencias de hasta 9 bandas (R9.4)
 
   localparam logic [3:0] OP_CROSS = 4'd1;
   localparam logic [3:0] OP_DOT   = 4'd2;
+  localparam logic [3:0] OP_SAM   = 4'd3;
+  localparam logic [3:0] OP_REF_LOAD = 4'd4;
 
   // Códigos de error RTL:
   localparam ERR_NONE   = 4'd0;
@@ -64,20 +124,51 @@ module hsi_vector_core_tb;
   logic                       out_empty,   out_full;
   /* verilator lint_on UNUSEDSIGNAL */
   logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] out_data_out;
+  logic [$clog2(FIFO_DEPTH):0] in1_level, in2_level, out_level;
+  logic [$clog2(FIFO_DEPTH):0] af_level = 3;
+  logic [$clog2(FIFO_DEPTH):0] ae_level = 1;
+  logic [2:0]                  almost_full, almost_empty;
 
   // Control
   logic [3:0]  op_code;
   logic [31:0] num_bands;                
+  logic        stream_mode = 1'b0;
+  logic        band_serial = 1'b0;
+  logic        ref_mode    = 1'b0;
+  logic [1:0]  post_mode   = 2'd0;
+  logic signed [COMPONENT_WIDTH-1:0] threshold = '0;
+  logic [1:0]  prec        = 2'd0;
+  logic [7:0]  out_scale   = 8'd0;
+  logic [15:0] band_first  = 16'd0;
+  logic [15:0] band_count  = 16'd0;
+  logic        more_input  = 1'b0;
   logic        start      = 1'b0;
 
   // Estado / error
   logic        pixel_done;
+  logic        pixel_valid;
   logic [3:0]  error_code;
+  int          valid_count = 0;
+  logic [3:0]  fsm_state;
+  logic        stall_in, stall_out;
+  int          stall_in_count  = 0;
+  int          stall_out_count = 0;
+  logic        read_seen = 1'b0;
 
   // Flags para verificación
   logic passed2, passed3, passed4, passed5;     // R1 (cross)
-  logic passed6, passed7, passed8;              // R2 (dot)
-  logic passed_err1, passed_err2;               // R3 (errores)
+  logic passed6, passed7, passed8, passed9;     // R2 (dot)
+  logic passed_err1, passed_err2, passed_err3;  // R3 (errores)
+  logic passed_err4, passed_err5;
+  logic passed_s1, passed_s2;                   // R4 (streaming)
+  logic passed_b1, passed_b2;                   // R5 (band-serial)
+  logic passed_h1;                              // R6 (more_input)
+  logic passed_sam;                             // R8 (OP_SAM)
+  logic passed_ref;                             // R9 (banco de referencias)
+  logic passed_post;                            // R10 (postprocesado)
+  logic passed_simd;                            // R11 (muestras empaquetadas)
+  logic passed_scale;                           // R12 (escalado de salida)
+  logic passed_win;                             // R13 (ventana de bandas)
 
   //---------------------------------------------------------------------------
   // Instancia del DUT
@@ -85,10 +176,15 @@ module hsi_vector_core_tb;
   hsi_vector_core #(
       .COMPONENT_WIDTH(COMPONENT_WIDTH),
       .FIFO_DEPTH     (FIFO_DEPTH),
-      .COMPONENTS_MAX (COMPONENTS_MAX)
+      .COMPONENTS_MAX (COMPONENTS_MAX),
+      .DOT_LANES      (DOT_LANES),
+      .FWFT           (1'b1),
+      .REF_BEATS      (REF_BEATS)
   ) dut (
       .clk(clk),
       .rst_n(rst_n),
+      .bus_clk(clk),
+      .bus_rst_n(rst_n),
       .in1_wr_en(in1_wr_en),
       .in1_data_in(in1_data_in),
       .in1_full(in1_full),
@@ -99,10 +195,31 @@ module hsi_vector_core_tb;
       .out_empty(out_empty),
       .out_data_out(out_data_out),
       .out_full(out_full),
+      .in1_level(in1_level),
+      .in2_level(in2_level),
+      .out_level(out_level),
+      .af_level(af_level),
+      .ae_level(ae_level),
+      .almost_full(almost_full),
+      .almost_empty(almost_empty),
       .op_code(op_code),
       .num_bands(num_bands),
+      .band_first(band_first),
+      .band_count(band_count),
+      .stream_mode(stream_mode),
+      .band_serial(band_serial),
+      .ref_mode(ref_mode),
+      .post_mode(post_mode),
+      .threshold(threshold),
+      .prec(prec),
+      .out_scale(out_scale),
+      .more_input(more_input),
       .start(start),
       .pixel_done(pixel_done),
+      .pixel_valid(pixel_valid),
+      .fsm_state(fsm_state),
+      .stall_in(stall_in),
+      .stall_out(stall_out),
       .error_code(error_code)
   );
 
@@ -111,6 +228,16 @@ module hsi_vector_core_tb;
   //---------------------------------------------------------------------------
   always #5 clk = ~clk;
 
+  // Contador de resultados escritos en la FIFO de salida
+  always_ff @(posedge clk) if (pixel_valid) valid_count <= valid_count + 1;
+
+  // Ciclos de bloqueo señalados para los contadores de rendimiento
+  always_ff @(posedge clk) begin
+    if (fsm_state == 4'd2) read_seen <= 1'b1;   // READ
+    if (stall_in)  stall_in_count  <= stall_in_count + 1;
+    if (stall_out) stall_out_count <= stall_out_count + 1;
+  end
+
   //---------------------------------------------------------------------------
   // Funciones auxiliares
   //---------------------------------------------------------------------------
@@ -140,12 +267,38 @@ module hsi_vector_core_tb;
       end
   endtask
 
+  // Escritura de una sola FIFO de entrada (referencias en la 2, píxeles con ref_mode en la 1)
+  task push_one(
+      input logic                        fifo2,
+      input signed [COMPONENT_WIDTH-1:0] a, b, c
+  );
+      begin
+          @(posedge clk);
+              if (fifo2) begin in2_data_in = {a, b, c}; in2_wr_en = 1; end
+              else       begin in1_data_in = {a, b, c}; in1_wr_en = 1; end
+          @(posedge clk);
+              in1_wr_en   = 0;
+              in2_wr_en   = 0;
+      end
+  endtask
+
+  task automatic pop_result(output logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] word);
+      begin
+          wait (!out_empty);
+          @(posedge clk) out_rd_en = 1;
+          @(posedge clk) begin
+              out_rd_en = 0;
+              word = out_data_out;
+          end
+      end
+  endtask
+
   //---------------------------------------------------------------------------
   // Cobertura funcional 
   //---------------------------------------------------------------------------
 `ifndef VERILATOR
   covergroup cg_vector @(posedge clk);
-      coverpoint op_code      { bins cross = {OP_CROSS}; bins dot = {OP_DOT}; }
+      coverpoint op_code      { bins cross = {OP_CROSS}; bins dot = {OP_DOT}; bins sam = {OP_SAM}; bins ref_load = {OP_REF_LOAD}; }
       coverpoint error_code   { bins ok[]  = {[0:4]}; } 
       coverpoint pixel_done   { bins pulse = {1}; }
   endgroup
@@ -161,8 +314,17 @@ module hsi_vector_core_tb;
       in1_wr_en = 0; in2_wr_en = 0; out_rd_en = 0;
       start      = 0;
       passed2=0; passed3=0; passed4=0; passed5=0;
-      passed6=0; passed7=0; passed8=0;
-      passed_err1=0; passed_err2=0;
+      passed6=0; passed7=0; passed8=0; passed9=0;
+      passed_err1=0; passed_err2=0; passed_err3=0; passed_err4=0; passed_err5=0;
+      passed_s1=0; passed_s2=0;
+      passed_b1=0; passed_b2=0;
+      passed_h1=0;
+      passed_sam=0;
+      passed_ref=0;
+      passed_post=0;
+      passed_simd=0;
+      passed_scale=0;
+      passed_win=0;
 
       // Reset síncrono activo a bajo
       rst_n = 0; num_bands = 3; op_code = OP_CROSS;
@@ -204,11 +366,106 @@ module hsi_vector_core_tb;
       // R2.3  (-1,0,0)·(0,1,0) = 0
       dot_test(-1,0,0, 0,1,0, 0, passed8, "R2.3");
 
-      if (passed6 & passed7 & passed8)
+      // R2.4  num_bands = 2 -> (2,3)·(5,6) = 28
+      num_bands = 2;
+      dot_test(1,2,3, 4,5,6, 28, passed9, "R2.4");
+      num_bands = 3;
+
+      if (passed6 & passed7 & passed8 & passed9)
           $display("R2 PASSED.");
       else
           $fatal("R2 FAILED.");
 
+      // --------------------------------------------------------------------
+      // R4 – Modo streaming
+      // --------------------------------------------------------------------
+      stream_test(passed_s1, passed_s2);
+      if (passed_s1 & passed_s2)
+          $display("R4 PASSED.");
+      else
+          $fatal("R4 FAILED.");
+
+      // --------------------------------------------------------------------
+      // R5 – Modo band-serial
+      // --------------------------------------------------------------------
+      serial_test(1'b0, passed_b1, "R5.1");
+      serial_test(1'b1, passed_b2, "R5.2");
+      if (passed_b1 & passed_b2)
+          $display("R5 PASSED.");
+      else
+          $fatal("R5 FAILED.");
+
+      // --------------------------------------------------------------------
+      // R6 – Productor externo (more_input)
+      // --------------------------------------------------------------------
+      hold_test(passed_h1);
+      if (passed_h1)
+          $display("R6 PASSED.");
+      else
+          $fatal("R6 FAILED.");
+
+      // --------------------------------------------------------------------
+      // R7 – FIFOs de entrada FWFT
+      // --------------------------------------------------------------------
+      if (!read_seen)
+          $display("R7 PASSED: ningún beat pasa por READ.");
+      else
+          $fatal("R7 FAILED: la FSM ha pasado por READ con FWFT = 1.");
+
+      // --------------------------------------------------------------------
+      // R8 – OP_SAM
+      // --------------------------------------------------------------------
+      sam_test(passed_sam);
+      if (passed_sam)
+          $display("R8 PASSED.");
+      else
+          $fatal("R8 FAILED.");
+
+      // --------------------------------------------------------------------
+      // R9 – Banco de referencias
+      // --------------------------------------------------------------------
+      ref_test(passed_ref);
+      if (passed_ref)
+          $display("R9 PASSED.");
+      else
+          $fatal("R9 FAILED.");
+
+      // --------------------------------------------------------------------
+      // R10 – Postprocesado
+      // --------------------------------------------------------------------
+      post_test(passed_post);
+      if (passed_post)
+          $display("R10 PASSED.");
+      else
+          $fatal("R10 FAILED.");
+
+      // --------------------------------------------------------------------
+      // R11 – Muestras empaquetadas
+      // --------------------------------------------------------------------
+      simd_test(passed_simd);
+      if (passed_simd)
+          $display("R11 PASSED.");
+      else
+          $fatal("R11 FAILED.");
+
+      // --------------------------------------------------------------------
+      // R12 – Acumulación ancha y escalado de salida
+      // --------------------------------------------------------------------
+      scale_test(passed_scale);
+      if (passed_scale)
+          $display("R12 PASSED.");
+      else
+          $fatal("R12 FAILED.");
+
+      // --------------------------------------------------------------------
+      // R13 – Ventana de bandas
+      // --------------------------------------------------------------------
+      window_test(passed_win);
+      if (passed_win)
+          $display("R13 PASSED.");
+      else
+          $fatal("R13 FAILED.");
+
       // --------------------------------------------------------------------
       // R3 – Gestión de errores
       // --------------------------------------------------------------------
@@ -238,7 +495,58 @@ module hsi_vector_core_tb;
           $display("R3.2 PASSED (ERR_BANDS detectado).");
       end else $fatal("R3.2 FAILED (error_code=%0d)", error_code);
 
-      if (passed_err1 & passed_err2)
+      // R3.3  ref_mode con OP_SAM                -> ERR_OP
+      @(posedge clk);
+      op_code   = OP_SAM;
+      num_bands = 3;
+      ref_mode  = 1;
+      start      = 1; // iniciar operación
+      @(posedge clk);
+      start      = 0; // finalizar operación
+      @(posedge clk);
+      ref_mode  = 0;
+      if (error_code == ERR_OP) begin
+          passed_err3 = 1;
+          $display("R3.3 PASSED (ERR_OP con ref_mode detectado).");
+      end else $fatal("R3.3 FAILED (error_code=%0d)", error_code);
+
+      // R3.4  post_mode con OP_SAM tras un reset   -> ERR_OP
+      rst_n = 0;
+      #20 rst_n = 1;
+      @(posedge clk);
+      if (error_code != ERR_NONE) $fatal("R3.4 FAILED (error_code=%0d tras el reset)", error_code);
+      op_code   = OP_SAM;
+      num_bands = 3;
+      post_mode = 2'd1;
+      start      = 1; // iniciar operación
+      @(posedge clk);
+      start      = 0; // finalizar operación
+      @(posedge clk);
+      post_mode = 2'd0;
+      if (error_code == ERR_OP) begin
+          passed_err4 = 1;
+          $display("R3.4 PASSED (ERR_OP con post_mode detectado).");
+      end else $fatal("R3.4 FAILED (error_code=%0d)", error_code);
+
+      // R3.5  prec != 0 con OP_CROSS tras un reset   -> ERR_OP
+      rst_n = 0;
+      #20 rst_n = 1;
+      @(posedge clk);
+      if (error_code != ERR_NONE) $fatal("R3.5 FAILED (error_code=%0d tras el reset)", error_code);
+      op_code   = OP_CROSS;
+      num_bands = 3;
+      prec      = 2'd1;
+      start      = 1; // iniciar operación
+      @(posedge clk);
+      start      = 0; // finalizar operación
+      @(posedge clk);
+      prec      = 2'd0;
+      if (error_code == ERR_OP) begin
+          passed_err5 = 1;
+          $display("R3.5 PASSED (ERR_OP con prec detectado).");
+      end else $fatal("R3.5 FAILED (error_code=%0d)", error_code);
+
+      if (passed_err1 & passed_err2 & passed_err3 & passed_err4 & passed_err5)
           $display("R3 PASSED.");
       else
           $fatal("R3 FAILED.");
@@ -289,6 +597,546 @@ module hsi_vector_core_tb;
   endtask
 
 
+  task automatic stream_test(output logic flag_dot, output logic flag_cross);
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w;
+    logic signed [COMPONENT_WIDTH-1:0] exp_dot [0:2];
+    begin
+      stream_mode = 1;
+
+      // R4.1  3 píxeles DOT con un único start
+      op_code   = OP_DOT;
+      num_bands = 3;
+      exp_dot[0] = 32; exp_dot[1] = 6; exp_dot[2] = -1;
+      flag_dot = 1;
+      push_vectors(1,2,3, 4,5,6);
+      push_vectors(1,1,1, 2,2,2);
+      push_vectors(-1,2,0, 3,1,7);
+      @(negedge clk);
+      if (in1_level != 3 || in2_level != 3) begin
+        flag_dot = 0;
+        $error("R4.3 FAILED: in1_level=%0d in2_level=%0d exp=3", in1_level, in2_level);
+      end
+      if (almost_full !== 3'b011 || almost_empty !== 3'b100) begin
+        flag_dot = 0;
+        $error("R4.4 FAILED: almost_full=%b almost_empty=%b con 3 píxeles encolados", almost_full, almost_empty);
+      end
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      for (int p = 0; p < 3; p++) begin
+        pop_result(w);
+        if (get_comp(w, 2) !== exp_dot[p] || error_code != ERR_NONE) begin
+          flag_dot = 0;
+          $error("R4.1 FAILED: pixel %0d result=%0d exp=%0d err=%0d", p, get_comp(w, 2), exp_dot[p], error_code);
+        end
+      end
+      @(negedge clk);
+      if (out_level != 0) begin
+        flag_dot = 0;
+        $error("R4.3 FAILED: out_level=%0d tras vaciar la salida", out_level);
+      end
+      if (almost_full !== 3'b000 || almost_empty !== 3'b111) begin
+        flag_dot = 0;
+        $error("R4.4 FAILED: almost_full=%b almost_empty=%b tras vaciar las FIFOs", almost_full, almost_empty);
+      end
+      if (flag_dot) $display("R4.1/R4.3/R4.4 PASSED: 3 píxeles DOT en streaming, niveles de FIFO correctos");
+
+      // R4.2  2 píxeles CROSS con un único start
+      op_code = OP_CROSS;
+      push_vectors(1,2,3, 4,5,6);
+      push_vectors(-1,0,0, 0,1,0);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      flag_cross = 1;
+      pop_result(w);
+      if (get_comp(w,0) !== -3 || get_comp(w,1) !== 6 || get_comp(w,2) !== -3) begin
+        flag_cross = 0;
+        $error("R4.2 FAILED: pixel 0 got (%0d,%0d,%0d)", get_comp(w,0), get_comp(w,1), get_comp(w,2));
+      end
+      pop_result(w);
+      if (get_comp(w,0) !== 0 || get_comp(w,1) !== 0 || get_comp(w,2) !== -1) begin
+        flag_cross = 0;
+        $error("R4.2 FAILED: pixel 1 got (%0d,%0d,%0d)", get_comp(w,0), get_comp(w,1), get_comp(w,2));
+      end
+      if (flag_cross) $display("R4.2 PASSED: 2 píxeles CROSS en streaming");
+
+      stream_mode = 0;
+    end
+  endtask
+
+  task automatic serial_test(
+    input  logic  use_stream,
+    output logic  flag,
+    input  string tag
+  );
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w;
+    begin
+      stream_mode = use_stream;
+      band_serial = 1;
+      op_code     = OP_DOT;
+      num_bands   = 7;
+      // Beats: bandas 0-2, 3-5 y la banda 6 alineada a la componente menos significativa
+      push_vectors(1,2,3, 1,1,1);
+      push_vectors(4,5,6, 2,2,2);
+      push_vectors(0,0,7, 0,0,3);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      if (get_comp(w, 2) === 57 && error_code == ERR_NONE) begin
+        flag = 1;
+        $display("%s PASSED: result=%0d", tag, get_comp(w, 2));
+      end else begin
+        flag = 0;
+        $error("%s FAILED: result=%0d exp=57 err=%0d", tag, get_comp(w, 2), error_code);
+      end
+      band_serial = 0;
+      stream_mode = 0;
+      num_bands   = 3;
+    end
+  endtask
+
+  task automatic hold_test(output logic flag);
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w0, w1;
+    int n0, si0, so0;
+    begin
+      op_code    = OP_DOT;
+      num_bands  = 3;
+      more_input = 1;
+      n0  = valid_count;
+      si0 = stall_in_count;
+      so0 = stall_out_count;
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      repeat (5) @(posedge clk);        // FIFOs vacías: se espera sin error
+      push_vectors(1,2,3, 4,5,6);
+      pop_result(w0);
+      repeat (5) @(posedge clk);
+      push_vectors(1,1,1, 2,2,2);
+      pop_result(w1);
+      more_input = 0;
+      repeat (3) @(posedge clk);
+      if (get_comp(w0, 2) === 32 && get_comp(w1, 2) === 6 && error_code == ERR_NONE &&
+          valid_count - n0 == 2) begin
+        flag = 1;
+        $display("R6.1 PASSED: 2 píxeles con more_input, %0d pulsos de pixel_valid", valid_count - n0);
+      end else begin
+        flag = 0;
+        $error("R6.1 FAILED: results=(%0d,%0d) exp=(32,6) pulsos=%0d err=%0d",
+               get_comp(w0, 2), get_comp(w1, 2), valid_count - n0, error_code);
+      end
+      if (stall_in_count - si0 >= 5 && stall_out_count == so0 && fsm_state == 4'd0) begin
+        $display("R6.2 PASSED: %0d ciclos de stall_in", stall_in_count - si0);
+      end else begin
+        flag = 0;
+        $error("R6.2 FAILED: stall_in=%0d stall_out=%0d fsm_state=%0d",
+               stall_in_count - si0, stall_out_count - so0, fsm_state);
+      end
+    end
+  endtask
+
+  task automatic sam_check(
+    input  logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w,
+    input  logic signed [COMPONENT_WIDTH-1:0]         exp_aa, exp_bb, exp_ab,
+    inout  logic                                      flag,
+    input  string                                     tag
+  );
+    begin
+      if (get_comp(w,0) === exp_aa && get_comp(w,1) === exp_bb && get_comp(w,2) === exp_ab &&
+          error_code == ERR_NONE) begin
+        $display("%s PASSED: (%0d,%0d,%0d)", tag, get_comp(w,0), get_comp(w,1), get_comp(w,2));
+      end else begin
+        flag = 0;
+        $error("%s FAILED: got (%0d,%0d,%0d) exp (%0d,%0d,%0d) err=%0d", tag,
+               get_comp(w,0), get_comp(w,1), get_comp(w,2), exp_aa, exp_bb, exp_ab, error_code);
+      end
+    end
+  endtask
+
+  task automatic sam_test(output logic flag);
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w;
+    begin
+      flag      = 1;
+      op_code   = OP_SAM;
+      num_bands = 3;
+
+      // R8.1  FSM por píxel
+      push_vectors(1,2,3, 4,5,6);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      sam_check(w, 14, 77, 32, flag, "R8.1");
+
+      // R8.2  Streaming
+      stream_mode = 1;
+      push_vectors(1,2,3, 4,5,6);
+      push_vectors(1,1,1, 2,2,2);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      sam_check(w, 14, 77, 32, flag, "R8.2 (px0)");
+      pop_result(w);
+      sam_check(w, 3, 12, 6, flag, "R8.2 (px1)");
+      stream_mode = 0;
+
+      // R8.3  Band-serial: 7 bandas en 3 beats
+      band_serial = 1;
+      num_bands   = 7;
+      push_vectors(1,2,3, 1,1,1);
+      push_vectors(4,5,6, 2,2,2);
+      push_vectors(0,0,7, 0,0,3);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      sam_check(w, 140, 24, 57, flag, "R8.3");
+      band_serial = 0;
+      num_bands   = 3;
+    end
+  endtask
+
+  task automatic ref_check(
+    input  logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w,
+    input  logic signed [COMPONENT_WIDTH-1:0]         exp_r0, exp_r1, exp_r2,
+    inout  logic                                      flag,
+    input  string                                     tag
+  );
+    begin
+      // Referencia k en la componente k (la 0 es la menos significativa)
+      if (get_comp(w,2) === exp_r0 && get_comp(w,1) === exp_r1 && get_comp(w,0) === exp_r2 &&
+          error_code == ERR_NONE) begin
+        $display("%s PASSED: (%0d,%0d,%0d)", tag, get_comp(w,2), get_comp(w,1), get_comp(w,0));
+      end else begin
+        flag = 0;
+        $error("%s FAILED: got (%0d,%0d,%0d) exp (%0d,%0d,%0d) err=%0d", tag,
+               get_comp(w,2), get_comp(w,1), get_comp(w,0), exp_r0, exp_r1, exp_r2, error_code);
+      end
+    end
+  endtask
+
+  task automatic ref_test(output logic flag);
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w;
+    int n0;
+    begin
+      flag      = 1;
+      num_bands = 3;
+
+      // R9.1  Carga de (4,5,6), (1,1,1) y (0,1,0)
+      op_code = OP_REF_LOAD;
+      push_one(1, 4,5,6);
+      push_one(1, 1,1,1);
+      push_one(1, 0,1,0);
+      n0 = valid_count;
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      wait (pixel_done);
+      @(posedge clk);
+      if (valid_count - n0 == 3 && in2_level == 0 && out_empty && fsm_state == 4'd0 &&
+          error_code == ERR_NONE) begin
+        $display("R9.1 PASSED: 3 referencias cargadas");
+      end else begin
+        flag = 0;
+        $error("R9.1 FAILED: pulsos=%0d in2_level=%0d out_empty=%0b fsm_state=%0d err=%0d",
+               valid_count - n0, in2_level, out_empty, fsm_state, error_code);
+      end
+
+      // R9.2  2 píxeles contra el banco con un único start
+      op_code  = OP_DOT;
+      ref_mode = 1;
+      push_one(0, 1,2,3);
+      push_one(0, 1,1,1);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      ref_check(w, 32, 6, 2, flag, "R9.2 (px0)");
+      pop_result(w);
+      ref_check(w, 15, 3, 1, flag, "R9.2 (px1)");
+
+      // R9.3  Nuevo trabajo sin recargar el banco (stream_mode ignorado)
+      stream_mode = 1;
+      push_one(0, 2,0,-1);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      ref_check(w, 2, 1, 0, flag, "R9.3");
+      stream_mode = 0;
+
+      // R9.4  Band-serial: 9 beats de referencia (más que FIFO_DEPTH) y un píxel de 7 bandas
+      ref_mode    = 0;
+      band_serial = 1;
+      num_bands   = 7;
+      op_code     = OP_REF_LOAD;
+      more_input  = 1;
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      push_one(1, 1,1,1); push_one(1, 2,2,2); push_one(1, 0,0,3);   // r0 = (1,1,1,2,2,2,3)
+      push_one(1, 1,1,1); push_one(1, 1,1,1); push_one(1, 0,0,1);   // r1 = unos
+      push_one(1, 1,0,0); push_one(1, 0,0,0); push_one(1, 0,0,0);   // r2 = banda 0
+      wait (pixel_done);
+      more_input  = 0;
+      op_code     = OP_DOT;
+      ref_mode    = 1;
+      push_one(0, 1,2,3);
+      push_one(0, 4,5,6);
+      push_one(0, 0,0,7);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      ref_check(w, 57, 28, 1, flag, "R9.4");
+      ref_mode    = 0;
+      band_serial = 0;
+      num_bands   = 3;
+    end
+  endtask
+
+  task automatic post_check(
+    input  logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w,
+    input  logic signed [COMPONENT_WIDTH-1:0]         exp_c0, exp_c1,
+    inout  logic                                      flag,
+    input  string                                     tag
+  );
+    begin
+      // Componentes 0 y 1 (las menos significativas); la 2 debe valer 0
+      if (get_comp(w,2) === exp_c0 && get_comp(w,1) === exp_c1 && get_comp(w,0) === '0 &&
+          error_code == ERR_NONE) begin
+        $display("%s PASSED: (%0d,%0d)", tag, get_comp(w,2), get_comp(w,1));
+      end else begin
+        flag = 0;
+        $error("%s FAILED: got (%0d,%0d,%0d) exp (%0d,%0d,0) err=%0d", tag,
+               get_comp(w,2), get_comp(w,1), get_comp(w,0), exp_c0, exp_c1, error_code);
+      end
+    end
+  endtask
+
+  task automatic post_test(output logic flag);
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w;
+    begin
+      flag      = 1;
+      num_bands = 3;
+
+      // Banco de 3 bandas: (4,5,6), (1,1,1) y (0,1,0)
+      op_code = OP_REF_LOAD;
+      push_one(1, 4,5,6);
+      push_one(1, 1,1,1);
+      push_one(1, 0,1,0);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      wait (pixel_done);
+      @(posedge clk);
+
+      // R10.1  ARGMAX: puntuaciones (32,6,2), (-15,-3,-1) y (-2,0,0)
+      op_code   = OP_DOT;
+      ref_mode  = 1;
+      post_mode = 2'd1;
+      push_one(0, 1,2,3);
+      push_one(0, -1,-1,-1);
+      push_one(0, 1,0,-1);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      post_check(w, 0, 32, flag, "R10.1 (px0)");
+      pop_result(w);
+      post_check(w, 2, -1, flag, "R10.1 (px1)");
+      pop_result(w);
+      post_check(w, 1, 0, flag, "R10.1 (empate)");
+
+      // R10.2  THRESHOLD = 3: puntuaciones (32,6,2), (5,1,1) y (-15,-3,-1)
+      post_mode = 2'd2;
+      threshold = 3;
+      push_one(0, 1,2,3);
+      push_one(0, 0,1,0);
+      push_one(0, -1,-1,-1);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      post_check(w, 3, 0, flag, "R10.2 (px0)");
+      pop_result(w);
+      post_check(w, 1, 0, flag, "R10.2 (px1)");
+      pop_result(w);
+      post_check(w, 0, 0, flag, "R10.2 (px2)");
+
+      // R10.3  THRESHOLD = 10 sobre OP_DOT en streaming (una puntuación por píxel)
+      ref_mode    = 0;
+      stream_mode = 1;
+      threshold   = 10;
+      push_vectors(1,2,3, 4,5,6);
+      push_vectors(1,0,0, 0,1,0);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      post_check(w, 1, 0, flag, "R10.3 (px0)");
+      pop_result(w);
+      post_check(w, 0, 0, flag, "R10.3 (px1)");
+      wait (fsm_state == 4'd0);
+      stream_mode = 0;
+      post_mode   = 2'd0;
+      threshold   = '0;
+    end
+  endtask
+
+  task automatic simd_check(
+    input  logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w,
+    input  logic signed [COMPONENT_WIDTH-1:0]         exp,
+    inout  logic                                      flag,
+    input  string                                     tag
+  );
+    begin
+      if (get_comp(w,2) === exp && get_comp(w,1) === '0 && get_comp(w,0) === '0 &&
+          error_code == ERR_NONE) begin
+        $display("%s PASSED: result=%0d", tag, get_comp(w,2));
+      end else begin
+        flag = 0;
+        $error("%s FAILED: got (%0d,%0d,%0d) exp %0d err=%0d", tag,
+               get_comp(w,2), get_comp(w,1), get_comp(w,0), exp, error_code);
+      end
+    end
+  endtask
+
+  task automatic simd_test(output logic flag);
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w;
+    begin
+      flag    = 1;
+      op_code = OP_DOT;
+
+      // R11.1  2 muestras de 8 bits por componente (banda 0 en la subpalabra más significativa)
+      prec      = 2'd1;
+      num_bands = 6;
+      push_vectors(16'h0102, 16'h0304, 16'h0506, 16'h0101, 16'h0101, 16'h01FF);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, 9, flag, "R11.1");
+
+      // R11.2  4 muestras de 4 bits por componente
+      prec      = 2'd2;
+      num_bands = 12;
+      push_vectors(16'h1234, 16'h567F, 16'hEDCB, 16'h1111, 16'h1111, 16'h1111);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, 13, flag, "R11.2");
+
+      // R11.3  8 bandas de 8 bits: beat completo de 6 y beat parcial de 2 alineado a la derecha
+      prec        = 2'd1;
+      num_bands   = 8;
+      band_serial = 1;
+      stream_mode = 1;
+      push_vectors(16'h0102, 16'h0304, 16'h0506, 16'h0202, 16'h0202, 16'h0202);
+      push_vectors(16'h0000, 16'h0000, 16'h0708, 16'h0000, 16'h0000, 16'h0202);
+      push_vectors(16'h0102, 16'h0304, 16'h0506, 16'h0101, 16'h0101, 16'h0101);
+      push_vectors(16'h0000, 16'h0000, 16'h0708, 16'h0000, 16'h0000, 16'h0101);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, 72, flag, "R11.3 (px0)");
+      pop_result(w);
+      simd_check(w, 36, flag, "R11.3 (px1)");
+      wait (fsm_state == 4'd0);
+      stream_mode = 0;
+      band_serial = 0;
+      prec        = 2'd0;
+      num_bands   = 3;
+    end
+  endtask
+
+  task automatic scale_test(output logic flag);
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w;
+    begin
+      flag      = 1;
+      op_code   = OP_DOT;
+      num_bands = 3;
+
+      // R12.1  Sin escalado: 16 bits bajos de 120000
+      out_scale = 8'h00;
+      push_vectors(200,200,200, 200,200,200);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, -11072, flag, "R12.1");
+
+      // R12.2  Saturación
+      out_scale = 8'h80;
+      push_vectors(200,200,200, 200,200,200);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, 32767, flag, "R12.2");
+
+      // R12.3  Desplazamiento de 4 bits truncando y redondeando
+      out_scale = 8'h04;
+      push_vectors(200,200,201, 200,200,200);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, 7512, flag, "R12.3 (trunc)");
+      out_scale = 8'h44;
+      push_vectors(200,200,201, 200,200,200);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, 7513, flag, "R12.3 (round)");
+
+      // R12.4  Saturación negativa en streaming
+      out_scale   = 8'h80;
+      stream_mode = 1;
+      push_vectors(-200,-200,-200, 200,200,200);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, -32768, flag, "R12.4");
+      wait (fsm_state == 4'd0);
+      stream_mode = 0;
+      out_scale   = 8'h00;
+    end
+  endtask
+
+  task automatic window_test(output logic flag);
+    logic [COMPONENT_WIDTH*COMPONENTS_MAX-1:0] w;
+    begin
+      flag    = 1;
+      op_code = OP_DOT;
+
+      // R13.1  Ventana dentro de un único beat
+      num_bands  = 3;
+      band_first = 1;
+      band_count = 1;
+      push_vectors(1,2,3, 4,5,6);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, 10, flag, "R13.1");
+
+      // R13.2  Band-serial: el beat 0 (bandas 0..2) no se entrega
+      num_bands   = 9;
+      band_first  = 4;
+      band_count  = 3;
+      band_serial = 1;
+      push_vectors(4,5,6, 1,1,1);
+      push_vectors(7,8,9, 1,1,1);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, 18, flag, "R13.2");
+      wait (fsm_state == 4'd0);
+
+      // R13.3  Streaming
+      stream_mode = 1;
+      push_vectors(4,5,6, 1,1,1);
+      push_vectors(7,8,9, 1,1,1);
+      push_vectors(4,5,6, 2,2,2);
+      push_vectors(7,8,9, 2,2,2);
+      @(posedge clk) start = 1;
+      @(posedge clk) start = 0;
+      pop_result(w);
+      simd_check(w, 18, flag, "R13.3 (px0)");
+      pop_result(w);
+      simd_check(w, 36, flag, "R13.3 (px1)");
+      wait (fsm_state == 4'd0);
+      stream_mode = 0;
+      band_serial = 0;
+      band_first  = 0;
+      band_count  = 0;
+      num_bands   = 3;
+    end
+  endtask
+
   task automatic dot_test(
     input  logic signed [COMPONENT_WIDTH-1:0] x1, y1, z1,
     input  logic signed [COMPONENT_WIDTH-1:0] x2, y2, z2,
@@ -34,6 +34,22 @@
  * | R10       | Señal err_o se activa ante acceso a dirección inválida y no altera estado  |
  * | R11       | Puede reiniciarse una operación una vez limpiado DONE                      |
  * | R12       | start_o no se activa de nuevo indebidamente en estado ocupado              *
+ * | R13       | Escritura y lectura de CONFIG (STREAM, BAND_SERIAL, REF_MODE) y salidas    |
+ * |           | CONFIG.POST y registro THRESHOLD hacia post_mode_o / threshold_o           |
+ * |           | CONFIG.PREC hacia prec_o y CONFIG.OUT_SCALE hacia out_scale_o              |
+ * |           | y registro BAND_WINDOW hacia band_first_o / band_count_o                   |
+ * | R14       | Con EXPOSE_DMA=0 los registros DMA_* son inválidos y DMA_START se ignora   |
+ * | R15       | Trabajo de PIXEL_COUNT píxeles: DONE solo tras el último, PROCESSED_COUNT  |
+ * | R16       | irq_o con IRQ_ENABLE/IRQ_STATUS: DONE, ERROR, OUT_LEVEL, IN_LEVEL y W1C    |
+ * | R17       | Accesos back-to-back: gnt_o en el mismo ciclo que rvalid_o de la anterior  |
+ * | R18       | Contadores PERF_*: ciclos ocupados, píxeles, bloqueos, estados y CLEAR     |
+ * |           | y contadores PERF_CORE_* del único núcleo                                  |
+ * | R19       | IRQ_LEVEL programa los umbrales almost_full/almost_empty de las FIFOs      |
+ * | R20       | Cola de descriptores: dos trabajos encolados se lanzan sin esperar a BUSY   |
+ * |           | y los registros sombra no alteran el trabajo en curso                      |
+ * | R21       | ENQUEUE junto a START/DMA_START solo lanza el descriptor extraído (una vez) |
+ * | R22       | Tras un error de la cola, CLEAR_ERROR lanza el siguiente descriptor aunque |
+ * |           | el núcleo conserve el código antiguo hasta el nuevo START                  |
  *
  * @note Las pruebas usan tareas automatizadas para simular accesos OBI y monitorizan
  * cambios en señales clave como `start_o`, `op_code_o`, `gnt_o`, `rvalid_o`.
@@ -61,11 +77,34 @@ module hsi_vector_core_wrapper_tb;
     // Hacia core (salidas del wrapper)
     logic [3:0]  op_code_o;
     logic [31:0] num_bands_o;
+    logic        stream_mode_o;
+    logic        band_serial_o;
+    logic        ref_mode_o;
+    logic [1:0]  post_mode_o;
+    logic [1:0]  prec_o;
+    logic [7:0]  out_scale_o;
+    logic [15:0] band_first_o, band_count_o;
+    logic [31:0] threshold_o;
     logic        start_o;
+    logic        job_active_o;
+
+    // Hacia DMA (no expuesto en esta configuración)
+    /* verilator lint_off UNUSEDSIGNAL */
+    logic [31:0] dma_src1_addr_o, dma_src2_addr_o, dma_dst_addr_o, pixel_count_o;
+    logic [15:0] dma_src_stride_o, dma_dst_stride_o;
+    /* verilator lint_on UNUSEDSIGNAL */
+    logic        dma_start_o;
 
     // Desde core (entradas al wrapper - simuladas aquí)
     logic        pixel_done_i;
+    logic        pixel_valid_i;
     logic [3:0]  error_code_i;
+    logic [15:0] in1_level_i, in2_level_i, out_level_i;
+    logic [2:0]  almost_full_i, almost_empty_i;
+    logic [15:0] fifo_af_level_o, fifo_ae_level_o;
+    logic        irq_o;
+    logic [3:0]  core_state_i;
+    logic        stall_in_i, stall_out_i;
 
     // Variables auxiliares globales
     integer error_count = 0;
@@ -83,7 +122,8 @@ module hsi_vector_core_wrapper_tb;
         .NUM_BANDS_WIDTH(32),
         .ERR_WIDTH(4),
         .READ_CLEAR_DONE(0),
-        .EXPOSE_FIFO_STATUS(0)
+        .EXPOSE_FIFO_STATUS(0),
+        .EXPOSE_PERF(1)
     ) dut (
         .clk_i(clk),
         .rst_ni(rst_ni),
@@ -98,17 +138,154 @@ module hsi_vector_core_wrapper_tb;
         .err_o(err_o),
         .op_code_o(op_code_o),
         .num_bands_o(num_bands_o),
+        .band_first_o(band_first_o),
+        .band_count_o(band_count_o),
+        .stream_mode_o(stream_mode_o),
+        .band_serial_o(band_serial_o),
+        .ref_mode_o(ref_mode_o),
+        .post_mode_o(post_mode_o),
+        .prec_o(prec_o),
+        .out_scale_o(out_scale_o),
+        .threshold_o(threshold_o),
         .start_o(start_o),
+        .start_ready_i(1'b1),
+        .job_active_o(job_active_o),
+        .dma_src1_addr_o(dma_src1_addr_o),
+        .dma_src2_addr_o(dma_src2_addr_o),
+        .dma_dst_addr_o(dma_dst_addr_o),
+        .pixel_count_o(pixel_count_o),
+        .dma_src_stride_o(dma_src_stride_o),
+        .dma_dst_stride_o(dma_dst_stride_o),
+        .dma_start_o(dma_start_o),
+        .dma_done_i(1'b0),
+        .pixel_done_i(pixel_done_i),
+        .pixel_valid_i(pixel_valid_i),
+        .error_code_i(error_code_i),
+        .in1_full_i(1'b0),
+        .in2_full_i(1'b0),
+        .out_full_i(1'b0),
+        .out_empty_i(1'b0),
+        .in1_empty_i(1'b0),
+        .in2_empty_i(1'b0),
+        .core_state_i(core_state_i),
+        .stall_in_i(stall_in_i),
+        .stall_out_i(stall_out_i),
+        .core_valid_i(pixel_valid_i),
+        .core_busy_i(core_state_i != 4'd0),
+        .in1_level_i(in1_level_i),
+        .in2_level_i(in2_level_i),
+        .out_level_i(out_level_i),
+        .almost_full_i(almost_full_i),
+        .almost_empty_i(almost_empty_i),
+        .fifo_af_level_o(fifo_af_level_o),
+        .fifo_ae_level_o(fifo_ae_level_o),
+        .irq_o(irq_o)
+    );
+
+    // Salidas de dut_dma (R21 solo observa start_o, dma_start_o y dma_src1_addr_o)
+    /* verilator lint_off UNUSEDSIGNAL */
+    logic         d2_gnt_o;
+    logic         d2_rvalid_o;
+    logic [31:0]  d2_rdata_o;
+    logic         d2_err_o;
+    logic [3:0]   d2_op_code_o;
+    logic [31:0]  d2_num_bands_o;
+    logic [15:0]  d2_band_first_o;
+    logic [15:0]  d2_band_count_o;
+    logic         d2_stream_mode_o;
+    logic         d2_band_serial_o;
+    logic         d2_ref_mode_o;
+    logic [1:0]   d2_post_mode_o;
+    logic [31:0]  d2_threshold_o;
+    logic [1:0]   d2_prec_o;
+    logic [7:0]   d2_out_scale_o;
+    logic         d2_start_o;
+    logic         d2_job_active_o;
+    logic [31:0]  d2_dma_src1_addr_o;
+    logic [31:0]  d2_dma_src2_addr_o;
+    logic [31:0]  d2_dma_dst_addr_o;
+    logic [31:0]  d2_pixel_count_o;
+    logic [15:0]  d2_dma_src_stride_o;
+    logic [15:0]  d2_dma_dst_stride_o;
+    logic         d2_dma_start_o;
+    logic [15:0]  d2_fifo_af_level_o;
+    logic [15:0]  d2_fifo_ae_level_o;
+    logic         d2_irq_o;
+    /* verilator lint_on UNUSEDSIGNAL */
+    logic        d2_dma_done_i;
+    logic        d2_rst_ni;     // dut_dma queda en reset hasta R21
+
+    // Segunda instancia con EXPOSE_DMA = 1 para R21: mismo bus OBI, salidas propias
+    hsi_vector_core_wrapper #(
+        .OP_CODE_WIDTH(4),
+        .NUM_BANDS_WIDTH(32),
+        .ERR_WIDTH(4),
+        .READ_CLEAR_DONE(0),
+        .EXPOSE_FIFO_STATUS(0),
+        .EXPOSE_PERF(1),
+        .EXPOSE_DMA(1)
+    ) dut_dma (
+        .clk_i(clk),
+        .rst_ni(d2_rst_ni),
+        .req_i(req_i),
+        .we_i(we_i),
+        .be_i(be_i),
+        .addr_i(addr_i),
+        .wdata_i(wdata_i),
+        .gnt_o(d2_gnt_o),
+        .rvalid_o(d2_rvalid_o),
+        .rdata_o(d2_rdata_o),
+        .err_o(d2_err_o),
+        .op_code_o(d2_op_code_o),
+        .num_bands_o(d2_num_bands_o),
+        .band_first_o(d2_band_first_o),
+        .band_count_o(d2_band_count_o),
+        .stream_mode_o(d2_stream_mode_o),
+        .band_serial_o(d2_band_serial_o),
+        .ref_mode_o(d2_ref_mode_o),
+        .post_mode_o(d2_post_mode_o),
+        .prec_o(d2_prec_o),
+        .out_scale_o(d2_out_scale_o),
+        .threshold_o(d2_threshold_o),
+        .start_o(d2_start_o),
+        .start_ready_i(1'b1),
+        .job_active_o(d2_job_active_o),
+        .dma_src1_addr_o(d2_dma_src1_addr_o),
+        .dma_src2_addr_o(d2_dma_src2_addr_o),
+        .dma_dst_addr_o(d2_dma_dst_addr_o),
+        .pixel_count_o(d2_pixel_count_o),
+        .dma_src_stride_o(d2_dma_src_stride_o),
+        .dma_dst_stride_o(d2_dma_dst_stride_o),
+        .dma_start_o(d2_dma_start_o),
+        .dma_done_i(d2_dma_done_i),
         .pixel_done_i(pixel_done_i),
+        .pixel_valid_i(pixel_valid_i),
         .error_code_i(error_code_i),
         .in1_full_i(1'b0),
         .in2_full_i(1'b0),
         .out_full_i(1'b0),
         .out_empty_i(1'b0),
         .in1_empty_i(1'b0),
-        .in2_empty_i(1'b0)
+        .in2_empty_i(1'b0),
+        .core_state_i(core_state_i),
+        .stall_in_i(stall_in_i),
+        .stall_out_i(stall_out_i),
+        .core_valid_i(pixel_valid_i),
+        .core_busy_i(core_state_i != 4'd0),
+        .in1_level_i(in1_level_i),
+        .in2_level_i(in2_level_i),
+        .out_level_i(out_level_i),
+        .almost_full_i(almost_full_i),
+        .almost_empty_i(almost_empty_i),
+        .fifo_af_level_o(d2_fifo_af_level_o),
+        .fifo_ae_level_o(d2_fifo_ae_level_o),
+        .irq_o(d2_irq_o)
     );
 
+    // Modelo de los comparadores almost_full / almost_empty de las FIFOs del núcleo
+    assign almost_full_i  = {out_level_i >= fifo_af_level_o, in2_level_i >= fifo_af_level_o, in1_level_i >= fifo_af_level_o};
+    assign almost_empty_i = {out_level_i <= fifo_ae_level_o, in2_level_i <= fifo_ae_level_o, in1_level_i <= fifo_ae_level_o};
+
     // ---------------------- Clock & Reset ----------------------
     initial clk = 0;
     always #5 clk = ~clk;  // 100 MHz
@@ -116,7 +293,10 @@ module hsi_vector_core_wrapper_tb;
     initial begin
         rst_ni = 0;
         req_i = 0; we_i = 0; be_i = 4'h0; addr_i = '0; wdata_i = '0;
-        pixel_done_i = 0; error_code_i = 0;
+        pixel_done_i = 0; pixel_valid_i = 0; error_code_i = 0;
+        in1_level_i = 16'd4; in2_level_i = 16'd4; out_level_i = 16'd0;
+        core_state_i = 4'd0; stall_in_i = 0; stall_out_i = 0;
+        d2_dma_done_i = 0; d2_rst_ni = 0;
         repeat (5) @(posedge clk);
         rst_ni = 1;
     end
@@ -168,6 +348,14 @@ module hsi_vector_core_wrapper_tb;
   end
 
 
+  // ---------------------- Contadores de pulsos (R21) ----------------------
+  integer start_cnt = 0, d2_start_cnt = 0, d2_dma_start_cnt = 0;
+  always @(posedge clk) begin
+      if (start_o)        start_cnt        <= start_cnt + 1;
+      if (d2_start_o)     d2_start_cnt     <= d2_start_cnt + 1;
+      if (d2_dma_start_o) d2_dma_start_cnt <= d2_dma_start_cnt + 1;
+  end
+
     // Monitor de salidas para evitar UNUSED y posible debug
     always @(posedge clk) begin
         op_code_o_d   <= op_code_o;
@@ -248,6 +436,234 @@ module hsi_vector_core_wrapper_tb;
 
         pixel_done_i = 1'b1; @(posedge clk); pixel_done_i = 1'b0;
 
+        obi_read(32'h14, data_rd); if (data_rd[0] !== 1'b0)    `INC_ERR("[R13] CONFIG tras reset !=0")
+        obi_write(32'h14, 32'h0000_0001, 4'h1, 1'b0, 1'b0);
+        obi_read(32'h14, data_rd); if (data_rd[0] !== 1'b1)    `INC_ERR("[R13] CONFIG.STREAM readback incorrecto")
+        if (stream_mode_o !== 1'b1)                            `INC_ERR("[R13] stream_mode_o no activo")
+        obi_write(32'h14, 32'h0000_0002, 4'h1, 1'b0, 1'b0);
+        obi_read(32'h14, data_rd); if (data_rd[1:0] !== 2'b10) `INC_ERR("[R13] CONFIG.BAND_SERIAL readback incorrecto")
+        if (stream_mode_o !== 1'b0)                            `INC_ERR("[R13] stream_mode_o no se desactivó")
+        if (band_serial_o !== 1'b1)                            `INC_ERR("[R13] band_serial_o no activo")
+        obi_write(32'h14, 32'h0000_0004, 4'h1, 1'b0, 1'b0);
+        obi_read(32'h14, data_rd); if (data_rd[2:0] !== 3'b100) `INC_ERR("[R13] CONFIG.REF_MODE readback incorrecto")
+        if (ref_mode_o !== 1'b1 || band_serial_o !== 1'b0)    `INC_ERR("[R13] ref_mode_o no activo")
+        obi_write(32'h14, 32'h0000_0010, 4'h1, 1'b0, 1'b0);
+        obi_read(32'h14, data_rd); if (data_rd[4:0] !== 5'b10000) `INC_ERR("[R13] CONFIG.POST readback incorrecto")
+        if (post_mode_o !== 2'd2 || ref_mode_o !== 1'b0)       `INC_ERR("[R13] post_mode_o incorrecto")
+        obi_read(32'h80, data_rd); if (data_rd !== 32'h0)      `INC_ERR("[R13] THRESHOLD tras reset !=0")
+        obi_write(32'h80, 32'hFFFF_FFF6, 4'hF, 1'b0, 1'b0);
+        obi_read(32'h80, data_rd); if (data_rd !== 32'hFFFF_FFF6) `INC_ERR("[R13] THRESHOLD readback incorrecto")
+        if (threshold_o !== 32'hFFFF_FFF6)                     `INC_ERR("[R13] threshold_o incorrecto")
+        obi_write(32'h80, 32'h0000_0000, 4'hF, 1'b0, 1'b0);
+        obi_write(32'h14, 32'h0000_0040, 4'h1, 1'b0, 1'b0);
+        obi_read(32'h14, data_rd); if (data_rd[6:0] !== 7'b1000000) `INC_ERR("[R13] CONFIG.PREC readback incorrecto")
+        if (prec_o !== 2'd2 || post_mode_o !== 2'd0)           `INC_ERR("[R13] prec_o incorrecto")
+        obi_write(32'h14, 32'h0000_C500, 4'h2, 1'b0, 1'b0);
+        obi_read(32'h14, data_rd); if (data_rd !== 32'h0000_C540) `INC_ERR("[R13] CONFIG.OUT_SCALE readback incorrecto")
+        if (out_scale_o !== 8'hC5 || prec_o !== 2'd2)          `INC_ERR("[R13] out_scale_o incorrecto")
+        obi_write(32'h14, 32'h0000_0000, 4'h2, 1'b0, 1'b0);
+        obi_read(32'h84, data_rd); if (data_rd !== 32'h0)      `INC_ERR("[R13] BAND_WINDOW tras reset !=0")
+        obi_write(32'h84, 32'h0003_0004, 4'hF, 1'b0, 1'b0);
+        obi_read(32'h84, data_rd); if (data_rd !== 32'h0003_0004) `INC_ERR("[R13] BAND_WINDOW readback incorrecto")
+        if (band_first_o !== 16'd4 || band_count_o !== 16'd3)  `INC_ERR("[R13] band_first_o / band_count_o incorrectos")
+        obi_write(32'h84, 32'h0000_0000, 4'hF, 1'b0, 1'b0);
+        obi_write(32'h14, 32'h0000_0000, 4'h1, 1'b0, 1'b0);
+
+        $display("Escritura con comprobacion de señal err_o para [R14]");
+        obi_write(32'h18, 32'h0000_0100, 4'hF, 1'b0, 1'b1);
+        obi_write(32'h08, 32'h0000_0008, 4'h1, 1'b0, 1'b0);
+        @(posedge clk); if (dma_start_o)       `INC_ERR("[R14] dma_start_o activo sin EXPOSE_DMA")
+        data_rd = rd_status(); if (data_rd[10:9] !== 2'b00) `INC_ERR("[R14] DMA_BUSY/DMA_DONE activos sin EXPOSE_DMA")
+
+        obi_write(32'h24, 32'd3, 4'hF, 1'b0, 1'b0);
+        obi_read(32'h24, data_rd); if (data_rd !== 32'd3)      `INC_ERR("[R15] PIXEL_COUNT readback incorrecto")
+        obi_write(32'h08, 32'h0000_0003, 4'h1, 1'b1, 1'b0);   // CLEAR_DONE | START
+        if (job_active_o !== 1'b1)                             `INC_ERR("[R15] job_active_o no activo")
+        pixel_done_i = 1'b1; @(posedge clk); pixel_done_i = 1'b0;
+        repeat (2) begin
+            pixel_valid_i = 1'b1; @(posedge clk); pixel_valid_i = 1'b0; @(posedge clk);
+        end
+        data_rd = rd_status(); if (data_rd[0] !== 1'b0 || data_rd[8] !== 1'b1) `INC_ERR("[R15] DONE antes del último píxel")
+        obi_read(32'h2C, data_rd); if (data_rd !== 32'd2)      `INC_ERR("[R15] PROCESSED_COUNT != 2")
+        pixel_valid_i = 1'b1; @(posedge clk); pixel_valid_i = 1'b0; @(posedge clk);
+        data_rd = rd_status(); if (data_rd[0] !== 1'b1 || data_rd[8] !== 1'b0) `INC_ERR("[R15] DONE/BUSY incorrectos al final del trabajo")
+        obi_read(32'h2C, data_rd); if (data_rd !== 32'd3)      `INC_ERR("[R15] PROCESSED_COUNT != 3")
+        if (job_active_o !== 1'b0)                             `INC_ERR("[R15] job_active_o activo tras el trabajo")
+        obi_write(32'h24, 32'd0, 4'hF, 1'b0, 1'b0);
+
+        obi_read(32'h38, data_rd); if (data_rd !== 32'h0000_0001) `INC_ERR("[R16] IRQ_LEVEL tras reset incorrecto")
+        obi_write(32'h34, 32'h0000_000F, 4'h1, 1'b0, 1'b0);  // limpiar pendientes
+        obi_read(32'h34, data_rd); if (data_rd[3:0] !== 4'h0)  `INC_ERR("[R16] IRQ_STATUS no se limpió")
+        obi_write(32'h30, 32'h0000_0001, 4'h1, 1'b0, 1'b0);  // IRQ DONE
+        obi_write(32'h08, 32'h0000_0003, 4'h1, 1'b1, 1'b0);  // CLEAR_DONE | START
+        if (irq_o)                                             `INC_ERR("[R16] irq_o activo antes de DONE")
+        pixel_done_i = 1'b1; @(posedge clk); pixel_done_i = 1'b0;
+        repeat (2) @(posedge clk);
+        if (!irq_o)                                            `INC_ERR("[R16] irq_o no activo tras DONE")
+        obi_write(32'h34, 32'h0000_0001, 4'h1, 1'b0, 1'b0);
+        if (irq_o)                                             `INC_ERR("[R16] irq_o no se limpió con W1C")
+
+        obi_write(32'h30, 32'h0000_0004, 4'h1, 1'b0, 1'b0);  // IRQ OUT_LEVEL
+        out_level_i = 16'd1; repeat (2) @(posedge clk);
+        if (!irq_o)                                            `INC_ERR("[R16] irq_o no activo con OUT_LEVEL")
+        out_level_i = 16'd0;
+        obi_write(32'h34, 32'h0000_0004, 4'h1, 1'b0, 1'b0);
+        if (irq_o)                                             `INC_ERR("[R16] OUT_LEVEL no se limpió")
+
+        obi_write(32'h30, 32'h0000_0008, 4'h1, 1'b0, 1'b0);  // IRQ IN_LEVEL
+        in1_level_i = 16'd0; in2_level_i = 16'd0; repeat (2) @(posedge clk);
+        if (!irq_o)                                            `INC_ERR("[R16] irq_o no activo con IN_LEVEL")
+        in1_level_i = 16'd4; in2_level_i = 16'd4;
+        obi_write(32'h34, 32'h0000_0008, 4'h1, 1'b0, 1'b0);
+        if (irq_o)                                             `INC_ERR("[R16] IN_LEVEL no se limpió")
+
+        obi_write(32'h30, 32'h0000_0002, 4'h1, 1'b0, 1'b0);  // IRQ ERROR
+        obi_write(32'h08, 32'h0000_0003, 4'h1, 1'b1, 1'b0);  // el error solo se captura con BUSY
+        error_code_i = 4'h3; repeat (3) @(posedge clk); error_code_i = 4'h0;
+        if (!irq_o)                                            `INC_ERR("[R16] irq_o no activo con ERROR")
+        obi_write(32'h08, 32'h0000_0004, 4'h1, 1'b0, 1'b0);  // CLEAR_ERROR
+        obi_write(32'h34, 32'h0000_0002, 4'h1, 1'b0, 1'b0);
+        if (irq_o)                                             `INC_ERR("[R16] ERROR no se limpió")
+        obi_write(32'h30, 32'h0000_0000, 4'h1, 1'b0, 1'b0);
+
+        // Escritura de OP_CODE seguida sin hueco de su lectura y de una lectura inválida
+        @(posedge clk);
+        addr_i = 32'h00; wdata_i = 32'h0000_0002; be_i = 4'h1; we_i = 1'b1; req_i = 1'b1;
+        #1; if (!gnt_o)                                        `INC_ERR("[R17] gnt_o no concedido a la primera petición")
+        @(posedge clk);
+        addr_i = 32'h00; we_i = 1'b0; be_i = 4'hF;
+        #1; if (!(gnt_o && rvalid_o))                          `INC_ERR("[R17] segunda petición no concedida junto a la respuesta")
+        @(posedge clk);
+        addr_i = 32'h20;
+        #1; if (!(gnt_o && rvalid_o) || rdata_o[3:0] !== 4'h2) `INC_ERR("[R17] lectura back-to-back de OP_CODE incorrecta")
+        @(posedge clk);
+        req_i = 1'b0; addr_i = 32'h0;
+        #1; if (!rvalid_o || !err_o)                           `INC_ERR("[R17] err_o no activo en la tercera respuesta")
+        @(posedge clk);
+        #1; if (rvalid_o)                                      `INC_ERR("[R17] rvalid_o sin petición pendiente")
+
+        // Núcleo simulado: 4 ciclos en COMPUTE esperando datos, 2 en WRITE retenido con un resultado
+        // y 3 en REF_LOAD
+        obi_write(32'h3C, 32'h0000_0001, 4'h1, 1'b0, 1'b0);  // PERF_CTRL.CLEAR
+        @(negedge clk); core_state_i = 4'd3; stall_in_i = 1'b1;
+        repeat (4) @(negedge clk);
+        core_state_i = 4'd4; stall_in_i = 1'b0; stall_out_i = 1'b1; pixel_valid_i = 1'b1;
+        @(negedge clk); pixel_valid_i = 1'b0;
+        @(negedge clk); core_state_i = 4'd8; stall_out_i = 1'b0;
+        repeat (3) @(negedge clk);
+        core_state_i = 4'd0;
+        obi_read(32'h40, data_rd); if (data_rd !== 32'd9)      `INC_ERR("[R18] PERF_BUSY != 9")
+        obi_read(32'h44, data_rd); if (data_rd !== 32'd1)      `INC_ERR("[R18] PERF_PIXELS != 1")
+        obi_read(32'h48, data_rd); if (data_rd !== 32'd4)      `INC_ERR("[R18] PERF_STALL_IN != 4")
+        obi_read(32'h4C, data_rd); if (data_rd !== 32'd2)      `INC_ERR("[R18] PERF_STALL_OUT != 2")
+        obi_read(32'h50, data_rd); if (data_rd == 32'd0)       `INC_ERR("[R18] PERF_STATE IDLE no cuenta")
+        obi_read(32'h5C, data_rd); if (data_rd !== 32'd4)      `INC_ERR("[R18] PERF_STATE COMPUTE != 4")
+        obi_read(32'h60, data_rd); if (data_rd !== 32'd2)      `INC_ERR("[R18] PERF_STATE WRITE != 2")
+        obi_read(32'h6C, data_rd); if (data_rd !== 32'd0)      `INC_ERR("[R18] PERF_STATE STREAM != 0")
+        obi_read(32'h70, data_rd); if (data_rd !== 32'd3)      `INC_ERR("[R18] PERF_STATE REF_LOAD != 3")
+        obi_read(32'h100, data_rd); if (data_rd !== 32'd1)     `INC_ERR("[R18] PERF_CORE_PIXELS(0) != 1")
+        obi_read(32'h104, data_rd); if (data_rd !== 32'd9)     `INC_ERR("[R18] PERF_CORE_BUSY(0) != 9")
+        obi_write(32'h108, 32'h0, 4'hF, 1'b0, 1'b1);           // NUM_CORES = 1: sin núcleo 1
+        obi_write(32'h3C, 32'h0000_0001, 4'h1, 1'b0, 1'b0);
+        obi_read(32'h40, data_rd); if (data_rd !== 32'd0)      `INC_ERR("[R18] PERF_BUSY no se limpió")
+        obi_read(32'h48, data_rd); if (data_rd !== 32'd0)      `INC_ERR("[R18] PERF_STALL_IN no se limpió")
+        obi_read(32'h70, data_rd); if (data_rd !== 32'd0)      `INC_ERR("[R18] PERF_STATE REF_LOAD no se limpió")
+        obi_write(32'h74, 32'h0, 4'hF, 1'b0, 1'b1);            // fuera del bloque de contadores
+
+        // Umbrales: almost_full con 5 palabras, almost_empty con 3
+        obi_write(32'h38, 32'h0003_0005, 4'hF, 1'b0, 1'b0);
+        if (fifo_af_level_o !== 16'd5 || fifo_ae_level_o !== 16'd3) `INC_ERR("[R19] umbrales de FIFO no siguen a IRQ_LEVEL")
+        obi_write(32'h30, 32'h0000_0008, 4'h1, 1'b0, 1'b0);  // IRQ IN_LEVEL
+        obi_write(32'h34, 32'h0000_000F, 4'h1, 1'b0, 1'b0);
+        if (irq_o)                                             `INC_ERR("[R19] IN_LEVEL activo con 4 palabras y umbral 3")
+        in1_level_i = 16'd3; in2_level_i = 16'd3; repeat (2) @(posedge clk);
+        if (!irq_o)                                            `INC_ERR("[R19] IN_LEVEL no activo con almost_empty")
+        in1_level_i = 16'd4; in2_level_i = 16'd4;
+        obi_write(32'h34, 32'h0000_0008, 4'h1, 1'b0, 1'b0);
+        obi_write(32'h30, 32'h0000_0000, 4'h1, 1'b0, 1'b0);
+        obi_write(32'h38, 32'h0000_0001, 4'hF, 1'b0, 1'b0);
+
+        // Cola de descriptores: DOT de 2 píxeles y, encolado durante el primero, SAM de 1 píxel
+        obi_write(32'h00, 32'h0000_0002, 4'h1, 1'b0, 1'b0);
+        obi_write(32'h04, 32'd3, 4'hF, 1'b0, 1'b0);
+        obi_write(32'h24, 32'd2, 4'hF, 1'b0, 1'b0);
+        obi_write(32'h08, 32'h0000_0010, 4'h1, 1'b0, 1'b0);  // ENQUEUE
+        data_rd = rd_status(); if (data_rd[8] !== 1'b1 || op_code_o !== 4'h2) `INC_ERR("[R20] primer descriptor no lanzado")
+        obi_write(32'h00, 32'h0000_0003, 4'h1, 1'b0, 1'b0);
+        obi_write(32'h04, 32'd5, 4'hF, 1'b0, 1'b0);
+        obi_write(32'h24, 32'd1, 4'hF, 1'b0, 1'b0);
+        obi_write(32'h08, 32'h0000_0010, 4'h1, 1'b0, 1'b0);
+        if (op_code_o !== 4'h2 || num_bands_o !== 32'd3 || pixel_count_o !== 32'd2) `INC_ERR("[R20] registros sombra alteran el trabajo en curso")
+        obi_read(32'h7C, data_rd); if (data_rd[7:0] !== 8'd1)  `INC_ERR("[R20] DESC_STATUS no muestra un descriptor pendiente")
+        obi_read(32'h00, data_rd); if (data_rd[3:0] !== 4'h3)  `INC_ERR("[R20] OP_CODE no devuelve el registro sombra")
+        repeat (2) begin
+            pixel_valid_i = 1'b1; @(posedge clk); pixel_valid_i = 1'b0; @(posedge clk);
+        end
+        data_rd = rd_status();
+        if (data_rd[8] !== 1'b1 || op_code_o !== 4'h3 || num_bands_o !== 32'd5 || pixel_count_o !== 32'd1)
+            `INC_ERR("[R20] segundo descriptor no aplicado al terminar el primero")
+        pixel_valid_i = 1'b1; @(posedge clk); pixel_valid_i = 1'b0; @(posedge clk);
+        data_rd = rd_status(); if (data_rd[0] !== 1'b1 || data_rd[8] !== 1'b0) `INC_ERR("[R20] DONE/BUSY incorrectos al vaciar la cola")
+        obi_read(32'h7C, data_rd); if (data_rd !== 32'h0000_0200) `INC_ERR("[R20] DESC_STATUS != 2 trabajos terminados")
+        obi_write(32'h08, 32'h0000_0002, 4'h1, 1'b0, 1'b0);
+        obi_write(32'h24, 32'd0, 4'hF, 1'b0, 1'b0);
+
+        // ENQUEUE con START (0x11) y con DMA_START (0x18): solo arranca el descriptor extraído
+        begin : r21
+            integer s0, d0, m0;
+            d2_rst_ni = 1'b1; @(posedge clk);
+            obi_write(32'h24, 32'd1, 4'hF, 1'b0, 1'b0);
+            s0 = start_cnt;
+            obi_write(32'h08, 32'h0000_0011, 4'h1, 1'b0, 1'b0);
+            repeat (2) @(posedge clk);
+            if (start_cnt !== s0 + 1)                          `INC_ERR("[R21] 0x11 no lanza exactamente un START")
+            pixel_valid_i = 1'b1; @(posedge clk); pixel_valid_i = 1'b0;
+            repeat (4) @(posedge clk);
+            if (start_cnt !== s0 + 1)                          `INC_ERR("[R21] 0x11 lanza un segundo START")
+            data_rd = rd_status(); if (data_rd[0] !== 1'b1 || data_rd[8] !== 1'b0) `INC_ERR("[R21] DONE/BUSY incorrectos tras 0x11")
+            obi_read(32'h7C, data_rd); if (data_rd !== 32'h0000_0100) `INC_ERR("[R21] 0x11 no pasa por la cola")
+            obi_write(32'h08, 32'h0000_0002, 4'h1, 1'b0, 1'b0);
+
+            obi_write(32'h18, 32'h0000_0100, 4'hF, 1'b0, 1'b0);  // DMA_SRC1 (solo en dut_dma)
+            s0 = start_cnt; d0 = d2_start_cnt; m0 = d2_dma_start_cnt;
+            obi_write(32'h08, 32'h0000_0018, 4'h1, 1'b0, 1'b0);
+            repeat (2) @(posedge clk);
+            if (d2_dma_start_cnt !== m0 + 1 || d2_start_cnt !== d0 + 1) `INC_ERR("[R21] 0x18 no lanza el descriptor con DMA")
+            if (start_cnt !== s0 + 1)                          `INC_ERR("[R21] 0x18 sin EXPOSE_DMA no lanza el descriptor")
+            if (d2_dma_src1_addr_o !== 32'h0000_0100)          `INC_ERR("[R21] DMA_SRC1 no sale del descriptor")
+            d2_dma_done_i = 1'b1; pixel_valid_i = 1'b1; @(posedge clk);
+            d2_dma_done_i = 1'b0; pixel_valid_i = 1'b0;
+            repeat (4) @(posedge clk);
+            if (d2_dma_start_cnt !== m0 + 1 || d2_start_cnt !== d0 + 1) `INC_ERR("[R21] 0x18 lanza un segundo DMA_START/START")
+            if (start_cnt !== s0 + 1)                          `INC_ERR("[R21] 0x18 lanza un segundo START")
+            obi_write(32'h08, 32'h0000_0002, 4'h1, 1'b0, 1'b0);
+            obi_write(32'h24, 32'd0, 4'hF, 1'b0, 1'b0);
+        end
+
+        // Cola tras un error: el primer trabajo falla y el núcleo conserva su código hasta el
+        // siguiente START; tras CLEAR_ERROR el segundo trabajo se lanza y termina
+        begin : r22
+            integer s0;
+            obi_write(32'h24, 32'd1, 4'hF, 1'b0, 1'b0);
+            s0 = start_cnt;
+            obi_write(32'h08, 32'h0000_0010, 4'h1, 1'b0, 1'b0);  // ENQUEUE (falla)
+            obi_write(32'h08, 32'h0000_0010, 4'h1, 1'b0, 1'b0);  // ENQUEUE (válido)
+            error_code_i = 4'h1; repeat (2) @(posedge clk);
+            data_rd = rd_status(); if (data_rd[4:1] !== 4'h1 || data_rd[8] !== 1'b0) `INC_ERR("[R22] error del primer trabajo no capturado")
+            obi_read(32'h7C, data_rd); if (data_rd[7:0] !== 8'd1) `INC_ERR("[R22] la cola no se detiene con el error")
+            obi_write(32'h08, 32'h0000_0004, 4'h1, 1'b0, 1'b0);  // CLEAR_ERROR
+            wait (start_cnt == s0 + 2);
+            error_code_i = 4'h0;                                 // el núcleo renueva el código con START
+            data_rd = rd_status(); if (data_rd[4:1] !== 4'h0 || data_rd[8] !== 1'b1) `INC_ERR("[R22] código antiguo recapturado tras CLEAR_ERROR")
+            pixel_valid_i = 1'b1; @(posedge clk); pixel_valid_i = 1'b0;
+            repeat (2) @(posedge clk);
+            data_rd = rd_status(); if (data_rd[0] !== 1'b1 || data_rd[4:1] !== 4'h0 || data_rd[8] !== 1'b0) `INC_ERR("[R22] el trabajo válido no termina tras CLEAR_ERROR")
+            obi_read(32'h7C, data_rd); if (data_rd[7:0] !== 8'd0) `INC_ERR("[R22] quedan descriptores en la cola")
+            if (start_cnt !== s0 + 2)                            `INC_ERR("[R22] número de START incorrecto")
+            obi_write(32'h08, 32'h0000_0002, 4'h1, 1'b0, 1'b0);
+            obi_write(32'h24, 32'd0, 4'hF, 1'b0, 1'b0);
+        end
+
         if (error_count==0) begin
             $display("============================= ALL TESTS PASSED =============================");
         end else begin